@@ -0,0 +1,280 @@
+﻿/// @file
+/// @brief psyq::event_driven のスループットと待ち時間を計測する。
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_EVENT_DRIVEN_BENCHMARK_HPP_
+#define PSYQ_EVENT_DRIVEN_BENCHMARK_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "./zone.hpp"
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+namespace psyq_test
+{
+    /// @brief event_driven_throughput の計測結果。
+    struct event_driven_benchmark_result
+    {
+        /// @brief メッセージを送信するスレッドの数。
+        std::size_t producer_count;
+        /// @brief dispatcher を処理するスレッドの数。
+        std::size_t dispatcher_count;
+        /// @brief dispatcher ごとのメッセージ受信関数の数。
+        std::size_t receiver_count;
+        /// @brief メッセージ引数の大きさ。バイト単位。
+        std::size_t payload_size;
+        /// @brief 送信したメッセージの数。
+        std::size_t message_count;
+        /// @brief 全てのメッセージを受信するまでの時間。秒単位。
+        double seconds;
+        /// @brief 1秒あたりに送信したメッセージの数。
+        double messages_per_second;
+        /// @brief 1秒あたりにメッセージ受信関数を呼び出した数。
+        /// @details 待ち時間を記録する受信関数の呼び出しも含む。
+        double deliveries_per_second;
+        /// @brief 送信予約から受信までの待ち時間の度数分布。
+        psyq::event_driven::latency_histogram::snapshot latency;
+    };
+
+    /// @brief 複数の送信スレッドと dispatcher スレッドで、メッセージを循環させる。
+    /// @details
+    ///   - in_producer_count 個のスレッドから、
+    ///     それぞれ in_message_count 個のメッセージを送信する。
+    ///   - in_dispatcher_count 個のスレッドに dispatcher を用意し、
+    ///     それぞれに in_receiver_count 個のメッセージ受信関数と、
+    ///     待ち時間を記録するメッセージ受信関数を1個登録する。
+    ///     全てのメッセージ受信関数が、全てのメッセージを受信する。
+    ///   - 呼び出したスレッドで zone::dispatch を繰り返す。
+    /// @return 計測結果。
+    /// @tparam template_payload_size メッセージ引数の大きさ。バイト単位。
+    template<std::size_t template_payload_size>
+    event_driven_benchmark_result event_driven_throughput(
+        /// [in] メッセージを送信するスレッドの数。
+        std::size_t const in_producer_count,
+        /// [in] dispatcher を処理するスレッドの数。
+        std::size_t const in_dispatcher_count,
+        /// [in] dispatcher ごとのメッセージ受信関数の数。
+        std::size_t const in_receiver_count,
+        /// [in] 送信スレッドごとのメッセージの数。
+        std::size_t const in_message_count)
+    {
+        typedef psyq::event_driven::zone<> benchmark_zone;
+        typedef std::array<unsigned char, template_payload_size> payload;
+        typedef psyq::event_driven::latency_histogram latency_histogram;
+        psyq::any::rtti::equip<payload>();
+
+        benchmark_zone local_zone(in_dispatcher_count, 0);
+        local_zone.enable_timestamp(true);
+        auto const local_total(in_producer_count * in_message_count);
+
+        // dispatcher スレッドを起動する。
+        std::atomic<std::size_t> local_ready_count(0);
+        std::atomic<std::size_t> local_done_count(0);
+        std::atomic<bool> local_start(false);
+        std::vector<std::unique_ptr<latency_histogram>> local_histograms;
+        std::vector<std::thread> local_threads;
+        for (std::size_t i(0); i < in_dispatcher_count; ++i)
+        {
+            local_histograms.emplace_back(new latency_histogram);
+            auto& local_histogram(*local_histograms.back());
+            local_threads.emplace_back(
+                [&local_zone, &local_ready_count, &local_done_count,
+                 &local_histogram, in_receiver_count, local_total]()
+                {
+                    auto const local_dispatcher(local_zone.equip_dispatcher());
+                    std::size_t local_received(0);
+                    std::uint32_t local_checksum(0);
+                    std::vector<benchmark_zone::dispatcher::function_shared_ptr>
+                        local_functions;
+                    for (std::size_t j(0); j < in_receiver_count; ++j)
+                    {
+                        local_functions.push_back(
+                            std::allocate_shared<
+                                benchmark_zone::dispatcher::function>(
+                                    local_zone.get_allocator(),
+                                    [&local_checksum](
+                                        benchmark_zone::packet const& in_packet)
+                                    {
+                                        auto const local_payload(
+                                            in_packet.get_parameter<payload>());
+                                        if (local_payload != nullptr)
+                                        {
+                                            local_checksum += (*local_payload)[0];
+                                        }
+                                    }));
+                        local_dispatcher->register_receiver(
+                            static_cast<benchmark_zone::tag::key_type>(j),
+                            1,
+                            local_functions.back());
+                    }
+                    local_functions.push_back(
+                        std::allocate_shared<benchmark_zone::dispatcher::function>(
+                            local_zone.get_allocator(),
+                            [&local_received, &local_histogram](
+                                benchmark_zone::packet const& in_packet)
+                            {
+                                local_histogram.record(
+                                    latency_histogram::now()
+                                    - in_packet.get_post_time());
+                                ++local_received;
+                            }));
+                    local_dispatcher->register_receiver(
+                        static_cast<benchmark_zone::tag::key_type>(
+                            in_receiver_count),
+                        1,
+                        local_functions.back());
+                    ++local_ready_count;
+                    while (local_received < local_total)
+                    {
+                        local_dispatcher->dispatch();
+                        std::this_thread::yield();
+                    }
+                    PSYQ_ASSERT(local_checksum == 0);
+                    ++local_done_count;
+                });
+        }
+        while (local_ready_count < in_dispatcher_count)
+        {
+            std::this_thread::yield();
+        }
+
+        // 送信スレッドを起動する。
+        for (std::size_t i(0); i < in_producer_count; ++i)
+        {
+            local_threads.emplace_back(
+                [&local_zone, &local_start, i, in_message_count]()
+                {
+                    payload local_payload = {};
+                    while (!local_start)
+                    {
+                        std::this_thread::yield();
+                    }
+                    for (std::size_t j(0); j < in_message_count; ++j)
+                    {
+                        // 受信マスクを0にして、全てのメッセージ受信関数へ送る。
+                        local_zone.post_zonal(
+                            benchmark_zone::tag(
+                                static_cast<benchmark_zone::tag::key_type>(i),
+                                0,
+                                1,
+                                0),
+                            payload(local_payload));
+                    }
+                });
+        }
+
+        // 全ての dispatcher が受信し終わるまで、メッセージを配送する。
+        auto const local_begin(std::chrono::steady_clock::now());
+        local_start = true;
+        while (local_done_count < in_dispatcher_count)
+        {
+            local_zone.dispatch();
+            std::this_thread::yield();
+        }
+        auto const local_end(std::chrono::steady_clock::now());
+        for (auto& local_thread: local_threads)
+        {
+            local_thread.join();
+        }
+
+        // 計測結果をまとめる。
+        event_driven_benchmark_result local_result;
+        local_result.producer_count = in_producer_count;
+        local_result.dispatcher_count = in_dispatcher_count;
+        local_result.receiver_count = in_receiver_count;
+        local_result.payload_size = template_payload_size;
+        local_result.message_count = local_total;
+        local_result.seconds =
+            std::chrono::duration<double>(local_end - local_begin).count();
+        local_result.messages_per_second =
+            local_total / local_result.seconds;
+        // 待ち時間を記録する受信関数も含め、登録した受信関数の数で数える。
+        local_result.deliveries_per_second =
+            local_result.messages_per_second
+            * in_dispatcher_count * (in_receiver_count + 1);
+        local_result.latency = latency_histogram().take_snapshot();
+        for (auto const& local_histogram: local_histograms)
+        {
+            auto const local_snapshot(local_histogram->take_snapshot());
+            for (std::size_t i(0); i < local_snapshot.buckets.size(); ++i)
+            {
+                local_result.latency.buckets[i] += local_snapshot.buckets[i];
+            }
+            local_result.latency.count += local_snapshot.count;
+            local_result.latency.sum += local_snapshot.sum;
+            local_result.latency.max =
+                (std::max)(local_result.latency.max, local_snapshot.max);
+        }
+        return local_result;
+    }
+
+    /// @brief event_driven_throughput の計測結果を出力する。
+    inline void print_event_driven_benchmark(
+        event_driven_benchmark_result const& in_result)
+    {
+        printf(
+            // receivers の "+1" は、待ち時間を記録する受信関数。
+            "producers %2u dispatchers %2u receivers %2u+1 payload %4u : "
+            "%10.0f msg/s %11.0f call/s "
+            "p50 %8lldns p99 %8lldns p99.9 %8lldns max %8lldns\n",
+            static_cast<unsigned>(in_result.producer_count),
+            static_cast<unsigned>(in_result.dispatcher_count),
+            static_cast<unsigned>(in_result.receiver_count),
+            static_cast<unsigned>(in_result.payload_size),
+            in_result.messages_per_second,
+            in_result.deliveries_per_second,
+            static_cast<long long>(in_result.latency.get_percentile(0.5)),
+            static_cast<long long>(in_result.latency.get_percentile(0.99)),
+            static_cast<long long>(in_result.latency.get_percentile(0.999)),
+            static_cast<long long>(in_result.latency.max));
+    }
+
+    /// @brief 送信スレッドと dispatcher スレッドの数、受信関数の数、
+    ///   メッセージ引数の大きさを変えながら計測する。
+    template<std::size_t template_payload_size>
+    void event_driven_benchmark_payload(
+        std::size_t const in_message_count,
+        bool const in_verbose)
+    {
+        std::size_t const local_thread_counts[] = {1, 4};
+        std::size_t const local_receiver_counts[] = {1, 8};
+        for (auto local_producer_count: local_thread_counts)
+        {
+            for (auto local_dispatcher_count: local_thread_counts)
+            {
+                for (auto local_receiver_count: local_receiver_counts)
+                {
+                    auto const local_result(
+                        event_driven_throughput<template_payload_size>(
+                            local_producer_count,
+                            local_dispatcher_count,
+                            local_receiver_count,
+                            in_message_count));
+                    PSYQ_ASSERT(
+                        local_result.latency.count
+                        == local_result.message_count * local_dispatcher_count);
+                    if (in_verbose)
+                    {
+                        print_event_driven_benchmark(local_result);
+                    }
+                }
+            }
+        }
+    }
+
+    inline void event_driven_benchmark(
+        std::size_t const in_message_count = 10000,
+        bool const in_verbose = true)
+    {
+        event_driven_benchmark_payload<8>(in_message_count, in_verbose);
+        event_driven_benchmark_payload<64>(in_message_count, in_verbose);
+        event_driven_benchmark_payload<512>(in_message_count, in_verbose);
+    }
+}
+
+#endif // !defined(PSYQ_EVENT_DRIVEN_BENCHMARK_HPP_)
+// vim: set expandtab:
@@ -0,0 +1,290 @@
+﻿/// @file
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_EVENT_DRIVEN_BOUNDED_QUEUE_HPP_
+#define PSYQ_EVENT_DRIVEN_BOUNDED_QUEUE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <type_traits>
+
+/// @cond
+namespace psyq
+{
+    namespace event_driven
+    {
+        template<typename, typename> class bounded_queue;
+    } // namespace event_driven
+} // namespace psyq
+/// @endcond
+
+namespace psyq
+{
+    namespace event_driven
+    {
+        /// @brief 待ち行列が満杯のときに、要素を追加しようとした場合の方針。
+        enum overflow_policy
+        {
+            overflow_policy_BLOCK,       ///< 空きができるまで待つ。
+            overflow_policy_DROP_OLDEST, ///< 最も古い要素を捨てて追加する。
+            overflow_policy_DROP_NEWEST, ///< 追加しようとした要素を捨てる。
+            overflow_policy_FAIL,        ///< 追加に失敗する。
+        };
+    } // namespace event_driven
+} // namespace psyq
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief ロックを使わない、容量が固定された複数送信者と複数受信者の待ち行列。
+/// @details
+///   - 構築時に要素の領域を確保し、それ以降はメモリ割当を行わない。
+///   - this_type::try_push と this_type::try_pop は、
+///     どのスレッドからでもロックなしで呼び出せる。
+///   - 同一スレッドから this_type::try_push した要素は、
+///     取り出す順序が追加した順序と同じになる。
+///   - 内部は、各要素に通し番号を持たせた循環バッファ。
+/// @tparam template_value     @copydoc bounded_queue::value_type
+/// @tparam template_allocator @copydoc bounded_queue::allocator_type
+template<typename template_value, typename template_allocator>
+class psyq::event_driven::bounded_queue
+{
+    /// @copydoc psyq::string::view::this_type
+    private: typedef bounded_queue this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 待ち行列の要素の型。
+    public: typedef template_value value_type;
+    /// @brief this_type で使うメモリ割当子。
+    public: typedef template_allocator allocator_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 待ち行列の要素を格納する領域。
+    private: struct cell
+    {
+        /// @brief 要素の領域の通し番号。
+        std::atomic<std::size_t> sequence;
+        /// @brief 要素を格納する領域。
+        typename std::aligned_storage<
+            sizeof(typename bounded_queue::value_type),
+            alignof(typename bounded_queue::value_type)>::type
+                storage;
+    };
+    /// @brief 要素の領域のメモリ割当子。
+    private: typedef
+        typename this_type::allocator_type::template rebind<
+            typename this_type::cell>::other
+        cell_allocator;
+
+    //-------------------------------------------------------------------------
+    /// @brief 空の待ち行列を構築する。
+    public: bounded_queue(
+        /// [in] 待ち行列の容量。
+        /// 0 以外は2以上の2のべき乗に切り上げる。0なら、領域を確保しない。
+        std::size_t const in_capacity,
+        /// [in] *thisが使うメモリ割当子の初期値。
+        typename this_type::allocator_type const& in_allocator):
+    allocator_(in_allocator),
+    cells_(nullptr),
+    mask_(0),
+    push_position_(0),
+    pop_position_(0)
+    {
+        if (0 < in_capacity)
+        {
+            std::size_t local_capacity(2);
+            while (local_capacity < in_capacity)
+            {
+                local_capacity <<= 1;
+            }
+            this->cells_ = this->allocator_.allocate(local_capacity);
+            for (std::size_t i(0); i < local_capacity; ++i)
+            {
+                new(&this->cells_[i].sequence) std::atomic<std::size_t>(i);
+            }
+            this->mask_ = local_capacity - 1;
+        }
+    }
+
+    /// @brief 待ち行列に残っている要素を破棄する。
+    public: ~bounded_queue()
+    {
+        if (this->cells_ != nullptr)
+        {
+            typename this_type::value_type local_value;
+            while (this->try_pop(local_value)) {}
+            this->allocator_.deallocate(this->cells_, this->mask_ + 1);
+        }
+    }
+
+    /// @brief メモリ割当子を取得する。
+    /// @return *thisが使っているメモリ割当子。
+    public: typename this_type::allocator_type get_allocator()
+    const PSYQ_NOEXCEPT
+    {
+        return this->allocator_;
+    }
+
+    /// @brief 待ち行列の容量を取得する。
+    /// @return 待ち行列の容量。0なら、領域を確保していない。
+    public: std::size_t get_capacity() const PSYQ_NOEXCEPT
+    {
+        return this->cells_ != nullptr? this->mask_ + 1: 0;
+    }
+
+    /// @brief 待ち行列の要素数を取得する。
+    /// @details 他のスレッドが同時に操作している場合、結果は目安でしかない。
+    /// @return 待ち行列の要素数。
+    public: std::size_t size() const PSYQ_NOEXCEPT
+    {
+        auto const local_pop(
+            this->pop_position_.load(std::memory_order_relaxed));
+        auto const local_push(
+            this->push_position_.load(std::memory_order_relaxed));
+        return local_pop < local_push? local_push - local_pop: 0;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 待ち行列の末尾に要素を追加する。
+    /// @details どのスレッドからでも、ロックなしで呼び出せる。
+    /// @retval true  成功。要素を追加した。
+    /// @retval false 失敗。待ち行列が満杯だった。 io_value は変化しない。
+    public: bool try_push(
+        /// [in,out] 追加する要素。
+        typename this_type::value_type&& io_value)
+    {
+        if (this->cells_ == nullptr)
+        {
+            return false;
+        }
+        auto local_position(
+            this->push_position_.load(std::memory_order_relaxed));
+        typename this_type::cell* local_cell;
+        for (;;)
+        {
+            local_cell = &this->cells_[local_position & this->mask_];
+            auto const local_sequence(
+                local_cell->sequence.load(std::memory_order_acquire));
+            auto const local_diff(
+                static_cast<std::ptrdiff_t>(local_sequence - local_position));
+            if (local_diff == 0)
+            {
+                if (this->push_position_.compare_exchange_weak(
+                        local_position,
+                        local_position + 1,
+                        std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (local_diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                local_position =
+                    this->push_position_.load(std::memory_order_relaxed);
+            }
+        }
+        new(&local_cell->storage)
+            typename this_type::value_type(std::move(io_value));
+        local_cell->sequence.store(
+            local_position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief 待ち行列の先頭から要素を取り出す。
+    /// @details どのスレッドからでも、ロックなしで呼び出せる。
+    /// @retval true  成功。要素を取り出した。
+    /// @retval false 失敗。待ち行列が空だった。
+    public: bool try_pop(
+        /// [out] 取り出した要素が代入される。
+        typename this_type::value_type& out_value)
+    {
+        if (this->cells_ == nullptr)
+        {
+            return false;
+        }
+        auto local_position(
+            this->pop_position_.load(std::memory_order_relaxed));
+        typename this_type::cell* local_cell;
+        for (;;)
+        {
+            local_cell = &this->cells_[local_position & this->mask_];
+            auto const local_sequence(
+                local_cell->sequence.load(std::memory_order_acquire));
+            auto const local_diff(
+                static_cast<std::ptrdiff_t>(
+                    local_sequence - (local_position + 1)));
+            if (local_diff == 0)
+            {
+                if (this->pop_position_.compare_exchange_weak(
+                        local_position,
+                        local_position + 1,
+                        std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (local_diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                local_position =
+                    this->pop_position_.load(std::memory_order_relaxed);
+            }
+        }
+        auto& local_value(
+            *reinterpret_cast<typename this_type::value_type*>(
+                &local_cell->storage));
+        out_value = std::move(local_value);
+        local_value.~value_type();
+        local_cell->sequence.store(
+            local_position + this->mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief 待ち行列の要素をすべて取り出す。
+    /// @details
+    ///   - 同一スレッドから追加された要素は、追加した順序で取り出される。
+    ///   - 他のスレッドが要素を追加し続けても終わるように、
+    ///     一度に取り出すのは this_type::get_capacity 個までとする。
+    /// @return 取り出した要素の数。
+    public: template<typename template_container>
+    std::size_t pop_all(
+        /// [in,out] 取り出した要素を末尾に追加するコンテナ。
+        template_container& io_container)
+    {
+        auto const local_capacity(this->get_capacity());
+        std::size_t local_count(0);
+        typename this_type::value_type local_value;
+        while (local_count < local_capacity && this->try_pop(local_value))
+        {
+            io_container.emplace_back(std::move(local_value));
+            ++local_count;
+        }
+        return local_count;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief コピー構築子は使用禁止。
+    private: bounded_queue(this_type const&);
+    /// @brief コピー代入演算子は使用禁止。
+    private: this_type& operator=(this_type const&);
+
+    //-------------------------------------------------------------------------
+    /// @brief 要素の領域のメモリ割当子。
+    private: typename this_type::cell_allocator allocator_;
+    /// @brief 要素の領域の配列。
+    private: typename this_type::cell* cells_;
+    /// @brief 要素の領域の番号を求めるマスク。
+    private: std::size_t mask_;
+    /// @brief 次に要素を追加する位置。
+    private: std::atomic<std::size_t> push_position_;
+    /// @brief 次に要素を取り出す位置。
+    private: std::atomic<std::size_t> pop_position_;
+
+}; // class psyq::event_driven::bounded_queue
+
+#endif // !defined(PSYQ_EVENT_DRIVEN_BOUNDED_QUEUE_HPP_)
+// vim: set expandtab:
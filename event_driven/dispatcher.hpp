@@ -3,10 +3,23 @@
 #ifndef PSYQ_EVENT_DRIVEN_DISPATCHER_HPP_
 #define PSYQ_EVENT_DRIVEN_DISPATCHER_HPP_
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include "../hash/primitive_bits.hpp"
+#include "./bounded_queue.hpp"
+#include "./latency_histogram.hpp"
+
 #ifndef PSYQ_EVENT_DRIVEN_DISPATCHER_RECEIVER_CAPACITY_DEFFAULT
 #define PSYQ_EVENT_DRIVEN_DISPATCHER_RECEIVER_CAPACITY_DEFFAULT 32
 #endif // !defined(PSYQ_EVENT_DRIVEN_DISPATCHER_RECEIVER_CAPACITY_DEFFAULT)
 
+#ifndef PSYQ_EVENT_DRIVEN_DISPATCHER_BATCH_CAPACITY_DEFFAULT
+#define PSYQ_EVENT_DRIVEN_DISPATCHER_BATCH_CAPACITY_DEFFAULT 4
+#endif // !defined(PSYQ_EVENT_DRIVEN_DISPATCHER_BATCH_CAPACITY_DEFFAULT)
+
 #ifndef PSYQ_EVENT_DRIVEN_DISPATCHER_FORWARDER_CAPACITY_DEFFAULT
 #define PSYQ_EVENT_DRIVEN_DISPATCHER_FORWARDER_CAPACITY_DEFFAULT 0
 #endif // !defined(PSYQ_EVENT_DRIVEN_DISPATCHER_FORWARDER_CAPACITY_DEFFAULT)
@@ -36,6 +49,8 @@ namespace psyq
 ///   - zone::equip_dispatcher
 ///     で、スレッドごとにメッセージ配送器のインスタンスを用意する。
 ///   - dispatcher::register_receiver で、メッセージ受信関数を登録する。
+///   - 別のメッセージゾーンやプロセスへメッセージを中継するなら、
+///     dispatcher::register_forwarder で、メッセージ転送関数を登録する。
 ///   - 以下のいずれかの関数で、メッセージを送信する。
 ///     - zone::post_external
 ///     - zone::post_zonal
@@ -84,6 +99,22 @@ class psyq::event_driven::dispatcher
         function_weak_ptr;
     /// @brief メッセージ受信関数の優先順位。
     public: typedef template_priority function_priority;
+    /// @brief メッセージパケットをまとめて受け取るメッセージ受信関数。
+    /// @details
+    ///   this_type::dispatch_grouped から、送り状が同じメッセージパケットの
+    ///   並びの先頭位置と要素数を引数に呼び出される。
+    public: typedef
+        std::function<
+            void(typename this_type::packet const* const*, std::size_t)>
+        batch_function;
+    /// @brief this_type::batch_function を強参照するスマートポインタ。
+    public: typedef
+        std::shared_ptr<typename this_type::batch_function>
+        batch_function_shared_ptr;
+    /// @brief this_type::batch_function を弱参照するスマートポインタ。
+    public: typedef
+        std::weak_ptr<typename this_type::batch_function>
+        batch_function_weak_ptr;
 
     //-------------------------------------------------------------------------
     /// this_type::function_shared_ptr のコンテナ。
@@ -98,6 +129,51 @@ class psyq::event_driven::dispatcher
             typename this_type::packet::shared_ptr,
             typename this_type::allocator_type>
         packet_shared_ptr_container;
+    /// this_type::batch_function_shared_ptr のコンテナ。
+    private: typedef
+        std::vector<
+            typename this_type::batch_function_shared_ptr,
+            typename this_type::allocator_type>
+        batch_function_shared_ptr_container;
+    /// 送り状ごとにまとめたメッセージパケットのコンテナ。
+    private: typedef
+        std::vector<
+            typename this_type::packet const*,
+            typename this_type::allocator_type>
+        packet_pointer_container;
+    /// @brief zone から配送される、変更不可のメッセージパケットの束。
+    /// @details
+    ///   zone::dispatch で全ての this_type に同じ束を配り、
+    ///   this_type は束を走査してメッセージパケットを配送する。
+    ///   メッセージパケットごとの参照カウンタ操作は発生しない。
+    private: typedef
+        std::shared_ptr<typename this_type::packet_shared_ptr_container const>
+        packet_batch_shared_ptr;
+    /// this_type::packet_batch_shared_ptr のコンテナ。
+    private: typedef
+        std::vector<
+            typename this_type::packet_batch_shared_ptr,
+            typename this_type::allocator_type>
+        packet_batch_container;
+
+    //-------------------------------------------------------------------------
+    /// @brief this_type::take_snapshot で取得する、メッセージの流れの統計。
+    public: struct snapshot
+    {
+        /// @brief メッセージ受信関数へ配送したメッセージパケットの数。
+        std::size_t received_count;
+        /// @brief 受信していて、まだ配送していないメッセージパケットの束の数。
+        std::size_t queue_depth;
+        /// @brief queue_depth の最大値。
+        std::size_t batch_high_water;
+        /// @brief 上限数を超えたので捨てたメッセージパケットの束の数。
+        std::size_t dropped_batch_count;
+        /// @brief 上限数を超えたので捨てたメッセージパケットの数。
+        std::size_t dropped_packet_count;
+        /// @brief zone::dispatch から this_type::dispatch
+        /// で配送するまでの待ち時間の度数分布。
+        psyq::event_driven::latency_histogram::snapshot dispatch_to_receive;
+    };
 
     //-------------------------------------------------------------------------
     /// @brief メッセージ転送フック。
@@ -171,6 +247,13 @@ class psyq::event_driven::dispatcher
         }
 #endif // !defined(PSYQ_NO_STD_DEFAULTED_FUNCTION)
 
+        /// @brief hook_index で使う、フックの索引キーを取得する。
+        public: static typename dispatcher::packet::message::tag::key_type
+        get_index_key(this_type const& in_hook) PSYQ_NOEXCEPT
+        {
+            return in_hook.receiver_key_;
+        }
+
         public: typename dispatcher::function_weak_ptr function_;
         public: typename dispatcher::packet::message::tag::key_type receiver_key_;
         public: typename dispatcher::function_priority priority_;
@@ -248,10 +331,341 @@ class psyq::event_driven::dispatcher
         }
 #endif // !defined(PSYQ_NO_STD_DEFAULTED_FUNCTION)
 
+        /// @brief hook_index で使う、フックの索引キーを取得する。
+        public: static typename dispatcher::packet::message::tag::key_type
+        get_index_key(this_type const& in_hook) PSYQ_NOEXCEPT
+        {
+            return in_hook.selector_key_;
+        }
+
         public: typename dispatcher::packet::message::tag::key_type selector_key_;
 
     }; // class receiving_hook
 
+    //-------------------------------------------------------------------------
+    /// @brief メッセージパケットをまとめて受け取るメッセージ受信フック。
+    private: class batch_hook
+    {
+        private: typedef batch_hook this_type;
+
+        public: typedef
+            std::vector<this_type, typename dispatcher::allocator_type>
+            container;
+
+        public: struct less
+        {
+            bool operator()(
+                this_type const& in_left,
+                this_type const& in_right)
+            const PSYQ_NOEXCEPT
+            {
+                return in_left.selector_key_ != in_right.selector_key_?
+                    in_left.selector_key_ < in_right.selector_key_:
+                    in_left.priority_ < in_right.priority_;
+            }
+
+        }; // struct less
+
+        public: batch_hook(
+            typename dispatcher::packet::message::tag::key_type const in_receiver_key,
+            typename dispatcher::packet::message::tag::key_type const in_selector_key,
+            typename dispatcher::batch_function_weak_ptr&& io_function,
+            typename dispatcher::function_priority const in_priority):
+        function_(std::move(io_function)),
+        receiver_key_(in_receiver_key),
+        selector_key_(in_selector_key),
+        priority_(in_priority)
+        {}
+
+#ifdef PSYQ_NO_STD_DEFAULTED_FUNCTION
+        /// @brief ムーブ構築子。
+        public: batch_hook(
+            /// [in,out] ムーブ元となるインスタンス。
+            this_type&& io_source):
+        function_(std::move(io_source.function_)),
+        receiver_key_(std::move(io_source.receiver_key_)),
+        selector_key_(std::move(io_source.selector_key_)),
+        priority_(std::move(io_source.priority_))
+        {}
+
+        /// @brief ムーブ代入演算子。
+        /// @return *this
+        public: this_type& operator=(
+            /// [in,out] ムーブ元となるインスタンス。
+            this_type&& io_source)
+        {
+            this->function_ = std::move(io_source.function_);
+            this->receiver_key_ = std::move(io_source.receiver_key_);
+            this->selector_key_ = std::move(io_source.selector_key_);
+            this->priority_ = std::move(io_source.priority_);
+            return *this;
+        }
+#endif // !defined(PSYQ_NO_STD_DEFAULTED_FUNCTION)
+
+        /// @brief hook_index で使う、フックの索引キーを取得する。
+        public: static typename dispatcher::packet::message::tag::key_type
+        get_index_key(this_type const& in_hook) PSYQ_NOEXCEPT
+        {
+            return in_hook.selector_key_;
+        }
+
+        public: typename dispatcher::batch_function_weak_ptr function_;
+        public: typename dispatcher::packet::message::tag::key_type receiver_key_;
+        public: typename dispatcher::packet::message::tag::key_type selector_key_;
+        public: typename dispatcher::function_priority priority_;
+
+    }; // class batch_hook
+
+    //-------------------------------------------------------------------------
+    /// @brief 索引キーから、メッセージ関数フックの範囲を引く索引。
+    /// @details
+    ///   - フックのコンテナは template_hook::get_index_key の順に並ぶので、
+    ///     索引キーが同じフックは連続した範囲になる。
+    ///     索引キーは receiving_hook と batch_hook ならメッセージ受信関数の識別値、
+    ///     forwarding_hook ならメッセージ受信オブジェクトの識別値。
+    ///   - フックのコンテナの並びが変わると、次の検索で索引を再構築する。
+    ///   - 索引キーにマスクをかけて検索する場合は、マスクごとに
+    ///     マスクした索引キーの順にフックの添字を並べた索引を、
+    ///     そのマスクで初めて検索したときに構築する。
+    ///   - 取り除かれたフックは墓標としてその場に残し、
+    ///     墓標を訪れた回数がフックの数を超えたら、まとめて削除する。
+    /// @tparam template_hook receiving_hook か forwarding_hook か batch_hook 。
+    private: template<typename template_hook> class hook_index
+    {
+        private: typedef hook_index this_type;
+
+        /// @brief template_hook::container の添字の範囲。
+        public: typedef std::pair<std::size_t, std::size_t> range;
+
+        private: typedef
+            std::unordered_map<
+                typename dispatcher::packet::message::tag::key_type,
+                range,
+                psyq::hash::primitive_bits<
+                    typename dispatcher::packet::message::tag::key_type>,
+                std::equal_to<
+                    typename dispatcher::packet::message::tag::key_type>,
+                typename dispatcher::allocator_type>
+            range_map;
+        /// @brief template_hook::container の添字のコンテナ。
+        private: typedef
+            std::vector<std::size_t, typename dispatcher::allocator_type>
+            position_container;
+        /// @brief マスクした索引キーの順に並べた、フックの添字の索引。
+        private: struct masked_index
+        {
+            explicit masked_index(
+                typename dispatcher::allocator_type const& in_allocator):
+            ranges(
+                0,
+                typename range_map::hasher(),
+                typename range_map::key_equal(),
+                in_allocator),
+            positions(in_allocator)
+            {}
+
+            /// @brief マスクした索引キーから、 positions の範囲を引く辞書。
+            range_map ranges;
+            /// @brief マスクした索引キーの順に並べた、フックの添字。
+            position_container positions;
+        };
+        /// @brief マスクから masked_index を引く辞書。
+        private: typedef
+            std::unordered_map<
+                typename dispatcher::packet::message::tag::key_type,
+                masked_index,
+                psyq::hash::primitive_bits<
+                    typename dispatcher::packet::message::tag::key_type>,
+                std::equal_to<
+                    typename dispatcher::packet::message::tag::key_type>,
+                typename dispatcher::allocator_type>
+            masked_index_map;
+
+        public: hook_index(
+            std::size_t const in_capacity,
+            typename dispatcher::allocator_type const& in_allocator):
+        ranges_(
+            in_capacity,
+            typename range_map::hasher(),
+            typename range_map::key_equal(),
+            in_allocator),
+        masked_indices_(
+            0,
+            typename masked_index_map::hasher(),
+            typename masked_index_map::key_equal(),
+            in_allocator),
+        tombstone_count_(0),
+        dirty_(false)
+        {}
+
+        /// @brief template_hook::container の並びが変わったことを通知する。
+        public: void invalidate() PSYQ_NOEXCEPT
+        {
+            this->dirty_ = true;
+        }
+
+        /// @brief 墓標を訪れた回数を加算する。
+        public: void add_tombstones(std::size_t const in_count) PSYQ_NOEXCEPT
+        {
+            this->tombstone_count_ += in_count;
+        }
+
+        /// @brief 索引キーに合致する範囲を検索する。
+        /// @return 索引キーが合致するフックの添字の範囲。
+        public: range find(
+            /// [in] 索引の対象となるフックの辞書。
+            typename template_hook::container const& in_hooks,
+            /// [in] 検索する索引キー。
+            typename dispatcher::packet::message::tag::key_type const in_key)
+        {
+            if (this->dirty_)
+            {
+                this->rebuild(in_hooks);
+            }
+            auto const local_find(this->ranges_.find(in_key));
+            return local_find != this->ranges_.end()?
+                local_find->second: range(0, 0);
+        }
+
+        /// @brief マスクした索引キーに合致するフックを検索する。
+        /// @return
+        ///   マスクした索引キーが in_key と合致するフックの添字を、
+        ///   昇順に並べた範囲の先頭と末尾。
+        public: std::pair<std::size_t const*, std::size_t const*> find_masked(
+            /// [in] 索引の対象となるフックの辞書。
+            typename template_hook::container const& in_hooks,
+            /// [in] 検索する索引キー。
+            typename dispatcher::packet::message::tag::key_type const in_key,
+            /// [in] 索引キーにかけるマスク。
+            typename dispatcher::packet::message::tag::key_type const in_mask)
+        {
+            if (this->dirty_)
+            {
+                this->rebuild(in_hooks);
+            }
+            auto local_masked_index(this->masked_indices_.find(in_mask));
+            if (local_masked_index == this->masked_indices_.end())
+            {
+                local_masked_index = this->masked_indices_.emplace(
+                    in_mask,
+                    masked_index(this->ranges_.get_allocator())).first;
+                this_type::build_masked_index(
+                    local_masked_index->second, in_hooks, in_mask);
+            }
+            auto const& local_index(local_masked_index->second);
+            auto const local_find(local_index.ranges.find(in_key));
+            if (local_find == local_index.ranges.end())
+            {
+                return std::pair<std::size_t const*, std::size_t const*>(
+                    nullptr, nullptr);
+            }
+            auto const local_positions(local_index.positions.data());
+            return std::pair<std::size_t const*, std::size_t const*>(
+                local_positions + local_find->second.first,
+                local_positions + local_find->second.second);
+        }
+
+        /// @brief 墓標が増えていたら、まとめて削除する。
+        public: void compact(
+            /// [in,out] 墓標を削除するフックの辞書。
+            typename template_hook::container& io_hooks,
+            /// [in] 墓標の数によらず削除するか。
+            bool const in_force)
+        {
+            if (in_force || io_hooks.size() < this->tombstone_count_)
+            {
+                dispatcher::remove_empty_hook(io_hooks);
+                this->tombstone_count_ = 0;
+                this->dirty_ = true;
+            }
+        }
+
+        private: void rebuild(
+            typename template_hook::container const& in_hooks)
+        {
+            this->ranges_.clear();
+            this->masked_indices_.clear();
+            std::size_t local_begin(0);
+            for (std::size_t i(1); i <= in_hooks.size(); ++i)
+            {
+                auto const local_key(
+                    template_hook::get_index_key(in_hooks[local_begin]));
+                if (i == in_hooks.size()
+                    || template_hook::get_index_key(in_hooks[i]) != local_key)
+                {
+                    this->ranges_.emplace(local_key, range(local_begin, i));
+                    local_begin = i;
+                }
+            }
+            this->dirty_ = false;
+        }
+
+        private: static void build_masked_index(
+            masked_index& io_index,
+            typename template_hook::container const& in_hooks,
+            typename dispatcher::packet::message::tag::key_type const in_mask)
+        {
+            // フックの添字を、マスクした索引キーの順に並べる。
+            auto& local_positions(io_index.positions);
+            local_positions.reserve(in_hooks.size());
+            for (std::size_t i(0); i < in_hooks.size(); ++i)
+            {
+                local_positions.push_back(i);
+            }
+            std::stable_sort(
+                local_positions.begin(),
+                local_positions.end(),
+                [&in_hooks, in_mask](
+                    std::size_t const in_left,
+                    std::size_t const in_right)
+                ->bool
+                {
+                    return (template_hook::get_index_key(in_hooks[in_left]) & in_mask)
+                        < (template_hook::get_index_key(in_hooks[in_right]) & in_mask);
+                });
+
+            // マスクした索引キーが同じ範囲を登録する。
+            std::size_t local_begin(0);
+            for (std::size_t i(1); i <= local_positions.size(); ++i)
+            {
+                auto const local_key(
+                    template_hook::get_index_key(
+                        in_hooks[local_positions[local_begin]])
+                    & in_mask);
+                if (i == local_positions.size()
+                    || (template_hook::get_index_key(
+                            in_hooks[local_positions[i]])
+                        & in_mask) != local_key)
+                {
+                    io_index.ranges.emplace(local_key, range(local_begin, i));
+                    local_begin = i;
+                }
+            }
+        }
+
+        private: range_map ranges_;
+        private: masked_index_map masked_indices_;
+        private: std::size_t tombstone_count_;
+        private: bool dirty_;
+
+    }; // class hook_index
+
+    /// @brief メッセージ受信フックの索引。
+    private: typedef
+        typename this_type::template hook_index<
+            typename this_type::receiving_hook>
+        receiving_index;
+    /// @brief メッセージ転送フックの索引。
+    private: typedef
+        typename this_type::template hook_index<
+            typename this_type::forwarding_hook>
+        forwarding_index;
+    /// @brief まとめて受け取るメッセージ受信フックの索引。
+    private: typedef
+        typename this_type::template hook_index<
+            typename this_type::batch_hook>
+        batch_index;
+
     //-------------------------------------------------------------------------
     /// @brief *this が使うメモリ割当子を取得する。
     /// @return *this が使うメモリ割当子。
@@ -268,6 +682,164 @@ class psyq::event_driven::dispatcher
         return this->thread_id_;
     }
 
+    //-------------------------------------------------------------------------
+    /// @name メッセージの流れの統計
+    /// @{
+
+    /// @brief メッセージの流れの統計を取得する。
+    /// @details
+    ///   どのスレッドからでも呼び出せる。
+    ///   待ち時間は、 zone::enable_timestamp
+    ///   で時刻印を有効にしている間だけ記録される。
+    /// @return メッセージの流れの統計。
+    public: typename this_type::snapshot take_snapshot()
+    {
+        typename this_type::snapshot local_snapshot;
+        {
+            std::lock_guard<psyq::spinlock> const local_lock(this->lock_);
+            local_snapshot.queue_depth = this->receiving_batches_.size();
+        }
+        local_snapshot.received_count =
+            this->received_count_.load(std::memory_order_relaxed);
+        local_snapshot.batch_high_water = this->get_batch_high_water();
+        local_snapshot.dropped_batch_count = this->get_dropped_batch_count();
+        local_snapshot.dropped_packet_count = this->get_dropped_packet_count();
+        local_snapshot.dispatch_to_receive =
+            this->dispatch_to_receive_.take_snapshot();
+        return local_snapshot;
+    }
+
+    /// @brief 溜まったメッセージパケットの束の数の最大値を取得する。
+    /// @return 溜まったメッセージパケットの束の数の最大値。
+    public: std::size_t get_batch_high_water() const PSYQ_NOEXCEPT
+    {
+        return this->batch_high_water_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief 上限数を超えたので捨てたメッセージパケットの束の数を取得する。
+    /// @details
+    ///   束の上限数を超えた場合、 overflow_policy_DROP_NEWEST と
+    ///   overflow_policy_FAIL では受信しようとした束を捨てる。
+    ///   overflow_policy_BLOCK と overflow_policy_DROP_OLDEST では、
+    ///   zone::dispatch を待たせないように、最も古い束を捨てる。
+    /// @return 捨てたメッセージパケットの束の数。
+    public: std::size_t get_dropped_batch_count() const PSYQ_NOEXCEPT
+    {
+        return this->dropped_batch_count_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief 上限数を超えたので捨てたメッセージパケットの数を取得する。
+    /// @return 捨てた束に含まれていたメッセージパケットの数。
+    public: std::size_t get_dropped_packet_count() const PSYQ_NOEXCEPT
+    {
+        return this->dropped_packet_count_.load(std::memory_order_relaxed);
+    }
+    /// @}
+    //-------------------------------------------------------------------------
+    /// @name 実行レーン
+    /// @{
+
+    /// @brief *this が実行レーンか判定する。
+    /// @details
+    ///   実行レーンは、スレッドではなく論理的な実行単位に合致する。
+    ///   this_type::lock で実行レーンを占有したスレッドだけが、
+    ///   *this を処理できる。
+    /// @retval true  *this は実行レーン。
+    /// @retval false *this はスレッドに合致する。
+    /// @sa zone::equip_lane で実行レーンを取得できる。
+    public: bool is_lane() const PSYQ_NOEXCEPT
+    {
+        return this->thread_id_ == std::thread::id();
+    }
+
+    /// @brief *this に合致する実行レーンの識別値を取得する。
+    /// @return *this に合致する実行レーンの識別値。
+    public: std::size_t get_lane_key() const PSYQ_NOEXCEPT
+    {
+        return this->lane_key_;
+    }
+
+    /// @brief 現在のスレッドで実行レーンを占有する。
+    /// @details
+    ///   実行レーンを占有できるまでブロックする。
+    ///   std::lock_guard などと組み合わせて使える。
+    /// @warning *this が実行レーンでない場合は、何もしない。
+    public: void lock()
+    {
+        while (!this->try_lock())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    /// @brief 現在のスレッドで実行レーンの占有を試みる。
+    /// @retval true  実行レーンを占有した。
+    /// @retval false 他のスレッドが実行レーンを占有していた。
+    /// @warning *this が実行レーンでない場合は、常に true を返す。
+    public: bool try_lock()
+    {
+        if (!this->is_lane())
+        {
+            return true;
+        }
+        std::thread::id local_free;
+        return this->lane_owner_.compare_exchange_strong(
+            local_free,
+            std::this_thread::get_id(),
+            std::memory_order_acquire,
+            std::memory_order_relaxed);
+    }
+
+    /// @brief 現在のスレッドでの実行レーンの占有を解除する。
+    /// @details
+    ///   this_type::defer_lane で実行を保留していた処理があれば、
+    ///   占有を解除した後に登録しなおす。
+    /// @warning *this が実行レーンでない場合は、何もしない。
+    public: void unlock()
+    {
+        if (this->is_lane())
+        {
+            PSYQ_ASSERT(
+                this->lane_owner_.load(std::memory_order_relaxed)
+                == std::this_thread::get_id());
+            this->lane_owner_.store(
+                std::thread::id(), std::memory_order_seq_cst);
+            this->resume_lane();
+        }
+    }
+
+    /// @brief 実行レーンの処理を、占有が解除されるまで保留する。
+    /// @details
+    ///   - 他のスレッドが実行レーンを占有していて実行できなかった処理を、
+    ///     占有を解除したスレッドが this_type::unlock で登録しなおす。
+    ///   - すでに占有が解除されていたら、この関数の中で登録しなおす。
+    ///   - 実行予約が設定されている間に、一つのスレッドからのみ呼び出すこと。
+    /// @warning psyq::event_driven の管理者以外は、この関数は使用禁止。
+    public: void defer_lane(
+        /// [in] 占有が解除されたときに呼び出す、処理を登録しなおす関数。
+        std::function<void()> in_resume)
+    {
+        this->lane_resume_ = std::move(in_resume);
+        this->lane_deferred_.store(true, std::memory_order_seq_cst);
+        if (this->lane_owner_.load(std::memory_order_seq_cst)
+            == std::thread::id())
+        {
+            this->resume_lane();
+        }
+    }
+
+    /// @brief 実行レーンの実行予約を設定する。
+    /// @warning psyq::event_driven の管理者以外は、この関数は使用禁止。
+    /// @return 設定する前の実行予約。
+    public: bool exchange_lane_scheduled(
+        /// [in] 設定する実行予約。
+        bool const in_scheduled)
+    {
+        return this->lane_scheduled_.exchange(
+            in_scheduled, std::memory_order_acq_rel);
+    }
+    /// @}
+
     //-------------------------------------------------------------------------
     /// @name メッセージの受信
     /// @{
@@ -284,7 +856,7 @@ class psyq::event_driven::dispatcher
     ///   失敗。メッセージパケットを配送しなかった。 this_type::get_thread_id
     ///   と合致しないスレッドからこの関数を呼び出すと、失敗する。
     public: bool dispatch(
-        /// [in] メッセージパケットの予約数。
+        /// [in] メッセージパケットの束の予約数。
         std::size_t const in_capacity = 0,
         /// [in] コンテナを再構築するか。
         bool const in_rebuild = false)
@@ -294,37 +866,183 @@ class psyq::event_driven::dispatcher
             return false;
         }
 
-        // 配送するメッセージパケットを取得する。
-        PSYQ_ASSERT(this->delivery_packets_.empty());
+        // メッセージパケットの束を順に走査し、
+        // メッセージ受信関数へメッセージパケットを配送する。
+        this->take_batches(in_capacity, in_rebuild);
+        this->record_batches();
+        for (auto const& local_batch: this->delivery_batches_)
         {
-            std::lock_guard<psyq::spinlock> const local_lock(this->lock_);
-            this->delivery_packets_.swap(this->receiving_packets_);
-            this_type::clear_packets(
-                this->receiving_packets_, in_capacity, in_rebuild);
+            this_type::deliver_packets(
+                this->function_caches_,
+                this->receiving_index_,
+                this->receiving_hooks_,
+                this->forwarding_index_,
+                this->forwarding_hooks_,
+                *local_batch);
         }
 
-        // メッセージ受信関数へメッセージパケットを配送する。
-        this_type::remove_empty_hook(this->receiving_hooks_);
-        this_type::remove_empty_hook(this->forwarding_hooks_);
-        this_type::deliver_packets(
-            this->function_caches_,
-            this->receiving_hooks_,
-            this->forwarding_hooks_,
-            this->delivery_packets_);
+        this->release_batches(in_capacity, in_rebuild);
+        return true;
+    }
 
-        // コンテナを整理する。
-        this_type::clear_packets(
-            this->delivery_packets_, in_capacity, in_rebuild);
+    /// @brief 送り状ごとにまとめて、メッセージ受信関数へメッセージパケットを配送する。
+    /// @details
+    ///   - this_type::dispatch の代わりに呼び出す。
+    ///   - 受信したメッセージパケットを、メッセージ受信関数の識別値と
+    ///     メッセージ受信オブジェクトの識別値とマスクで安定ソートし、
+    ///     送り状が同じメッセージパケットの並びごとに、
+    ///     メッセージ受信関数の検索を一度だけ行う。
+    ///   - this_type::register_receiver で登録した関数は、
+    ///     並びのメッセージパケットごとに呼び出される。
+    ///   - this_type::register_batch_receiver で登録した関数は、
+    ///     並びごとに一度だけ呼び出される。
+    ///   - 送り状が異なるメッセージパケットの間では、受信順序が保たれない。
+    ///     送り状が同じメッセージパケットの受信順序は保たれる。
+    /// .
+    /// @retval true 成功。メッセージパケットを配送した。
+    /// @retval false
+    ///   失敗。メッセージパケットを配送しなかった。 this_type::get_thread_id
+    ///   と合致しないスレッドからこの関数を呼び出すと、失敗する。
+    public: bool dispatch_grouped(
+        /// [in] メッセージパケットの束の予約数。
+        std::size_t const in_capacity = 0,
+        /// [in] コンテナを再構築するか。
+        bool const in_rebuild = false)
+    {
+        if (!this->verify_thread())
+        {
+            return false;
+        }
+
+        // メッセージパケットを送り状でまとめる。
+        this->take_batches(in_capacity, in_rebuild);
+        this->record_batches();
+        auto& local_packets(this->grouped_packets_);
+        PSYQ_ASSERT(local_packets.empty());
+        for (auto const& local_batch: this->delivery_batches_)
+        {
+            for (auto const& local_packet: *local_batch)
+            {
+                local_packets.push_back(local_packet.get());
+            }
+        }
+        std::stable_sort(
+            std::begin(local_packets),
+            std::end(local_packets),
+            [](
+                typename this_type::packet const* const in_left,
+                typename this_type::packet const* const in_right)
+            ->bool
+            {
+                return this_type::less_tag(
+                    in_left->get_message().get_tag(),
+                    in_right->get_message().get_tag());
+            });
+
+        // 送り状が同じ並びごとに、メッセージ受信関数を検索して配送する。
+        for (std::size_t i(0); i < local_packets.size();)
+        {
+            auto const& local_tag(local_packets[i]->get_message().get_tag());
+            auto local_last(i + 1);
+            while (
+                local_last < local_packets.size()
+                && !this_type::less_tag(
+                    local_tag, local_packets[local_last]->get_message().get_tag()))
+            {
+                ++local_last;
+            }
+            this->deliver_group(&local_packets[i], local_last - i);
+            i = local_last;
+        }
+        local_packets.clear();
+        this->release_batches(in_capacity, in_rebuild);
         if (in_rebuild)
         {
-            this->receiving_hooks_.shrink_to_fit();
-            this->forwarding_hooks_.shrink_to_fit();
-            this->function_caches_.shrink_to_fit();
-            this->function_caches_.reserve(this->receiving_hooks_.capacity());
+            local_packets.shrink_to_fit();
         }
         return true;
     }
 
+    /// @brief メッセージパケットをまとめて受け取るメッセージ受信関数を登録する。
+    /// @details
+    ///   - 登録に成功した後は、 this_type::dispatch_grouped で
+    ///     in_receiver_key / in_selector_key の組み合わせと合致する
+    ///     メッセージの並びを受信するたび、 in_function が呼び出される。
+    ///     this_type::dispatch では呼び出されない。
+    ///   - 登録した in_function は弱参照しているだけで、
+    ///     this_type は所有権を持たない。
+    ///     in_function の所有権は、ユーザーが管理すること。
+    /// .
+    /// @retval true 成功。 in_function を登録した。
+    /// @retval false
+    ///     失敗。 in_function を登録しなかった。
+    ///     - this_type::get_thread_id
+    ///       と合致しないスレッドから呼び出すと、失敗する。
+    ///     - in_receiver_key / in_selector_key の組み合わせが同じ
+    ///       メッセージ受信関数がすでに追加されていると、失敗する。
+    ///     - in_function が空だと、失敗する。
+    public: bool register_batch_receiver(
+        /// [in] 登録するメッセージ受信関数に対応する、
+        /// メッセージ受信オブジェクトの識別値。
+        typename this_type::packet::message::tag::key_type const in_receiver_key,
+        /// [in] 登録するメッセージ受信関数の識別値。
+        typename this_type::packet::message::tag::key_type const in_selector_key,
+        /// [in] 登録するメッセージ受信関数。
+        typename this_type::batch_function_shared_ptr const& in_function,
+        /// [in] メッセージを受信する優先順位。
+        typename this_type::function_priority const in_priority
+            = PSYQ_EVENT_DRIVEN_RECEIVER_PRIORITY_DEFAULT)
+    {
+        if (in_function.get() == nullptr
+            || !static_cast<bool>(*in_function)
+            || !this->verify_thread()
+            || this->find_batch_hook(in_receiver_key, in_selector_key)
+                != std::end(this->batch_hooks_))
+        {
+            return false;
+        }
+        typename this_type::batch_hook local_hook(
+            in_receiver_key,
+            in_selector_key,
+            typename this_type::batch_function_weak_ptr(in_function),
+            in_priority);
+        auto const local_position(
+            std::upper_bound(
+                std::begin(this->batch_hooks_),
+                std::end(this->batch_hooks_),
+                local_hook,
+                typename this_type::batch_hook::less()));
+        this->batch_hooks_.insert(local_position, std::move(local_hook));
+        this->batch_index_.invalidate();
+        return true;
+    }
+
+    /// @brief メッセージパケットをまとめて受け取るメッセージ受信関数を取り除く。
+    /// @return
+    ///   取り除いたメッセージ受信関数を指すスマートポインタ。
+    ///   該当するメッセージ受信関数がない場合は、空となる。
+    public: typename this_type::batch_function_weak_ptr unregister_batch_receiver(
+        /// [in] 除去するメッセージ受信関数に対応する
+        /// メッセージ受信オブジェクトの識別値。
+        typename this_type::packet::message::tag::key_type const in_receiver_key,
+        /// [in] 除去するメッセージ受信関数の識別値。
+        typename this_type::packet::message::tag::key_type const in_selector_key)
+    {
+        if (this->verify_thread())
+        {
+            auto const local_find(
+                this->find_batch_hook(in_receiver_key, in_selector_key));
+            if (local_find != std::end(this->batch_hooks_))
+            {
+                auto const local_function(std::move(local_find->function_));
+                local_find->function_.reset();
+                this->batch_index_.add_tombstones(1);
+                return local_function;
+            }
+        }
+        return typename this_type::batch_function_weak_ptr();
+    }
+
     /// @brief メッセージ受信関数を登録する。
     /// @details
     ///   - 登録に成功した後は、 in_receiver_key / in_selector_key
@@ -395,6 +1113,7 @@ class psyq::event_driven::dispatcher
             in_selector_key,
             typename this_type::function_weak_ptr(in_function),
             in_priority);
+        this->receiving_index_.invalidate();
         return true;
     }
 
@@ -422,6 +1141,7 @@ class psyq::event_driven::dispatcher
             {
                 auto const local_function(std::move(local_find->function_));
                 local_find->function_.reset();
+                this->receiving_index_.add_tombstones(1);
                 return local_function;
             }
         }
@@ -447,6 +1167,7 @@ class psyq::event_driven::dispatcher
                     local_hook.function_.reset();
                 }
             }
+            this->receiving_index_.add_tombstones(local_count);
         }
         return local_count;
     }
@@ -485,8 +1206,25 @@ class psyq::event_driven::dispatcher
     /// @{
 
     /// @brief メッセージ転送関数を登録する。
-    /// @todo 未実装
-    private: bool register_forwarder(
+    /// @details
+    ///   - 登録に成功した後は、 in_receiver_key
+    ///     に合致するメッセージを受信するたび、メッセージ受信関数の後に
+    ///     in_function が呼び出される。メッセージ受信関数の識別値は問わない。
+    ///   - in_function から、別のメッセージゾーンやプロセスへ
+    ///     メッセージパケットを転送すること。
+    ///   - 登録した in_function は弱参照しているだけで、
+    ///     this_type は所有権を持たない。
+    ///     in_function の所有権は、ユーザーが管理すること。
+    /// .
+    /// @retval true 成功。 in_function を登録した。
+    /// @retval false
+    ///     失敗。 in_function を登録しなかった。
+    ///     - this_type::get_thread_id
+    ///       と合致しないスレッドから呼び出すと、失敗する。
+    ///     - in_receiver_key が同じメッセージ転送関数が
+    ///       すでに追加されていると、失敗する。
+    ///     - in_function が空だと、失敗する。
+    public: bool register_forwarder(
         /// [in] 登録するメッセージ転送関数に対応する、
         /// メッセージ受信オブジェクトの識別値。
         typename this_type::packet::message::tag::key_type const in_receiver_key,
@@ -494,47 +1232,141 @@ class psyq::event_driven::dispatcher
         typename this_type::function_shared_ptr const& in_function,
         /// [in] メッセージを転送する優先順位。
         typename this_type::function_priority const in_priority
-            = PSYQ_EVENT_DRIVEN_FORWARDER_PRIORITY_DEFAULT);
+            = PSYQ_EVENT_DRIVEN_FORWARDER_PRIORITY_DEFAULT)
+    {
+        if (in_function.get() == nullptr
+            || !static_cast<bool>(*in_function)
+            || !this->verify_thread())
+        {
+            return false;
+        }
+        auto const local_end(std::end(this->forwarding_hooks_));
+        if (this_type::find_forwarding_hook_iterator(
+                std::begin(this->forwarding_hooks_), local_end, in_receiver_key)
+            != local_end)
+        {
+            // 等価なメッセージ転送フックが存在しているので失敗。
+            return false;
+        }
+        this->forwarding_hooks_.emplace(
+            std::upper_bound(
+                std::begin(this->forwarding_hooks_),
+                local_end,
+                typename this_type::forwarding_hook(
+                    in_receiver_key,
+                    typename this_type::function_weak_ptr(),
+                    in_priority),
+                typename this_type::forwarding_hook::less()),
+            in_receiver_key,
+            typename this_type::function_weak_ptr(in_function),
+            in_priority);
+        this->forwarding_index_.invalidate();
+        return true;
+    }
 
     /// @brief メッセージ転送関数を取り除く。
-    /// @todo 未実装
-    private: typename this_type::function_weak_ptr unregister_forwarder(
+    /// @return
+    ///   取り除いたメッセージ転送関数を指すスマートポインタ。
+    ///   該当するメッセージ転送関数がない場合は、空となる。
+    public: typename this_type::function_weak_ptr unregister_forwarder(
         /// [in] 取り除くメッセージ転送関数に対応する、
         /// メッセージ受信オブジェクトの識別値。
-        typename this_type::packet::message::tag::key_type const in_receiver_key);
+        typename this_type::packet::message::tag::key_type const in_receiver_key)
+    {
+        if (this->verify_thread())
+        {
+            auto const local_end(std::end(this->forwarding_hooks_));
+            auto const local_find(
+                this_type::find_forwarding_hook_iterator(
+                    std::begin(this->forwarding_hooks_),
+                    local_end,
+                    in_receiver_key));
+            if (local_find != local_end)
+            {
+                auto const local_function(std::move(local_find->function_));
+                local_find->function_.reset();
+                this->forwarding_index_.add_tombstones(1);
+                return local_function;
+            }
+        }
+        return typename this_type::function_weak_ptr();
+    }
 
     /// @brief メッセージ転送関数を検索する。
-    /// @todo 未実装
-    private: typename this_type::function_weak_ptr find_forwarder(
+    /// @return
+    ///   検索したメッセージ転送関数を指すスマートポインタ。
+    ///   該当するメッセージ転送関数が見つからなかった場合は、空となる。
+    public: typename this_type::function_weak_ptr find_forwarder(
         /// [in] 検索するメッセージ転送関数に対応する、
         /// メッセージ受信オブジェクトの識別値。
-        typename this_type::packet::message::tag::key_type const in_receiver_key);
+        typename this_type::packet::message::tag::key_type const in_receiver_key)
+    const PSYQ_NOEXCEPT
+    {
+        if (this->verify_thread())
+        {
+            auto const local_end(std::end(this->forwarding_hooks_));
+            auto const local_find(
+                this_type::find_forwarding_hook_iterator(
+                    std::begin(this->forwarding_hooks_),
+                    local_end,
+                    in_receiver_key));
+            if (local_find != local_end)
+            {
+                return local_find->function_;
+            }
+        }
+        return typename this_type::function_weak_ptr();
+    }
     /// @}
     //-------------------------------------------------------------------------
     /// @brief this_type を構築する。
     /// @warning psyq::event_driven の管理者以外は、この関数は使用禁止。
     public: dispatcher(
         /// [in] *this に対応するスレッドの識別子。
+        /// std::thread::id() の場合は、実行レーンとして構築する。
         std::thread::id const& in_thread_id,
-        /// [in] メッセージパケットの予約数。
-        std::size_t const in_packet_capacity,
+        /// [in] *this に対応する実行レーンの識別値。
+        std::size_t const in_lane_key,
+        /// [in] メッセージパケットの束の予約数。
+        std::size_t const in_batch_capacity,
         /// [in] メッセージ受信関数の予約数。
         std::size_t const in_receiver_capacity,
         /// [in] メッセージ転送関数の予約数。
         std::size_t const in_forwarder_capacity,
+        /// [in] 溜めておけるメッセージパケットの束の上限数。0なら無制限。
+        std::size_t const in_batch_limit,
+        /// [in] 上限数を超えた場合の方針。
+        psyq::event_driven::overflow_policy const in_overflow_policy,
         /// [in] *this が使うメモリ割当子の初期値。
         typename this_type::allocator_type const& in_allocator):
     receiving_hooks_(in_allocator),
+    receiving_index_(in_receiver_capacity, in_allocator),
     forwarding_hooks_(in_allocator),
-    receiving_packets_(in_allocator),
-    delivery_packets_(in_allocator),
+    forwarding_index_(in_forwarder_capacity, in_allocator),
+    batch_hooks_(in_allocator),
+    batch_index_(0, in_allocator),
+    receiving_batches_(in_allocator),
+    receiving_head_(0),
+    delivery_batches_(in_allocator),
     function_caches_(in_allocator),
-    thread_id_(in_thread_id)
+    batch_function_caches_(in_allocator),
+    grouped_packets_(in_allocator),
+    received_count_(0),
+    dropped_batch_count_(0),
+    dropped_packet_count_(0),
+    batch_high_water_(0),
+    batch_limit_(in_batch_limit),
+    overflow_policy_(in_overflow_policy),
+    lane_owner_(std::thread::id()),
+    lane_scheduled_(false),
+    lane_deferred_(false),
+    thread_id_(in_thread_id),
+    lane_key_(in_lane_key)
     {
         this->receiving_hooks_.reserve(in_receiver_capacity);
         this->forwarding_hooks_.reserve(in_forwarder_capacity);
-        this->receiving_packets_.reserve(in_packet_capacity);
-        this->delivery_packets_.reserve(in_packet_capacity);
+        this->receiving_batches_.reserve(in_batch_capacity);
+        this->delivery_batches_.reserve(in_batch_capacity);
         this->function_caches_.reserve(in_receiver_capacity);
     }
 
@@ -547,13 +1379,28 @@ class psyq::event_driven::dispatcher
     /// @brief ムーブ代入演算子は使用禁止。
     private: this_type& operator=(this_type&&);
 
+    /// @brief this_type::defer_lane で保留した処理を登録しなおす。
+    private: void resume_lane()
+    {
+        if (this->lane_deferred_.load(std::memory_order_seq_cst)
+            && this->lane_deferred_.exchange(false, std::memory_order_seq_cst))
+        {
+            auto const local_resume(std::move(this->lane_resume_));
+            this->lane_resume_ = nullptr;
+            local_resume();
+        }
+    }
+
     /// @brief 現在のスレッドが処理が許可されているスレッドか判定する。
     /// @retval true  現在のスレッドは、処理が許可されている。
     /// @retval false 現在のスレッドは、処理が許可されてない。
     private: bool verify_thread() const PSYQ_NOEXCEPT
     {
         auto const local_verify(
-            std::this_thread::get_id() == this->get_thread_id());
+            std::this_thread::get_id() == (
+                this->is_lane()?
+                    this->lane_owner_.load(std::memory_order_acquire):
+                    this->get_thread_id()));
         PSYQ_ASSERT(local_verify);
         return local_verify;
     }
@@ -588,7 +1435,9 @@ class psyq::event_driven::dispatcher
         }
         this_type::deliver_packet(
             this->function_caches_,
+            this->receiving_index_,
             this->receiving_hooks_,
+            this->forwarding_index_,
             this->forwarding_hooks_,
             in_packet);
         return true;
@@ -674,7 +1523,32 @@ class psyq::event_driven::dispatcher
             {
                 break;
             }
-            if (local_hook.receiver_key_ == in_receiver_key)
+            if (local_hook.receiver_key_ == in_receiver_key
+                && !local_hook.function_.expired())
+            {
+                return i;
+            }
+        }
+        return in_end;
+    }
+
+    private: template<typename template_iterator>
+    static template_iterator find_forwarding_hook_iterator(
+        template_iterator const in_begin,
+        template_iterator const in_end,
+        typename this_type::packet::message::tag::key_type const in_receiver_key)
+    {
+        for (
+            auto i(
+                std::lower_bound(
+                    in_begin,
+                    in_end,
+                    in_receiver_key,
+                    typename this_type::forwarding_hook::less()));
+            i != in_end && i->receiver_key_ == in_receiver_key;
+            ++i)
+        {
+            if (!i->function_.expired())
             {
                 return i;
             }
@@ -702,28 +1576,224 @@ class psyq::event_driven::dispatcher
     }
 
     //-------------------------------------------------------------------------
-    /// @brief 外部からメッセージパケットを受信する。
+    /// @brief 配送するメッセージパケットの束を取得し、墓標を整理する。
+    private: void take_batches(
+        /// [in] メッセージパケットの束の予約数。
+        std::size_t const in_capacity,
+        /// [in] コンテナを再構築するか。
+        bool const in_rebuild)
+    {
+        PSYQ_ASSERT(this->delivery_batches_.empty());
+        {
+            std::lock_guard<psyq::spinlock> const local_lock(this->lock_);
+
+            // 環状に使っていた束を、受信した順に並べ直す。
+            std::rotate(
+                this->receiving_batches_.begin(),
+                this->receiving_batches_.begin() + this->receiving_head_,
+                this->receiving_batches_.end());
+            this->receiving_head_ = 0;
+            this->delivery_batches_.swap(this->receiving_batches_);
+            this_type::clear_packets(
+                this->receiving_batches_, in_capacity, in_rebuild);
+        }
+        this->receiving_index_.compact(this->receiving_hooks_, in_rebuild);
+        this->forwarding_index_.compact(this->forwarding_hooks_, in_rebuild);
+        this->batch_index_.compact(this->batch_hooks_, in_rebuild);
+    }
+
+    /// @brief 配送するメッセージパケットの数と待ち時間を記録する。
+    private: void record_batches()
+    {
+        std::int64_t local_now(0);
+        std::size_t local_count(0);
+        for (auto const& local_batch: this->delivery_batches_)
+        {
+            local_count += local_batch->size();
+            for (auto const& local_packet: *local_batch)
+            {
+                auto const local_dispatch_time(
+                    local_packet->get_dispatch_time());
+                if (local_dispatch_time != 0)
+                {
+                    if (local_now == 0)
+                    {
+                        local_now = psyq::event_driven::latency_histogram::now();
+                    }
+                    this->dispatch_to_receive_.record(
+                        local_now - local_dispatch_time);
+                }
+            }
+        }
+        this->received_count_.fetch_add(
+            local_count, std::memory_order_relaxed);
+    }
+
+    /// @brief 配送を終えたメッセージパケットの束を手放し、コンテナを整理する。
+    private: void release_batches(
+        /// [in] メッセージパケットの束の予約数。
+        std::size_t const in_capacity,
+        /// [in] コンテナを再構築するか。
+        bool const in_rebuild)
+    {
+        this_type::clear_packets(
+            this->delivery_batches_, in_capacity, in_rebuild);
+        if (in_rebuild)
+        {
+            this->receiving_hooks_.shrink_to_fit();
+            this->forwarding_hooks_.shrink_to_fit();
+            this->batch_hooks_.shrink_to_fit();
+            this->function_caches_.shrink_to_fit();
+            this->function_caches_.reserve(this->receiving_hooks_.capacity());
+            this->batch_function_caches_.shrink_to_fit();
+        }
+    }
+
+    /// @brief 送り状が同じメッセージパケットの並びを配送する。
+    private: void deliver_group(
+        /// [in] 配送するメッセージパケットの並びの先頭位置。
+        typename this_type::packet const* const* const in_packets,
+        /// [in] 配送するメッセージパケットの数。
+        std::size_t const in_count)
+    {
+        // メッセージ受信関数を一度だけ検索する。
+        auto const& local_tag(in_packets[0]->get_message().get_tag());
+        auto& local_functions(this->function_caches_);
+        PSYQ_ASSERT(local_functions.empty());
+        this_type::cache_receivers(
+            local_functions, this->receiving_index_, this->receiving_hooks_, local_tag);
+        this_type::cache_forwarders(
+            local_functions, this->forwarding_index_, this->forwarding_hooks_, local_tag);
+        auto& local_batch_functions(this->batch_function_caches_);
+        PSYQ_ASSERT(local_batch_functions.empty());
+        auto const local_range(
+            this->batch_index_.find(
+                this->batch_hooks_, local_tag.get_selector_key()));
+        std::size_t local_tombstones(0);
+        for (auto i(local_range.first); i < local_range.second; ++i)
+        {
+            auto& local_hook(this->batch_hooks_[i]);
+            if (local_tag.verify_receiver_key(local_hook.receiver_key_))
+            {
+                auto local_function(local_hook.function_.lock());
+                if (local_function.get() != nullptr)
+                {
+                    local_batch_functions.emplace_back(std::move(local_function));
+                }
+                else
+                {
+                    ++local_tombstones;
+                }
+            }
+        }
+        this->batch_index_.add_tombstones(local_tombstones);
+
+        // メッセージ受信関数を呼び出す。
+        for (std::size_t i(0); i < in_count; ++i)
+        {
+            for (auto const& local_function: local_functions)
+            {
+                (*local_function)(*in_packets[i]);
+            }
+        }
+        for (auto const& local_function: local_batch_functions)
+        {
+            (*local_function)(in_packets, in_count);
+        }
+        local_functions.clear();
+        local_batch_functions.clear();
+    }
+
+    /// @brief まとめて受け取るメッセージ受信フックを検索する。
+    private: typename this_type::batch_hook::container::iterator find_batch_hook(
+        typename this_type::packet::message::tag::key_type const in_receiver_key,
+        typename this_type::packet::message::tag::key_type const in_selector_key)
+    {
+        auto const local_end(std::end(this->batch_hooks_));
+        for (auto i(std::begin(this->batch_hooks_)); i != local_end; ++i)
+        {
+            if (i->selector_key_ == in_selector_key
+                && i->receiver_key_ == in_receiver_key
+                && !i->function_.expired())
+            {
+                return i;
+            }
+        }
+        return local_end;
+    }
+
+    /// @brief dispatch_grouped で、メッセージパケットをまとめる順序で比較する。
+    private: static bool less_tag(
+        typename this_type::packet::message::tag const& in_left,
+        typename this_type::packet::message::tag const& in_right)
+    PSYQ_NOEXCEPT
+    {
+        if (in_left.get_selector_key() != in_right.get_selector_key())
+        {
+            return in_left.get_selector_key() < in_right.get_selector_key();
+        }
+        if (in_left.get_receiver_key() != in_right.get_receiver_key())
+        {
+            return in_left.get_receiver_key() < in_right.get_receiver_key();
+        }
+        return in_left.get_receiver_mask() < in_right.get_receiver_mask();
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 外部からメッセージパケットの束を受信する。
+    /// @details
+    ///   - 束を参照するだけで、メッセージパケットは複製しない。
+    ///   - overflow_policy_DROP_OLDEST で上限数に達したら、
+    ///     this_type::receiving_batches_ を環状に使い、
+    ///     最も古い束を新しい束で上書きする。
     private: void receive_packets(
-        /// [in] 受信するメッセージパケットのコンテナ。
-        typename this_type::packet_shared_ptr_container const&
-            in_receiving_packets)
+        /// [in] 受信するメッセージパケットの束。
+        typename this_type::packet_batch_shared_ptr const& in_batch)
     {
+        PSYQ_ASSERT(in_batch.get() != nullptr);
         std::lock_guard<psyq::spinlock> const local_lock(this->lock_);
-        this->receiving_packets_.insert(
-            std::end(this->receiving_packets_),
-            std::begin(in_receiving_packets),
-            std::end(in_receiving_packets));
+        if (0 < this->batch_limit_
+            && this->batch_limit_ <= this->receiving_batches_.size())
+        {
+            // this_type::receive_packets は zone::dispatch から呼び出されるので、
+            // 待たずに古い束か新しい束を捨てる。
+            auto const local_drop_newest(
+                this->overflow_policy_
+                    == psyq::event_driven::overflow_policy_DROP_NEWEST
+                || this->overflow_policy_
+                    == psyq::event_driven::overflow_policy_FAIL);
+            auto& local_oldest(this->receiving_batches_[this->receiving_head_]);
+            this->dropped_batch_count_.fetch_add(1, std::memory_order_relaxed);
+            this->dropped_packet_count_.fetch_add(
+                local_drop_newest? in_batch->size(): local_oldest->size(),
+                std::memory_order_relaxed);
+            if (!local_drop_newest)
+            {
+                local_oldest = in_batch;
+                this->receiving_head_ =
+                    (this->receiving_head_ + 1) % this->receiving_batches_.size();
+            }
+            return;
+        }
+        this->receiving_batches_.push_back(in_batch);
+        auto const local_size(this->receiving_batches_.size());
+        if (this->batch_high_water_.load(std::memory_order_relaxed)
+            < local_size)
+        {
+            this->batch_high_water_.store(
+                local_size, std::memory_order_relaxed);
+        }
     }
 
-    private: static void clear_packets(
-        typename this_type::packet_shared_ptr_container& io_packets,
+    private: template<typename template_container>
+    static void clear_packets(
+        template_container& io_packets,
         std::size_t const in_capacity,
         bool const in_rebuild)
     {
         if (in_rebuild)
         {
-            io_packets = typename this_type::packet_shared_ptr_container(
-                io_packets.get_allocator());
+            io_packets = template_container(io_packets.get_allocator());
         }
         else
         {
@@ -736,8 +1806,12 @@ class psyq::event_driven::dispatcher
     private: static void deliver_packets(
         /// [in,out] メッセージ受信関数のキャッシュに使うコンテナ。
         typename this_type::function_shared_ptr_container& io_functions,
+        /// [in,out] メッセージ受信フックの索引。
+        typename this_type::receiving_index& io_receiving_index,
         /// [in] メッセージ受信フックの辞書。
         typename this_type::receiving_hook::container const& in_receiving_hooks,
+        /// [in,out] メッセージ転送フックの索引。
+        typename this_type::forwarding_index& io_forwarding_index,
         /// [in] メッセージ転送フックの辞書。
         typename this_type::forwarding_hook::container const& in_forwarding_hooks,
         /// [in] 配送するメッセージパケットのコンテナ。
@@ -754,7 +1828,9 @@ class psyq::event_driven::dispatcher
                 // メッセージパケットを配送する。
                 this_type::deliver_packet(
                     io_functions,
+                    io_receiving_index,
                     in_receiving_hooks,
+                    io_forwarding_index,
                     in_forwarding_hooks,
                     *local_packet_pointer);
             }
@@ -769,8 +1845,12 @@ class psyq::event_driven::dispatcher
     private: static void deliver_packet(
         /// [in,out] メッセージ受信関数のキャッシュに使うコンテナ。
         typename this_type::function_shared_ptr_container& io_functions,
+        /// [in,out] メッセージ受信フックの索引。
+        typename this_type::receiving_index& io_receiving_index,
         /// [in] メッセージ受信フックの辞書。
         typename this_type::receiving_hook::container const& in_receiving_hooks,
+        /// [in,out] メッセージ転送フックの索引。
+        typename this_type::forwarding_index& io_forwarding_index,
         /// [in] メッセージ転送フックの辞書。
         typename this_type::forwarding_hook::container const& in_forwarding_hooks,
         /// [in] 配送するメッセージパケット。
@@ -779,9 +1859,9 @@ class psyq::event_driven::dispatcher
         PSYQ_ASSERT(io_functions.empty());
         auto& local_tag(in_packet.get_message().get_tag());
         this_type::cache_receivers(
-            io_functions, in_receiving_hooks, local_tag);
+            io_functions, io_receiving_index, in_receiving_hooks, local_tag);
         this_type::cache_forwarders(
-            io_functions, in_forwarding_hooks, local_tag);
+            io_functions, io_forwarding_index, in_forwarding_hooks, local_tag);
         for (auto const& local_function: io_functions)
         {
             (*local_function)(in_packet);
@@ -793,31 +1873,21 @@ class psyq::event_driven::dispatcher
     private: static void cache_receivers(
         /// [in,out] メッセージ受信関数のキャッシュに使うコンテナ。
         typename this_type::function_shared_ptr_container& io_functions,
+        /// [in,out] メッセージ受信フックの索引。
+        typename this_type::receiving_index& io_index,
         /// [in] メッセージ受信フックの辞書。
         typename this_type::receiving_hook::container const& in_hooks,
         /// [in] 配送するメッセージパケットの送り状。
         typename this_type::packet::message::tag const& in_tag)
     {
-        // メッセージ受信フックの辞書を走査し、
-        // メッセージ受信関数の識別値が一致するメッセージ受信フックを検索する。
-        auto const local_end(std::end(in_hooks));
-        for (
-            auto i(
-                std::lower_bound(
-                    std::begin(in_hooks),
-                    local_end,
-                    in_tag.get_selector_key(),
-                    typename this_type::receiving_hook::less()));
-            i != local_end;
-            ++i)
+        // 索引から、メッセージ受信関数の識別値が一致する範囲を取得する。
+        auto const local_range(
+            io_index.find(in_hooks, in_tag.get_selector_key()));
+        std::size_t local_tombstones(0);
+        for (auto i(local_range.first); i < local_range.second; ++i)
         {
-            auto& local_hook(*i);
-            if (local_hook.selector_key_ != in_tag.get_selector_key())
-            {
-                break;
-            }
-
             // メッセージ受信関数をキャッシュに貯める。
+            auto& local_hook(in_hooks[i]);
             if (in_tag.verify_receiver_key(local_hook.receiver_key_))
             {
                 auto local_function(local_hook.function_.lock());
@@ -825,40 +1895,133 @@ class psyq::event_driven::dispatcher
                 {
                     io_functions.emplace_back(std::move(local_function));
                 }
+                else
+                {
+                    ++local_tombstones;
+                }
             }
         }
+        io_index.add_tombstones(local_tombstones);
     }
 
     /// @brief メッセージパケットを配送するメッセージ転送関数を貯める。
+    /// @details
+    ///   送り状の識別値マスクが全ビット有効なら、メッセージ受信オブジェクトの
+    ///   識別値が一致する範囲だけを索引から引く。
+    ///   そうでないなら、識別値マスクごとの索引から、
+    ///   マスクした識別値が一致するフックだけを引く。
     private: static void cache_forwarders(
+        /// [in,out] メッセージ転送関数のキャッシュに使うコンテナ。
         typename this_type::function_shared_ptr_container& io_functions,
+        /// [in,out] メッセージ転送フックの索引。
+        typename this_type::forwarding_index& io_index,
+        /// [in] メッセージ転送フックの辞書。
         typename this_type::forwarding_hook::container const& in_hooks,
+        /// [in] 配送するメッセージパケットの送り状。
         typename this_type::packet::message::tag const& in_tag)
     {
-        for (auto& local_hook: in_hooks)
+        if (in_hooks.empty())
         {
-            if (in_tag.verify_receiver_key(local_hook.receiver_key_))
+            return;
+        }
+        std::size_t local_tombstones(0);
+        auto const local_cache_forwarder(
+            [&io_functions, &in_hooks, &in_tag, &local_tombstones](
+                std::size_t const in_position)
+            {
+                // メッセージ転送関数をキャッシュに貯める。
+                auto& local_hook(in_hooks[in_position]);
+                if (in_tag.verify_receiver_key(local_hook.receiver_key_))
+                {
+                    auto local_function(local_hook.function_.lock());
+                    if (local_function.get() != nullptr)
+                    {
+                        io_functions.emplace_back(std::move(local_function));
+                    }
+                    else
+                    {
+                        ++local_tombstones;
+                    }
+                }
+            });
+        typedef typename this_type::packet::message::tag::key_type key_type;
+        auto const local_mask(in_tag.get_receiver_mask());
+        if (local_mask == static_cast<key_type>(~key_type(0)))
+        {
+            auto const local_range(
+                io_index.find(in_hooks, in_tag.get_receiver_key()));
+            for (auto i(local_range.first); i < local_range.second; ++i)
+            {
+                local_cache_forwarder(i);
+            }
+        }
+        else
+        {
+            auto const local_range(
+                io_index.find_masked(
+                    in_hooks, in_tag.get_receiver_key(), local_mask));
+            for (auto i(local_range.first); i != local_range.second; ++i)
             {
-                /// @todo 未実装
+                local_cache_forwarder(*i);
             }
         }
+        io_index.add_tombstones(local_tombstones);
     }
 
     //-------------------------------------------------------------------------
     /// @brief メッセージ受信フックの辞書。
     private: typename this_type::receiving_hook::container receiving_hooks_;
+    /// @brief メッセージ受信フックの索引。
+    private: typename this_type::receiving_index receiving_index_;
     /// @brief メッセージ転送フックの辞書。
     private: typename this_type::forwarding_hook::container forwarding_hooks_;
-    /// @brief 外部から受信したメッセージパケットのコンテナ。
-    private: typename this_type::packet_shared_ptr_container receiving_packets_;
-    /// @brief メッセージ受信関数へ配送するメッセージパケットのコンテナ。
-    private: typename this_type::packet_shared_ptr_container delivery_packets_;
+    /// @brief メッセージ転送フックの索引。
+    private: typename this_type::forwarding_index forwarding_index_;
+    /// @brief まとめて受け取るメッセージ受信フックの辞書。
+    private: typename this_type::batch_hook::container batch_hooks_;
+    /// @brief まとめて受け取るメッセージ受信フックの索引。
+    private: typename this_type::batch_index batch_index_;
+    /// @brief 外部から受信したメッセージパケットの束のコンテナ。
+    private: typename this_type::packet_batch_container receiving_batches_;
+    /// @brief receiving_batches_ を環状に使うときの、最も古い束の位置。
+    private: std::size_t receiving_head_;
+    /// @brief メッセージ受信関数へ配送するメッセージパケットの束のコンテナ。
+    private: typename this_type::packet_batch_container delivery_batches_;
     /// @brief メッセージ受信関数のキャッシュ。
     private: typename this_type::function_shared_ptr_container function_caches_;
+    /// @brief まとめて受け取るメッセージ受信関数のキャッシュ。
+    private: typename this_type::batch_function_shared_ptr_container
+        batch_function_caches_;
+    /// @brief dispatch_grouped で送り状ごとにまとめたメッセージパケット。
+    private: typename this_type::packet_pointer_container grouped_packets_;
     /// @brief 排他的処理に使うロックオブジェクト。
     private: psyq::spinlock lock_;
+    /// @brief メッセージ受信関数へ配送したメッセージパケットの数。
+    private: std::atomic<std::size_t> received_count_;
+    /// @brief zone::dispatch から this_type::dispatch までの待ち時間。
+    private: psyq::event_driven::latency_histogram dispatch_to_receive_;
+    /// @brief 上限数を超えたので捨てたメッセージパケットの束の数。
+    private: std::atomic<std::size_t> dropped_batch_count_;
+    /// @brief 上限数を超えたので捨てたメッセージパケットの数。
+    private: std::atomic<std::size_t> dropped_packet_count_;
+    /// @brief 溜まったメッセージパケットの束の数の最大値。
+    private: std::atomic<std::size_t> batch_high_water_;
+    /// @brief 溜めておけるメッセージパケットの束の上限数。0なら無制限。
+    private: std::size_t const batch_limit_;
+    /// @brief 上限数を超えた場合の方針。
+    private: psyq::event_driven::overflow_policy const overflow_policy_;
+    /// @brief 実行レーンを占有しているスレッドの識別子。
+    private: std::atomic<std::thread::id> lane_owner_;
+    /// @brief 実行レーンの実行が予約されているか。
+    private: std::atomic<bool> lane_scheduled_;
+    /// @brief 実行レーンの処理が、占有の解除を待って保留されているか。
+    private: std::atomic<bool> lane_deferred_;
+    /// @brief 占有が解除されたときに、保留した処理を登録しなおす関数。
+    private: std::function<void()> lane_resume_;
     /// @brief *this に合致するスレッドの識別子。
     private: std::thread::id const thread_id_;
+    /// @brief *this に合致する実行レーンの識別値。
+    private: std::size_t const lane_key_;
 
 }; // class psyq::event_driven::dispatcher
 
@@ -0,0 +1,313 @@
+﻿/// @file
+/// @brief @copybrief psyq::event_driven::external_ring
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_EVENT_DRIVEN_EXTERNAL_RING_HPP_
+#define PSYQ_EVENT_DRIVEN_EXTERNAL_RING_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "../assert.hpp"
+
+/// external_ring のスロットの境界単位。バイト単位。
+#ifndef PSYQ_EVENT_DRIVEN_EXTERNAL_RING_ALIGNMENT
+#define PSYQ_EVENT_DRIVEN_EXTERNAL_RING_ALIGNMENT 64
+#endif // !defined(PSYQ_EVENT_DRIVEN_EXTERNAL_RING_ALIGNMENT)
+
+/// @cond
+namespace psyq
+{
+    namespace event_driven
+    {
+        class external_ring;
+    } // namespace event_driven
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief プロセス間で共有するメモリに配置する、ロックを使わないリングバッファ。
+/// @details
+///   - 固定長のスロットを環状に並べ、スロットごとの通し番号を
+///     atomic に更新して、複数の送信者と受信者がロックなしで読み書きする。
+///   - 共有メモリの確保と割り当ては、OSのAPIを使ってユーザーが行うこと。
+///     一つのプロセスが this_type::construct で初期化し、
+///     他のプロセスは this_type::attach で参照する。
+///   - 共有メモリに配置するので、ポインタを持たない。
+///     std::atomic<std::uint32_t> がロックフリーであること。
+///   - zone::set_external_ring で送信側のメッセージゾーンに設定し、
+///     zone::receive_external で受信側のメッセージゾーンに取り込む。
+class psyq::event_driven::external_ring
+{
+    /// @copydoc psyq::string::view::this_type
+    private: typedef external_ring this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief スロットの先頭に置く管理情報。
+    private: struct slot_header
+    {
+        /// @brief スロットの通し番号。
+        std::atomic<std::uint32_t> sequence;
+        /// @brief スロットに書き込んだデータの大きさ。バイト単位。
+        std::uint32_t size;
+    };
+
+    /// @brief 初期化済みかを判定する識別値。
+    private: enum: std::uint32_t {MAGIC = 0x52515950}; // "PYQR"
+
+    //-------------------------------------------------------------------------
+    /// @brief リングバッファに必要なメモリの大きさを算出する。
+    /// @return リングバッファに必要なメモリの大きさ。バイト単位。
+    public: static std::size_t compute_memory_size(
+        /// [in] スロットの数。2のべき乗であること。
+        std::uint32_t const in_slot_count,
+        /// [in] スロットに書き込めるデータの最大の大きさ。バイト単位。
+        std::uint32_t const in_payload_capacity)
+    PSYQ_NOEXCEPT
+    {
+        return this_type::get_header_size()
+            + this_type::compute_slot_stride(in_payload_capacity)
+                * in_slot_count;
+    }
+
+    /// @brief メモリにリングバッファを構築する。
+    /// @details 共有メモリを確保した一つのプロセスだけが呼び出すこと。
+    /// @retval !=nullptr 構築したリングバッファ。
+    /// @retval ==nullptr 失敗。引数が不正か、メモリが足りない。
+    public: static this_type* construct(
+        /// [in] リングバッファを構築するメモリの先頭位置。
+        void* const in_memory,
+        /// [in] リングバッファを構築するメモリの大きさ。バイト単位。
+        std::size_t const in_memory_size,
+        /// [in] スロットの数。2のべき乗であること。
+        std::uint32_t const in_slot_count,
+        /// [in] スロットに書き込めるデータの最大の大きさ。バイト単位。
+        std::uint32_t const in_payload_capacity)
+    {
+        if (in_memory == nullptr
+            || in_slot_count == 0
+            || (in_slot_count & (in_slot_count - 1)) != 0
+            || in_memory_size
+                < this_type::compute_memory_size(
+                    in_slot_count, in_payload_capacity))
+        {
+            PSYQ_ASSERT(false);
+            return nullptr;
+        }
+        auto const local_ring(new(in_memory) this_type);
+        PSYQ_ASSERT(local_ring->enqueue_position_.is_lock_free());
+        local_ring->slot_mask_ = in_slot_count - 1;
+        local_ring->slot_stride_ = static_cast<std::uint32_t>(
+            this_type::compute_slot_stride(in_payload_capacity));
+        local_ring->payload_capacity_ = in_payload_capacity;
+        local_ring->enqueue_position_.store(0, std::memory_order_relaxed);
+        local_ring->dequeue_position_.store(0, std::memory_order_relaxed);
+        for (std::uint32_t i(0); i < in_slot_count; ++i)
+        {
+            auto const local_slot(new(local_ring->get_slot(i)) slot_header);
+            local_slot->sequence.store(i, std::memory_order_relaxed);
+            local_slot->size = 0;
+        }
+        local_ring->magic_.store(this_type::MAGIC, std::memory_order_release);
+        return local_ring;
+    }
+
+    /// @brief this_type::construct で構築済みのリングバッファを参照する。
+    /// @retval !=nullptr 参照したリングバッファ。
+    /// @retval ==nullptr 失敗。まだ構築されていない。
+    public: static this_type* attach(
+        /// [in] リングバッファが構築されているメモリの先頭位置。
+        void* const in_memory)
+    PSYQ_NOEXCEPT
+    {
+        auto const local_ring(static_cast<this_type*>(in_memory));
+        return local_ring != nullptr
+            && local_ring->magic_.load(std::memory_order_acquire)
+                == this_type::MAGIC?
+                    local_ring: nullptr;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief スロットに書き込めるデータの最大の大きさを取得する。
+    /// @return スロットに書き込めるデータの最大の大きさ。バイト単位。
+    public: std::uint32_t get_payload_capacity() const PSYQ_NOEXCEPT
+    {
+        return this->payload_capacity_;
+    }
+
+    /// @brief データを書き込む。
+    /// @details どのスレッドやプロセスからでも、ロックなしで呼び出せる。
+    /// @retval true  成功。データを書き込んだ。
+    /// @retval false 失敗。空きスロットがないか、データが大きすぎる。
+    public: bool push(
+        /// [in] 書き込むデータの先頭位置。
+        void const* const in_data,
+        /// [in] 書き込むデータの大きさ。バイト単位。
+        std::size_t const in_size)
+    {
+        return this->produce(
+            in_size,
+            [in_data, in_size](void* const out_payload)
+            {
+                std::memcpy(out_payload, in_data, in_size);
+            });
+    }
+
+    /// @brief スロットへ直接データを書き込む。
+    /// @details どのスレッドやプロセスからでも、ロックなしで呼び出せる。
+    /// @retval true  成功。データを書き込んだ。
+    /// @retval false 失敗。空きスロットがないか、データが大きすぎる。
+    public: template<typename template_writer>
+    bool produce(
+        /// [in] 書き込むデータの大きさ。バイト単位。
+        std::size_t const in_size,
+        /// [in] スロットへデータを書き込む関数オブジェクト。
+        /// void(void*) 形式で、引数にスロットの書き込み位置を受け取る。
+        template_writer&& in_writer)
+    {
+        if (this->payload_capacity_ < in_size)
+        {
+            return false;
+        }
+        auto local_position(
+            this->enqueue_position_.load(std::memory_order_relaxed));
+        for (;;)
+        {
+            auto const local_slot(this->get_slot(local_position));
+            auto const local_difference(
+                static_cast<std::int32_t>(
+                    local_slot->sequence.load(std::memory_order_acquire)
+                    - local_position));
+            if (local_difference == 0)
+            {
+                if (this->enqueue_position_.compare_exchange_weak(
+                        local_position,
+                        local_position + 1,
+                        std::memory_order_relaxed))
+                {
+                    local_slot->size = static_cast<std::uint32_t>(in_size);
+                    in_writer(local_slot + 1);
+                    local_slot->sequence.store(
+                        local_position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (local_difference < 0)
+            {
+                // 空きスロットがない。
+                return false;
+            }
+            else
+            {
+                local_position =
+                    this->enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// @brief データを一つ読み出す。
+    /// @details どのスレッドやプロセスからでも、ロックなしで呼び出せる。
+    /// @retval true  成功。データを読み出した。
+    /// @retval false 失敗。読み出すデータがない。
+    public: template<typename template_reader>
+    bool consume(
+        /// [in] スロットからデータを読み出す関数オブジェクト。
+        /// void(void const*, std::size_t) 形式で、
+        /// 引数にスロットの読み出し位置と大きさを受け取る。
+        template_reader&& in_reader)
+    {
+        auto local_position(
+            this->dequeue_position_.load(std::memory_order_relaxed));
+        for (;;)
+        {
+            auto const local_slot(this->get_slot(local_position));
+            auto const local_difference(
+                static_cast<std::int32_t>(
+                    local_slot->sequence.load(std::memory_order_acquire)
+                    - (local_position + 1)));
+            if (local_difference == 0)
+            {
+                if (this->dequeue_position_.compare_exchange_weak(
+                        local_position,
+                        local_position + 1,
+                        std::memory_order_relaxed))
+                {
+                    in_reader(
+                        static_cast<void const*>(local_slot + 1),
+                        static_cast<std::size_t>(local_slot->size));
+                    local_slot->sequence.store(
+                        local_position + this->slot_mask_ + 1,
+                        std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (local_difference < 0)
+            {
+                // 読み出すデータがない。
+                return false;
+            }
+            else
+            {
+                local_position =
+                    this->dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    private: external_ring() PSYQ_NOEXCEPT {}
+    /// @brief コピー構築子は使用禁止。
+    private: external_ring(this_type const&);
+    /// @brief コピー代入演算子は使用禁止。
+    private: this_type& operator=(this_type const&);
+
+    /// @brief 通し番号に対応するスロットを取得する。
+    private: slot_header* get_slot(std::uint32_t const in_position)
+    PSYQ_NOEXCEPT
+    {
+        return reinterpret_cast<slot_header*>(
+            reinterpret_cast<char*>(this) + this_type::get_header_size()
+            + static_cast<std::size_t>(in_position & this->slot_mask_)
+                * this->slot_stride_);
+    }
+
+    private: static std::size_t get_header_size() PSYQ_NOEXCEPT
+    {
+        return this_type::align_size(sizeof(this_type));
+    }
+
+    private: static std::size_t compute_slot_stride(
+        std::uint32_t const in_payload_capacity)
+    PSYQ_NOEXCEPT
+    {
+        return this_type::align_size(sizeof(slot_header) + in_payload_capacity);
+    }
+
+    private: static std::size_t align_size(std::size_t const in_size)
+    PSYQ_NOEXCEPT
+    {
+        return (in_size + PSYQ_EVENT_DRIVEN_EXTERNAL_RING_ALIGNMENT - 1)
+            / PSYQ_EVENT_DRIVEN_EXTERNAL_RING_ALIGNMENT
+            * PSYQ_EVENT_DRIVEN_EXTERNAL_RING_ALIGNMENT;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 初期化済みかを判定する識別値。
+    private: std::atomic<std::uint32_t> magic_;
+    /// @brief スロットの数から1を引いた値。
+    private: std::uint32_t slot_mask_;
+    /// @brief スロットの間隔。バイト単位。
+    private: std::uint32_t slot_stride_;
+    /// @brief スロットに書き込めるデータの最大の大きさ。バイト単位。
+    private: std::uint32_t payload_capacity_;
+    /// @brief 次に書き込むスロットの通し番号。
+    private: std::atomic<std::uint32_t> enqueue_position_;
+    /// @brief 書き込みと読み出しの通し番号が、同じキャッシュ行に乗らないようにする。
+    private: char padding_[PSYQ_EVENT_DRIVEN_EXTERNAL_RING_ALIGNMENT];
+    /// @brief 次に読み出すスロットの通し番号。
+    private: std::atomic<std::uint32_t> dequeue_position_;
+
+}; // class psyq::event_driven::external_ring
+
+#endif // !defined(PSYQ_EVENT_DRIVEN_EXTERNAL_RING_HPP_)
+// vim: set expandtab:
@@ -0,0 +1,353 @@
+﻿/// @file
+/// @brief @copybrief psyq::event_driven::lane_executor
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_EVENT_DRIVEN_LANE_EXECUTOR_HPP_
+#define PSYQ_EVENT_DRIVEN_LANE_EXECUTOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../assert.hpp"
+
+/// @cond
+namespace psyq
+{
+    namespace event_driven
+    {
+        class lane_executor;
+    } // namespace event_driven
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief ワークスティーリングで処理を実行するスレッドプール。
+/// @details
+///   - ワーカースレッドごとに処理の待ち行列を持つ。
+///     ワーカースレッドは自分の待ち行列の末尾から処理を取り出し、
+///     空なら他のワーカースレッドの待ち行列の先頭から処理を盗む。
+///   - ワーカースレッドで実行中の処理から登録した処理は、
+///     そのワーカースレッドの待ち行列に積む。
+///   - 処理の数は atomic で数え、ミューテックスと条件変数は、
+///     ワーカースレッドが眠るときと起こすとき、
+///     全ての処理が終わったときにだけ使う。
+///   - zone::schedule_lanes で、実行レーンの dispatcher::dispatch
+///     を処理として登録する。実行レーンは一度に一つのワーカースレッドでしか
+///     実行されないので、実行レーンごとの受信順序は保たれる。
+class psyq::event_driven::lane_executor
+{
+    /// @copydoc psyq::string::view::this_type
+    private: typedef lane_executor this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief ワーカースレッドで実行する処理。
+    public: typedef std::function<void()> task;
+
+    //-------------------------------------------------------------------------
+    /// @brief ワーカースレッドごとの処理の待ち行列。
+    private: struct worker_queue
+    {
+        /// @brief 処理の待ち行列。
+        std::deque<typename lane_executor::task> tasks;
+        /// @brief tasks の排他制御に使うミューテックス。
+        std::mutex mutex;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @brief ワーカースレッドを起動する。
+    public: explicit lane_executor(
+        /// [in] 起動するワーカースレッドの数。
+        std::size_t const in_thread_count =
+            (std::max)(std::thread::hardware_concurrency(), 1u))
+    :
+    pending_count_(0),
+    unfinished_count_(0),
+    sleeping_count_(0),
+    next_queue_(0),
+    stop_(false)
+    {
+        auto const local_count((std::max)(in_thread_count, std::size_t(1)));
+        this->queues_.reserve(local_count);
+        for (std::size_t i(0); i < local_count; ++i)
+        {
+            this->queues_.emplace_back(new worker_queue);
+        }
+        this->threads_.reserve(local_count);
+        this->worker_ids_.reserve(local_count);
+        for (std::size_t i(0); i < local_count; ++i)
+        {
+            this->threads_.emplace_back(&this_type::run_worker, this, i);
+            this->worker_ids_.push_back(this->threads_.back().get_id());
+        }
+    }
+
+    /// @brief 全ての処理が終わるのを待って、ワーカースレッドを停止する。
+    public: ~lane_executor()
+    {
+        this->wait_idle();
+        {
+            std::lock_guard<std::mutex> const local_lock(this->idle_mutex_);
+            this->stop_ = true;
+        }
+        this->work_condition_.notify_all();
+        for (auto& local_thread: this->threads_)
+        {
+            local_thread.join();
+        }
+    }
+
+    /// @brief ワーカースレッドの数を取得する。
+    /// @return ワーカースレッドの数。
+    public: std::size_t get_thread_count() const PSYQ_NOEXCEPT
+    {
+        return this->threads_.size();
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 処理を登録する。
+    /// @details
+    ///   - どのスレッドからでも呼び出せる。
+    ///   - ワーカースレッドから呼び出すと、そのワーカースレッドの待ち行列に積む。
+    ///     それ以外のスレッドから呼び出すと、待ち行列を順番に選んで積む。
+    ///   - 眠っているワーカースレッドがある場合にだけ、
+    ///     ミューテックスを獲得して起こす。
+    public: void submit(
+        /// [in] 登録する処理。
+        typename this_type::task in_task)
+    {
+        // 処理が終わるより先に数えるので、処理の途中で待機状態にはならない。
+        this->unfinished_count_.fetch_add(1, std::memory_order_relaxed);
+        this->push_task(std::move(in_task));
+    }
+
+    /// @brief 後で登録する処理を予約する。
+    /// @details
+    ///   予約した処理を this_type::submit_reserved で登録して終わるまで、
+    ///   this_type::wait_idle は待機状態にならない。
+    public: void reserve() PSYQ_NOEXCEPT
+    {
+        this->unfinished_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// @brief this_type::reserve で予約した処理を登録する。
+    /// @details どのスレッドからでも呼び出せる。
+    public: void submit_reserved(
+        /// [in] 登録する処理。
+        typename this_type::task in_task)
+    {
+        this->push_task(std::move(in_task));
+    }
+
+    /// @brief 登録した処理が全て終わるまで待つ。
+    /// @details
+    ///   実行中の処理から登録された処理や、
+    ///   this_type::reserve で予約された処理も含めて待つ。
+    public: void wait_idle()
+    {
+        std::unique_lock<std::mutex> local_lock(this->idle_mutex_);
+        this->idle_condition_.wait(
+            local_lock,
+            [this]()
+            {
+                return this->unfinished_count_.load(
+                    std::memory_order_acquire) == 0;
+            });
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief コピー構築子は使用禁止。
+    private: lane_executor(this_type const&);
+    /// @brief コピー代入演算子は使用禁止。
+    private: this_type& operator=(this_type const&);
+
+    /// @brief 処理を待ち行列に積み、眠っているワーカースレッドを起こす。
+    private: void push_task(
+        /// [in] 積む処理。
+        typename this_type::task in_task)
+    {
+        auto local_index(this->find_worker());
+        if (this->queues_.size() <= local_index)
+        {
+            local_index =
+                this->next_queue_.fetch_add(1, std::memory_order_relaxed)
+                % this->queues_.size();
+        }
+        auto& local_queue(*this->queues_[local_index]);
+        {
+            std::lock_guard<std::mutex> const local_lock(local_queue.mutex);
+            local_queue.tasks.push_back(std::move(in_task));
+        }
+
+        this->pending_count_.fetch_add(1, std::memory_order_seq_cst);
+        if (0 < this->sleeping_count_.load(std::memory_order_seq_cst))
+        {
+            // 眠ろうとしているワーカースレッドが処理の数を確かめる前か、
+            // 条件変数で待機した後になるよう、ミューテックスで同期する。
+            {
+                std::lock_guard<std::mutex> const local_lock(this->idle_mutex_);
+            }
+            this->work_condition_.notify_one();
+        }
+    }
+
+    /// @brief ワーカースレッドの処理。
+    private: void run_worker(
+        /// [in] ワーカースレッドの番号。
+        std::size_t const in_index)
+    {
+        for (;;)
+        {
+            if (!this->acquire_pending())
+            {
+                // 処理が登録されるまで眠る。
+                std::unique_lock<std::mutex> local_lock(this->idle_mutex_);
+                this->sleeping_count_.fetch_add(1, std::memory_order_seq_cst);
+                this->work_condition_.wait(
+                    local_lock,
+                    [this]()
+                    {
+                        return this->stop_
+                            || 0 < this->pending_count_.load(
+                                std::memory_order_seq_cst);
+                    });
+                this->sleeping_count_.fetch_sub(1, std::memory_order_relaxed);
+                if (this->stop_
+                    && this->pending_count_.load(std::memory_order_relaxed) == 0)
+                {
+                    return;
+                }
+                continue;
+            }
+
+            // 処理を取り出して実行する。
+            // pending_count_ を減らしたので、取り出せる処理が必ずある。
+            typename this_type::task local_task;
+            while (!this->take_task(in_index, local_task))
+            {
+                std::this_thread::yield();
+            }
+            local_task();
+            local_task = nullptr;
+
+            // 最後の処理が終わったときだけ、待機状態になったことを通知する。
+            if (this->unfinished_count_.fetch_sub(1, std::memory_order_acq_rel)
+                == 1)
+            {
+                {
+                    std::lock_guard<std::mutex> const local_lock(
+                        this->idle_mutex_);
+                }
+                this->idle_condition_.notify_all();
+            }
+        }
+    }
+
+    /// @brief まだ取り出されていない処理を1つ予約する。
+    /// @retval true  処理を予約した。
+    /// @retval false まだ取り出されていない処理がなかった。
+    private: bool acquire_pending() PSYQ_NOEXCEPT
+    {
+        auto local_count(this->pending_count_.load(std::memory_order_relaxed));
+        while (0 < local_count)
+        {
+            if (this->pending_count_.compare_exchange_weak(
+                    local_count,
+                    local_count - 1,
+                    std::memory_order_acquire,
+                    std::memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief 現在のスレッドに合致するワーカースレッドの番号を取得する。
+    /// @return
+    ///   現在のスレッドに合致するワーカースレッドの番号。
+    ///   ワーカースレッドでない場合は、ワーカースレッドの数。
+    private: std::size_t find_worker() const PSYQ_NOEXCEPT
+    {
+        auto const local_id(std::this_thread::get_id());
+        std::size_t i(0);
+        for (; i < this->worker_ids_.size(); ++i)
+        {
+            if (this->worker_ids_[i] == local_id)
+            {
+                break;
+            }
+        }
+        return i;
+    }
+
+    /// @brief 自分の待ち行列か、他のワーカースレッドの待ち行列から処理を取り出す。
+    /// @retval true  処理を取り出した。
+    /// @retval false 処理がなかった。
+    private: bool take_task(
+        /// [in] ワーカースレッドの番号。
+        std::size_t const in_index,
+        /// [out] 取り出した処理。
+        typename this_type::task& out_task)
+    {
+        // 自分の待ち行列の末尾から取り出す。
+        {
+            auto& local_queue(*this->queues_[in_index]);
+            std::lock_guard<std::mutex> const local_lock(local_queue.mutex);
+            if (!local_queue.tasks.empty())
+            {
+                out_task = std::move(local_queue.tasks.back());
+                local_queue.tasks.pop_back();
+                return true;
+            }
+        }
+
+        // 他のワーカースレッドの待ち行列の先頭から盗む。
+        auto const local_count(this->queues_.size());
+        for (std::size_t i(1); i < local_count; ++i)
+        {
+            auto& local_queue(*this->queues_[(in_index + i) % local_count]);
+            std::lock_guard<std::mutex> const local_lock(local_queue.mutex);
+            if (!local_queue.tasks.empty())
+            {
+                out_task = std::move(local_queue.tasks.front());
+                local_queue.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief ワーカースレッドごとの処理の待ち行列。
+    private: std::vector<std::unique_ptr<worker_queue>> queues_;
+    /// @brief ワーカースレッド。
+    private: std::vector<std::thread> threads_;
+    /// @brief ワーカースレッドの識別子。
+    private: std::vector<std::thread::id> worker_ids_;
+    /// @brief ワーカースレッドを眠らせるときと起こすとき、
+    /// 待機状態を通知するときに使うミューテックス。 stop_ の排他制御にも使う。
+    private: std::mutex idle_mutex_;
+    /// @brief 処理が登録されたことを通知する条件変数。
+    private: std::condition_variable work_condition_;
+    /// @brief 全ての処理が終わったことを通知する条件変数。
+    private: std::condition_variable idle_condition_;
+    /// @brief まだ取り出されていない処理の数。
+    private: std::atomic<std::size_t> pending_count_;
+    /// @brief 登録されてから、まだ終わっていない処理の数。
+    private: std::atomic<std::size_t> unfinished_count_;
+    /// @brief 眠っているワーカースレッドの数。
+    private: std::atomic<std::size_t> sleeping_count_;
+    /// @brief 次に処理を登録する待ち行列の番号。
+    private: std::atomic<std::size_t> next_queue_;
+    /// @brief ワーカースレッドを停止するか。
+    private: bool stop_;
+
+}; // class psyq::event_driven::lane_executor
+
+#endif // !defined(PSYQ_EVENT_DRIVEN_LANE_EXECUTOR_HPP_)
+// vim: set expandtab:
@@ -0,0 +1,176 @@
+﻿/// @file
+/// @brief @copybrief psyq::event_driven::latency_histogram
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_EVENT_DRIVEN_LATENCY_HISTOGRAM_HPP_
+#define PSYQ_EVENT_DRIVEN_LATENCY_HISTOGRAM_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/// @cond
+namespace psyq
+{
+    namespace event_driven
+    {
+        class latency_histogram;
+    } // namespace event_driven
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief 待ち時間の度数分布。
+/// @details
+///   - 待ち時間をナノ秒単位で、2のべき乗ごとの階級に数える。
+///     階級 i には、 2^(i-1) 以上 2^i 未満の待ち時間が入る。
+///     階級 0 には、0以下の待ち時間が入る。
+///   - this_type::record は単一のスレッドから呼び出すこと。
+///     this_type::take_snapshot は、どのスレッドからでも呼び出せる。
+class psyq::event_driven::latency_histogram
+{
+    /// @copydoc psyq::string::view::this_type
+    private: typedef latency_histogram this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 度数分布の階級の数。
+    public: static std::size_t const BUCKET_COUNT = 64;
+
+    /// @brief 度数分布の写し。
+    public: struct snapshot
+    {
+        /// @brief 指定した割合の待ち時間を、階級の上限値で取得する。
+        /// @return
+        ///   待ち時間を短い順に並べたとき、 in_ratio
+        ///   の位置にある待ち時間を含む階級の上限値。ナノ秒単位。
+        std::int64_t get_percentile(
+            /// [in] 0以上1以下の割合。
+            double const in_ratio)
+        const PSYQ_NOEXCEPT
+        {
+            if (this->count == 0)
+            {
+                return 0;
+            }
+            auto const local_rank(
+                static_cast<std::uint64_t>(in_ratio * (this->count - 1)) + 1);
+            std::uint64_t local_count(0);
+            for (std::size_t i(0); i < this->buckets.size(); ++i)
+            {
+                local_count += this->buckets[i];
+                if (local_rank <= local_count)
+                {
+                    if (i == 0)
+                    {
+                        return 0;
+                    }
+                    auto const local_half(std::int64_t(1) << (i - 1));
+                    return (std::min)(this->max, local_half - 1 + local_half);
+                }
+            }
+            return this->max;
+        }
+
+        /// @brief 階級ごとの度数。
+        std::array<std::uint64_t, latency_histogram::BUCKET_COUNT> buckets;
+        /// @brief 記録した待ち時間の数。
+        std::uint64_t count;
+        /// @brief 記録した待ち時間の合計。ナノ秒単位。
+        std::int64_t sum;
+        /// @brief 記録した待ち時間の最大値。ナノ秒単位。
+        std::int64_t max;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @brief 空の度数分布を構築する。
+    public: latency_histogram() PSYQ_NOEXCEPT: sum_(0), max_(0)
+    {
+        for (auto& local_bucket: this->buckets_)
+        {
+            local_bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief 現在の時刻を取得する。
+    /// @return 単調増加する時計の現在時刻。ナノ秒単位。0になることはない。
+    public: static std::int64_t now() PSYQ_NOEXCEPT
+    {
+        auto const local_now(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        return local_now != 0? local_now: 1;
+    }
+
+    /// @brief 待ち時間を記録する。
+    public: void record(
+        /// [in] 記録する待ち時間。ナノ秒単位。
+        std::int64_t const in_latency,
+        /// [in] 記録する数。
+        std::uint64_t const in_count = 1)
+    PSYQ_NOEXCEPT
+    {
+        this->buckets_[this_type::find_bucket(in_latency)].fetch_add(
+            in_count, std::memory_order_relaxed);
+        this->sum_.fetch_add(
+            in_latency * static_cast<std::int64_t>(in_count),
+            std::memory_order_relaxed);
+        if (this->max_.load(std::memory_order_relaxed) < in_latency)
+        {
+            this->max_.store(in_latency, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief 度数分布の写しを取得する。
+    /// @details
+    ///   他のスレッドが同時に this_type::record している場合、
+    ///   階級ごとの度数と合計は厳密には一致しないことがある。
+    /// @return 度数分布の写し。
+    public: typename this_type::snapshot take_snapshot() const PSYQ_NOEXCEPT
+    {
+        typename this_type::snapshot local_snapshot;
+        local_snapshot.count = 0;
+        for (std::size_t i(0); i < this_type::BUCKET_COUNT; ++i)
+        {
+            local_snapshot.buckets[i] =
+                this->buckets_[i].load(std::memory_order_relaxed);
+            local_snapshot.count += local_snapshot.buckets[i];
+        }
+        local_snapshot.sum = this->sum_.load(std::memory_order_relaxed);
+        local_snapshot.max = this->max_.load(std::memory_order_relaxed);
+        return local_snapshot;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief コピー構築子は使用禁止。
+    private: latency_histogram(this_type const&);
+    /// @brief コピー代入演算子は使用禁止。
+    private: this_type& operator=(this_type const&);
+
+    /// @brief 待ち時間が入る階級を検索する。
+    /// @return 待ち時間が入る階級の番号。
+    private: static std::size_t find_bucket(
+        /// [in] 待ち時間。ナノ秒単位。
+        std::int64_t const in_latency)
+    PSYQ_NOEXCEPT
+    {
+        std::size_t local_bucket(0);
+        for (auto i(in_latency); 0 < i; i >>= 1)
+        {
+            ++local_bucket;
+        }
+        return local_bucket;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 階級ごとの度数。
+    private: std::array<std::atomic<std::uint64_t>, BUCKET_COUNT> buckets_;
+    /// @brief 記録した待ち時間の合計。ナノ秒単位。
+    private: std::atomic<std::int64_t> sum_;
+    /// @brief 記録した待ち時間の最大値。ナノ秒単位。
+    private: std::atomic<std::int64_t> max_;
+
+}; // class psyq::event_driven::latency_histogram
+
+#endif // !defined(PSYQ_EVENT_DRIVEN_LATENCY_HISTOGRAM_HPP_)
+// vim: set expandtab:
@@ -3,7 +3,11 @@
 #ifndef PSYQ_EVENT_DRIVEN_PACKET_HPP_
 #define PSYQ_EVENT_DRIVEN_PACKET_HPP_
 
+#include <atomic>
 #include <memory>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 #include "../any/rtti.hpp"
 
 /// @cond
@@ -28,6 +32,7 @@ class psyq::event_driven::packet
     //-------------------------------------------------------------------------
     public: template<typename template_message> class zonal;
     public: template<typename template_message> class external;
+    public: template<std::size_t template_capacity> class imported;
     /// @brief this_type を強参照するスマートポインタ。
     public: typedef std::shared_ptr<this_type> shared_ptr;
     /// @brief this_type を弱参照するスマートポインタ。
@@ -82,6 +87,48 @@ class psyq::event_driven::packet
     }
     /// @}
     //-------------------------------------------------------------------------
+    /// @name 時刻印
+    /// @{
+
+    /// @brief 送信を予約した時刻を取得する。
+    /// @return
+    ///   zone で送信を予約した時刻。ナノ秒単位。
+    ///   zone::enable_timestamp で時刻印を有効にしてなければ、0。
+    public: std::int64_t get_post_time() const PSYQ_NOEXCEPT
+    {
+        return this->post_time_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief dispatcher へ配送した時刻を取得する。
+    /// @return
+    ///   zone::dispatch で配送した時刻。ナノ秒単位。
+    ///   zone::enable_timestamp で時刻印を有効にしてなければ、0。
+    public: std::int64_t get_dispatch_time() const PSYQ_NOEXCEPT
+    {
+        return this->dispatch_time_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief 送信を予約した時刻を設定する。
+    /// @warning psyq::event_driven の管理者以外は、この関数は使用禁止。
+    public: void set_post_time(
+        /// [in] 送信を予約した時刻。ナノ秒単位。
+        std::int64_t const in_time)
+    PSYQ_NOEXCEPT
+    {
+        this->post_time_.store(in_time, std::memory_order_relaxed);
+    }
+
+    /// @brief dispatcher へ配送した時刻を設定する。
+    /// @warning psyq::event_driven の管理者以外は、この関数は使用禁止。
+    public: void set_dispatch_time(
+        /// [in] dispatcher へ配送した時刻。ナノ秒単位。
+        std::int64_t const in_time)
+    PSYQ_NOEXCEPT
+    {
+        this->dispatch_time_.store(in_time, std::memory_order_relaxed);
+    }
+    /// @}
+    //-------------------------------------------------------------------------
     /// @brief メッセージゾーン内パケットを生成する。
     /// @return
     ///   生成したメッセージパケットを指すスマートポインタ。
@@ -116,7 +163,17 @@ class psyq::event_driven::packet
     }
 
     //-------------------------------------------------------------------------
-    protected: packet() PSYQ_NOEXCEPT {}
+    protected: packet() PSYQ_NOEXCEPT: post_time_(0), dispatch_time_(0) {}
+
+    //-------------------------------------------------------------------------
+    /// @brief 送信を予約した時刻。ナノ秒単位。
+    /// @details
+    ///   同じメッセージパケットを複数のスレッドから送信予約できるので、
+    ///   std::atomic で読み書きする。
+    private: std::atomic<std::int64_t> post_time_;
+    /// @brief dispatcher へ配送した時刻。ナノ秒単位。
+    /// @details this_type::post_time_ と同じく、 std::atomic で読み書きする。
+    private: std::atomic<std::int64_t> dispatch_time_;
 
 }; // class psyq::event_driven::packet
 
@@ -254,5 +311,115 @@ class psyq::event_driven::packet<template_base_message>::external:
 
 }; // class psyq::event_driven::packet::external
 
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief メッセージゾーン外から取り込んだメッセージを持つパケット。
+/// @details
+///   - zone::receive_external で、 external_ring から読み出した
+///     メッセージの送り状と引数のバイト列を複製して構築する。
+///   - メッセージ引数の型は、RTTI識別値から実行時に決まる。
+/// @tparam template_base_message @copydoc packet::message
+/// @tparam template_capacity     メッセージ引数を格納できる最大の大きさ。バイト単位。
+template<typename template_base_message>
+template<std::size_t template_capacity>
+class psyq::event_driven::packet<template_base_message>::imported:
+    public psyq::event_driven::packet<template_base_message>
+{
+    /// @copydoc psyq::string::view::this_type
+    private: typedef imported this_type;
+    /// @copydoc psyq::string::view::base_type
+    public: typedef psyq::event_driven::packet<template_base_message> base_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 引数のバイト列を持つメッセージ。
+    public: class message: public template_base_message
+    {
+        private: typedef message this_type;
+        public: typedef template_base_message base_type;
+
+        /// @brief メッセージを構築する。
+        public: message(
+            /// [in] メッセージの送り状。
+            typename base_type::tag const& in_tag,
+            /// [in] 複製する引数の先頭位置。
+            void const* const in_parameter,
+            /// [in] 複製する引数の大きさ。バイト単位。
+            std::size_t const in_parameter_size)
+        PSYQ_NOEXCEPT:
+        base_type(
+            in_tag,
+            &this->parameter_,
+            static_cast<std::size_t>(
+                reinterpret_cast<char const*>(&this->parameter_)
+                - reinterpret_cast<char const*>(this))
+            + in_parameter_size)
+        {
+            PSYQ_ASSERT(in_parameter_size <= template_capacity);
+            if (0 < in_parameter_size)
+            {
+                std::memcpy(&this->parameter_, in_parameter, in_parameter_size);
+            }
+        }
+
+        /// @brief メッセージ引数を格納する領域。
+        private: typename std::aligned_storage<template_capacity>::type
+            parameter_;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @name 構築
+    /// @{
+
+    /// @brief メッセージパケットを構築する。
+    public: imported(
+        /// [in] メッセージの送り状。
+        typename template_base_message::tag const& in_tag,
+        /// [in] メッセージ引数のRTTI。
+        psyq::any::rtti const* const in_parameter_rtti,
+        /// [in] 複製するメッセージ引数の先頭位置。
+        void const* const in_parameter,
+        /// [in] 複製するメッセージ引数の大きさ。バイト単位。
+        std::size_t const in_parameter_size)
+    PSYQ_NOEXCEPT:
+    message_(in_tag, in_parameter, in_parameter_size),
+    parameter_rtti_(in_parameter_rtti)
+    {}
+    /// @}
+    //-------------------------------------------------------------------------
+    /// @name プロパティ
+    /// @{
+    public: typename base_type::message const& get_message()
+    const PSYQ_NOEXCEPT override
+    {
+        return this->message_;
+    }
+
+    public: typename base_type::message const* get_external_message()
+    const PSYQ_NOEXCEPT override
+    {
+        return &this->message_;
+    }
+
+    public: psyq::any::rtti const* get_parameter_rtti()
+    const PSYQ_NOEXCEPT override
+    {
+        return this->parameter_rtti_;
+    }
+
+    public: void const* get_parameter_data(
+        psyq::any::rtti const* const in_rtti)
+    const PSYQ_NOEXCEPT override
+    {
+        return psyq::any::rtti::find(in_rtti, this->parameter_rtti_) != nullptr?
+            this->message_.get_parameter_data(): nullptr;
+    }
+    /// @}
+    //-------------------------------------------------------------------------
+    /// @brief 保持しているメッセージ。
+    private: typename this_type::message message_;
+    /// @brief 保持しているメッセージ引数のRTTI。
+    private: psyq::any::rtti const* parameter_rtti_;
+
+}; // class psyq::event_driven::packet::imported
+
 #endif // !defined(PSYQ_EVENT_DRIVEN_PACKET_HPP_)
 // vim: set expandtab:
@@ -0,0 +1,418 @@
+﻿/// @file
+/// @brief @copybrief psyq::event_driven::packet_pool
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_EVENT_DRIVEN_PACKET_POOL_HPP_
+#define PSYQ_EVENT_DRIVEN_PACKET_POOL_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include "../atomic_count.hpp"
+
+/// packet_pool が扱うメモリブロックの大きさの区分の数。
+#ifndef PSYQ_EVENT_DRIVEN_PACKET_POOL_CLASS_COUNT
+#define PSYQ_EVENT_DRIVEN_PACKET_POOL_CLASS_COUNT 16
+#endif // !defined(PSYQ_EVENT_DRIVEN_PACKET_POOL_CLASS_COUNT)
+
+/// packet_pool が一度に確保するメモリチャンクの大きさ。バイト単位。
+#ifndef PSYQ_EVENT_DRIVEN_PACKET_POOL_CHUNK_SIZE_DEFAULT
+#define PSYQ_EVENT_DRIVEN_PACKET_POOL_CHUNK_SIZE_DEFAULT 4096
+#endif // !defined(PSYQ_EVENT_DRIVEN_PACKET_POOL_CHUNK_SIZE_DEFAULT)
+
+/// @cond
+namespace psyq
+{
+    namespace event_driven
+    {
+        template<typename> class packet_pool;
+        template<typename, typename> class packet_allocator;
+    } // namespace event_driven
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief メッセージパケットのメモリを再利用するメモリプール。
+/// @details
+///   - メモリブロックを大きさの区分ごとに空きリストで管理し、
+///     解放されたメモリブロックを同じ区分の割り当てで再利用する。
+///   - 空きリストが空の場合のみ、メモリチャンクを確保して切り分ける。
+///     メモリチャンクは this_type の破棄時にまとめて解放する。
+///   - どの区分よりも大きいメモリは、メモリ割当子から直接割り当てる。
+///   - 区分ごとの psyq::spinlock で排他制御するので、
+///     どのスレッドからでも割り当てと解放ができる。
+/// @tparam template_allocator @copydoc packet_pool::allocator_type
+template<typename template_allocator>
+class psyq::event_driven::packet_pool
+{
+    /// @copydoc psyq::string::view::this_type
+    private: typedef packet_pool this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief this_type を強参照するスマートポインタ。
+    public: typedef std::shared_ptr<this_type> shared_ptr;
+    /// @brief メモリチャンクの確保に使うメモリ割当子。
+    public: typedef template_allocator allocator_type;
+    /// @brief メモリブロックの大きさの区分の単位。バイト単位。
+    public: static std::size_t const CLASS_UNIT =
+        std::alignment_of<std::max_align_t>::value;
+    /// @brief 区分で管理するメモリブロックの大きさの最大値。バイト単位。
+    public: static std::size_t const CLASS_SIZE_MAX =
+        CLASS_UNIT * PSYQ_EVENT_DRIVEN_PACKET_POOL_CLASS_COUNT;
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリチャンクの確保単位。
+    private: typedef std::max_align_t chunk_unit;
+    /// @brief メモリチャンクの確保に使うメモリ割当子。
+    private: typedef
+        typename this_type::allocator_type::template rebind<
+            typename this_type::chunk_unit>::other
+        chunk_allocator;
+    /// @brief 空きメモリブロック。
+    private: struct free_block
+    {
+        /// @brief 次の空きメモリブロック。
+        free_block* next;
+    };
+    /// @brief メモリチャンクの先頭に置く管理情報。
+    private: struct chunk_header
+    {
+        /// @brief 次のメモリチャンク。
+        chunk_header* next;
+        /// @brief メモリチャンクの大きさ。 chunk_unit 単位。
+        std::size_t size;
+    };
+    /// @brief メモリブロックの大きさの区分。
+    private: struct size_class
+    {
+        size_class() PSYQ_NOEXCEPT: free_blocks(nullptr) {}
+
+        /// @brief 空きメモリブロックのリスト。
+        free_block* free_blocks;
+        /// @brief free_blocks の排他制御に使うロックオブジェクト。
+        psyq::spinlock lock;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @brief 空のメモリプールを構築する。
+    public: explicit packet_pool(
+        /// [in] メモリチャンクの確保に使うメモリ割当子。
+        typename this_type::allocator_type const& in_allocator,
+        /// [in] 一度に確保するメモリチャンクの大きさ。バイト単位。
+        std::size_t const in_chunk_size =
+            PSYQ_EVENT_DRIVEN_PACKET_POOL_CHUNK_SIZE_DEFAULT):
+    allocator_(in_allocator),
+    chunks_(nullptr),
+    chunk_size_(in_chunk_size),
+    reserved_bytes_(0)
+    {}
+
+    /// @brief 全てのメモリチャンクを解放する。
+    /// @details 割り当てたメモリブロックは、全て解放しておくこと。
+    public: ~packet_pool()
+    {
+        auto local_chunk(this->chunks_);
+        while (local_chunk != nullptr)
+        {
+            auto const local_next(local_chunk->next);
+            this->allocator_.deallocate(
+                reinterpret_cast<typename this_type::chunk_unit*>(local_chunk),
+                local_chunk->size);
+            local_chunk = local_next;
+        }
+    }
+
+    /// @brief メモリ割当子を取得する。
+    /// @return *thisが使っているメモリ割当子。
+    public: typename this_type::allocator_type get_allocator()
+    const PSYQ_NOEXCEPT
+    {
+        return this->allocator_;
+    }
+
+    /// @brief 確保しているメモリチャンクの大きさの合計を取得する。
+    /// @return 確保しているメモリチャンクの大きさの合計。バイト単位。
+    public: std::size_t get_reserved_bytes() const PSYQ_NOEXCEPT
+    {
+        return this->reserved_bytes_.load();
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリブロックを割り当てる。
+    /// @return 割り当てたメモリブロックの先頭位置。
+    public: void* allocate(
+        /// [in] 割り当てるメモリの大きさ。バイト単位。
+        std::size_t const in_size,
+        /// [in] 割り当てるメモリの境界単位。バイト単位。
+        std::size_t const in_alignment)
+    {
+        PSYQ_ASSERT(in_alignment <= this_type::CLASS_UNIT);
+        if (this_type::CLASS_SIZE_MAX < in_size || in_size == 0)
+        {
+            return this->allocator_.allocate(
+                this_type::count_chunk_units(in_size));
+        }
+        auto const local_index((in_size - 1) / this_type::CLASS_UNIT);
+        auto& local_class(this->classes_[local_index]);
+        std::lock_guard<psyq::spinlock> local_lock(local_class.lock);
+        if (local_class.free_blocks == nullptr)
+        {
+            local_class.free_blocks = this->allocate_chunk(
+                (local_index + 1) * this_type::CLASS_UNIT);
+            if (local_class.free_blocks == nullptr)
+            {
+                return nullptr;
+            }
+        }
+        auto const local_block(local_class.free_blocks);
+        local_class.free_blocks = local_block->next;
+        return local_block;
+    }
+
+    /// @brief メモリブロックを解放する。
+    /// @details 解放したメモリブロックは、同じ区分の割り当てで再利用される。
+    public: void deallocate(
+        /// [in] 解放するメモリブロックの先頭位置。
+        void* const in_memory,
+        /// [in] 解放するメモリブロックの大きさ。バイト単位。
+        std::size_t const in_size)
+    PSYQ_NOEXCEPT
+    {
+        if (in_memory == nullptr)
+        {
+            return;
+        }
+        if (this_type::CLASS_SIZE_MAX < in_size || in_size == 0)
+        {
+            this->allocator_.deallocate(
+                static_cast<typename this_type::chunk_unit*>(in_memory),
+                this_type::count_chunk_units(in_size));
+            return;
+        }
+        auto const local_block(
+            static_cast<typename this_type::free_block*>(in_memory));
+        auto& local_class(
+            this->classes_[(in_size - 1) / this_type::CLASS_UNIT]);
+        std::lock_guard<psyq::spinlock> local_lock(local_class.lock);
+        local_block->next = local_class.free_blocks;
+        local_class.free_blocks = local_block;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief コピー構築子は使用禁止。
+    private: packet_pool(this_type const&);
+    /// @brief コピー代入演算子は使用禁止。
+    private: this_type& operator=(this_type const&);
+
+    /// @brief メモリチャンクを確保し、メモリブロックに切り分ける。
+    /// @return 切り分けたメモリブロックのリストの先頭。
+    private: typename this_type::free_block* allocate_chunk(
+        /// [in] 切り分けるメモリブロックの大きさ。バイト単位。
+        std::size_t const in_block_size)
+    {
+        auto const local_header_size(
+            this_type::count_chunk_units(sizeof(typename this_type::chunk_header))
+            * sizeof(typename this_type::chunk_unit));
+        auto const local_chunk_units(
+            this_type::count_chunk_units(
+                local_header_size + (std::max)(in_block_size, this->chunk_size_)));
+        auto const local_memory(this->allocator_.allocate(local_chunk_units));
+        if (local_memory == nullptr)
+        {
+            return nullptr;
+        }
+
+        // メモリチャンクを登録する。
+        auto const local_chunk(
+            reinterpret_cast<typename this_type::chunk_header*>(local_memory));
+        local_chunk->size = local_chunk_units;
+        {
+            std::lock_guard<psyq::spinlock> local_lock(this->chunk_lock_);
+            local_chunk->next = this->chunks_;
+            this->chunks_ = local_chunk;
+        }
+        auto const local_chunk_bytes(
+            local_chunk_units * sizeof(typename this_type::chunk_unit));
+        this->reserved_bytes_.add(local_chunk_bytes);
+
+        // メモリチャンクをメモリブロックに切り分ける。
+        auto const local_begin(
+            reinterpret_cast<char*>(local_memory) + local_header_size);
+        auto const local_count(
+            (local_chunk_bytes - local_header_size) / in_block_size);
+        typename this_type::free_block* local_blocks(nullptr);
+        for (auto i(local_count); 0 < i; --i)
+        {
+            auto const local_block(
+                reinterpret_cast<typename this_type::free_block*>(
+                    local_begin + (i - 1) * in_block_size));
+            local_block->next = local_blocks;
+            local_blocks = local_block;
+        }
+        return local_blocks;
+    }
+
+    /// @brief 大きさを chunk_unit の数に変換する。
+    /// @return in_size を格納できる chunk_unit の数。
+    private: static std::size_t count_chunk_units(
+        /// [in] 変換する大きさ。バイト単位。
+        std::size_t const in_size)
+    PSYQ_NOEXCEPT
+    {
+        return (in_size + sizeof(typename this_type::chunk_unit) - 1)
+            / sizeof(typename this_type::chunk_unit);
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリチャンクの確保に使うメモリ割当子。
+    private: typename this_type::chunk_allocator allocator_;
+    /// @brief メモリブロックの大きさの区分。
+    private: typename this_type::size_class
+        classes_[PSYQ_EVENT_DRIVEN_PACKET_POOL_CLASS_COUNT];
+    /// @brief 確保したメモリチャンクのリスト。
+    private: typename this_type::chunk_header* chunks_;
+    /// @brief chunks_ の排他制御に使うロックオブジェクト。
+    private: psyq::spinlock chunk_lock_;
+    /// @brief 一度に確保するメモリチャンクの大きさ。バイト単位。
+    private: std::size_t chunk_size_;
+    /// @brief 確保しているメモリチャンクの大きさの合計。バイト単位。
+    private: psyq::atomic_count reserved_bytes_;
+
+}; // class psyq::event_driven::packet_pool
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief packet_pool からメモリを割り当てるメモリ割当子。
+/// @details
+///   - packet::create_zonal と packet::create_external に渡すと、
+///     メッセージパケットとその参照カウンタが packet_pool から割り当てられる。
+///   - メモリ割当子は packet_pool を強参照するので、
+///     メッセージパケットが残っている間は packet_pool も破棄されない。
+/// @tparam template_value     @copydoc packet_allocator::value_type
+/// @tparam template_allocator @copydoc packet_pool::allocator_type
+template<typename template_value, typename template_allocator>
+class psyq::event_driven::packet_allocator
+{
+    /// @copydoc psyq::string::view::this_type
+    private: typedef packet_allocator this_type;
+
+    /// @cond
+    template<typename, typename>
+    friend class psyq::event_driven::packet_allocator;
+    /// @endcond
+
+    //-------------------------------------------------------------------------
+    /// @brief 割り当てる値の型。
+    public: typedef template_value value_type;
+    /// @brief 割り当てる値へのポインタ。
+    public: typedef value_type* pointer;
+    /// @brief 割り当てる値への読み取り専用ポインタ。
+    public: typedef value_type const* const_pointer;
+    /// @brief 割り当てる値への参照。
+    public: typedef value_type& reference;
+    /// @brief 割り当てる値への読み取り専用参照。
+    public: typedef value_type const& const_reference;
+    /// @brief 要素数を表す型。
+    public: typedef std::size_t size_type;
+    /// @brief ポインタの差分を表す型。
+    public: typedef std::ptrdiff_t difference_type;
+    /// @brief メモリ割当子が使うメモリプール。
+    public: typedef psyq::event_driven::packet_pool<template_allocator> pool;
+
+    /// @brief 別の型を割り当てるメモリ割当子を取得する。
+    public: template<typename template_other> struct rebind
+    {
+        /// @brief template_other を割り当てるメモリ割当子の型。
+        typedef psyq::event_driven::packet_allocator<
+            template_other, template_allocator>
+                other;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリプールを使うメモリ割当子を構築する。
+    public: explicit packet_allocator(
+        /// [in] メモリ割当子が使うメモリプール。
+        typename this_type::pool::shared_ptr in_pool)
+    PSYQ_NOEXCEPT:
+    pool_(std::move(in_pool))
+    {
+        PSYQ_ASSERT(this->pool_.get() != nullptr);
+    }
+
+    /// @brief 別の型を割り当てるメモリ割当子から構築する。
+    public: template<typename template_other>
+    packet_allocator(
+        /// [in] メモリプールを共有するメモリ割当子。
+        psyq::event_driven::packet_allocator<
+            template_other, template_allocator>
+                const& in_source)
+    PSYQ_NOEXCEPT:
+    pool_(in_source.pool_)
+    {}
+
+    /// @brief メモリ割当子が使うメモリプールを取得する。
+    /// @return メモリ割当子が使うメモリプール。
+    public: typename this_type::pool::shared_ptr const& get_pool()
+    const PSYQ_NOEXCEPT
+    {
+        return this->pool_;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリを割り当てる。
+    /// @return 割り当てたメモリの先頭位置。
+    public: typename this_type::pointer allocate(
+        /// [in] 割り当てる値の数。
+        typename this_type::size_type const in_count)
+    {
+        return static_cast<typename this_type::pointer>(
+            this->pool_->allocate(
+                in_count * sizeof(template_value),
+                std::alignment_of<template_value>::value));
+    }
+
+    /// @brief メモリを解放する。
+    public: void deallocate(
+        /// [in] 解放するメモリの先頭位置。
+        typename this_type::pointer const in_memory,
+        /// [in] 解放する値の数。
+        typename this_type::size_type const in_count)
+    PSYQ_NOEXCEPT
+    {
+        this->pool_->deallocate(in_memory, in_count * sizeof(template_value));
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリ割当子を比較する。
+    /// @return 同じメモリプールを使っているか。
+    public: template<typename template_other>
+    bool operator==(
+        /// [in] 比較するメモリ割当子。
+        psyq::event_driven::packet_allocator<
+            template_other, template_allocator>
+                const& in_right)
+    const PSYQ_NOEXCEPT
+    {
+        return this->pool_ == in_right.pool_;
+    }
+
+    /// @brief メモリ割当子を比較する。
+    /// @return 異なるメモリプールを使っているか。
+    public: template<typename template_other>
+    bool operator!=(
+        /// [in] 比較するメモリ割当子。
+        psyq::event_driven::packet_allocator<
+            template_other, template_allocator>
+                const& in_right)
+    const PSYQ_NOEXCEPT
+    {
+        return !(*this == in_right);
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリ割当子が使うメモリプール。
+    private: typename this_type::pool::shared_ptr pool_;
+
+}; // class psyq::event_driven::packet_allocator
+
+#endif // !defined(PSYQ_EVENT_DRIVEN_PACKET_POOL_HPP_)
+// vim: set expandtab:
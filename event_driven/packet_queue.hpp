@@ -0,0 +1,186 @@
+﻿/// @file
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_EVENT_DRIVEN_PACKET_QUEUE_HPP_
+#define PSYQ_EVENT_DRIVEN_PACKET_QUEUE_HPP_
+
+#include <atomic>
+#include <memory>
+
+/// @cond
+namespace psyq
+{
+    namespace event_driven
+    {
+        template<typename, typename> class packet_queue;
+    } // namespace event_driven
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief ロックを使わない、複数送信者と単一受信者のメッセージパケット待ち行列。
+/// @details
+///   - this_type::push は、どのスレッドからでもロックなしで呼び出せる。
+///   - this_type::pop_all は、単一のスレッドからのみ呼び出すこと。
+///   - 同一スレッドから this_type::push した要素は、
+///     this_type::pop_all で取り出す順序が push 順序と同じになる。
+///   - 内部は、先頭ノードを atomic に差し替える単方向リストで、
+///     this_type::pop_all で全ノードを一括して取り出し、逆順に並べ直す。
+///   - ノードは this_type::allocator_type から割り当てる。
+///     packet_allocator を渡すと、ノードのメモリも再利用される。
+/// @tparam template_value     @copydoc packet_queue::value_type
+/// @tparam template_allocator @copydoc packet_queue::allocator_type
+template<typename template_value, typename template_allocator>
+class psyq::event_driven::packet_queue
+{
+    /// @copydoc psyq::string::view::this_type
+    private: typedef packet_queue this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 待ち行列の要素の型。
+    public: typedef template_value value_type;
+    /// @brief this_type で使うメモリ割当子。
+    public: typedef template_allocator allocator_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 待ち行列のノード。
+    private: struct node
+    {
+        node(typename packet_queue::value_type&& io_value):
+        next(nullptr),
+        value(std::move(io_value))
+        {}
+
+        /// @brief 次のノード。
+        node* next;
+        /// @brief ノードが持つ要素。
+        typename packet_queue::value_type value;
+    };
+    /// @brief ノードのメモリ割当子。
+    private: typedef
+        typename this_type::allocator_type::template rebind<
+            typename this_type::node>::other
+        node_allocator;
+
+    //-------------------------------------------------------------------------
+    /// @brief 空の待ち行列を構築する。
+    public: explicit packet_queue(
+        /// [in] *thisが使うメモリ割当子の初期値。
+        typename this_type::allocator_type const& in_allocator):
+    allocator_(in_allocator),
+    head_(nullptr)
+    {}
+
+    /// @brief 待ち行列に残っている要素を破棄する。
+    public: ~packet_queue()
+    {
+        this_type::destroy_nodes(
+            this->allocator_, this->head_.exchange(nullptr));
+    }
+
+    /// @brief メモリ割当子を取得する。
+    /// @return *thisが使っているメモリ割当子。
+    public: typename this_type::allocator_type get_allocator()
+    const PSYQ_NOEXCEPT
+    {
+        return this->allocator_;
+    }
+
+    /// @brief 待ち行列が空か判定する。
+    /// @details 他のスレッドが同時に push している場合、結果は目安でしかない。
+    /// @retval true  待ち行列は空。
+    /// @retval false 待ち行列は空ではない。
+    public: bool empty() const PSYQ_NOEXCEPT
+    {
+        return this->head_.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    /// @brief 待ち行列の末尾に要素を追加する。
+    /// @details どのスレッドからでも、ロックなしで呼び出せる。
+    /// @retval true  成功。要素を追加した。
+    /// @retval false 失敗。ノードのメモリ割当に失敗した。
+    public: bool push(
+        /// [in,out] 追加する要素。
+        typename this_type::value_type&& io_value)
+    {
+        auto const local_node(this->allocator_.allocate(1));
+        if (local_node == nullptr)
+        {
+            return false;
+        }
+        new(local_node) typename this_type::node(std::move(io_value));
+        local_node->next = this->head_.load(std::memory_order_relaxed);
+        while (
+            !this->head_.compare_exchange_weak(
+                local_node->next,
+                local_node,
+                std::memory_order_release,
+                std::memory_order_relaxed))
+        {}
+        return true;
+    }
+
+    /// @brief 待ち行列の要素をすべて取り出す。
+    /// @details
+    ///   - 単一のスレッドからのみ呼び出すこと。
+    ///   - 同一スレッドから push された要素は、push 順序で取り出される。
+    /// @return 取り出した要素の数。
+    public: template<typename template_container>
+    std::size_t pop_all(
+        /// [in,out] 取り出した要素を末尾に追加するコンテナ。
+        template_container& io_container)
+    {
+        // 全ノードを一括で取り出し、push 順序に並べ直す。
+        auto local_node(this->head_.exchange(nullptr, std::memory_order_acquire));
+        typename this_type::node* local_first(nullptr);
+        std::size_t local_count(0);
+        while (local_node != nullptr)
+        {
+            auto const local_next(local_node->next);
+            local_node->next = local_first;
+            local_first = local_node;
+            local_node = local_next;
+            ++local_count;
+        }
+
+        // 要素をコンテナへ移動し、ノードを破棄する。
+        io_container.reserve(io_container.size() + local_count);
+        for (auto i(local_first); i != nullptr; i = i->next)
+        {
+            io_container.emplace_back(std::move(i->value));
+        }
+        this_type::destroy_nodes(this->allocator_, local_first);
+        return local_count;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief コピー構築子は使用禁止。
+    private: packet_queue(this_type const&);
+    /// @brief コピー代入演算子は使用禁止。
+    private: this_type& operator=(this_type const&);
+
+    /// @brief ノードのリストを破棄する。
+    private: static void destroy_nodes(
+        /// [in,out] ノードの解放に使うメモリ割当子。
+        typename this_type::node_allocator& io_allocator,
+        /// [in] 破棄するリストの先頭ノード。
+        typename this_type::node* in_node)
+    {
+        while (in_node != nullptr)
+        {
+            auto const local_next(in_node->next);
+            in_node->~node();
+            io_allocator.deallocate(in_node, 1);
+            in_node = local_next;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief ノードのメモリ割当子。
+    private: typename this_type::node_allocator allocator_;
+    /// @brief 最後に push されたノード。
+    private: std::atomic<typename this_type::node*> head_;
+
+}; // class psyq::event_driven::packet_queue
+
+#endif // !defined(PSYQ_EVENT_DRIVEN_PACKET_QUEUE_HPP_)
+// vim: set expandtab:
@@ -39,6 +39,12 @@
 #include "./message.hpp"
 #include "./packet.hpp"
 #include "./dispatcher.hpp"
+#include "./bounded_queue.hpp"
+#include "./external_ring.hpp"
+#include "./latency_histogram.hpp"
+#include "./lane_executor.hpp"
+#include "./packet_pool.hpp"
+#include "./packet_queue.hpp"
 
 #ifndef PSYQ_EVENT_DRIVEN_ZONE_PACKET_DEFAULT
 #define PSYQ_EVENT_DRIVEN_ZONE_PACKET_DEFAULT\
@@ -50,6 +56,11 @@
 #define PSYQ_EVENT_DRIVEN_ZONE_PRIORITY_DEFAULT std::int32_t
 #endif // !defined(PSYQ_EVENT_DRIVEN_ZONE_PRIORITY_DEFAULT)
 
+/// zone::receive_external で取り込めるメッセージ引数の最大の大きさ。バイト単位。
+#ifndef PSYQ_EVENT_DRIVEN_ZONE_EXTERNAL_PARAMETER_CAPACITY
+#define PSYQ_EVENT_DRIVEN_ZONE_EXTERNAL_PARAMETER_CAPACITY 64
+#endif // !defined(PSYQ_EVENT_DRIVEN_ZONE_EXTERNAL_PARAMETER_CAPACITY)
+
 #ifndef PSYQ_EVENT_DRIVEN_ZONE_ALLOCATOR_DEFAULT
 #define PSYQ_EVENT_DRIVEN_ZONE_ALLOCATOR_DEFAULT std::allocator<void*>
 #endif // !defined(PSYQ_EVENT_DRIVEN_ZONE_ALLOCATOR_DEFAULT)
@@ -90,6 +101,54 @@ class psyq::event_driven::zone
     public: typedef typename this_type::message::tag tag;
     /// @brief this_type で使うメモリ割当子。
     public: typedef template_allocator allocator_type;
+    /// @brief this_type::receive_external で構築するメッセージパケット。
+    public: typedef
+        typename this_type::packet::template imported<
+            PSYQ_EVENT_DRIVEN_ZONE_EXTERNAL_PARAMETER_CAPACITY>
+        imported_packet;
+    /// @brief this_type::packet の構築に使うメモリ割当子。
+    /// @details this_type が持つ packet_pool からメモリを割り当てる。
+    public: typedef
+        psyq::event_driven::packet_allocator<
+            typename this_type::packet, typename this_type::allocator_type>
+        packet_allocator;
+
+    //-------------------------------------------------------------------------
+    /// @brief external_ring に書き込むメッセージの見出し。
+    /// @details 見出しの直後に、メッセージ引数のバイト列が続く。
+    private: struct external_header
+    {
+        /// @brief メッセージ引数のRTTI識別値。
+        psyq::any::rtti_key parameter_key;
+        /// @brief メッセージ引数の大きさ。バイト単位。
+        std::uint32_t parameter_size;
+        /// @brief メッセージ送信オブジェクトの識別値。
+        typename zone::tag::key_type sender_key;
+        /// @brief メッセージ受信オブジェクトの識別値。
+        typename zone::tag::key_type receiver_key;
+        /// @brief メッセージ受信オブジェクトの識別値マスク。
+        typename zone::tag::key_type receiver_mask;
+        /// @brief メッセージ受信関数の識別値。
+        typename zone::tag::key_type selector_key;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @brief this_type::take_snapshot で取得する、メッセージの流れの統計。
+    public: struct snapshot
+    {
+        /// @brief 送信予約したメッセージパケットの数。
+        std::size_t posted_count;
+        /// @brief dispatcher へ配送したメッセージパケットの数。
+        std::size_t delivered_count;
+        /// @brief 送信予約されていて、まだ配送していないメッセージパケットの数。
+        std::size_t queue_depth;
+        /// @brief queue_depth の最大値。
+        std::size_t high_water;
+        /// @brief 上限数を超えたので捨てたメッセージパケットの数。
+        std::size_t dropped_count;
+        /// @brief 送信予約から dispatcher へ配送するまでの待ち時間の度数分布。
+        psyq::event_driven::latency_histogram::snapshot post_to_dispatch;
+    };
 
     //-------------------------------------------------------------------------
     /// @copydoc this_type::dispatchers_
@@ -106,14 +165,39 @@ class psyq::event_driven::zone
         std::size_t const in_dispatcher_capacity,
         /// [in] this_type::packet の予約数。
         std::size_t const in_packet_capacity,
+        /// [in] 送信予約できるメッセージパケットの上限数。0なら無制限。
+        std::size_t const in_post_limit = 0,
+        /// [in] this_type::dispatcher が溜めておける、
+        /// メッセージパケットの束の上限数。0なら無制限。
+        std::size_t const in_batch_limit = 0,
+        /// [in] 上限数を超えた場合の方針。
+        psyq::event_driven::overflow_policy const in_overflow_policy =
+            psyq::event_driven::overflow_policy_BLOCK,
         /// [in] *thisが使うメモリ割当子の初期値。
         typename this_type::allocator_type const& in_allocator =
             template_allocator()):
     dispatchers_(in_allocator),
-    delivery_packets_(in_allocator)
+    delivery_batch_(
+        std::allocate_shared<
+            typename this_type::dispatcher::packet_shared_ptr_container>(
+                in_allocator, in_allocator)),
+    packet_allocator_(
+        std::allocate_shared<typename this_type::packet_allocator::pool>(
+            in_allocator, in_allocator)),
+    posted_packets_(this->packet_allocator_),
+    bounded_packets_(in_post_limit, in_allocator),
+    posted_size_(0),
+    dropped_count_(0),
+    high_water_(0),
+    posted_count_(0),
+    delivered_count_(0),
+    timestamp_enabled_(false),
+    batch_limit_(in_batch_limit),
+    overflow_policy_(in_overflow_policy),
+    external_ring_(nullptr)
     {
         this->dispatchers_.reserve(in_dispatcher_capacity);
-        this->delivery_packets_.reserve(in_packet_capacity);
+        this->delivery_batch_->reserve(in_packet_capacity);
     }
 
     /// @brief メモリ割当子を取得する。
@@ -124,6 +208,91 @@ class psyq::event_driven::zone
         return this->dispatchers_.get_allocator();
     }
 
+    /// @brief this_type::packet の構築に使うメモリ割当子を取得する。
+    /// @details
+    ///   this_type::post で送信する構築済のメッセージパケットも、
+    ///   このメモリ割当子で構築すると、メモリが再利用される。
+    /// @return this_type が持つ packet_pool からメモリを割り当てるメモリ割当子。
+    public: typename this_type::packet_allocator const& get_packet_allocator()
+    const PSYQ_NOEXCEPT
+    {
+        return this->packet_allocator_;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @name メッセージの流れの統計
+    /// @{
+
+    /// @brief 送信予約されているメッセージパケットの数を取得する。
+    /// @details 他のスレッドで送信予約している途中のものも含む。
+    /// @return 送信予約されているメッセージパケットの数。
+    public: std::size_t get_posted_size() const PSYQ_NOEXCEPT
+    {
+        return this->posted_size_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief 送信予約されたメッセージパケットの数の最大値を取得する。
+    /// @return 送信予約されたメッセージパケットの数の最大値。
+    public: std::size_t get_high_water() const PSYQ_NOEXCEPT
+    {
+        return this->high_water_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief 上限数を超えたので捨てたメッセージパケットの数を取得する。
+    /// @details
+    ///   overflow_policy_FAIL で送信予約に失敗したものや、
+    ///   this_type::post_external で external_ring
+    ///   に書き込めなかったもの、 this_type::receive_external
+    ///   で読み出したメッセージが壊れていたものも含む。
+    /// @return 捨てたメッセージパケットの数。
+    public: std::size_t get_dropped_count() const PSYQ_NOEXCEPT
+    {
+        return this->dropped_count_.load(std::memory_order_relaxed);
+    }
+
+    /// @brief メッセージの流れの統計を取得する。
+    /// @details
+    ///   どのスレッドからでも、ロックなしで呼び出せる。
+    ///   待ち時間は、 this_type::enable_timestamp
+    ///   で時刻印を有効にしている間だけ記録される。
+    /// @return メッセージの流れの統計。
+    public: typename this_type::snapshot take_snapshot() const PSYQ_NOEXCEPT
+    {
+        typename this_type::snapshot local_snapshot;
+        local_snapshot.posted_count =
+            this->posted_count_.load(std::memory_order_relaxed);
+        local_snapshot.delivered_count =
+            this->delivered_count_.load(std::memory_order_relaxed);
+        local_snapshot.queue_depth = this->get_posted_size();
+        local_snapshot.high_water = this->get_high_water();
+        local_snapshot.dropped_count = this->get_dropped_count();
+        local_snapshot.post_to_dispatch =
+            this->post_to_dispatch_.take_snapshot();
+        return local_snapshot;
+    }
+
+    /// @brief メッセージパケットの時刻印を有効にするか設定する。
+    /// @details
+    ///   有効にすると、送信予約と配送の時刻をメッセージパケットに記録し、
+    ///   待ち時間を度数分布に記録する。時計の読み出しが増えるので、
+    ///   計測するときだけ有効にすること。
+    public: void enable_timestamp(
+        /// [in] 時刻印を有効にするか。
+        bool const in_enable)
+    PSYQ_NOEXCEPT
+    {
+        this->timestamp_enabled_.store(in_enable, std::memory_order_relaxed);
+    }
+
+    /// @brief 上限数を超えた場合の方針を取得する。
+    /// @return 上限数を超えた場合の方針。
+    public: psyq::event_driven::overflow_policy get_overflow_policy()
+    const PSYQ_NOEXCEPT
+    {
+        return this->overflow_policy_;
+    }
+    /// @}
+
     //-------------------------------------------------------------------------
     /// @name メッセージの送受信
     /// @{
@@ -133,6 +302,10 @@ class psyq::event_driven::zone
     ///   - この関数と、 this_type::equip_dispatcher からスレッドごとに取得した
     ///     this_type::dispatcher インスタンスの this_type::dispatcher::dispatch
     ///     を定期的に呼び出し、メッセージパケットを循環させること。
+    ///   - 送信予約されたメッセージパケットをすべて取り出してから、
+    ///     this_type::dispatcher へ配送する。
+    ///     送信予約の上限数がある場合は、他のスレッドが送信予約し続けても
+    ///     終わるように、一度に取り出すのは待ち行列の容量までとする。
     ///   - this_type::lock_ でロックの獲得を待ってから実行される。
     ///     ロックを獲得している他のスレッドからブロックされることに注意。
     public: void dispatch(
@@ -142,9 +315,29 @@ class psyq::event_driven::zone
         bool const in_rebuild = false)
     {
         std::lock_guard<psyq::spinlock> local_lock(this->lock_);
-        this_type::deliver_packets(this->dispatchers_, this->delivery_packets_);
-        this_type::dispatcher::clear_packets(
-            this->delivery_packets_, in_capacity, in_rebuild);
+        auto& local_batch(
+            this_type::prepare_batch(
+                this->delivery_batch_, in_capacity, in_rebuild));
+        auto const local_count(
+            this->bounded_packets_.get_capacity() != 0?
+                this->bounded_packets_.pop_all(local_batch):
+                this->posted_packets_.pop_all(local_batch));
+        if (0 < local_count)
+        {
+            this->posted_size_.fetch_sub(
+                local_count, std::memory_order_relaxed);
+            this->delivered_count_.fetch_add(
+                local_count, std::memory_order_relaxed);
+            if (this->timestamp_enabled_.load(std::memory_order_relaxed))
+            {
+                this_type::stamp_dispatch_time(
+                    this->post_to_dispatch_, local_batch);
+            }
+            this_type::deliver_packets(
+                this->dispatchers_,
+                typename this_type::dispatcher::packet_batch_shared_ptr(
+                    this->delivery_batch_));
+        }
     }
 
     /// @brief スレッドに合致する this_type::dispatcher を用意する。
@@ -170,14 +363,88 @@ class psyq::event_driven::zone
             this_type::create_dispatcher(
                 this->dispatchers_,
                 in_thread_id,
-                this->delivery_packets_.capacity(),
+                0,
+                PSYQ_EVENT_DRIVEN_DISPATCHER_BATCH_CAPACITY_DEFFAULT,
+                PSYQ_EVENT_DRIVEN_DISPATCHER_RECEIVER_CAPACITY_DEFFAULT,
+                PSYQ_EVENT_DRIVEN_DISPATCHER_FORWARDER_CAPACITY_DEFFAULT,
+                this->batch_limit_,
+                this->overflow_policy_);
+    }
+
+    /// @brief 実行レーンに合致する this_type::dispatcher を用意する。
+    /// @details
+    ///   - 実行レーンは、スレッドではなく論理的な実行単位に合致する
+    ///     this_type::dispatcher 。
+    ///     this_type::schedule_lanes で、 lane_executor
+    ///     のワーカースレッドから処理される。
+    ///   - 実行レーンは一度に一つのスレッドからしか処理されないので、
+    ///     実行レーンごとのメッセージの受信順序は保たれる。
+    ///   - メッセージ受信関数を登録するときなどは、
+    ///     dispatcher::lock で実行レーンを占有してから呼び出すこと。
+    ///   - 用意した this_type::dispatcher の所有権は、ユーザーが管理すること。
+    ///   - this_type::lock_ でロックの獲得を待ってから実行される。
+    ///     ロックを獲得している他のスレッドからブロックされることに注意。
+    /// .
+    /// @return in_lane_key に合致する実行レーンの this_type::dispatcher 。
+    public: typename this_type::dispatcher::shared_ptr equip_lane(
+        /// [in] 用意する実行レーンの識別値。
+        std::size_t const in_lane_key)
+    {
+        std::lock_guard<psyq::spinlock> local_lock(this->lock_);
+        auto const local_lane(
+            this_type::find_lane(this->dispatchers_, in_lane_key));
+        return local_lane.get() != nullptr?
+            local_lane:
+            this_type::create_dispatcher(
+                this->dispatchers_,
+                std::thread::id(),
+                in_lane_key,
+                PSYQ_EVENT_DRIVEN_DISPATCHER_BATCH_CAPACITY_DEFFAULT,
                 PSYQ_EVENT_DRIVEN_DISPATCHER_RECEIVER_CAPACITY_DEFFAULT,
-                PSYQ_EVENT_DRIVEN_DISPATCHER_FORWARDER_CAPACITY_DEFFAULT);
+                PSYQ_EVENT_DRIVEN_DISPATCHER_FORWARDER_CAPACITY_DEFFAULT,
+                this->batch_limit_,
+                this->overflow_policy_);
+    }
+
+    /// @brief 実行レーンの処理を lane_executor に登録する。
+    /// @details
+    ///   - this_type::dispatch の後に呼び出し、配送したメッセージパケットを
+    ///     lane_executor のワーカースレッドで実行レーンに受信させる。
+    ///   - すでに実行が予約されている実行レーンは、重ねて登録しない。
+    ///   - this_type::lock_ でロックの獲得を待ってから実行される。
+    ///     ロックを獲得している他のスレッドからブロックされることに注意。
+    /// @return 登録した実行レーンの数。
+    public: std::size_t schedule_lanes(
+        /// [in,out] 実行レーンの処理を登録する lane_executor 。
+        psyq::event_driven::lane_executor& io_executor)
+    {
+        std::size_t local_count(0);
+        std::lock_guard<psyq::spinlock> local_lock(this->lock_);
+        for (auto const& local_observer: this->dispatchers_)
+        {
+            auto const local_holder(local_observer.lock());
+            auto const local_lane(local_holder.get());
+            if (local_lane != nullptr
+                && local_lane->is_lane()
+                && !local_lane->exchange_lane_scheduled(true))
+            {
+                typename this_type::dispatcher::weak_ptr const local_weak(
+                    local_holder);
+                io_executor.submit(
+                    [&io_executor, local_weak]()
+                    {
+                        this_type::run_lane(io_executor, local_weak);
+                    });
+                ++local_count;
+            }
+        }
+        return local_count;
     }
 
     /// @brief メッセージゾーンの内と外へのメッセージの送信を予約する。
     /// @details
-    ///   - 引数を持たないメッセージパケットを動的メモリ割当して構築し、
+    ///   - 引数を持たないメッセージパケットを
+    ///     this_type::get_packet_allocator から割り当てて構築し、
     ///     メッセージゾーンの内と外への送信を予約する。
     ///   - この関数では、メッセージ送信の予約のみを行う。
     ///     メッセージを実際に送信する処理は、この関数の呼び出し後、
@@ -186,8 +453,8 @@ class psyq::event_driven::zone
     ///     dispatcher::dispatch を呼び出すことで行なわれる。
     ///   - 同一スレッドで送信を予約したメッセージの受信順序は、
     ///     送信予約順序と同じになる。
-    ///   - this_type::lock_ でロックの獲得を待ってから実行される。
-    ///     ロックを獲得している他のスレッドからブロックされることに注意。
+    ///   - ロックを獲得せずに送信を予約するので、
+    ///     他のスレッドからブロックされることはない。
     /// .
     /// @sa
     ///   - 構築済のメッセージパケットを送信するには、 this_type::post を使う。
@@ -196,36 +463,45 @@ class psyq::event_driven::zone
     ///   - this_type::dispatcher
     ///     に登録されているメッセージ受信関数にのみメッセージを送信するには、
     ///     dispatcher::send_local を使う。
-    /// @todo メッセージゾーンの外へ送信する処理は未実装。
-    public: void post_external(
+    ///   - メッセージゾーンの外へは、 this_type::set_external_ring
+    ///     で設定した external_ring を経由して送信する。
+    /// @retval true  成功。メッセージゾーン内への送信を予約した。
+    /// @retval false
+    ///   失敗。メッセージの送信を予約しなかった。
+    ///   overflow_policy_FAIL か overflow_policy_DROP_NEWEST
+    ///   で、上限数を超えた場合など。
+    public: bool post_external(
         /// [in] 送信するメッセージの送り状。
         typename this_type::tag const& in_tag)
     {
-        this->post(
+        return this->post_external(
             this_type::packet::create_external(
                 typename this_type::packet::message(in_tag),
-                this->get_allocator()),
-            true);
+                this->packet_allocator_));
     }
 
     /// @copydoc this_type::post_external
     public: template<typename template_parameter>
-    void post_external(
+    bool post_external(
         /// [in] 送信するメッセージの送り状。
         typename this_type::tag const& in_tag,
         /// [in] 送信するメッセージの引数。POD型であること。
         template_parameter&& io_parameter)
     {
-        this->post(
+        static_assert(
+            std::is_trivially_copyable<
+                typename std::decay<template_parameter>::type>::value,
+            "template_parameter must be trivially copyable.");
+        return this->post_external(
             this_type::packet::create_external(
                 this_type::message::construct(in_tag, std::move(io_parameter)),
-                this->get_allocator()),
-            true);
+                this->packet_allocator_));
     }
 
     /// @brief メッセージゾーン内へのメッセージの送信を予約する。
     /// @details
-    ///   - 引数を持たないメッセージパケットを動的メモリ割当して構築し、
+    ///   - 引数を持たないメッセージパケットを
+    ///     this_type::get_packet_allocator から割り当てて構築し、
     ///     メッセージゾーン内への送信を予約する。
     ///   - この関数では、メッセージ送信の予約のみを行う。
     ///     メッセージを実際に送信する処理は、この関数の呼び出し後、
@@ -234,8 +510,8 @@ class psyq::event_driven::zone
     ///     dispatcher::dispatch を呼び出すことで行なわれる。
     ///   - 同一スレッドで送信を予約したメッセージの受信順序は、
     ///     送信予約順序と同じになる。
-    ///   - this_type::lock_ でロックの獲得を待ってから実行される。
-    ///     ロックを獲得している他のスレッドからブロックされることに注意。
+    ///   - ロックを獲得せずに送信を予約するので、
+    ///     他のスレッドからブロックされることはない。
     /// .
     /// @sa
     ///   - 構築済のメッセージパケットを送信するには、 this_type::post を使う。
@@ -244,34 +520,44 @@ class psyq::event_driven::zone
     ///   - this_type::dispatcher
     ///     に登録されているメッセージ受信関数にのみメッセージを送信するには、
     ///     dispatcher::send_local を使う。
-    public: void post_zonal(
+    /// @retval true  成功。メッセージの送信を予約した。
+    /// @retval false
+    ///   失敗。メッセージの送信を予約しなかった。
+    ///   overflow_policy_FAIL か overflow_policy_DROP_NEWEST
+    ///   で、上限数を超えた場合など。
+    public: bool post_zonal(
         /// [in] 送信するメッセージの送り状。
         typename this_type::tag const& in_tag)
     {
-        this->post(
+        return this->post(
             this_type::packet::create_zonal(
                 typename this_type::packet::message(in_tag),
-                this->get_allocator()),
+                this->packet_allocator_),
             true);
     }
 
     /// @copydoc this_type::post_zonal
     public: template<typename template_parameter>
-    void post_zonal(
+    bool post_zonal(
         /// [in] 送信するメッセージの送り状。
         typename this_type::tag const& in_tag,
         /// [in] 送信するメッセージの引数。
         template_parameter&& io_parameter)
     {
-        this->post(
+        return this->post(
             this_type::packet::create_zonal(
                 this_type::message::construct(in_tag, std::move(io_parameter)),
-                this->get_allocator()),
+                this->packet_allocator_),
             true);
     }
 
     /// @brief メッセージの送信を予約する。
     /// @details
+    ///   - 構築子で送信予約の上限数を指定した場合、上限数を超えると
+    ///     psyq::event_driven::overflow_policy に従う。
+    ///     overflow_policy_BLOCK では、 this_type::dispatch
+    ///     で空きができるまでブロックするので、
+    ///     this_type::dispatch を呼び出すスレッドからは呼び出さないこと。
     ///   - この関数では、メッセージ送信の予約のみを行う。
     ///     メッセージを実際に送信する処理は、この関数の呼び出し後、
     ///     this_type::dispatch を呼び出すことで行なわれる。
@@ -279,8 +565,8 @@ class psyq::event_driven::zone
     ///     dispatcher::dispatch を呼び出すことで行なわれる。
     ///   - 同一スレッドで送信を予約したメッセージの受信順序は、
     ///     送信予約順序と同じになる。
-    ///   - this_type::lock_ でロックの獲得を待ってから実行される。
-    ///     ロックを獲得している他のスレッドからブロックされることに注意。
+    ///   - ロックを獲得せずに送信を予約するので、
+    ///     他のスレッドからブロックされることはない。
     /// .
     /// @retval true  成功。メッセージの送信を予約した。
     /// @retval false 失敗。メッセージの送信を予約しなかった。
@@ -292,6 +578,61 @@ class psyq::event_driven::zone
     }
     /// @}
     //-------------------------------------------------------------------------
+    /// @name メッセージゾーン外との送受信
+    /// @{
+
+    /// @brief メッセージゾーン外への送信に使う external_ring を設定する。
+    /// @details
+    ///   - 設定した後は、 this_type::post_external で送信するメッセージが
+    ///     external_ring にも書き込まれる。
+    ///   - メッセージ引数のRTTI識別値で型を特定するので、
+    ///     送信側と受信側のプロセスで、同じRTTI識別値を
+    ///     psyq::any::rtti::make に明示して構築しておくこと。
+    ///   - メッセージを送信している間は、変更しないこと。
+    public: void set_external_ring(
+        /// [in] 設定する external_ring 。nullptrなら、外へは送信しない。
+        psyq::event_driven::external_ring* const in_ring)
+    PSYQ_NOEXCEPT
+    {
+        this->external_ring_ = in_ring;
+    }
+
+    /// @brief external_ring から読み出したメッセージの送信を予約する。
+    /// @details
+    ///   - 読み出したメッセージから this_type::imported_packet を構築し、
+    ///     メッセージゾーン内への送信を予約する。
+    ///   - メッセージを実際に送信する処理は、この関数の呼び出し後、
+    ///     this_type::dispatch を呼び出すことで行なわれる。
+    ///   - 壊れていたメッセージや、RTTIが見つからないメッセージは捨てて、
+    ///     this_type::get_dropped_count で数える。
+    /// @return 送信を予約したメッセージの数。捨てたメッセージは含まない。
+    public: std::size_t receive_external(
+        /// [in,out] メッセージを読み出す external_ring 。
+        psyq::event_driven::external_ring& io_ring,
+        /// [in] 読み出すメッセージの最大数。
+        std::size_t const in_max_count = (std::numeric_limits<std::size_t>::max)())
+    {
+        std::size_t local_read_count(0);
+        std::size_t local_import_count(0);
+        while (
+            local_read_count < in_max_count
+            && io_ring.consume(
+                [this, &local_import_count](
+                    void const* const in_data,
+                    std::size_t const in_size)
+                {
+                    if (this->import_packet(in_data, in_size))
+                    {
+                        ++local_import_count;
+                    }
+                }))
+        {
+            ++local_read_count;
+        }
+        return local_import_count;
+    }
+    /// @}
+    //-------------------------------------------------------------------------
     /// @brief コピー構築子は使用禁止。
     private: zone(this_type const&);
     /// @brief コピー代入演算子は使用禁止。
@@ -309,11 +650,231 @@ class psyq::event_driven::zone
             PSYQ_ASSERT(!in_assert);
             return false;
         }
-        std::lock_guard<psyq::spinlock> local_lock(this->lock_);
-        this->delivery_packets_.emplace_back(std::move(io_packet));
+        if (this->timestamp_enabled_.load(std::memory_order_relaxed))
+        {
+            io_packet->set_post_time(
+                psyq::event_driven::latency_histogram::now());
+        }
+
+        // 待ち行列に追加した直後に他のスレッドで取り出されても
+        // this_type::posted_size_ が負にならないよう、追加する前に数えておき、
+        // 追加に失敗したら戻す。
+        auto const local_posted_size(
+            this->posted_size_.fetch_add(1, std::memory_order_relaxed) + 1);
+        bool local_push;
+        if (this->bounded_packets_.get_capacity() == 0)
+        {
+            local_push = this->posted_packets_.push(std::move(io_packet));
+            PSYQ_ASSERT(local_push || !in_assert);
+        }
+        else
+        {
+            local_push = this->push_bounded(std::move(io_packet));
+        }
+        if (!local_push)
+        {
+            this->posted_size_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        // 上限数がある待ち行列では、送信予約中のものを数えないよう、
+        // 待ち行列の位置から求めた要素数を最大値とする。
+        this_type::update_high_water(
+            this->high_water_,
+            this->bounded_packets_.get_capacity() != 0?
+                this->bounded_packets_.size(): local_posted_size);
+        this->posted_count_.fetch_add(1, std::memory_order_relaxed);
         return true;
     }
 
+    /// @brief 配送するメッセージパケットに、配送した時刻を設定する。
+    /// @details 送信予約した時刻を持つメッセージパケットは、待ち時間を記録する。
+    private: static void stamp_dispatch_time(
+        /// [in,out] 送信予約から配送までの待ち時間を記録する度数分布。
+        psyq::event_driven::latency_histogram& io_histogram,
+        /// [in,out] 配送するメッセージパケットのコンテナ。
+        typename this_type::dispatcher::packet_shared_ptr_container const&
+            in_packets)
+    {
+        auto const local_now(psyq::event_driven::latency_histogram::now());
+        for (auto const& local_packet: in_packets)
+        {
+            auto const local_post_time(local_packet->get_post_time());
+            if (local_post_time != 0)
+            {
+                io_histogram.record(local_now - local_post_time);
+            }
+            local_packet->set_dispatch_time(local_now);
+        }
+    }
+
+    /// @brief 上限数のある待ち行列に、メッセージパケットを追加する。
+    /// @details 待ち行列が満杯なら、 this_type::overflow_policy_ に従う。
+    /// @retval true  メッセージパケットを追加した。
+    /// @retval false メッセージパケットを追加しなかった。
+    private: bool push_bounded(
+        /// [in] 追加するメッセージパケット。
+        typename this_type::packet::shared_ptr&& io_packet)
+    {
+        while (!this->bounded_packets_.try_push(std::move(io_packet)))
+        {
+            switch (this->overflow_policy_)
+            {
+                case psyq::event_driven::overflow_policy_BLOCK:
+                std::this_thread::yield();
+                break;
+
+                case psyq::event_driven::overflow_policy_DROP_OLDEST:
+                {
+                    typename this_type::packet::shared_ptr local_oldest;
+                    if (this->bounded_packets_.try_pop(local_oldest))
+                    {
+                        this->posted_size_.fetch_sub(
+                            1, std::memory_order_relaxed);
+                        this->dropped_count_.fetch_add(
+                            1, std::memory_order_relaxed);
+                    }
+                    break;
+                }
+
+                case psyq::event_driven::overflow_policy_DROP_NEWEST:
+                this->dropped_count_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+
+                default:
+                this->dropped_count_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief 最大値を更新する。
+    private: static void update_high_water(
+        /// [in,out] 更新する最大値。
+        std::atomic<std::size_t>& io_high_water,
+        /// [in] 比較する値。
+        std::size_t const in_value)
+    {
+        auto local_high_water(io_high_water.load(std::memory_order_relaxed));
+        while (
+            local_high_water < in_value
+            && !io_high_water.compare_exchange_weak(
+                local_high_water, in_value, std::memory_order_relaxed))
+        {}
+    }
+
+    /// @brief メッセージゾーンの内と外への送信を予約する。
+    /// @details
+    ///   - メッセージゾーン内への送信を予約できた場合にだけ、
+    ///     external_ring に書き込む。
+    ///   - external_ring が満杯か、メッセージ引数が大きすぎて書き込めない場合は、
+    ///     捨てたメッセージパケットとして数える。
+    /// @retval true  成功。メッセージゾーン内への送信を予約した。
+    /// @retval false 失敗。どこへも送信しなかった。
+    private: bool post_external(
+        /// [in] 送信するメッセージを持つメッセージパケット。
+        typename this_type::packet::shared_ptr&& io_packet)
+    {
+        auto const local_ring(this->external_ring_);
+        if (local_ring == nullptr)
+        {
+            return this->post(std::move(io_packet), true);
+        }
+
+        // 送信予約すると、他のスレッドで配送されて破棄されることがあるので、
+        // 書き込み終わるまで所有権を持っておく。
+        typename this_type::packet::shared_ptr const local_packet(io_packet);
+        if (!this->post(std::move(io_packet), true))
+        {
+            return false;
+        }
+        if (!this_type::export_packet(*local_ring, *local_packet))
+        {
+            this->dropped_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    /// @brief メッセージパケットを external_ring に書き込む。
+    /// @retval true  成功。書き込んだ。
+    /// @retval false 失敗。書き込まなかった。
+    private: static bool export_packet(
+        /// [in,out] 書き込む external_ring 。
+        psyq::event_driven::external_ring& io_ring,
+        /// [in] 書き込むメッセージパケット。
+        typename this_type::packet const& in_packet)
+    {
+        auto const local_message(in_packet.get_external_message());
+        auto const local_rtti(in_packet.get_parameter_rtti());
+        if (local_message == nullptr || local_rtti == nullptr)
+        {
+            return false;
+        }
+        auto const& local_tag(local_message->get_tag());
+        typename this_type::external_header const local_header = {
+            local_rtti->get_key(),
+            static_cast<std::uint32_t>(local_message->get_parameter_size()),
+            local_tag.get_sender_key(),
+            local_tag.get_receiver_key(),
+            local_tag.get_receiver_mask(),
+            local_tag.get_selector_key()};
+        return io_ring.produce(
+            sizeof(local_header) + local_header.parameter_size,
+            [&local_header, local_message](void* const out_payload)
+            {
+                std::memcpy(out_payload, &local_header, sizeof(local_header));
+                std::memcpy(
+                    static_cast<char*>(out_payload) + sizeof(local_header),
+                    local_message->get_parameter_data(),
+                    local_header.parameter_size);
+            });
+    }
+
+    /// @brief external_ring から読み出したメッセージの送信を予約する。
+    /// @details
+    ///   external_ring は別のプロセスと共有するので、読み出したメッセージは
+    ///   信用せずに検証し、壊れていたら this_type::dropped_count_ で数える。
+    /// @retval true  成功。メッセージの送信を予約した。
+    /// @retval false
+    ///   失敗。メッセージが壊れているか、RTTIが見つからないか、
+    ///   送信予約に失敗した。
+    private: bool import_packet(
+        /// [in] 読み出したメッセージの先頭位置。
+        void const* const in_data,
+        /// [in] 読み出したメッセージの大きさ。バイト単位。
+        std::size_t const in_size)
+    {
+        typename this_type::external_header local_header;
+        if (in_size < sizeof(local_header))
+        {
+            this->dropped_count_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        std::memcpy(&local_header, in_data, sizeof(local_header));
+        auto const local_rtti(
+            psyq::any::rtti::find(local_header.parameter_key));
+        if (in_size < sizeof(local_header) + local_header.parameter_size
+            || PSYQ_EVENT_DRIVEN_ZONE_EXTERNAL_PARAMETER_CAPACITY
+                < local_header.parameter_size
+            || local_rtti == nullptr)
+        {
+            this->dropped_count_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return this->post(
+            std::allocate_shared<typename this_type::imported_packet>(
+                this->packet_allocator_,
+                typename this_type::tag(
+                    local_header.sender_key,
+                    local_header.receiver_key,
+                    local_header.selector_key,
+                    local_header.receiver_mask),
+                local_rtti,
+                static_cast<char const*>(in_data) + sizeof(local_header),
+                local_header.parameter_size),
+            false);
+    }
+
     /// @brief this_type::dispatcher をコンテナから検索する。
     /// @return
     ///   検索した this_type::dispatcher を強参照するスマートポインタ。
@@ -329,6 +890,7 @@ class psyq::event_driven::zone
             auto const local_holder(local_observer.lock());
             auto const local_dispatcher(local_holder.get());
             if (local_dispatcher != nullptr
+                && !local_dispatcher->is_lane()
                 && local_dispatcher->get_thread_id() == in_thread_id)
             {
                 return local_holder;
@@ -337,6 +899,73 @@ class psyq::event_driven::zone
         return typename this_type::dispatcher::shared_ptr();
     }
 
+    /// @brief 実行レーンの this_type::dispatcher をコンテナから検索する。
+    /// @return
+    ///   検索した this_type::dispatcher を強参照するスマートポインタ。
+    ///   見つからなかった場合、スマートポインタは空となる。
+    private: static typename this_type::dispatcher::shared_ptr find_lane(
+        /// [in] 検索する this_type::dispatcher のコンテナ。
+        typename this_type::dispatcher_weak_ptr_container const& in_dispatchers,
+        /// [in] 検索する実行レーンの識別値。
+        std::size_t const in_lane_key)
+    {
+        for (auto const& local_observer: in_dispatchers)
+        {
+            auto const local_holder(local_observer.lock());
+            auto const local_dispatcher(local_holder.get());
+            if (local_dispatcher != nullptr
+                && local_dispatcher->is_lane()
+                && local_dispatcher->get_lane_key() == in_lane_key)
+            {
+                return local_holder;
+            }
+        }
+        return typename this_type::dispatcher::shared_ptr();
+    }
+
+    /// @brief 実行レーンを占有して、メッセージ受信関数を呼び出す。
+    /// @details
+    ///   他のスレッドが実行レーンを占有していた場合は、処理を保留し、
+    ///   占有を解除したスレッドが lane_executor に処理を登録しなおす。
+    ///   保留している間は実行予約を解除しないので、
+    ///   this_type::schedule_lanes からも重ねて登録されない。
+    private: static void run_lane(
+        /// [in,out] 処理を登録しなおす lane_executor 。
+        psyq::event_driven::lane_executor& io_executor,
+        /// [in] 実行する実行レーン。
+        typename this_type::dispatcher::weak_ptr const& in_lane)
+    {
+        auto const local_holder(in_lane.lock());
+        auto const local_lane(local_holder.get());
+        if (local_lane == nullptr)
+        {
+            return;
+        }
+
+        if (local_lane->try_lock())
+        {
+            // 予約を解除してから実行するので、
+            // 実行中に届いたメッセージパケットは、次の予約で処理される。
+            local_lane->exchange_lane_scheduled(false);
+            local_lane->dispatch();
+            local_lane->unlock();
+        }
+        else
+        {
+            // 登録しなおすまで io_executor が待機状態にならないよう予約する。
+            io_executor.reserve();
+            local_lane->defer_lane(
+                [&io_executor, in_lane]()
+                {
+                    io_executor.submit_reserved(
+                        [&io_executor, in_lane]()
+                        {
+                            this_type::run_lane(io_executor, in_lane);
+                        });
+                });
+        }
+    }
+
     /// @brief this_type::dispatcher を生成し、コンテナに追加する。
     /// @return
     ///   生成した this_type::dispatcher を強参照するスマートポインタ。
@@ -346,12 +975,18 @@ class psyq::event_driven::zone
         typename this_type::dispatcher_weak_ptr_container& io_dispatchers,
         /// [in] 生成する this_type::dispatcher に対応するスレッドの識別子。
         std::thread::id const& in_thread_id,
-        /// [in] メッセージパケットの予約数。
-        std::size_t const in_packet_capacity,
+        /// [in] 生成する this_type::dispatcher に対応する実行レーンの識別値。
+        std::size_t const in_lane_key,
+        /// [in] メッセージパケットの束の予約数。
+        std::size_t const in_batch_capacity,
         /// [in] メッセージ受信関数の予約数。
         std::size_t const in_receiver_capacity,
         /// [in] メッセージ転送関数の予約数。
-        std::size_t const in_forwarder_capacity)
+        std::size_t const in_forwarder_capacity,
+        /// [in] 溜めておけるメッセージパケットの束の上限数。
+        std::size_t const in_batch_limit,
+        /// [in] 上限数を超えた場合の方針。
+        psyq::event_driven::overflow_policy const in_overflow_policy)
     {
         // this_type::dispatcher を構築する。
         auto const local_allocator(io_dispatchers.get_allocator());
@@ -359,9 +994,12 @@ class psyq::event_driven::zone
             std::allocate_shared<typename this_type::dispatcher>(
                 local_allocator,
                 in_thread_id,
-                in_packet_capacity,
+                in_lane_key,
+                in_batch_capacity,
                 in_receiver_capacity,
                 in_forwarder_capacity,
+                in_batch_limit,
+                in_overflow_policy,
                 local_allocator));
         if (local_dispatcher.get() != nullptr)
         {
@@ -374,13 +1012,51 @@ class psyq::event_driven::zone
         return local_dispatcher;
     }
 
-    /// @brief this_type::dispatcher へメッセージパケットを配送する。
+    /// @brief メッセージパケットの束を、再利用するか新たに構築する。
+    /// @details
+    ///   前回配送した束をどの this_type::dispatcher も参照していなければ、
+    ///   空にして再利用する。まだ参照されていれば、変更せずに手放し、
+    ///   新たな束を構築する。
+    /// @return 空のメッセージパケットの束。
+    private: static typename this_type::dispatcher::packet_shared_ptr_container&
+    prepare_batch(
+        /// [in,out] 前回配送したメッセージパケットの束。
+        std::shared_ptr<
+            typename this_type::dispatcher::packet_shared_ptr_container>&
+                io_batch,
+        /// [in] メッセージパケットの予約数。
+        std::size_t const in_capacity,
+        /// [in] メッセージパケットのコンテナを再構築するか。
+        bool const in_rebuild)
+    {
+        if (io_batch.use_count() == 1)
+        {
+            // this_type::dispatcher が束の参照を手放した後の処理と同期する。
+            std::atomic_thread_fence(std::memory_order_acquire);
+            this_type::dispatcher::clear_packets(
+                *io_batch, in_capacity, in_rebuild);
+        }
+        else
+        {
+            auto const local_allocator(io_batch->get_allocator());
+            io_batch = std::allocate_shared<
+                typename this_type::dispatcher::packet_shared_ptr_container>(
+                    local_allocator, local_allocator);
+            io_batch->reserve(in_capacity);
+        }
+        return *io_batch;
+    }
+
+    /// @brief this_type::dispatcher へメッセージパケットの束を配送する。
+    /// @details
+    ///   全ての this_type::dispatcher が同じ束を共有するので、
+    ///   配送のコストは this_type::dispatcher の数にだけ比例する。
     private: static void deliver_packets(
         /// [in,out] メッセージパケットを受信する this_type::dispatcher のコンテナ。
         typename this_type::dispatcher_weak_ptr_container& io_dispatchers,
-        /// [in] this_type::dispatcher へ配送するメッセージパケットのコンテナ。
-        typename this_type::dispatcher::packet_shared_ptr_container const&
-            in_packets)
+        /// [in] this_type::dispatcher へ配送するメッセージパケットの束。
+        typename this_type::dispatcher::packet_batch_shared_ptr const&
+            in_batch)
     {
         auto local_last(std::begin(io_dispatchers));
         auto const local_end(std::end(io_dispatchers));
@@ -390,7 +1066,7 @@ class psyq::event_driven::zone
             auto const local_dispatcher(local_holder.get());
             if (local_dispatcher != nullptr)
             {
-                local_dispatcher->receive_packets(in_packets);
+                local_dispatcher->receive_packets(in_batch);
                 i->swap(*local_last);
                 ++local_last;
             }
@@ -401,10 +1077,46 @@ class psyq::event_driven::zone
     //-------------------------------------------------------------------------
     /// @brief 各スレッドに合致する this_type::dispatcher のコンテナ。
     private: typename this_type::dispatcher_weak_ptr_container dispatchers_;
-    /// @brief this_type::dispatcher へ配るメッセージパケットのコンテナ。
-    private: typename this_type::dispatcher::packet_shared_ptr_container
-        delivery_packets_;
-    /// @brief 排他的処理に使うロックオブジェクト。
+    /// @brief this_type::dispatcher へ最後に配ったメッセージパケットの束。
+    private: std::shared_ptr<
+        typename this_type::dispatcher::packet_shared_ptr_container>
+            delivery_batch_;
+    /// @brief this_type::packet の構築に使うメモリ割当子。
+    private: typename this_type::packet_allocator packet_allocator_;
+    /// @brief 送信予約されたメッセージパケットの、ロックを使わない待ち行列。
+    /// @details
+    ///   待ち行列のノードも this_type::packet_allocator_ から割り当て、
+    ///   定常状態の送信でメモリ割当子を呼び出さないようにする。
+    private: psyq::event_driven::packet_queue<
+        typename this_type::packet::shared_ptr,
+        typename this_type::packet_allocator>
+            posted_packets_;
+    /// @brief 送信予約できる上限数がある場合の、メッセージパケットの待ち行列。
+    private: psyq::event_driven::bounded_queue<
+        typename this_type::packet::shared_ptr,
+        typename this_type::allocator_type>
+            bounded_packets_;
+    /// @brief 送信予約されているメッセージパケットの数。
+    private: std::atomic<std::size_t> posted_size_;
+    /// @brief 上限数を超えたので捨てたメッセージパケットの数。
+    private: std::atomic<std::size_t> dropped_count_;
+    /// @brief 送信予約されたメッセージパケットの数の最大値。
+    private: std::atomic<std::size_t> high_water_;
+    /// @brief 送信予約したメッセージパケットの数。
+    private: std::atomic<std::size_t> posted_count_;
+    /// @brief this_type::dispatcher へ配送したメッセージパケットの数。
+    private: std::atomic<std::size_t> delivered_count_;
+    /// @brief メッセージパケットの時刻印が有効か。
+    private: std::atomic<bool> timestamp_enabled_;
+    /// @brief 送信予約から this_type::dispatcher へ配送するまでの待ち時間。
+    private: psyq::event_driven::latency_histogram post_to_dispatch_;
+    /// @brief this_type::dispatcher が溜めておける束の上限数。
+    private: std::size_t const batch_limit_;
+    /// @brief 上限数を超えた場合の方針。
+    private: psyq::event_driven::overflow_policy const overflow_policy_;
+    /// @brief メッセージゾーン外への送信に使う external_ring 。
+    private: psyq::event_driven::external_ring* external_ring_;
+    /// @brief this_type::dispatchers_ の排他的処理に使うロックオブジェクト。
     private: psyq::spinlock lock_;
 
 }; // class psyq::event_driven::zone
@@ -423,9 +1135,37 @@ namespace psyq_test
     };
     typedef value_wrapper<std::int32_t> integer_wrapper;
     typedef value_wrapper<double> floating_wrapper;
+
+    /// @brief 割り当てた回数を数えるメモリ割当子。
+    template<typename template_value>
+    struct counting_allocator: public std::allocator<template_value>
+    {
+        template<typename template_other> struct rebind
+        {
+            typedef counting_allocator<template_other> other;
+        };
+        counting_allocator() PSYQ_NOEXCEPT {}
+        template<typename template_other>
+        counting_allocator(counting_allocator<template_other> const&)
+        PSYQ_NOEXCEPT
+        {}
+        template_value* allocate(std::size_t const in_count)
+        {
+            psyq_test::counting_allocator<void>::get_count().fetch_add(
+                1, std::memory_order_relaxed);
+            return std::allocator<template_value>::allocate(in_count);
+        }
+        static std::atomic<std::size_t>& get_count() PSYQ_NOEXCEPT
+        {
+            static std::atomic<std::size_t> static_count(0);
+            return static_count;
+        }
+    };
     inline void event_driven()
     {
         psyq::any::rtti::make<psyq_test::floating_wrapper>();
+        psyq::any::rtti::make<psyq_test::integer_wrapper>();
+        psyq::any::rtti::make<std::int32_t>();
 
         typedef psyq::event_driven::zone<> message_zone;
         message_zone local_zone(0, 0);
@@ -463,6 +1203,8 @@ namespace psyq_test
             RECEIVER_KEY = 10,
             METHOD_PARAMETER_VOID = 1,
             METHOD_PARAMETER_DOUBLE,
+            METHOD_PARAMETER_INTEGER,
+            METHOD_PARAMETER_POD,
         };
         local_dispatcher.register_receiver(
             RECEIVER_KEY, METHOD_PARAMETER_VOID, local_method_a);
@@ -488,8 +1230,733 @@ namespace psyq_test
         local_dispatcher.dispatch();
         local_zone.dispatch();
         local_dispatcher.dispatch();
+
+        // 複数スレッドから送信し、スレッドごとの受信順序を確かめる。
+        std::size_t const local_thread_count(4);
+        std::int32_t const local_post_count(256);
+        std::vector<std::int32_t> local_last_values(local_thread_count, -1);
+        std::int32_t local_receive_count(0);
+        auto const local_method_c(
+            std::allocate_shared<message_zone::dispatcher::function>(
+                local_zone.get_allocator(),
+                [&local_last_values, &local_receive_count, local_post_count](
+                    message_zone::packet const& in_packet)
+                {
+                    auto const local_parameter(
+                        in_packet.get_parameter<psyq_test::integer_wrapper>());
+                    PSYQ_ASSERT(local_parameter != nullptr);
+                    auto& local_last(
+                        local_last_values.at(
+                            local_parameter->value / local_post_count));
+                    PSYQ_ASSERT(local_last < local_parameter->value);
+                    local_last = local_parameter->value;
+                    ++local_receive_count;
+                }));
+        local_dispatcher.register_receiver(
+            RECEIVER_KEY, METHOD_PARAMETER_INTEGER, local_method_c);
+        std::vector<std::thread> local_threads;
+        for (std::size_t i(0); i < local_thread_count; ++i)
+        {
+            local_threads.emplace_back(
+                [&local_zone, i, local_post_count]()
+                {
+                    for (std::int32_t j(0); j < local_post_count; ++j)
+                    {
+                        local_zone.post_zonal(
+                            message_zone::tag(
+                                SENDER_KEY,
+                                RECEIVER_KEY,
+                                METHOD_PARAMETER_INTEGER),
+                            psyq_test::integer_wrapper(
+                                static_cast<std::int32_t>(i)
+                                * local_post_count + j));
+                    }
+                });
+            // 送信中にも配送し、送信予約の取り出しと競合させる。
+            local_zone.dispatch();
+            local_dispatcher.dispatch();
+        }
+        for (auto& local_thread: local_threads)
+        {
+            local_thread.join();
+        }
+        local_zone.dispatch();
+        local_dispatcher.dispatch();
+        PSYQ_ASSERT(
+            local_receive_count
+            == static_cast<std::int32_t>(local_thread_count) * local_post_count);
+
+        // 定常状態の送信では、メモリプールがメモリチャンクを追加しない。
+        std::size_t local_reserved_bytes(0);
+        for (int i(0); i < 3; ++i)
+        {
+            std::fill(local_last_values.begin(), local_last_values.end(), -1);
+            for (std::int32_t j(0); j < local_post_count; ++j)
+            {
+                local_zone.post_zonal(
+                    message_zone::tag(
+                        SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_INTEGER),
+                    psyq_test::integer_wrapper(j));
+            }
+            local_zone.dispatch();
+            local_dispatcher.dispatch();
+            auto const local_bytes(
+                local_zone.get_packet_allocator().get_pool()->get_reserved_bytes());
+            PSYQ_ASSERT(0 < local_bytes);
+            PSYQ_ASSERT(i < 2 || local_bytes == local_reserved_bytes);
+            local_reserved_bytes = local_bytes;
+        }
+
+        // 定常状態の送信と配送では、上位のメモリ割当子を呼び出さない。
+        {
+            typedef psyq::event_driven::zone<
+                PSYQ_EVENT_DRIVEN_ZONE_PACKET_DEFAULT,
+                PSYQ_EVENT_DRIVEN_ZONE_PRIORITY_DEFAULT,
+                psyq_test::counting_allocator<void*>>
+                    counting_zone;
+            counting_zone local_counting_zone(1, local_post_count);
+            auto const local_counting_dispatcher(
+                local_counting_zone.equip_dispatcher());
+            std::int32_t local_counting_sum(0);
+            auto const local_counting_method(
+                std::allocate_shared<counting_zone::dispatcher::function>(
+                    local_counting_zone.get_allocator(),
+                    [&local_counting_sum](counting_zone::packet const& in_packet)
+                    {
+                        auto const local_parameter(
+                            in_packet.get_parameter<psyq_test::integer_wrapper>());
+                        PSYQ_ASSERT(local_parameter != nullptr);
+                        local_counting_sum += local_parameter->value;
+                    }));
+            local_counting_dispatcher->register_receiver(
+                RECEIVER_KEY, METHOD_PARAMETER_INTEGER, local_counting_method);
+            auto& local_allocation_count(
+                psyq_test::counting_allocator<void>::get_count());
+            std::size_t local_last_count(0);
+            for (int i(0); i < 4; ++i)
+            {
+                for (std::int32_t j(0); j < local_post_count; ++j)
+                {
+                    local_counting_zone.post_zonal(
+                        counting_zone::tag(
+                            SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_INTEGER),
+                        psyq_test::integer_wrapper(1));
+                }
+                local_counting_zone.dispatch();
+                local_counting_dispatcher->dispatch();
+                auto const local_count(local_allocation_count.load());
+                PSYQ_ASSERT(i < 2 || local_count == local_last_count);
+                local_last_count = local_count;
+            }
+            PSYQ_ASSERT(local_counting_sum == 4 * local_post_count);
+        }
+
+        // 別スレッドの dispatcher にも、同じメッセージパケットの束が届く。
+        std::atomic<bool> local_worker_ready(false);
+        std::atomic<std::int32_t> local_worker_count(0);
+        std::thread local_worker(
+            [&local_zone, &local_worker_ready, &local_worker_count,
+             local_post_count]()
+            {
+                auto const local_worker_dispatcher(
+                    local_zone.equip_dispatcher());
+                auto const local_method(
+                    std::allocate_shared<message_zone::dispatcher::function>(
+                        local_zone.get_allocator(),
+                        [&local_worker_count](message_zone::packet const&)
+                        {
+                            ++local_worker_count;
+                        }));
+                local_worker_dispatcher->register_receiver(
+                    RECEIVER_KEY, METHOD_PARAMETER_INTEGER, local_method);
+                local_worker_ready = true;
+                while (local_worker_count < local_post_count)
+                {
+                    local_worker_dispatcher->dispatch();
+                    std::this_thread::yield();
+                }
+            });
+        while (!local_worker_ready)
+        {
+            std::this_thread::yield();
+        }
+        local_receive_count = 0;
+        std::fill(local_last_values.begin(), local_last_values.end(), -1);
+        for (std::int32_t j(0); j < local_post_count; ++j)
+        {
+            local_zone.post_zonal(
+                message_zone::tag(
+                    SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_INTEGER),
+                psyq_test::integer_wrapper(j));
+        }
+        local_zone.dispatch();
+        local_dispatcher.dispatch();
+        local_worker.join();
+        PSYQ_ASSERT(local_receive_count == local_post_count);
+        PSYQ_ASSERT(local_worker_count == local_post_count);
+
+        // 所有者が破棄したメッセージ受信関数は墓標となり、呼び出されない。
+        // 同じ識別値で登録し直すと、新しいメッセージ受信関数が呼び出される。
+        std::int32_t local_tombstone_calls(0);
+        auto local_method_d(
+            std::allocate_shared<message_zone::dispatcher::function>(
+                local_zone.get_allocator(),
+                [&local_tombstone_calls](message_zone::packet const&)
+                {
+                    ++local_tombstone_calls;
+                }));
+        enum: message_zone::tag::key_type {TOMBSTONE_KEY = 30};
+        PSYQ_ASSERT(
+            local_dispatcher.register_receiver(
+                TOMBSTONE_KEY, METHOD_PARAMETER_VOID, local_method_d));
+        local_method_d.reset();
+        local_zone.post_zonal(
+            message_zone::tag(SENDER_KEY, TOMBSTONE_KEY, METHOD_PARAMETER_VOID));
+        local_zone.dispatch();
+        local_dispatcher.dispatch();
+        PSYQ_ASSERT(local_tombstone_calls == 0);
+        local_method_d =
+            std::allocate_shared<message_zone::dispatcher::function>(
+                local_zone.get_allocator(),
+                [&local_tombstone_calls](message_zone::packet const&)
+                {
+                    local_tombstone_calls += 10;
+                });
+        PSYQ_ASSERT(
+            local_dispatcher.register_receiver(
+                TOMBSTONE_KEY, METHOD_PARAMETER_VOID, local_method_d));
+        local_zone.post_zonal(
+            message_zone::tag(SENDER_KEY, TOMBSTONE_KEY, METHOD_PARAMETER_VOID));
+        local_zone.dispatch();
+        local_dispatcher.dispatch();
+        PSYQ_ASSERT(local_tombstone_calls == 10);
+        PSYQ_ASSERT(
+            !local_dispatcher.find_receiver(
+                TOMBSTONE_KEY, METHOD_PARAMETER_VOID).expired());
+        PSYQ_ASSERT(local_dispatcher.unregister_receiver(TOMBSTONE_KEY) == 1);
+
+        // メッセージ転送関数で、別のメッセージゾーンへメッセージを転送する。
+        message_zone local_remote_zone(1, 0);
+        auto const local_remote_dispatcher(local_remote_zone.equip_dispatcher());
+        std::int32_t local_remote_sum(0);
+        auto const local_remote_method(
+            std::allocate_shared<message_zone::dispatcher::function>(
+                local_zone.get_allocator(),
+                [&local_remote_sum](message_zone::packet const& in_packet)
+                {
+                    auto const local_parameter(
+                        in_packet.get_parameter<psyq_test::integer_wrapper>());
+                    PSYQ_ASSERT(local_parameter != nullptr);
+                    local_remote_sum += local_parameter->value;
+                }));
+        local_remote_dispatcher->register_receiver(
+            RECEIVER_KEY, METHOD_PARAMETER_INTEGER, local_remote_method);
+        auto const local_forwarder(
+            std::allocate_shared<message_zone::dispatcher::function>(
+                local_zone.get_allocator(),
+                [&local_remote_zone](message_zone::packet const& in_packet)
+                {
+                    auto const local_parameter(
+                        in_packet.get_parameter<psyq_test::integer_wrapper>());
+                    if (local_parameter != nullptr)
+                    {
+                        local_remote_zone.post_zonal(
+                            in_packet.get_message().get_tag(),
+                            psyq_test::integer_wrapper(*local_parameter));
+                    }
+                }));
+        PSYQ_ASSERT(
+            local_dispatcher.register_forwarder(RECEIVER_KEY, local_forwarder));
+        PSYQ_ASSERT(
+            !local_dispatcher.register_forwarder(RECEIVER_KEY, local_forwarder));
+        PSYQ_ASSERT(
+            local_dispatcher.find_forwarder(RECEIVER_KEY).lock()
+            == local_forwarder);
+        local_receive_count = 0;
+        std::fill(local_last_values.begin(), local_last_values.end(), -1);
+        local_zone.post_zonal(
+            message_zone::tag(
+                SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_INTEGER),
+            psyq_test::integer_wrapper(3));
+        local_zone.post_zonal(
+            message_zone::tag(SENDER_KEY, TOMBSTONE_KEY, METHOD_PARAMETER_INTEGER),
+            psyq_test::integer_wrapper(100));
+        local_zone.dispatch();
+        local_dispatcher.dispatch();
+        local_remote_zone.dispatch();
+        local_remote_dispatcher->dispatch();
+        PSYQ_ASSERT(local_receive_count == 1);
+        PSYQ_ASSERT(local_remote_sum == 3);
+        PSYQ_ASSERT(
+            local_dispatcher.unregister_forwarder(RECEIVER_KEY).lock()
+            == local_forwarder);
+        PSYQ_ASSERT(local_dispatcher.find_forwarder(RECEIVER_KEY).expired());
+
+        // 識別値マスクを使うメッセージは、マスクした識別値が一致する
+        // メッセージ転送関数にだけ配送される。
+        {
+            message_zone::tag::key_type const local_forward_selector(99);
+            std::size_t const local_forwarder_count(64);
+            std::vector<std::int32_t> local_forward_counts(
+                local_forwarder_count, 0);
+            std::vector<message_zone::dispatcher::function_shared_ptr>
+                local_forwarders;
+            for (std::size_t i(0); i < local_forwarder_count; ++i)
+            {
+                local_forwarders.push_back(
+                    std::allocate_shared<message_zone::dispatcher::function>(
+                        local_zone.get_allocator(),
+                        [&local_forward_counts, i](message_zone::packet const&)
+                        {
+                            ++local_forward_counts[i];
+                        }));
+                PSYQ_ASSERT(
+                    local_dispatcher.register_forwarder(
+                        static_cast<message_zone::tag::key_type>(0x1000 + i),
+                        local_forwarders.back()));
+            }
+            auto const local_post_masked(
+                [&local_zone, &local_dispatcher, local_forward_selector](
+                    message_zone::tag::key_type const in_receiver_key,
+                    message_zone::tag::key_type const in_receiver_mask)
+                {
+                    local_zone.post_zonal(
+                        message_zone::tag(
+                            SENDER_KEY,
+                            in_receiver_key,
+                            local_forward_selector,
+                            in_receiver_mask));
+                    local_zone.dispatch();
+                    local_dispatcher.dispatch();
+                });
+
+            // 下位4ビットが5のメッセージ転送関数だけに配送される。
+            local_post_masked(5, 0xf);
+            for (std::size_t i(0); i < local_forwarder_count; ++i)
+            {
+                PSYQ_ASSERT(local_forward_counts[i] == ((i & 0xf) == 5? 1: 0));
+            }
+
+            // マスクが0なら、全てのメッセージ転送関数に配送される。
+            local_post_masked(0, 0);
+            for (std::size_t i(0); i < local_forwarder_count; ++i)
+            {
+                PSYQ_ASSERT(
+                    local_forward_counts[i] == ((i & 0xf) == 5? 2: 1));
+            }
+
+            // メッセージ転送関数を取り除くと、索引にも反映される。
+            PSYQ_ASSERT(
+                local_dispatcher.unregister_forwarder(0x1000 + 21).lock()
+                == local_forwarders[21]);
+            local_post_masked(5, 0xf);
+            PSYQ_ASSERT(local_forward_counts[5] == 3);
+            PSYQ_ASSERT(local_forward_counts[21] == 2);
+            PSYQ_ASSERT(local_forward_counts[37] == 3);
+            PSYQ_ASSERT(local_forward_counts[53] == 3);
+
+            // マスクした識別値に合致しないメッセージは、どれにも配送されない。
+            local_post_masked(0x10, 0xf);
+            PSYQ_ASSERT(local_forward_counts[0] == 1);
+            for (std::size_t i(0); i < local_forwarder_count; ++i)
+            {
+                if (i != 21)
+                {
+                    local_dispatcher.unregister_forwarder(
+                        static_cast<message_zone::tag::key_type>(0x1000 + i));
+                }
+            }
+        }
+
+        // external_ring を経由して、別のメッセージゾーンへメッセージを送る。
+        // 実際には、プロセス間で共有するメモリに external_ring を構築する。
+        std::vector<std::max_align_t> local_shared_memory(
+            psyq::event_driven::external_ring::compute_memory_size(4, 64)
+            / sizeof(std::max_align_t) + 1);
+        PSYQ_ASSERT(
+            psyq::event_driven::external_ring::construct(
+                local_shared_memory.data(),
+                local_shared_memory.size() * sizeof(std::max_align_t),
+                4,
+                64)
+            != nullptr);
+        auto const local_external_ring(
+            psyq::event_driven::external_ring::attach(
+                local_shared_memory.data()));
+        PSYQ_ASSERT(local_external_ring != nullptr);
+        auto const local_pod_method(
+            std::allocate_shared<message_zone::dispatcher::function>(
+                local_zone.get_allocator(),
+                [&local_remote_sum](message_zone::packet const& in_packet)
+                {
+                    auto const local_parameter(
+                        in_packet.get_parameter<std::int32_t>());
+                    PSYQ_ASSERT(local_parameter != nullptr);
+                    PSYQ_ASSERT(in_packet.get_external_message() != nullptr);
+                    local_remote_sum += *local_parameter;
+                }));
+        local_remote_dispatcher->register_receiver(
+            RECEIVER_KEY, METHOD_PARAMETER_POD, local_pod_method);
+        local_zone.set_external_ring(local_external_ring);
+        local_zone.post_external(
+            message_zone::tag(SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_POD),
+            std::int32_t(40));
+        local_zone.post_external(
+            message_zone::tag(SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_VOID));
+        // external_ring に書き込めないメッセージは、捨てたものとして数える。
+        auto const local_dropped_count(local_zone.get_dropped_count());
+        local_zone.post_external(
+            message_zone::tag(SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_POD),
+            std::array<std::int32_t, 32>());
+        PSYQ_ASSERT(local_zone.get_dropped_count() == local_dropped_count + 1);
+        local_zone.set_external_ring(nullptr);
+        local_remote_sum = 0;
+        PSYQ_ASSERT(local_remote_zone.receive_external(*local_external_ring) == 2);
+        PSYQ_ASSERT(local_remote_zone.receive_external(*local_external_ring) == 0);
+        local_remote_zone.dispatch();
+        local_remote_dispatcher->dispatch();
+        PSYQ_ASSERT(local_remote_sum == 40);
+        for (std::uint32_t i(0); i < 4; ++i)
+        {
+            PSYQ_ASSERT(local_external_ring->push(&i, sizeof(i)));
+        }
+        std::uint32_t local_pushed(0);
+        PSYQ_ASSERT(!local_external_ring->push(&local_pushed, sizeof(local_pushed)));
+        PSYQ_ASSERT(
+            local_external_ring->consume(
+                [&local_pushed](void const* const in_data, std::size_t const in_size)
+                {
+                    PSYQ_ASSERT(in_size == sizeof(local_pushed));
+                    std::memcpy(&local_pushed, in_data, in_size);
+                }));
+        PSYQ_ASSERT(local_pushed == 0);
+
+        // 壊れたメッセージは取り込まずに捨て、捨てたメッセージとして数える。
+        auto const local_remote_dropped_count(
+            local_remote_zone.get_dropped_count());
+        PSYQ_ASSERT(local_remote_zone.receive_external(*local_external_ring) == 0);
+        PSYQ_ASSERT(
+            local_remote_zone.get_dropped_count()
+            == local_remote_dropped_count + 3);
+        local_zone.set_external_ring(local_external_ring);
+        local_zone.post_external(
+            message_zone::tag(SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_POD),
+            std::int32_t(7));
+        local_zone.set_external_ring(nullptr);
+        std::vector<char> local_record;
+        PSYQ_ASSERT(
+            local_external_ring->consume(
+                [&local_record](void const* const in_data, std::size_t const in_size)
+                {
+                    auto const local_data(static_cast<char const*>(in_data));
+                    local_record.assign(local_data, local_data + in_size);
+                }));
+        PSYQ_ASSERT(
+            local_external_ring->push(
+                local_record.data(), local_record.size() - 1));
+        PSYQ_ASSERT(
+            local_external_ring->push(local_record.data(), local_record.size()));
+        local_remote_sum = 0;
+        PSYQ_ASSERT(local_remote_zone.receive_external(*local_external_ring) == 1);
+        PSYQ_ASSERT(
+            local_remote_zone.get_dropped_count()
+            == local_remote_dropped_count + 4);
+        local_remote_zone.dispatch();
+        local_remote_dispatcher->dispatch();
+        PSYQ_ASSERT(local_remote_sum == 7);
+        local_zone.dispatch();
+        local_dispatcher.dispatch();
+
+        // 送り状ごとにまとめて配送する。
+        std::vector<std::int32_t> local_batch_sizes;
+        std::int32_t local_batch_sum(0);
+        auto const local_batch_method(
+            std::allocate_shared<message_zone::dispatcher::batch_function>(
+                local_zone.get_allocator(),
+                [&local_batch_sizes, &local_batch_sum](
+                    message_zone::packet const* const* const in_packets,
+                    std::size_t const in_count)
+                {
+                    local_batch_sizes.push_back(
+                        static_cast<std::int32_t>(in_count));
+                    for (std::size_t i(0); i < in_count; ++i)
+                    {
+                        auto const local_parameter(
+                            in_packets[i]->get_parameter<
+                                psyq_test::integer_wrapper>());
+                        PSYQ_ASSERT(local_parameter != nullptr);
+                        local_batch_sum =
+                            local_batch_sum * 10 + local_parameter->value;
+                    }
+                }));
+        PSYQ_ASSERT(
+            local_dispatcher.register_batch_receiver(
+                RECEIVER_KEY, METHOD_PARAMETER_INTEGER, local_batch_method));
+        PSYQ_ASSERT(
+            !local_dispatcher.register_batch_receiver(
+                RECEIVER_KEY, METHOD_PARAMETER_INTEGER, local_batch_method));
+        local_receive_count = 0;
+        std::fill(local_last_values.begin(), local_last_values.end(), -1);
+        for (std::int32_t i(1); i <= 3; ++i)
+        {
+            local_zone.post_zonal(
+                message_zone::tag(
+                    SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_INTEGER),
+                psyq_test::integer_wrapper(i));
+            local_zone.post_zonal(
+                message_zone::tag(
+                    SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_DOUBLE),
+                psyq_test::floating_wrapper(local_double));
+        }
+        local_zone.dispatch();
+        local_dispatcher.dispatch_grouped();
+        PSYQ_ASSERT(local_receive_count == 3);
+        PSYQ_ASSERT(local_batch_sizes.size() == 1 && local_batch_sizes[0] == 3);
+        PSYQ_ASSERT(local_batch_sum == 123);
+        PSYQ_ASSERT(
+            local_dispatcher.unregister_batch_receiver(
+                RECEIVER_KEY, METHOD_PARAMETER_INTEGER).lock()
+            == local_batch_method);
+
+        // 実行レーンをワーカースレッドで処理し、受信順序が保たれるか確かめる。
+        enum: message_zone::tag::key_type {LANE_KEY = 40};
+        std::size_t const local_lane_count(3);
+        std::vector<message_zone::dispatcher::shared_ptr> local_lanes;
+        std::vector<message_zone::dispatcher::function_shared_ptr>
+            local_lane_methods;
+        std::vector<std::vector<std::int32_t>> local_lane_values(
+            local_lane_count);
+        for (std::size_t i(0); i < local_lane_count; ++i)
+        {
+            local_lanes.push_back(local_zone.equip_lane(i));
+            PSYQ_ASSERT(local_lanes.back()->is_lane());
+            auto& local_values(local_lane_values[i]);
+            local_lane_methods.push_back(
+                std::allocate_shared<message_zone::dispatcher::function>(
+                    local_zone.get_allocator(),
+                    [&local_values](message_zone::packet const& in_packet)
+                    {
+                        auto const local_parameter(
+                            in_packet.get_parameter<
+                                psyq_test::integer_wrapper>());
+                        PSYQ_ASSERT(local_parameter != nullptr);
+                        local_values.push_back(local_parameter->value);
+                    }));
+            std::lock_guard<message_zone::dispatcher> const local_lock(
+                *local_lanes.back());
+            local_lanes.back()->register_receiver(
+                LANE_KEY, METHOD_PARAMETER_INTEGER, local_lane_methods.back());
+        }
+        PSYQ_ASSERT(local_zone.equip_lane(1) == local_lanes[1]);
+        PSYQ_ASSERT(local_zone.equip_dispatcher() != local_lanes[0]);
+        {
+            psyq::event_driven::lane_executor local_executor(2);
+            for (std::int32_t i(0); i < 64; ++i)
+            {
+                local_zone.post_zonal(
+                    message_zone::tag(
+                        SENDER_KEY, LANE_KEY, METHOD_PARAMETER_INTEGER),
+                    psyq_test::integer_wrapper(i));
+                if (i % 4 == 3)
+                {
+                    local_zone.dispatch();
+                    local_zone.schedule_lanes(local_executor);
+                }
+            }
+            local_executor.wait_idle();
+            local_zone.schedule_lanes(local_executor);
+        }
+        for (auto const& local_values: local_lane_values)
+        {
+            PSYQ_ASSERT(local_values.size() == 64);
+            for (std::size_t i(0); i < local_values.size(); ++i)
+            {
+                PSYQ_ASSERT(local_values[i] == static_cast<std::int32_t>(i));
+            }
+        }
+
+        // 他のスレッドが占有している実行レーンは、占有が解除されてから処理される。
+        {
+            psyq::event_driven::lane_executor local_executor(2);
+            auto& local_held_lane(*local_lanes[0]);
+            local_held_lane.lock();
+            for (std::int32_t i(64); i < 68; ++i)
+            {
+                local_zone.post_zonal(
+                    message_zone::tag(
+                        SENDER_KEY, LANE_KEY, METHOD_PARAMETER_INTEGER),
+                    psyq_test::integer_wrapper(i));
+            }
+            local_zone.dispatch();
+            PSYQ_ASSERT(
+                local_zone.schedule_lanes(local_executor) == local_lanes.size());
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            PSYQ_ASSERT(local_lane_values[0].size() == 64);
+            local_held_lane.unlock();
+            local_executor.wait_idle();
+            for (auto const& local_values: local_lane_values)
+            {
+                PSYQ_ASSERT(local_values.size() == 68);
+                PSYQ_ASSERT(local_values.back() == 67);
+            }
+
+            // ワーカースレッドから登録した処理も、全て終わるまで待つ。
+            std::atomic<std::int32_t> local_task_count(0);
+            local_executor.submit(
+                [&local_executor, &local_task_count]()
+                {
+                    for (std::int32_t i(0); i < 100; ++i)
+                    {
+                        local_executor.submit(
+                            [&local_task_count]()
+                            {
+                                local_task_count.fetch_add(1);
+                            });
+                    }
+                });
+            local_executor.wait_idle();
+            PSYQ_ASSERT(local_task_count.load() == 100);
+        }
+        local_dispatcher.dispatch();
+
+        // 上限数を超えたメッセージパケットは、方針に従って捨てる。
+        {
+            message_zone local_bounded_zone(
+                1, 0, 4, 2, psyq::event_driven::overflow_policy_DROP_OLDEST);
+            auto const local_bounded_dispatcher(
+                local_bounded_zone.equip_dispatcher());
+            std::vector<std::int32_t> local_bounded_values;
+            auto const local_bounded_method(
+                std::allocate_shared<message_zone::dispatcher::function>(
+                    local_zone.get_allocator(),
+                    [&local_bounded_values](message_zone::packet const& in_packet)
+                    {
+                        local_bounded_values.push_back(
+                            in_packet.get_parameter<
+                                psyq_test::integer_wrapper>()->value);
+                    }));
+            local_bounded_dispatcher->register_receiver(
+                RECEIVER_KEY, METHOD_PARAMETER_INTEGER, local_bounded_method);
+            for (std::int32_t i(0); i < 6; ++i)
+            {
+                auto const local_posted(
+                    local_bounded_zone.post_zonal(
+                        message_zone::tag(
+                            SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_INTEGER),
+                        psyq_test::integer_wrapper(i)));
+                PSYQ_ASSERT(local_posted);
+            }
+            PSYQ_ASSERT(local_bounded_zone.get_dropped_count() == 2);
+            PSYQ_ASSERT(local_bounded_zone.get_high_water() == 4);
+            PSYQ_ASSERT(local_bounded_zone.get_posted_size() == 4);
+            for (std::int32_t i(0); i < 3; ++i)
+            {
+                local_bounded_zone.post_zonal(
+                    message_zone::tag(
+                        SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_INTEGER),
+                    psyq_test::integer_wrapper(10 + i));
+                local_bounded_zone.dispatch();
+            }
+            PSYQ_ASSERT(local_bounded_zone.get_posted_size() == 0);
+            PSYQ_ASSERT(local_bounded_dispatcher->get_batch_high_water() == 2);
+            PSYQ_ASSERT(local_bounded_dispatcher->get_dropped_batch_count() == 1);
+            PSYQ_ASSERT(local_bounded_dispatcher->get_dropped_packet_count() == 4);
+            local_bounded_dispatcher->dispatch();
+            PSYQ_ASSERT(local_bounded_values.size() == 2);
+            PSYQ_ASSERT(local_bounded_values[0] == 11);
+            PSYQ_ASSERT(local_bounded_values[1] == 12);
+
+            // 古い束を何度捨てても、残った束は受信した順に配送される。
+            for (std::int32_t i(0); i < 7; ++i)
+            {
+                local_bounded_zone.post_zonal(
+                    message_zone::tag(
+                        SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_INTEGER),
+                    psyq_test::integer_wrapper(20 + i));
+                local_bounded_zone.dispatch();
+            }
+            PSYQ_ASSERT(local_bounded_dispatcher->get_dropped_batch_count() == 6);
+            PSYQ_ASSERT(local_bounded_dispatcher->get_dropped_packet_count() == 9);
+            local_bounded_dispatcher->dispatch();
+            PSYQ_ASSERT(local_bounded_values.size() == 4);
+            PSYQ_ASSERT(local_bounded_values[2] == 25);
+            PSYQ_ASSERT(local_bounded_values[3] == 26);
+
+            message_zone local_failing_zone(
+                1, 0, 2, 0, psyq::event_driven::overflow_policy_FAIL);
+            for (std::int32_t i(0); i < 3; ++i)
+            {
+                auto const local_posted(
+                    local_failing_zone.post(
+                        message_zone::packet::create_zonal(
+                            message_zone::message(
+                                message_zone::tag(
+                                    SENDER_KEY,
+                                    RECEIVER_KEY,
+                                    METHOD_PARAMETER_VOID)),
+                            local_failing_zone.get_packet_allocator())));
+                PSYQ_ASSERT(local_posted == (i < 2));
+            }
+            PSYQ_ASSERT(local_failing_zone.get_dropped_count() == 1);
+
+            message_zone local_newest_zone(
+                1, 0, 2, 0, psyq::event_driven::overflow_policy_DROP_NEWEST);
+            for (std::int32_t i(0); i < 3; ++i)
+            {
+                auto const local_posted(
+                    local_newest_zone.post_zonal(
+                        message_zone::tag(
+                            SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_INTEGER),
+                        psyq_test::integer_wrapper(i)));
+                PSYQ_ASSERT(local_posted == (i < 2));
+            }
+            PSYQ_ASSERT(local_newest_zone.get_dropped_count() == 1);
+            PSYQ_ASSERT(local_newest_zone.get_posted_size() == 2);
+            local_newest_zone.dispatch();
+            PSYQ_ASSERT(local_newest_zone.get_posted_size() == 0);
+        }
+
+        // 時刻印を有効にして、メッセージの流れの統計を取得する。
+        {
+            message_zone local_timed_zone(1, 0);
+            auto const local_timed_dispatcher(
+                local_timed_zone.equip_dispatcher());
+            local_timed_zone.post_zonal(
+                message_zone::tag(SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_VOID));
+            local_timed_zone.enable_timestamp(true);
+            for (std::int32_t i(0); i < 3; ++i)
+            {
+                local_timed_zone.post_zonal(
+                    message_zone::tag(
+                        SENDER_KEY, RECEIVER_KEY, METHOD_PARAMETER_VOID));
+            }
+            auto const local_posted_snapshot(local_timed_zone.take_snapshot());
+            PSYQ_ASSERT(local_posted_snapshot.posted_count == 4);
+            PSYQ_ASSERT(local_posted_snapshot.queue_depth == 4);
+            PSYQ_ASSERT(local_posted_snapshot.delivered_count == 0);
+            local_timed_zone.dispatch();
+            PSYQ_ASSERT(local_timed_dispatcher->take_snapshot().queue_depth == 1);
+            local_timed_dispatcher->dispatch();
+            auto const local_zone_snapshot(local_timed_zone.take_snapshot());
+            PSYQ_ASSERT(local_zone_snapshot.delivered_count == 4);
+            PSYQ_ASSERT(local_zone_snapshot.queue_depth == 0);
+            PSYQ_ASSERT(local_zone_snapshot.post_to_dispatch.count == 3);
+            PSYQ_ASSERT(0 <= local_zone_snapshot.post_to_dispatch.sum);
+            PSYQ_ASSERT(
+                local_zone_snapshot.post_to_dispatch.get_percentile(0.5)
+                <= local_zone_snapshot.post_to_dispatch.max);
+            auto const local_dispatcher_snapshot(
+                local_timed_dispatcher->take_snapshot());
+            PSYQ_ASSERT(local_dispatcher_snapshot.received_count == 4);
+            PSYQ_ASSERT(local_dispatcher_snapshot.queue_depth == 0);
+            PSYQ_ASSERT(
+                local_dispatcher_snapshot.dispatch_to_receive.count == 4);
+        }
+
         local_dispatcher.unregister_receiver(
             RECEIVER_KEY, METHOD_PARAMETER_VOID);
+        local_dispatcher.unregister_receiver(
+            RECEIVER_KEY, METHOD_PARAMETER_INTEGER);
         PSYQ_ASSERT(
             local_dispatcher.unregister_receiver(RECEIVER_KEY) == 1);
     }
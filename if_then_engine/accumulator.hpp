@@ -153,6 +153,17 @@ class psyq::if_then_engine::_private::accumulator
         return this->accumulated_statuses_.size();
     }
 
+    /// @brief 予約されている状態変更のコンテナを取得する。
+    /// @details
+    /// 前回の this_type::_flush で遅延した状態変更がコンテナの先頭にあり、
+    /// その後に this_type::accumulate で予約した状態変更が続く。
+    /// @warning psyq::if_then_engine 管理者以外は、この関数は使用禁止。
+    public: typename this_type::status_container const& _get_accumulations()
+    const PSYQ_NOEXCEPT
+    {
+        return this->accumulated_statuses_;
+    }
+
     /// @brief 状態変更を予約する。
     /// @sa 実際の状態変更は this_type::_flush で適用される。
     /// @warning
@@ -0,0 +1,181 @@
+﻿/// @file
+/// @brief @copybrief psyq::if_then_engine::arena_allocator
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_IF_THEN_ENGINE_ARENA_ALLOCATOR_HPP_
+#define PSYQ_IF_THEN_ENGINE_ARENA_ALLOCATOR_HPP_
+
+#include <memory>
+#include <type_traits>
+#include "./monotonic_arena.hpp"
+
+/// @cond
+namespace psyq
+{
+    namespace if_then_engine
+    {
+        template<typename> class arena_allocator;
+    } // namespace if_then_engine
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief チャンク毎のメモリ領域を使うメモリ割当子。
+/// @details
+/// driver の template_allocator にこの型を指定すると、
+/// driver::reserve_chunk と driver::extend_chunk
+/// がチャンク毎に _private::monotonic_arena を用意し、
+/// チャンクが持つ状態値ビット列と要素条件と条件挙動関数のコンテナは、
+/// そのメモリ領域から切り出される。
+/// driver::erase_chunk でチャンクを削除すると、
+/// メモリ領域を参照するコンテナが全て破棄され、メモリ領域がまとめて解放される。
+/// @note
+/// メモリ領域を持たない場合は、 ::operator new と ::operator delete を使う。
+/// 辞書のノードはチャンクを跨いで共有されるので、メモリ領域を持たない
+/// メモリ割当子で確保する。
+/// @tparam template_value @copydoc arena_allocator::value_type
+template<typename template_value>
+class psyq::if_then_engine::arena_allocator
+{
+    /// @brief this が指す値の型。
+    private: typedef arena_allocator this_type;
+
+    /// @cond
+    template<typename> friend class psyq::if_then_engine::arena_allocator;
+    /// @endcond
+
+    //-------------------------------------------------------------------------
+    /// @brief 割り当てる値の型。
+    public: typedef template_value value_type;
+    /// @brief 割り当てる値へのポインタ。
+    public: typedef value_type* pointer;
+    /// @brief 割り当てる値への読み取り専用ポインタ。
+    public: typedef value_type const* const_pointer;
+    /// @brief 割り当てる値への参照。
+    public: typedef value_type& reference;
+    /// @brief 割り当てる値への読み取り専用参照。
+    public: typedef value_type const& const_reference;
+    /// @brief 要素数を表す型。
+    public: typedef std::size_t size_type;
+    /// @brief ポインタの差分を表す型。
+    public: typedef std::ptrdiff_t difference_type;
+    /// @brief メモリ割当子が使うメモリ領域。
+    public: typedef psyq::if_then_engine::_private::monotonic_arena arena;
+    /// @brief コンテナのムーブ代入で、メモリ割当子も移動させる。
+    public: typedef std::true_type propagate_on_container_move_assignment;
+    /// @brief コンテナの交換で、メモリ割当子も交換する。
+    public: typedef std::true_type propagate_on_container_swap;
+
+    /// @brief 別の型を割り当てるメモリ割当子を取得する。
+    public: template<typename template_other> struct rebind
+    {
+        /// @brief template_other を割り当てるメモリ割当子の型。
+        typedef psyq::if_then_engine::arena_allocator<template_other> other;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリ領域を持たないメモリ割当子を構築する。
+    public: arena_allocator() PSYQ_NOEXCEPT {}
+
+    /// @brief メモリ領域を使うメモリ割当子を構築する。
+    public: explicit arena_allocator(
+        /// [in] メモリ割当子が使うメモリ領域。
+        std::shared_ptr<typename this_type::arena> in_arena)
+    PSYQ_NOEXCEPT:
+    arena_(std::move(in_arena))
+    {}
+
+    /// @brief 別の型を割り当てるメモリ割当子から構築する。
+    public: template<typename template_other>
+    arena_allocator(
+        /// [in] メモリ領域を共有するメモリ割当子。
+        psyq::if_then_engine::arena_allocator<template_other> const& in_source)
+    PSYQ_NOEXCEPT:
+    arena_(in_source.arena_)
+    {}
+
+    //-------------------------------------------------------------------------
+    /// @brief 新たなメモリ領域を使うメモリ割当子を構築する。
+    /// @return 新たなメモリ領域を使うメモリ割当子。
+    public: this_type make_arena(
+        /// [in] メモリ領域が確保するメモリブロックの大きさの最小値。
+        std::size_t const in_block_size =
+            PSYQ_IF_THEN_ENGINE_ARENA_BLOCK_SIZE_DEFAULT)
+    const
+    {
+        return this_type(
+            std::make_shared<typename this_type::arena>(in_block_size));
+    }
+
+    /// @brief メモリ割当子が使うメモリ領域を取得する。
+    /// @return
+    /// メモリ割当子が使うメモリ領域。
+    /// メモリ領域を持たない場合は空となる。
+    public: std::shared_ptr<typename this_type::arena> const& get_arena()
+    const PSYQ_NOEXCEPT
+    {
+        return this->arena_;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリを割り当てる。
+    /// @return 割り当てたメモリの先頭位置。
+    public: typename this_type::pointer allocate(
+        /// [in] 割り当てる値の数。
+        typename this_type::size_type const in_count)
+    {
+        auto const local_size(in_count * sizeof(template_value));
+        return static_cast<typename this_type::pointer>(
+            this->arena_.get() != nullptr?
+                this->arena_->allocate(
+                    local_size, std::alignment_of<template_value>::value):
+                ::operator new(local_size));
+    }
+
+    /// @brief メモリを解放する。
+    /// @details
+    /// メモリ領域を使っている場合は何もせず、
+    /// メモリ領域が破棄される時にまとめて解放する。
+    public: void deallocate(
+        /// [in] 解放するメモリの先頭位置。
+        typename this_type::pointer const in_memory,
+        /// [in] 解放する値の数。
+        typename this_type::size_type const)
+    PSYQ_NOEXCEPT
+    {
+        if (this->arena_.get() == nullptr)
+        {
+            ::operator delete(in_memory);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリ割当子を比較する。
+    /// @return 同じメモリ領域を使っているか。
+    public: template<typename template_other>
+    bool operator==(
+        /// [in] 比較するメモリ割当子。
+        psyq::if_then_engine::arena_allocator<template_other> const& in_right)
+    const PSYQ_NOEXCEPT
+    {
+        return this->arena_ == in_right.arena_;
+    }
+
+    /// @brief メモリ割当子を比較する。
+    /// @return 異なるメモリ領域を使っているか。
+    public: template<typename template_other>
+    bool operator!=(
+        /// [in] 比較するメモリ割当子。
+        psyq::if_then_engine::arena_allocator<template_other> const& in_right)
+    const PSYQ_NOEXCEPT
+    {
+        return !(*this == in_right);
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリ割当子が使うメモリ領域。
+    private: std::shared_ptr<typename this_type::arena> arena_;
+
+}; // class psyq::if_then_engine::arena_allocator
+
+#endif // !defined(PSYQ_IF_THEN_ENGINE_ARENA_ALLOCATOR_HPP_)
+// vim: set expandtab:
@@ -9,6 +9,7 @@
 #include "./status_monitor.hpp"
 #include "./expression_monitor.hpp"
 #include "./handler.hpp"
+#include "./footprint.hpp"
 
 /// @brief 挙動関数の呼び出し優先順位のデフォルト値。
 #ifndef PSYQ_IF_THEN_ENGINE_DISPATCHER_FUNCTION_PRIORITY_DEFAULT
@@ -58,6 +59,8 @@ class psyq::if_then_engine::_private::dispatcher
              typename this_type::evaluator::expression::evaluation,
              template_priority>
          handler;
+    /// @brief メモリ使用量の計測値。
+    public: typedef psyq::if_then_engine::_private::footprint footprint;
 
     //-------------------------------------------------------------------------
     /// @copydoc this_type::status_monitors_
@@ -227,6 +230,45 @@ class psyq::if_then_engine::_private::dispatcher
             this->cached_handlers_.get_allocator());
         this->cached_handlers_.reserve(in_cache_capacity);
     }
+
+    /// @brief 条件挙動ハンドラの登録に備えて、監視器辞書の容量を予約する。
+    /// @details
+    /// 条件挙動ハンドラをまとめて登録する前に呼び出しておくと、
+    /// 登録の途中で辞書が何度も再ハッシュされるのを防げる。
+    public: void reserve_monitors(
+        /// [in] これから監視する状態値の数。
+        std::size_t const in_status_count,
+        /// [in] これから監視する条件式の数。
+        std::size_t const in_expression_count)
+    {
+        this_type::reserve_monitor_map(this->status_monitors_, in_status_count);
+        this_type::reserve_monitor_map(
+            this->expression_monitors_, in_expression_count);
+    }
+
+    /// @brief 条件挙動器のメモリ使用量を計測する。
+    public: void measure_footprint(
+        /// [in,out] 状態監視器辞書の計測値を加算する。
+        typename this_type::footprint& io_status_footprint,
+        /// [in,out] 条件式監視器辞書の計測値を加算する。
+        typename this_type::footprint& io_expression_footprint,
+        /// [in,out] 条件挙動キャッシュの計測値を加算する。
+        typename this_type::footprint& io_cache_footprint)
+    const
+    {
+        io_status_footprint.count_map(this->status_monitors_);
+        for (auto const& local_status_monitor: this->status_monitors_)
+        {
+            local_status_monitor.second.measure_footprint(io_status_footprint);
+        }
+        io_expression_footprint.count_map(this->expression_monitors_);
+        for (auto const& local_expression_monitor: this->expression_monitors_)
+        {
+            local_expression_monitor.second.measure_footprint(
+                io_expression_footprint);
+        }
+        io_cache_footprint.count_vector(this->cached_handlers_);
+    }
     /// @}
     //-------------------------------------------------------------------------
     /// @name 条件挙動ハンドラ
@@ -501,6 +543,22 @@ class psyq::if_then_engine::_private::dispatcher
         io_monitors.rehash(in_bucket_count);
     }
 
+    /// @brief 監視器の辞書の容量を予約する。
+    private: template<typename template_monitor_map>
+    static void reserve_monitor_map(
+        /// [in,out] 容量を予約する監視器の辞書。
+        template_monitor_map& io_monitors,
+        /// [in] これから追加する監視器の数。
+        std::size_t const in_count)
+    {
+        auto const local_count(io_monitors.size() + in_count);
+        if (io_monitors.bucket_count() * io_monitors.max_load_factor()
+            < local_count)
+        {
+            io_monitors.reserve(local_count);
+        }
+    }
+
     //-------------------------------------------------------------------------
     /// @brief status_monitor の辞書。
     private: typename this_type::status_monitor_map status_monitors_;
@@ -14,6 +14,7 @@
 #include "./evaluator.hpp"
 #include "./dispatcher.hpp"
 #include "./handler_chunk.hpp"
+#include "./arena_allocator.hpp"
 #include "./handler_builder.hpp"
 #include "./status_builder.hpp"
 #include "./expression_builder.hpp"
@@ -100,6 +101,103 @@ class psyq::if_then_engine::driver
             typename this_type::dispatcher>
         handler_chunk;
 
+    //-------------------------------------------------------------------------
+    /// @brief 駆動器のメモリ使用量の計測値。
+    /// @details
+    /// driver::measure_footprint で取得し、 driver::driver や driver::rebuild
+    /// に渡す辞書のバケット数を決める目安として使う。
+    public: class footprint
+    {
+        /// @brief this が指す値の型。
+        private: typedef footprint this_type;
+
+        /// @brief 辞書1つ分のメモリ使用量の計測値。
+        public: typedef psyq::if_then_engine::_private::footprint element;
+
+        /// @brief 駆動器が使っているメモリの大きさの概算を取得する。
+        /// @return 駆動器が使っているメモリの大きさ。バイト単位。
+        public: std::size_t get_bytes() const PSYQ_NOEXCEPT
+        {
+            return this->status_chunks_.bytes_
+                + this->statuses_.bytes_
+                + this->expression_chunks_.bytes_
+                + this->expressions_.bytes_
+                + this->status_monitors_.bytes_
+                + this->expression_monitors_.bytes_
+                + this->cached_handlers_.bytes_
+                + this->handler_chunks_.bytes_;
+        }
+
+        /// @brief 推奨するチャンク辞書のバケット数を取得する。
+        /// @return driver::rebuild の in_chunk_count に渡す値の目安。
+        public: std::size_t recommend_chunk_count(
+            /// [in] 辞書の最大負荷率。
+            float const in_max_load_factor = 1)
+        const
+        {
+            return (std::max)(
+                (std::max)(
+                    this->status_chunks_.recommend_bucket_count(
+                        0, in_max_load_factor),
+                    this->expression_chunks_.recommend_bucket_count(
+                        0, in_max_load_factor)),
+                this->handler_chunks_.element_count_);
+        }
+
+        /// @brief 推奨する状態値辞書のバケット数を取得する。
+        /// @return driver::rebuild の in_status_count に渡す値の目安。
+        public: std::size_t recommend_status_count(
+            /// [in] 辞書の最大負荷率。
+            float const in_max_load_factor = 1)
+        const
+        {
+            return (std::max)(
+                this->statuses_.recommend_bucket_count(0, in_max_load_factor),
+                this->status_monitors_.recommend_bucket_count(
+                    0, in_max_load_factor));
+        }
+
+        /// @brief 推奨する条件式辞書のバケット数を取得する。
+        /// @return driver::rebuild の in_expression_count に渡す値の目安。
+        public: std::size_t recommend_expression_count(
+            /// [in] 辞書の最大負荷率。
+            float const in_max_load_factor = 1)
+        const
+        {
+            return (std::max)(
+                this->expressions_.recommend_bucket_count(
+                    0, in_max_load_factor),
+                this->expression_monitors_.recommend_bucket_count(
+                    0, in_max_load_factor));
+        }
+
+        /// @brief 推奨する条件挙動キャッシュの予約数を取得する。
+        /// @return driver::rebuild の in_cache_capacity に渡す値の目安。
+        public: std::size_t recommend_cache_capacity() const PSYQ_NOEXCEPT
+        {
+            // 条件挙動キャッシュの容量は、これまでの最大使用数となっている。
+            return this->cached_handlers_.bucket_count_;
+        }
+
+        /// @brief 状態値ビット列チャンク辞書の計測値。
+        public: typename this_type::element status_chunks_;
+        /// @brief 状態値プロパティ辞書の計測値。
+        public: typename this_type::element statuses_;
+        /// @brief 要素条件チャンク辞書の計測値。
+        public: typename this_type::element expression_chunks_;
+        /// @brief 条件式辞書の計測値。
+        public: typename this_type::element expressions_;
+        /// @brief 状態監視器辞書の計測値。
+        public: typename this_type::element status_monitors_;
+        /// @brief 条件式監視器辞書の計測値。
+        public: typename this_type::element expression_monitors_;
+        /// @brief 条件挙動キャッシュの計測値。
+        public: typename this_type::element cached_handlers_;
+        /// @brief 条件挙動チャンクのコンテナの計測値。
+        public: typename this_type::element handler_chunks_;
+
+    }; // class footprint
+
     //-------------------------------------------------------------------------
     /// @name 構築と代入
     /// @{
@@ -164,6 +262,10 @@ class psyq::if_then_engine::driver
 #endif // defined(PSYQ_NO_STD_DEFAULTED_FUNCTION)
 
     /// @brief 駆動器を再構築する。
+    /// @details
+    /// psyq::if_then_engine::arena_allocator を使う駆動器では、
+    /// チャンクごとに新たなメモリ領域を用意してチャンクをコピーし、
+    /// 元のメモリ領域を解放する。
     public: void rebuild(
         /// [in] チャンク辞書のバケット数。
         std::size_t const in_chunk_count,
@@ -175,17 +277,45 @@ class psyq::if_then_engine::driver
         std::size_t const in_cache_capacity =
             PSYQ_IF_THEN_ENGINE_DRIVER_CACHE_CAPACITY_DEFAULT)
     {
-        this->reservoir_.rebuild(in_chunk_count, in_status_count);
+        auto const local_renew_allocator(
+            [this](
+                typename this_type::chunk_key const& in_chunk_key,
+                typename this_type::allocator_type const& in_allocator)
+            ->typename this_type::allocator_type
+            {
+                return this->renew_chunk_allocator(in_chunk_key, in_allocator);
+            });
+        this->reservoir_.rebuild(
+            in_chunk_count, in_status_count, local_renew_allocator);
         //this->accumulator_.rebuild(in_cache_capacity);
-        this->evaluator_.rebuild(in_chunk_count, in_expression_count);
+        this->evaluator_.rebuild(
+            in_chunk_count, in_expression_count, local_renew_allocator);
         this->dispatcher_.rebuild(
             in_status_count, in_expression_count, in_cache_capacity);
         this->handler_chunks_.shrink_to_fit();
         for (auto& local_handler_chunk: this->handler_chunks_)
         {
-            local_handler_chunk.shrink_to_fit();
+            local_handler_chunk.rebuild(local_renew_allocator);
         }
     }
+
+    /// @brief 駆動器のメモリ使用量を計測する。
+    /// @return 駆動器のメモリ使用量の計測値。
+    public: typename this_type::footprint measure_footprint() const
+    {
+        typename this_type::footprint local_footprint;
+        this->reservoir_.measure_footprint(
+            local_footprint.status_chunks_, local_footprint.statuses_);
+        this->evaluator_.measure_footprint(
+            local_footprint.expression_chunks_, local_footprint.expressions_);
+        this->dispatcher_.measure_footprint(
+            local_footprint.status_monitors_,
+            local_footprint.expression_monitors_,
+            local_footprint.cached_handlers_);
+        this_type::handler_chunk::measure_footprint(
+            local_footprint.handler_chunks_, this->handler_chunks_);
+        return local_footprint;
+    }
     /// @}
     //-------------------------------------------------------------------------
     /// @name チャンク
@@ -267,6 +397,13 @@ class psyq::if_then_engine::driver
         /// 文字列表が空の場合は、条件挙動ハンドラを追加しない。
         template_relation_table const& in_handler_table)
     {
+        // 文字列表の行数から、辞書の容量をあらかじめ予約しておく。
+        this->reserve_chunk(
+            in_chunk_key,
+            this_type::count_table_rows(in_status_table),
+            this_type::count_table_rows(in_expression_table),
+            this_type::count_table_rows(in_handler_table));
+
         in_status_builder(
             this->reservoir_,
             this->hash_function_,
@@ -352,6 +489,35 @@ class psyq::if_then_engine::driver
                 in_handler_attribute));
     }
 
+    /// @brief チャンクへの追加に備えて、辞書とコンテナの容量を予約する。
+    /// @details
+    /// 状態値と条件式と条件挙動ハンドラをまとめて追加する前に呼び出しておくと、
+    /// 追加の途中で辞書が何度も再ハッシュされるのを防げる。
+    /// this_type::extend_chunk は、文字列表の行数を使って自動的に呼び出す。
+    /// @note
+    /// allocator_type が psyq::if_then_engine::arena_allocator の場合は、
+    /// チャンクがまだなければ、チャンク専用のメモリ領域を用意する。
+    public: void reserve_chunk(
+        /// [in] 追加するチャンクの識別値。
+        typename this_type::chunk_key const& in_chunk_key,
+        /// [in] これから追加する状態値の数。
+        std::size_t const in_status_count,
+        /// [in] これから追加する条件式の数。
+        std::size_t const in_expression_count,
+        /// [in] これから追加する条件挙動ハンドラの数。
+        std::size_t const in_handler_count)
+    {
+        this->equip_chunk(in_chunk_key, this->reservoir_.get_allocator());
+        this->reservoir_.reserve_statuses(in_status_count);
+        this->evaluator_.reserve_expressions(in_expression_count);
+        this->dispatcher_.reserve_monitors(in_status_count, in_handler_count);
+        if (0 < in_handler_count)
+        {
+            this_type::handler_chunk::reserve(
+                this->handler_chunks_, in_chunk_key, in_handler_count);
+        }
+    }
+
     /// @brief チャンクを削除する。
     public: void erase_chunk(
         /// [in] 削除するチャンクの識別値。
@@ -492,6 +658,108 @@ class psyq::if_then_engine::driver
         this->dispatcher_._dispatch(this->reservoir_, this->evaluator_);
     }
     /// @}
+    //-------------------------------------------------------------------------
+    /// @brief チャンク専用のメモリ領域を使うチャンクを用意する。
+    /// @details
+    /// 状態値ビット列チャンクと要素条件チャンクと条件挙動チャンクが、
+    /// 1つのメモリ領域を共有する。チャンクが全て削除されると、
+    /// メモリ領域もまとめて解放される。
+    private: template<typename template_value>
+    void equip_chunk(
+        /// [in] 用意するチャンクの識別値。
+        typename this_type::chunk_key const& in_chunk_key,
+        /// [in] 駆動器が使っているメモリ割当子。
+        psyq::if_then_engine::arena_allocator<template_value> const&
+            in_allocator)
+    {
+        auto const local_reservoir_chunk(
+            this->reservoir_.find_chunk(in_chunk_key));
+        auto const local_allocator(
+            local_reservoir_chunk != nullptr?
+                typename this_type::allocator_type(
+                    local_reservoir_chunk->bit_blocks_.get_allocator()):
+                in_allocator.make_arena());
+        this->reservoir_.equip_chunk(in_chunk_key, local_allocator);
+        this->evaluator_.equip_chunk(in_chunk_key, local_allocator);
+        this_type::handler_chunk::equip(
+            this->handler_chunks_, in_chunk_key, local_allocator);
+    }
+
+    /// @brief チャンク専用のメモリ領域を使わないので、何もしない。
+    private: template<typename template_allocator_other>
+    void equip_chunk(
+        typename this_type::chunk_key const&,
+        template_allocator_other const&)
+    PSYQ_NOEXCEPT
+    {}
+
+    /// @brief 再構築したチャンクが使うメモリ割当子を用意する。
+    /// @details
+    /// 状態貯蔵器と条件評価器と条件挙動チャンクのうち、
+    /// 先に再構築したものが用意した新たなメモリ領域を、後のものも共有する。
+    /// @return 再構築したチャンクが使うメモリ割当子。
+    private: template<typename template_value>
+    psyq::if_then_engine::arena_allocator<template_value> renew_chunk_allocator(
+        /// [in] 再構築するチャンクの識別値。
+        typename this_type::chunk_key const& in_chunk_key,
+        /// [in] 再構築する前のチャンクが使っているメモリ割当子。
+        psyq::if_then_engine::arena_allocator<template_value> const&
+            in_allocator)
+    const
+    {
+        if (in_allocator.get_arena().get() == nullptr)
+        {
+            return in_allocator;
+        }
+        auto const local_reservoir_chunk(
+            this->reservoir_.find_chunk(in_chunk_key));
+        if (local_reservoir_chunk != nullptr)
+        {
+            typename this_type::allocator_type const local_allocator(
+                local_reservoir_chunk->bit_blocks_.get_allocator());
+            if (local_allocator != in_allocator)
+            {
+                return local_allocator;
+            }
+        }
+        auto const local_evaluator_chunk(
+            this->evaluator_._find_chunk(in_chunk_key));
+        if (local_evaluator_chunk != nullptr)
+        {
+            typename this_type::allocator_type const local_allocator(
+                local_evaluator_chunk->sub_expressions_.get_allocator());
+            if (local_allocator != in_allocator)
+            {
+                return local_allocator;
+            }
+        }
+        return in_allocator.make_arena();
+    }
+
+    /// @brief チャンク専用のメモリ領域を使わないので、同じメモリ割当子を返す。
+    /// @return in_allocator
+    private: template<typename template_allocator_other>
+    static template_allocator_other const& renew_chunk_allocator(
+        typename this_type::chunk_key const&,
+        template_allocator_other const& in_allocator)
+    PSYQ_NOEXCEPT
+    {
+        return in_allocator;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 文字列表の属性行を除いた行数を取得する。
+    /// @return 文字列表の属性行を除いた行数。
+    private: template<typename template_relation_table>
+    static std::size_t count_table_rows(
+        /// [in] 行数を数える psyq::string::relation_table 。
+        template_relation_table const& in_table)
+    {
+        auto const local_row_count(in_table.get_row_count());
+        return in_table.get_attribute_row() < local_row_count?
+            local_row_count - 1: local_row_count;
+    }
+
     //-------------------------------------------------------------------------
     /// @brief 駆動器で用いる状態貯蔵器。
     private: typename this_type::reservoir reservoir_;
@@ -8,6 +8,7 @@
 #include <vector>
 #include "../hash/primitive_bits.hpp"
 #include "./expression.hpp"
+#include "./footprint.hpp"
 
 /// @cond
 namespace psyq
@@ -72,6 +73,8 @@ class psyq::if_then_engine::_private::evaluator
         chunk;
     /// @brief 要素条件チャンクの識別値。
     public: typedef typename this_type::reservoir::chunk_key chunk_key;
+    /// @brief メモリ使用量の計測値。
+    public: typedef psyq::if_then_engine::_private::footprint footprint;
 
     //-------------------------------------------------------------------------
     /// @brief 条件式の辞書。
@@ -148,21 +151,108 @@ class psyq::if_then_engine::_private::evaluator
     }
 
     /// @brief 条件評価器を再構築する。
+    /// @details
+    /// 要素条件チャンクは、元と同じメモリ割当子を使う。
     public: void rebuild(
         /// [in] 要素条件チャンク辞書のバケット数。
         std::size_t const in_chunk_count,
         /// [in] 条件式辞書のバケット数。
         std::size_t const in_expression_count)
+    {
+        this->rebuild(
+            in_chunk_count,
+            in_expression_count,
+            [](
+                typename this_type::chunk_key const&,
+                typename this_type::allocator_type const& in_allocator)
+            ->typename this_type::allocator_type
+            {
+                return in_allocator;
+            });
+    }
+
+    /// @brief 条件評価器を再構築する。
+    /// @details
+    /// in_renew_allocator がチャンクごとに返すメモリ割当子が元と異なる場合は、
+    /// そのメモリ割当子を使う要素条件チャンクへ要素条件をコピーする。
+    public: template<typename template_renew_allocator>
+    void rebuild(
+        /// [in] 要素条件チャンク辞書のバケット数。
+        std::size_t const in_chunk_count,
+        /// [in] 条件式辞書のバケット数。
+        std::size_t const in_expression_count,
+        /// [in] チャンクの識別値と元のチャンクのメモリ割当子を受け取り、
+        /// 再構築したチャンクが使うメモリ割当子を返す関数オブジェクト。
+        template_renew_allocator const& in_renew_allocator)
     {
         this->expressions_.rehash(in_expression_count);
         this->chunks_.rehash(in_chunk_count);
         for (auto& local_chunk: this->chunks_)
         {
-            local_chunk.second.sub_expressions_.shrink_to_fit();
-            local_chunk.second.status_transitions_.shrink_to_fit();
-            local_chunk.second.status_comparisons_.shrink_to_fit();
+            auto& local_source(local_chunk.second);
+            typename this_type::allocator_type const local_allocator(
+                local_source.sub_expressions_.get_allocator());
+            typename this_type::allocator_type const local_new_allocator(
+                in_renew_allocator(local_chunk.first, local_allocator));
+            if (local_new_allocator != local_allocator)
+            {
+                typename this_type::chunk local_target(local_new_allocator);
+                local_target.sub_expressions_.assign(
+                    local_source.sub_expressions_.begin(),
+                    local_source.sub_expressions_.end());
+                local_target.status_transitions_.assign(
+                    local_source.status_transitions_.begin(),
+                    local_source.status_transitions_.end());
+                local_target.status_comparisons_.assign(
+                    local_source.status_comparisons_.begin(),
+                    local_source.status_comparisons_.end());
+                local_source = std::move(local_target);
+            }
+            else
+            {
+                local_source.sub_expressions_.shrink_to_fit();
+                local_source.status_transitions_.shrink_to_fit();
+                local_source.status_comparisons_.shrink_to_fit();
+            }
         }
     }
+
+    /// @brief 条件式の登録に備えて、条件式辞書の容量を予約する。
+    /// @details
+    /// 条件式をまとめて登録する前に呼び出しておくと、
+    /// 登録の途中で辞書が何度も再ハッシュされるのを防げる。
+    public: void reserve_expressions(
+        /// [in] これから登録する条件式の数。
+        std::size_t const in_expression_count)
+    {
+        auto const local_expression_count(
+            this->expressions_.size() + in_expression_count);
+        if (this->expressions_.bucket_count()
+            * this->expressions_.max_load_factor() < local_expression_count)
+        {
+            this->expressions_.reserve(local_expression_count);
+        }
+    }
+
+    /// @brief 条件評価器のメモリ使用量を計測する。
+    public: void measure_footprint(
+        /// [in,out] 要素条件チャンク辞書の計測値を加算する。
+        typename this_type::footprint& io_chunk_footprint,
+        /// [in,out] 条件式辞書の計測値を加算する。
+        typename this_type::footprint& io_expression_footprint)
+    const
+    {
+        io_chunk_footprint.count_map(this->chunks_);
+        for (auto const& local_chunk: this->chunks_)
+        {
+            io_chunk_footprint.add_vector(local_chunk.second.sub_expressions_);
+            io_chunk_footprint.add_vector(
+                local_chunk.second.status_transitions_);
+            io_chunk_footprint.add_vector(
+                local_chunk.second.status_comparisons_);
+        }
+        io_expression_footprint.count_map(this->expressions_);
+    }
     /// @}
     //-------------------------------------------------------------------------
     /// @name 条件式
@@ -474,6 +564,23 @@ class psyq::if_then_engine::_private::evaluator
             in_status_comparison_capacity);
     }
 
+    /// @brief 要素条件チャンクを用意する。
+    /// @details
+    /// in_chunk_key に対応するチャンクがまだない場合は、
+    /// in_allocator を使う空のチャンクを追加する。
+    /// @retval true  チャンクを追加した。
+    /// @retval false チャンクがすでにあったので、何もしなかった。
+    public: bool equip_chunk(
+        /// [in] 用意する要素条件チャンクに対応する識別値。
+        typename this_type::chunk_key const& in_chunk_key,
+        /// [in] 追加するチャンクが使うメモリ割当子。
+        typename this_type::allocator_type const& in_allocator)
+    {
+        return this->chunks_.emplace(
+            in_chunk_key,
+            typename this_type::chunk_map::mapped_type(in_allocator)).second;
+    }
+
     /// @brief 要素条件チャンクと、それを使っている条件式を破棄する。
     /// @retval true  成功。チャンクを破棄した。
     /// @retval false 失敗。 in_chunk_key に対応するチャンクがない。
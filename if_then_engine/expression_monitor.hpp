@@ -53,7 +53,8 @@ class psyq::if_then_engine::_private::expression_monitor
     public: explicit expression_monitor(
         /// [in] メモリ割当子の初期値。
         typename this_type::handler_container::allocator_type const& in_allocator):
-    handlers_(in_allocator)
+    handlers_(in_allocator),
+    handler_conditions_(this_type::handler::INVALID_CONDITION)
     {}
 
 #ifdef PSYQ_NO_STD_DEFAULTED_FUNCTION
@@ -62,7 +63,8 @@ class psyq::if_then_engine::_private::expression_monitor
         /// [in,out] ムーブ元となるインスタンス。
         this_type&& io_source):
     handlers_(std::move(io_source.handlers_)),
-    flags_(std::move(io_source.flags_))
+    flags_(std::move(io_source.flags_)),
+    handler_conditions_(std::move(io_source.handler_conditions_))
     {}
 
     /// @brief ムーブ代入演算子。
@@ -75,6 +77,8 @@ class psyq::if_then_engine::_private::expression_monitor
         {
             this->handlers_ = std::move(io_source.handlers_);
             this->flags_ = std::move(io_source.flags_);
+            this->handler_conditions_ =
+                std::move(io_source.handler_conditions_);
         }
         return *this;
     }
@@ -126,12 +130,21 @@ class psyq::if_then_engine::_private::expression_monitor
                 io_expression_monitors.emplace(
                     in_expression_key,
                     this_type(io_expression_monitors.get_allocator())));
-            auto& local_handlers(local_emplace.first->second.handlers_);
-            if (local_emplace.second
-                || !this_type::trim_handlers(local_handlers, local_function, false))
+            auto& local_monitor(local_emplace.first->second);
+            auto& local_handlers(local_monitor.handlers_);
+            auto const local_find(
+                !local_emplace.second
+                && this_type::trim_handlers(
+                    local_handlers, local_function, false));
+            if (!local_emplace.second)
+            {
+                local_monitor.update_handler_conditions();
+            }
+            if (!local_find)
             {
                 // 条件式監視器へ条件挙動ハンドラを追加する。
                 local_handlers.emplace_back(in_condition, in_function, in_priority);
+                local_monitor.handler_conditions_ |= in_condition;
                 return true;
             }
         }
@@ -145,7 +158,10 @@ class psyq::if_then_engine::_private::expression_monitor
         /// [in] 削除する this_type::handler に対応する条件挙動関数。
         typename this_type::handler::function const& in_function)
     {
-        return this_type::trim_handlers(this->handlers_, &in_function, true);
+        auto const local_trim_handlers(
+            this_type::trim_handlers(this->handlers_, &in_function, true));
+        this->update_handler_conditions();
+        return local_trim_handlers;
     }
 
     /// @brief 条件挙動ハンドラを整理する。
@@ -154,10 +170,21 @@ class psyq::if_then_engine::_private::expression_monitor
     public: bool shrink_handlers()
     {
         this_type::trim_handlers(this->handlers_, nullptr, false);
+        this->update_handler_conditions();
         this->handlers_.shrink_to_fit();
         return this->handlers_.empty();
     }
 
+    /// @brief 条件挙動ハンドラのコンテナのメモリ使用量を計測する。
+    public: template<typename template_footprint>
+    void measure_footprint(
+        /// [in,out] メモリ使用量を加算する _private::footprint 。
+        template_footprint& io_footprint)
+    const
+    {
+        io_footprint.add_vector(this->handlers_);
+    }
+
     //-------------------------------------------------------------------------
     /// @brief 条件式を状態監視器へ登録する。
     /// @details
@@ -260,9 +287,17 @@ class psyq::if_then_engine::_private::expression_monitor
             auto i(io_expression_monitors.begin());
             i != io_expression_monitors.end();)
         {
-            // 条件式の評価の要求を検知する。
+            // 条件挙動ハンドラがなければ、条件式を評価せずに監視器を削除する。
             auto& local_expression_key(i->first);
             auto& local_expression_monitor(i->second);
+            if (local_expression_monitor.handler_conditions_
+                == this_type::handler::INVALID_CONDITION)
+            {
+                i = io_expression_monitors.erase(i);
+                continue;
+            }
+
+            // 条件式の評価の要求を検知する。
             if (local_expression_monitor.detect_transition(
                     in_evaluator, local_expression_key))
             {
@@ -473,16 +508,22 @@ class psyq::if_then_engine::_private::expression_monitor
         auto const local_transition(
             this_type::handler::make_condition(
                 local_now_evaluation, local_last_evaluation));
-        if (local_transition != this_type::handler::INVALID_CONDITION)
+        if (local_transition != this_type::handler::INVALID_CONDITION
+            && local_transition
+                == (local_transition & this->handler_conditions_))
         {
             // 条件式の評価の変化が挙動条件と合致すれば、
             // 条件挙動ハンドラをキャッシュに貯める。
+            // 挙動条件の和集合に含まれない変化は、どのハンドラとも合致しないので、
+            // ハンドラの走査を省略している。
+            auto local_erase(false);
             for (auto i(this->handlers_.begin()); i != this->handlers_.end();)
             {
                 auto const& local_handler(*i);
                 if (local_handler.get_function().expired())
                 {
                     i = this->handlers_.erase(i);
+                    local_erase = true;
                 }
                 else
                 {
@@ -497,7 +538,23 @@ class psyq::if_then_engine::_private::expression_monitor
                     }
                 }
             }
+            if (local_erase)
+            {
+                this->update_handler_conditions();
+            }
+        }
+    }
+
+    /// @brief 条件挙動ハンドラの挙動条件の和集合を更新する。
+    private: void update_handler_conditions() PSYQ_NOEXCEPT
+    {
+        typename this_type::handler::condition local_conditions(
+            this_type::handler::INVALID_CONDITION);
+        for (auto const& local_handler: this->handlers_)
+        {
+            local_conditions |= local_handler.get_condition();
         }
+        this->handler_conditions_ = local_conditions;
     }
 
     /// @brief 条件式を評価する。
@@ -604,6 +661,8 @@ class psyq::if_then_engine::_private::expression_monitor
     private: typename this_type::handler_container handlers_;
     /// @brief 条件式の評価結果を記録するフラグの集合。
     private: std::bitset<8> flags_;
+    /// @brief this_type::handlers_ の挙動条件の和集合。
+    private: typename this_type::handler::condition handler_conditions_;
 
 }; // class psyq::if_then_engine::_private::expression_monitor
 
@@ -0,0 +1,137 @@
+﻿/// @file
+/// @brief @copybrief psyq::if_then_engine::_private::footprint
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_IF_THEN_ENGINE_FOOTPRINT_HPP_
+#define PSYQ_IF_THEN_ENGINE_FOOTPRINT_HPP_
+
+#include <cstddef>
+#include <cmath>
+#include "../assert.hpp"
+
+/// @cond
+namespace psyq
+{
+    namespace if_then_engine
+    {
+        namespace _private
+        {
+            class footprint;
+        } // namespace _private
+    } // namespace if_then_engine
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief メモリ使用量の計測値。
+/// @details
+/// 1つの辞書の要素数とバケット数、
+/// および辞書とそれに付随するコンテナが使っているメモリの大きさを保持する。
+/// @note
+/// 辞書のノードの大きさは標準ライブラリの実装に依存するので、
+/// footprint::bytes_ は概算となる。
+class psyq::if_then_engine::_private::footprint
+{
+    /// @brief this が指す値の型。
+    private: typedef footprint this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 空の計測値を構築する。
+    public: footprint() PSYQ_NOEXCEPT:
+    bytes_(0),
+    element_count_(0),
+    bucket_count_(0)
+    {}
+
+    //-------------------------------------------------------------------------
+    /// @brief 負荷率を取得する。
+    /// @return
+    /// 要素数をバケット数で割った値。
+    /// 動的配列を計測した場合は、要素数を容量で割った値となる。
+    public: float get_load_factor() const PSYQ_NOEXCEPT
+    {
+        return 0 < this->bucket_count_?
+            static_cast<float>(this->element_count_) / this->bucket_count_: 0;
+    }
+
+    /// @brief 推奨するバケット数を取得する。
+    /// @return
+    /// 現在の要素数に in_extra_count を加えた数の要素を格納しても、
+    /// 最大負荷率を超えないバケット数。
+    public: std::size_t recommend_bucket_count(
+        /// [in] 今後に追加する予定の要素数。
+        std::size_t const in_extra_count = 0,
+        /// [in] 辞書の最大負荷率。
+        float const in_max_load_factor = 1)
+    const
+    {
+        PSYQ_ASSERT(0 < in_max_load_factor);
+        return static_cast<std::size_t>(
+            std::ceil(
+                (this->element_count_ + in_extra_count) / in_max_load_factor));
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 辞書を計測し、要素数とバケット数とメモリ使用量を加算する。
+    /// @return *this
+    public: template<typename template_map>
+    this_type& count_map(
+        /// [in] 計測する std::unordered_map 互換の辞書。
+        template_map const& in_map)
+    {
+        this->element_count_ += in_map.size();
+        this->bucket_count_ += in_map.bucket_count();
+        return this->add_map(in_map);
+    }
+
+    /// @brief 動的配列を計測し、要素数と容量とメモリ使用量を加算する。
+    /// @return *this
+    public: template<typename template_vector>
+    this_type& count_vector(
+        /// [in] 計測する std::vector 互換の動的配列。
+        template_vector const& in_vector)
+    {
+        this->element_count_ += in_vector.size();
+        this->bucket_count_ += in_vector.capacity();
+        return this->add_vector(in_vector);
+    }
+
+    /// @brief 辞書を計測し、メモリ使用量のみを加算する。
+    /// @return *this
+    public: template<typename template_map>
+    this_type& add_map(
+        /// [in] 計測する std::unordered_map 互換の辞書。
+        template_map const& in_map)
+    {
+        // ノードは、要素と次のノードへのポインタとハッシュ値を持つと仮定する。
+        this->bytes_ += in_map.bucket_count() * sizeof(void*)
+            + in_map.size() * (
+                sizeof(typename template_map::value_type)
+                + sizeof(void*)
+                + sizeof(std::size_t));
+        return *this;
+    }
+
+    /// @brief 動的配列を計測し、メモリ使用量のみを加算する。
+    /// @return *this
+    public: template<typename template_vector>
+    this_type& add_vector(
+        /// [in] 計測する std::vector 互換の動的配列。
+        template_vector const& in_vector)
+    {
+        this->bytes_ += in_vector.capacity()
+            * sizeof(typename template_vector::value_type);
+        return *this;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 使用しているメモリの大きさの概算。バイト単位。
+    public: std::size_t bytes_;
+    /// @brief 辞書の要素数。
+    public: std::size_t element_count_;
+    /// @brief 辞書のバケット数。動的配列の場合は容量。
+    public: std::size_t bucket_count_;
+
+}; // class psyq::if_then_engine::_private::footprint
+
+#endif // !defined(PSYQ_IF_THEN_ENGINE_FOOTPRINT_HPP_)
+// vim: set expandtab:
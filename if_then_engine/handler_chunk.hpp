@@ -103,6 +103,38 @@ class psyq::if_then_engine::_private::handler_chunk
         this->functions_.shrink_to_fit();
     }
 
+    /// @brief 条件挙動関数のコンテナを再構築する。
+    /// @details
+    /// in_renew_allocator が返すメモリ割当子が元と異なる場合は、
+    /// そのメモリ割当子を使うコンテナへ条件挙動関数を移動する。
+    /// 同じ場合は、コンテナを整理するだけ。
+    public: template<typename template_renew_allocator>
+    void rebuild(
+        /// [in] チャンクの識別値と元のコンテナのメモリ割当子を受け取り、
+        /// 再構築したコンテナが使うメモリ割当子を返す関数オブジェクト。
+        template_renew_allocator const& in_renew_allocator)
+    {
+        typename template_dispatcher::allocator_type const local_allocator(
+            this->functions_.get_allocator());
+        typename template_dispatcher::allocator_type const local_new_allocator(
+            in_renew_allocator(this->key_, local_allocator));
+        if (local_new_allocator != local_allocator)
+        {
+            typename this_type::function_shared_ptr_container local_functions(
+                local_new_allocator);
+            local_functions.reserve(this->functions_.size());
+            std::move(
+                this->functions_.begin(),
+                this->functions_.end(),
+                std::back_inserter(local_functions));
+            this->functions_ = std::move(local_functions);
+        }
+        else
+        {
+            this->shrink_to_fit();
+        }
+    }
+
     //-------------------------------------------------------------------------
     /// @brief 条件挙動チャンクに handler::function を追加する。
     /// @retval true  成功。 handler::function を追加した。
@@ -155,6 +187,40 @@ class psyq::if_then_engine::_private::handler_chunk
         return local_count;
     }
 
+    /// @brief 条件挙動チャンクに handler::function を追加する容量を予約する。
+    public: static void reserve(
+        /// [in,out] 予約する条件挙動チャンクのコンテナ。
+        typename this_type::container& io_chunks,
+        /// [in] 予約する条件挙動チャンクの識別値。
+        typename this_type::key const& in_key,
+        /// [in] これから追加する handler::function の数。
+        std::size_t const in_function_count)
+    {
+        auto& local_chunk_functions(
+            this_type::equip(io_chunks, in_key).functions_);
+        local_chunk_functions.reserve(
+            local_chunk_functions.size() + in_function_count);
+    }
+
+    /// @brief 条件挙動チャンクのコンテナのメモリ使用量を計測する。
+    /// @details
+    /// 条件挙動チャンクの数と容量、および条件挙動チャンクが保持する
+    /// handler::function_shared_ptr と handler::function の大きさを加算する。
+    public: static void measure_footprint(
+        /// [in,out] 計測値を加算する _private::footprint 。
+        typename this_type::dispatcher::footprint& io_footprint,
+        /// [in] 計測する条件挙動チャンクのコンテナ。
+        typename this_type::container const& in_chunks)
+    {
+        io_footprint.count_vector(in_chunks);
+        for (auto const& local_chunk: in_chunks)
+        {
+            io_footprint.add_vector(local_chunk.functions_);
+            io_footprint.bytes_ += local_chunk.functions_.size()
+                * sizeof(typename this_type::dispatcher::handler::function);
+        }
+    }
+
     /// @brief コンテナから条件挙動チャンクを削除する。
     /// @retval true  in_key に対応する条件挙動チャンクを削除した。
     /// @retval false in_key に対応する条件挙動チャンクがコンテナになかった。
@@ -197,6 +263,19 @@ class psyq::if_then_engine::_private::handler_chunk
         typename this_type::container& io_chunks,
         /// [in] 用意する条件挙動チャンクの識別値。
         typename this_type::key const& in_key)
+    {
+        return this_type::equip(io_chunks, in_key, io_chunks.get_allocator());
+    }
+
+    /// @brief 条件挙動チャンクを用意する。
+    /// @return 用意した条件挙動チャンク。
+    public: static this_type& equip(
+        /// [in,out] 条件挙動チャンクのコンテナ。
+        typename this_type::container& io_chunks,
+        /// [in] 用意する条件挙動チャンクの識別値。
+        typename this_type::key const& in_key,
+        /// [in] 条件挙動チャンクを追加する場合に、チャンクが使うメモリ割当子。
+        typename this_type::dispatcher::allocator_type const& in_allocator)
     {
         // 条件挙動関数を追加する条件挙動チャンクを用意する。
         auto const local_lower_bound(
@@ -210,7 +289,7 @@ class psyq::if_then_engine::_private::handler_chunk
             *local_lower_bound:
             *io_chunks.insert(
                 local_lower_bound,
-                this_type(in_key, io_chunks.get_allocator()));
+                this_type(in_key, in_allocator));
     }
 
     //-------------------------------------------------------------------------
@@ -0,0 +1,230 @@
+﻿/// @file
+/// @brief @copybrief psyq::if_then_engine::key_interner
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_IF_THEN_ENGINE_KEY_INTERNER_HPP_
+#define PSYQ_IF_THEN_ENGINE_KEY_INTERNER_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../string/flyweight.hpp"
+
+/// @cond
+namespace psyq
+{
+    namespace if_then_engine
+    {
+        template<typename, typename, typename> class key_interner;
+    } // namespace if_then_engine
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief 文字列を、密な32ビットの識別番号に変換する関数オブジェクト。
+/// @details
+/// driver の template_hasher にこの型を指定すると、
+/// 状態値とチャンクと条件式の識別値が、
+/// 文字列のハッシュ値ではなく、文字列を登録した順に割り当てた識別番号となる。
+/// - 空文字列の識別番号は常に0となる。
+/// - 同じ文字列には、常に同じ識別番号を割り当てる。
+/// - 識別番号は1から順に割り当てるので、ハッシュ値の衝突は起こらない。
+///
+/// 駆動器の辞書は psyq::hash::primitive_bits で識別値をそのままハッシュ値とするので、
+/// 辞書のバケット数を識別番号の数以上にしておけば、
+/// 辞書の検索は、識別番号を添字とした配列の検索と同等になる。
+/// @note
+/// 登録した文字列の辞書は、コピーしたインスタンスと共有する。
+/// スレッドセーフではないので、複数のスレッドから同時に使わないこと。
+/// @tparam template_string    @copydoc key_interner::argument_type
+/// @tparam template_hasher    文字列の辞書で使う、文字列ハッシュ関数オブジェクトの型。
+/// @tparam template_allocator @copydoc key_interner::allocator_type
+template<
+    typename template_string = psyq::string::view<char>,
+    typename template_hasher = PSYQ_STRING_FLYWEIGHT_HASHER_DEFAULT,
+    typename template_allocator = std::allocator<void*>>
+class psyq::if_then_engine::key_interner
+{
+    /// @brief this が指す値の型。
+    private: typedef key_interner this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 識別番号に変換する文字列。
+    public: typedef template_string argument_type;
+    /// @brief 文字列から変換した識別番号。
+    public: typedef std::uint32_t result_type;
+    /// @brief 各種コンテナに用いるメモリ割当子の型。
+    public: typedef template_allocator allocator_type;
+    /// @brief 登録した文字列を保持する型。
+    public: typedef
+        std::basic_string<
+            typename this_type::argument_type::value_type,
+            typename this_type::argument_type::traits_type,
+            typename this_type::allocator_type>
+        string;
+
+    //-------------------------------------------------------------------------
+    /// @brief 登録した文字列の辞書で使うハッシュ関数オブジェクト。
+    private: struct string_hash
+    {
+        std::size_t operator()(
+            typename key_interner::string const& in_string)
+        const PSYQ_NOEXCEPT
+        {
+            return template_hasher()(
+                typename key_interner::argument_type(
+                    in_string.data(), in_string.size()));
+        }
+    };
+    /// @brief 登録した文字列の辞書。
+    private: typedef
+        std::unordered_map<
+            typename this_type::string,
+            typename this_type::result_type,
+            typename this_type::string_hash,
+            std::equal_to<typename this_type::string>,
+            typename this_type::allocator_type>
+        id_map;
+    /// @brief 識別番号を添字として、登録した文字列を参照するコンテナ。
+    private: typedef
+        std::vector<
+            typename this_type::string const*,
+            typename this_type::allocator_type>
+        string_container;
+    /// @brief 文字列と識別番号の対応表。
+    private: struct table
+    {
+        table(
+            std::size_t const in_reserve_ids,
+            typename key_interner::allocator_type const& in_allocator):
+        ids_(
+            in_reserve_ids,
+            typename key_interner::string_hash(),
+            std::equal_to<typename key_interner::string>(),
+            in_allocator),
+        strings_(in_allocator)
+        {
+            // 空文字列の識別番号は0とする。
+            this->strings_.reserve(in_reserve_ids + 1);
+            this->strings_.push_back(nullptr);
+        }
+
+        /// @brief 登録した文字列の辞書。
+        typename key_interner::id_map ids_;
+        /// @brief 識別番号を添字とする、登録した文字列のコンテナ。
+        typename key_interner::string_container strings_;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @brief 空の変換器を構築する。
+    public: explicit key_interner(
+        /// [in] 登録する文字列の予約数。
+        std::size_t const in_reserve_ids = 0,
+        /// [in] 使用するメモリ割当子の初期値。
+        typename this_type::allocator_type const& in_allocator =
+            typename this_type::allocator_type())
+    :
+    table_(
+        std::allocate_shared<typename this_type::table>(
+            in_allocator, in_reserve_ids, in_allocator))
+    {}
+
+    //-------------------------------------------------------------------------
+    /// @brief 文字列を識別番号に変換する。
+    /// @details 文字列がまだ登録されてないなら、新たな識別番号を割り当てる。
+    /// @return in_string に対応する識別番号。
+    public: typename this_type::result_type operator()(
+        /// [in] 識別番号に変換する文字列。
+        typename this_type::argument_type const& in_string)
+    const
+    {
+        if (in_string.empty())
+        {
+            return 0;
+        }
+        auto& local_table(*this->table_);
+        auto const local_emplace(
+            local_table.ids_.emplace(
+                typename this_type::string(
+                    in_string.data(),
+                    in_string.size(),
+                    local_table.ids_.get_allocator()),
+                static_cast<typename this_type::result_type>(
+                    local_table.strings_.size())));
+        if (local_emplace.second)
+        {
+            PSYQ_ASSERT(
+                local_table.strings_.size()
+                == local_emplace.first->second);
+            local_table.strings_.push_back(&local_emplace.first->first);
+        }
+        return local_emplace.first->second;
+    }
+
+    /// @brief 登録済の文字列を識別番号に変換する。
+    /// @return
+    /// in_string に対応する識別番号。
+    /// 文字列が登録されてない場合は0を返す。
+    public: typename this_type::result_type find_id(
+        /// [in] 識別番号に変換する文字列。
+        typename this_type::argument_type const& in_string)
+    const
+    {
+        auto const& local_ids(this->table_->ids_);
+        auto const local_find(
+            local_ids.find(
+                typename this_type::string(
+                    in_string.data(),
+                    in_string.size(),
+                    local_ids.get_allocator())));
+        return local_find != local_ids.end()? local_find->second: 0;
+    }
+
+    /// @brief 識別番号に対応する文字列を取得する。
+    /// @return
+    /// in_id に対応する文字列。
+    /// 該当する文字列がない場合は、空文字列を返す。
+    public: typename this_type::argument_type find_string(
+        /// [in] 取得する文字列に対応する識別番号。
+        typename this_type::result_type const in_id)
+    const
+    {
+        auto const& local_strings(this->table_->strings_);
+        if (local_strings.size() <= in_id || local_strings[in_id] == nullptr)
+        {
+            return typename this_type::argument_type();
+        }
+        auto const& local_string(*local_strings[in_id]);
+        return typename this_type::argument_type(
+            local_string.data(), local_string.size());
+    }
+
+    /// @brief 割り当てた識別番号の数を取得する。
+    /// @return
+    /// 割り当てた識別番号の数。空文字列の識別番号0も含む。
+    /// 識別番号は、この値より小さい。
+    public: std::size_t get_id_count() const PSYQ_NOEXCEPT
+    {
+        return this->table_->strings_.size();
+    }
+
+    /// @brief 文字列の登録に備えて、容量を予約する。
+    public: void reserve(
+        /// [in] これから登録する文字列の数。
+        std::size_t const in_id_count)
+    {
+        auto& local_table(*this->table_);
+        local_table.ids_.reserve(local_table.ids_.size() + in_id_count);
+        local_table.strings_.reserve(
+            local_table.strings_.size() + in_id_count);
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 文字列と識別番号の対応表。コピーしたインスタンスと共有する。
+    private: std::shared_ptr<typename this_type::table> table_;
+
+}; // class psyq::if_then_engine::key_interner
+
+#endif // !defined(PSYQ_IF_THEN_ENGINE_KEY_INTERNER_HPP_)
+// vim: set expandtab:
@@ -0,0 +1,209 @@
+﻿/// @file
+/// @brief @copybrief psyq::if_then_engine::_private::monotonic_arena
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_IF_THEN_ENGINE_MONOTONIC_ARENA_HPP_
+#define PSYQ_IF_THEN_ENGINE_MONOTONIC_ARENA_HPP_
+
+#ifndef PSYQ_IF_THEN_ENGINE_ARENA_BLOCK_SIZE_DEFAULT
+#define PSYQ_IF_THEN_ENGINE_ARENA_BLOCK_SIZE_DEFAULT 4096
+#endif // !defined(PSYQ_IF_THEN_ENGINE_ARENA_BLOCK_SIZE_DEFAULT)
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include "../assert.hpp"
+
+/// @cond
+namespace psyq
+{
+    namespace if_then_engine
+    {
+        namespace _private
+        {
+            class monotonic_arena;
+        } // namespace _private
+    } // namespace if_then_engine
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief 単調増加のメモリ領域。
+/// @details
+/// ブロック単位でメモリを確保し、その先頭から順にメモリを切り出す。
+/// 切り出したメモリを個別に解放することはせず、
+/// monotonic_arena::release で全てのブロックをまとめて解放する。
+class psyq::if_then_engine::_private::monotonic_arena
+{
+    /// @brief this が指す値の型。
+    private: typedef monotonic_arena this_type;
+
+    /// @brief メモリブロックの先頭に置く管理情報。
+    private: struct block_header
+    {
+        /// @brief 次のメモリブロック。
+        block_header* next_;
+        /// @brief メモリブロックの大きさ。バイト単位。
+        std::size_t size_;
+    };
+
+    //-------------------------------------------------------------------------
+    /// @brief 空のメモリ領域を構築する。
+    public: explicit monotonic_arena(
+        /// [in] 確保するメモリブロックの大きさの最小値。バイト単位。
+        std::size_t const in_block_size =
+            PSYQ_IF_THEN_ENGINE_ARENA_BLOCK_SIZE_DEFAULT)
+    PSYQ_NOEXCEPT:
+    blocks_(nullptr),
+    free_begin_(nullptr),
+    free_end_(nullptr),
+    block_size_(in_block_size),
+    allocated_bytes_(0),
+    reserved_bytes_(0)
+    {}
+
+    /// @brief 全てのメモリブロックを解放する。
+    public: ~monotonic_arena()
+    {
+        this->release();
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリを切り出す。
+    /// @return 切り出したメモリの先頭位置。
+    public: void* allocate(
+        /// [in] 切り出すメモリの大きさ。バイト単位。
+        std::size_t const in_size,
+        /// [in] 切り出すメモリの境界単位。バイト単位。
+        std::size_t const in_alignment)
+    {
+        PSYQ_ASSERT(
+            0 < in_alignment && (in_alignment & (in_alignment - 1)) == 0);
+        auto local_memory(
+            this_type::align_memory(this->free_begin_, in_alignment));
+        if (local_memory <= this->free_end_
+            && in_size <= static_cast<std::size_t>(
+                this->free_end_ - local_memory))
+        {
+            this->free_begin_ = local_memory + in_size;
+        }
+        else
+        {
+            // 空き領域が足りないので、新たなメモリブロックを確保する。
+            local_memory = this->allocate_block(in_size, in_alignment);
+        }
+        this->allocated_bytes_ += in_size;
+        return local_memory;
+    }
+
+    /// @brief 全てのメモリブロックを、まとめて解放する。
+    /// @warning 切り出したメモリは、全て使えなくなる。
+    public: void release() PSYQ_NOEXCEPT
+    {
+        for (auto i(this->blocks_); i != nullptr;)
+        {
+            auto const local_next(i->next_);
+            ::operator delete(i);
+            i = local_next;
+        }
+        this->blocks_ = nullptr;
+        this->free_begin_ = nullptr;
+        this->free_end_ = nullptr;
+        this->allocated_bytes_ = 0;
+        this->reserved_bytes_ = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 切り出したメモリの合計を取得する。
+    /// @return 切り出したメモリの合計。バイト単位。
+    public: std::size_t get_allocated_bytes() const PSYQ_NOEXCEPT
+    {
+        return this->allocated_bytes_;
+    }
+
+    /// @brief 確保しているメモリブロックの合計を取得する。
+    /// @return 確保しているメモリブロックの合計。バイト単位。
+    public: std::size_t get_reserved_bytes() const PSYQ_NOEXCEPT
+    {
+        return this->reserved_bytes_;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief メモリブロックを確保し、そこからメモリを切り出す。
+    /// @return 切り出すメモリの先頭位置。
+    private: char* allocate_block(
+        /// [in] 切り出すメモリの大きさ。バイト単位。
+        std::size_t const in_size,
+        /// [in] 切り出すメモリの境界単位。バイト単位。
+        std::size_t const in_alignment)
+    {
+        auto const local_least_size(
+            sizeof(block_header) + in_size + in_alignment);
+        auto const local_block_size(
+            local_least_size < this->block_size_?
+                this->block_size_: local_least_size);
+        auto const local_block(
+            static_cast<block_header*>(::operator new(local_block_size)));
+        local_block->size_ = local_block_size;
+        this->reserved_bytes_ += local_block_size;
+        auto const local_begin(reinterpret_cast<char*>(local_block + 1));
+        auto const local_end(
+            reinterpret_cast<char*>(local_block) + local_block_size);
+        auto const local_memory(
+            this_type::align_memory(local_begin, in_alignment));
+        if (this->blocks_ == nullptr
+            || (local_least_size < this->block_size_
+                && this->free_end_ - this->free_begin_
+                    < local_end - (local_memory + in_size)))
+        {
+            // 空き領域が広いほうのブロックから、以後の切り出しを行う。
+            local_block->next_ = this->blocks_;
+            this->blocks_ = local_block;
+            this->free_begin_ = local_memory + in_size;
+            this->free_end_ = local_end;
+        }
+        else
+        {
+            // 現在の空き領域はそのままにして、ブロックを後ろに繋げる。
+            local_block->next_ = this->blocks_->next_;
+            this->blocks_->next_ = local_block;
+        }
+        return local_memory;
+    }
+
+    /// @brief メモリの先頭位置を、境界単位に合わせる。
+    /// @return 境界単位に合わせたメモリの先頭位置。
+    private: static char* align_memory(
+        /// [in] 境界単位に合わせるメモリの先頭位置。
+        char* const in_memory,
+        /// [in] 境界単位。2のべき乗であること。
+        std::size_t const in_alignment)
+    PSYQ_NOEXCEPT
+    {
+        auto const local_address(reinterpret_cast<std::uintptr_t>(in_memory));
+        return in_memory + (
+            (in_alignment - (local_address & (in_alignment - 1)))
+            & (in_alignment - 1));
+    }
+
+    //-------------------------------------------------------------------------
+    private: monotonic_arena(this_type const&);// = delete;
+    private: this_type& operator=(this_type const&);// = delete;
+
+    //-------------------------------------------------------------------------
+    /// @brief 確保しているメモリブロックのリスト。
+    private: block_header* blocks_;
+    /// @brief 空き領域の先頭位置。
+    private: char* free_begin_;
+    /// @brief 空き領域の末尾位置。
+    private: char* free_end_;
+    /// @brief 確保するメモリブロックの大きさの最小値。バイト単位。
+    private: std::size_t block_size_;
+    /// @brief 切り出したメモリの合計。バイト単位。
+    private: std::size_t allocated_bytes_;
+    /// @brief 確保しているメモリブロックの合計。バイト単位。
+    private: std::size_t reserved_bytes_;
+
+}; // class psyq::if_then_engine::_private::monotonic_arena
+
+#endif // !defined(PSYQ_IF_THEN_ENGINE_MONOTONIC_ARENA_HPP_)
+// vim: set expandtab:
@@ -0,0 +1,290 @@
+﻿/// @file
+/// @brief @copybrief psyq::if_then_engine::recorder
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_IF_THEN_ENGINE_RECORDER_HPP_
+#define PSYQ_IF_THEN_ENGINE_RECORDER_HPP_
+
+#include <cstdint>
+#include <vector>
+#include "./driver.hpp"
+
+/// @cond
+namespace psyq
+{
+    namespace if_then_engine
+    {
+        template<typename> class recorder;
+    } // namespace if_then_engine
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief driver への入力を、時間フレーム毎にバイト列へ記録する。
+/// @details
+/// 以下の入力を記録し、 replayer で別の driver に再現できる。
+/// - driver::accumulator_ に対して呼び出された accumulator::accumulate 。
+///   recorder::progress で、前回からの予約をまとめて記録する。
+/// - recorder::register_handler で登録した条件挙動ハンドラの、
+///   条件式の識別値と挙動条件と優先順位。条件挙動関数そのものは記録しない。
+/// - recorder::erase_chunk で削除したチャンクの識別値。
+///
+/// 整数は可変長で記録するので、記録は小さく収まる。
+/// @note
+/// driver::extend_chunk などで登録する状態値と条件式は記録しないので、
+/// 再現する driver には、記録を開始した時点と同じ状態値と条件式を、
+/// あらかじめ登録しておくこと。
+/// @tparam template_driver @copydoc recorder::driver
+template<typename template_driver>
+class psyq::if_then_engine::recorder
+{
+    /// @brief this が指す値の型。
+    private: typedef recorder this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 記録する psyq::if_then_engine::driver の型。
+    public: typedef template_driver driver;
+    /// @brief 記録したバイト列の型。
+    public: typedef
+        std::vector<std::uint8_t, typename this_type::driver::allocator_type>
+        log;
+    /// @brief 記録する事象の種類。
+    public: enum event: std::uint8_t
+    {
+        event_PROGRESS,         ///< driver::progress による時間フレームの終端。
+        event_ACCUMULATE,       ///< accumulator::accumulate による状態変更の予約。
+        event_REGISTER_HANDLER, ///< driver::register_handler による条件挙動ハンドラの登録。
+        event_ERASE_CHUNK,      ///< driver::erase_chunk によるチャンクの削除。
+    };
+    /// @brief 状態変更の右辺値が、状態値の識別値であることを示すフラグ。
+    public: enum: std::uint8_t
+    {
+        RIGHT_KEY_FLAG = 0x80,
+    };
+
+    //-------------------------------------------------------------------------
+    /// @brief 空の記録器を構築する。
+    public: explicit recorder(
+        /// [in] 記録の予約バイト数。
+        std::size_t const in_reserve_bytes,
+        /// [in] 使用するメモリ割当子の初期値。
+        typename this_type::driver::allocator_type const& in_allocator =
+            typename this_type::driver::allocator_type())
+    :
+    log_(in_allocator),
+    carried_count_(0),
+    frame_count_(0)
+    {
+        this->log_.reserve(in_reserve_bytes);
+    }
+
+    /// @brief 記録したバイト列を取得する。
+    /// @return 記録したバイト列。
+    public: typename this_type::log const& get_log() const PSYQ_NOEXCEPT
+    {
+        return this->log_;
+    }
+
+    /// @brief 記録した時間フレームの数を取得する。
+    /// @return 記録した時間フレームの数。
+    public: std::size_t get_frame_count() const PSYQ_NOEXCEPT
+    {
+        return this->frame_count_;
+    }
+
+    /// @brief 記録を破棄する。
+    /// @warning
+    /// 予約されている状態変更が残っていると、
+    /// それを再現できなくなるので、時間フレームの終端で呼び出すこと。
+    public: void clear_log() PSYQ_NOEXCEPT
+    {
+        this->log_.clear();
+        this->frame_count_ = 0;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 条件挙動ハンドラを登録し、記録する。
+    /// @return driver::register_handler の戻り値。
+    /// @sa 引数の詳細は driver::register_handler を参照。
+    public: bool register_handler(
+        /// [in,out] 条件挙動ハンドラを登録する駆動器。
+        typename this_type::driver& io_driver,
+        typename this_type::driver::chunk_key const& in_chunk_key,
+        typename this_type::driver::evaluator::expression_key const&
+            in_expression_key,
+        typename this_type::driver::dispatcher::handler::condition const
+            in_condition,
+        typename this_type::driver::dispatcher::handler::function_shared_ptr
+            in_function,
+        typename this_type::driver::dispatcher::handler::priority const
+            in_priority =
+                PSYQ_IF_THEN_ENGINE_DISPATCHER_FUNCTION_PRIORITY_DEFAULT)
+    {
+        auto const local_register(
+            io_driver.register_handler(
+                in_chunk_key,
+                in_expression_key,
+                in_condition,
+                std::move(in_function),
+                in_priority));
+        if (local_register)
+        {
+            this->log_.push_back(this_type::event_REGISTER_HANDLER);
+            this_type::write_unsigned(this->log_, in_chunk_key);
+            this_type::write_unsigned(this->log_, in_expression_key);
+            this->log_.push_back(in_condition);
+            this_type::write_signed(this->log_, in_priority);
+        }
+        return local_register;
+    }
+
+    /// @brief チャンクを削除し、記録する。
+    public: void erase_chunk(
+        /// [in,out] チャンクを削除する駆動器。
+        typename this_type::driver& io_driver,
+        /// [in] 削除するチャンクの識別値。
+        typename this_type::driver::chunk_key const& in_chunk_key)
+    {
+        io_driver.erase_chunk(in_chunk_key);
+        this->log_.push_back(this_type::event_ERASE_CHUNK);
+        this_type::write_unsigned(this->log_, in_chunk_key);
+    }
+
+    /// @brief 予約された状態変更を記録してから、 driver::progress を呼び出す。
+    /// @details driver::progress の代わりに、時間フレーム毎に呼び出す。
+    public: void progress(
+        /// [in,out] 時間フレームを進める駆動器。
+        typename this_type::driver& io_driver)
+    {
+        // 前回から遅延している状態変更を除いて、予約を記録する。
+        auto const& local_accumulations(
+            io_driver.accumulator_._get_accumulations());
+        PSYQ_ASSERT(this->carried_count_ <= local_accumulations.size());
+        auto const local_end(local_accumulations.end());
+        for (
+            auto i(local_accumulations.begin() + this->carried_count_);
+            i != local_end;
+            ++i)
+        {
+            this->write_accumulation(i->first, i->second);
+        }
+        this->log_.push_back(this_type::event_PROGRESS);
+        ++this->frame_count_;
+
+        // 駆動器を更新し、次回に遅延した状態変更の数を保存しておく。
+        io_driver.progress();
+        this->carried_count_ = io_driver.accumulator_.count_accumulation();
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 状態変更の予約を記録する。
+    private: void write_accumulation(
+        /// [in] 記録する状態変更。
+        typename this_type::driver::reservoir::status_assignment const&
+            in_assignment,
+        /// [in] 記録する予約系列の切り替えと遅延方法。
+        typename this_type::driver::accumulator::delay const in_delay)
+    {
+        typedef typename this_type::driver::reservoir::status_value
+            status_value;
+        this->log_.push_back(this_type::event_ACCUMULATE);
+        this_type::write_unsigned(this->log_, in_assignment.get_key());
+        this->log_.push_back(
+            static_cast<std::uint8_t>(in_assignment.get_operator()));
+        this->log_.push_back(static_cast<std::uint8_t>(in_delay));
+
+        // 右辺値の種類を記録してから、種類に合わせて右辺値を記録する。
+        auto const& local_value(in_assignment.get_value());
+        auto const local_kind(local_value.get_kind());
+        auto const local_right_key(in_assignment.get_right_key() != nullptr);
+        this->log_.push_back(
+            static_cast<std::uint8_t>(
+                (local_kind - status_value::kind_SIGNED)
+                | (local_right_key? this_type::RIGHT_KEY_FLAG: 0)));
+        switch (local_kind)
+        {
+            case status_value::kind_BOOL:
+            this->log_.push_back(*local_value.get_bool());
+            break;
+
+            case status_value::kind_UNSIGNED:
+            this_type::write_unsigned(this->log_, *local_value.get_unsigned());
+            break;
+
+            case status_value::kind_SIGNED:
+            this_type::write_signed(this->log_, *local_value.get_signed());
+            break;
+
+            case status_value::kind_FLOAT:
+            {
+                // 浮動小数点数は、ビット列をそのまま記録する。
+                typedef
+                    psyq::float_bit_field<typename status_value::float_type>
+                    float_bit_field;
+                auto local_bits(
+                    float_bit_field(*local_value.get_float()).bit_field_);
+                for (auto i(sizeof(local_bits)); 0 < i; --i)
+                {
+                    this->log_.push_back(
+                        static_cast<std::uint8_t>(local_bits & 0xff));
+                    local_bits >>= 8;
+                }
+            }
+            break;
+
+            default:
+            break;
+        }
+    }
+
+    /// @brief 符号なし整数を、可変長で記録する。
+    private: template<typename template_unsigned>
+    static void write_unsigned(
+        /// [in,out] 記録先のバイト列。
+        typename this_type::log& io_log,
+        /// [in] 記録する符号なし整数。
+        template_unsigned in_value)
+    {
+        static_assert(
+            std::is_unsigned<template_unsigned>::value,
+            "'template_unsigned' is not unsigned integer.");
+        for (;;)
+        {
+            auto const local_byte(static_cast<std::uint8_t>(in_value & 0x7f));
+            in_value >>= 7;
+            if (in_value == 0)
+            {
+                io_log.push_back(local_byte);
+                return;
+            }
+            io_log.push_back(local_byte | 0x80);
+        }
+    }
+
+    /// @brief 符号あり整数を、 zigzag 符号化して可変長で記録する。
+    private: template<typename template_signed>
+    static void write_signed(
+        /// [in,out] 記録先のバイト列。
+        typename this_type::log& io_log,
+        /// [in] 記録する符号あり整数。
+        template_signed const in_value)
+    {
+        typedef typename std::make_unsigned<template_signed>::type unsigned_type;
+        auto const local_shift(static_cast<unsigned_type>(in_value) << 1);
+        this_type::write_unsigned(
+            io_log,
+            static_cast<unsigned_type>(
+                in_value < 0? ~local_shift: local_shift));
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 記録したバイト列。
+    private: typename this_type::log log_;
+    /// @brief 前回の driver::progress で遅延した、状態変更の予約数。
+    private: std::size_t carried_count_;
+    /// @brief 記録した時間フレームの数。
+    private: std::size_t frame_count_;
+
+}; // class psyq::if_then_engine::recorder
+
+#endif // !defined(PSYQ_IF_THEN_ENGINE_RECORDER_HPP_)
+// vim: set expandtab:
@@ -0,0 +1,333 @@
+﻿/// @file
+/// @brief @copybrief psyq::if_then_engine::replayer
+/// @author Hillco Psychi (https://twitter.com/psychi)
+#ifndef PSYQ_IF_THEN_ENGINE_REPLAYER_HPP_
+#define PSYQ_IF_THEN_ENGINE_REPLAYER_HPP_
+
+#include "./recorder.hpp"
+
+/// @cond
+namespace psyq
+{
+    namespace if_then_engine
+    {
+        template<typename> class replayer;
+    } // namespace if_then_engine
+} // namespace psyq
+/// @endcond
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/// @brief recorder で記録したバイト列から、 driver への入力を再現する。
+/// @par 使い方の概略
+/// - 記録を開始した時点と同じ状態値と条件式を、 driver に登録しておく。
+/// - replayer::prepare_frame で1時間フレーム分の入力を driver に再現し、
+///   真が返ってきたら driver::progress を呼び出す。
+///   driver::progress だけを計測すると、記録した時間フレームの負荷を再現できる。
+/// - 全ての時間フレームをまとめて再現するなら replayer::replay を使う。
+/// @tparam template_driver @copydoc replayer::driver
+template<typename template_driver>
+class psyq::if_then_engine::replayer
+{
+    /// @brief this が指す値の型。
+    private: typedef replayer this_type;
+
+    //-------------------------------------------------------------------------
+    /// @brief 入力を再現する psyq::if_then_engine::driver の型。
+    public: typedef template_driver driver;
+    /// @brief 再現に使う記録器の型。
+    public: typedef psyq::if_then_engine::recorder<template_driver> recorder;
+
+    //-------------------------------------------------------------------------
+    /// @brief 再現器を構築する。
+    public: explicit replayer(
+        /// [in] recorder::get_log で取得した記録。
+        /// 再現が終わるまで、参照を保持すること。
+        typename this_type::recorder::log const& in_log)
+    PSYQ_NOEXCEPT:
+    log_(&in_log),
+    position_(0),
+    frame_count_(0),
+    failed_(false)
+    {}
+
+    /// @brief 記録を最後まで再現したか判定する。
+    public: bool is_end() const PSYQ_NOEXCEPT
+    {
+        return this->failed_ || this->log_->size() <= this->position_;
+    }
+
+    /// @brief 記録の解析に失敗したか判定する。
+    public: bool is_failed() const PSYQ_NOEXCEPT
+    {
+        return this->failed_;
+    }
+
+    /// @brief 再現した時間フレームの数を取得する。
+    /// @return 再現した時間フレームの数。
+    public: std::size_t get_frame_count() const PSYQ_NOEXCEPT
+    {
+        return this->frame_count_;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 全ての時間フレームの入力を再現し、 driver::progress を呼び出す。
+    /// @return 再現した時間フレームの数。
+    /// @sa 引数の詳細は this_type::prepare_frame を参照。
+    public: template<typename template_function_maker>
+    std::size_t replay(
+        typename this_type::driver& io_driver,
+        template_function_maker const& in_make_function)
+    {
+        auto const local_frame_count(this->frame_count_);
+        while (this->prepare_frame(io_driver, in_make_function))
+        {
+            io_driver.progress();
+        }
+        return this->frame_count_ - local_frame_count;
+    }
+
+    /// @brief 1時間フレーム分の入力を再現する。
+    /// @retval true
+    /// 時間フレームの終端まで再現した。続けて driver::progress を呼び出すこと。
+    /// @retval false 記録の終端に達したか、記録の解析に失敗した。
+    public: template<typename template_function_maker>
+    bool prepare_frame(
+        /// [in,out] 入力を再現する駆動器。
+        typename this_type::driver& io_driver,
+        /// [in] 条件挙動関数を構築する関数オブジェクト。
+        /// 以下に相当するメンバ関数を使えること。
+        /// @code
+        /// // brief 記録された条件挙動ハンドラに対応する条件挙動関数を構築する。
+        /// driver::dispatcher::handler::function_shared_ptr template_function_maker::operator()(
+        ///     // [in] 条件挙動関数に対応する条件式の識別値。
+        ///     driver::evaluator::expression_key const& in_expression_key,
+        ///     // [in] 条件挙動関数を呼び出す挙動条件。
+        ///     driver::dispatcher::handler::condition const in_condition,
+        ///     // [in] 条件挙動関数の呼び出し優先順位。
+        ///     driver::dispatcher::handler::priority const in_priority)
+        /// const;
+        /// @endcode
+        template_function_maker const& in_make_function)
+    {
+        while (!this->is_end())
+        {
+            switch (this->read_byte())
+            {
+                case this_type::recorder::event_PROGRESS:
+                ++this->frame_count_;
+                return !this->failed_;
+
+                case this_type::recorder::event_ACCUMULATE:
+                this->read_accumulation(io_driver.accumulator_);
+                break;
+
+                case this_type::recorder::event_REGISTER_HANDLER:
+                this->read_handler(io_driver, in_make_function);
+                break;
+
+                case this_type::recorder::event_ERASE_CHUNK:
+                {
+                    auto const local_chunk_key(
+                        this->template read_unsigned<
+                            typename this_type::driver::chunk_key>());
+                    if (!this->failed_)
+                    {
+                        io_driver.erase_chunk(local_chunk_key);
+                    }
+                }
+                break;
+
+                default:
+                PSYQ_ASSERT(false);
+                this->failed_ = true;
+                break;
+            }
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 記録された条件挙動ハンドラを、駆動器に登録する。
+    private: template<typename template_function_maker>
+    void read_handler(
+        /// [in,out] 条件挙動ハンドラを登録する駆動器。
+        typename this_type::driver& io_driver,
+        /// [in] 条件挙動関数を構築する関数オブジェクト。
+        template_function_maker const& in_make_function)
+    {
+        typedef typename this_type::driver::dispatcher::handler handler;
+        auto const local_chunk_key(
+            this->template read_unsigned<
+                typename this_type::driver::chunk_key>());
+        auto const local_expression_key(
+            this->template read_unsigned<
+                typename this_type::driver::evaluator::expression_key>());
+        auto const local_condition(
+            static_cast<typename handler::condition>(this->read_byte()));
+        auto const local_priority(
+            this->template read_signed<typename handler::priority>());
+        if (!this->failed_)
+        {
+            io_driver.register_handler(
+                local_chunk_key,
+                local_expression_key,
+                local_condition,
+                in_make_function(
+                    local_expression_key, local_condition, local_priority),
+                local_priority);
+        }
+    }
+
+    /// @brief 記録された状態変更を、状態変更器に予約する。
+    private: void read_accumulation(
+        /// [in,out] 状態変更を予約する状態変更器。
+        typename this_type::driver::accumulator& io_accumulator)
+    {
+        typedef typename this_type::driver::reservoir reservoir;
+        typedef typename reservoir::status_value status_value;
+        auto const local_key(
+            this->template read_unsigned<typename reservoir::status_key>());
+        auto const local_operator(
+            static_cast<typename status_value::assignment>(this->read_byte()));
+        auto const local_delay(
+            static_cast<typename this_type::driver::accumulator::delay>(
+                this->read_byte()));
+        auto const local_kind_byte(this->read_byte());
+        auto const local_kind(
+            static_cast<typename status_value::kind>(
+                (local_kind_byte & ~this_type::recorder::RIGHT_KEY_FLAG)
+                + status_value::kind_SIGNED));
+
+        // 右辺値の種類に合わせて、右辺値を読み込む。
+        status_value local_value;
+        switch (local_kind)
+        {
+            case status_value::kind_EMPTY:
+            break;
+
+            case status_value::kind_BOOL:
+            local_value = status_value(this->read_byte() != 0);
+            break;
+
+            case status_value::kind_UNSIGNED:
+            local_value = status_value(
+                this->template read_unsigned<
+                    typename status_value::unsigned_type>());
+            break;
+
+            case status_value::kind_SIGNED:
+            local_value = status_value(
+                this->template read_signed<
+                    typename status_value::signed_type>());
+            break;
+
+            case status_value::kind_FLOAT:
+            {
+                typedef
+                    psyq::float_bit_field<typename status_value::float_type>
+                    float_bit_field;
+                typename float_bit_field::bit_field local_bits(0);
+                for (unsigned i(0); i < sizeof(local_bits); ++i)
+                {
+                    local_bits |= static_cast<
+                        typename float_bit_field::bit_field>(
+                            this->read_byte()) << (i * 8);
+                }
+                local_value = status_value(
+                    float_bit_field(local_bits).float_);
+            }
+            break;
+
+            default:
+            PSYQ_ASSERT(false);
+            this->failed_ = true;
+            break;
+        }
+        if (this->failed_)
+        {
+            return;
+        }
+
+        // 状態変更を予約する。
+        if ((local_kind_byte & this_type::recorder::RIGHT_KEY_FLAG) != 0
+            && local_value.get_unsigned() != nullptr)
+        {
+            io_accumulator.accumulate(
+                typename reservoir::status_assignment(
+                    local_key,
+                    local_operator,
+                    static_cast<typename reservoir::status_key>(
+                        *local_value.get_unsigned())),
+                local_delay);
+        }
+        else
+        {
+            io_accumulator.accumulate(
+                typename reservoir::status_assignment(
+                    local_key, local_operator, local_value),
+                local_delay);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 記録から1バイトを読み込む。
+    /// @return 読み込んだバイト。記録の終端に達していた場合は0。
+    private: std::uint8_t read_byte() PSYQ_NOEXCEPT
+    {
+        if (this->log_->size() <= this->position_)
+        {
+            this->failed_ = true;
+            return 0;
+        }
+        auto const local_byte((*this->log_)[this->position_]);
+        ++this->position_;
+        return local_byte;
+    }
+
+    /// @brief 可変長で記録された符号なし整数を読み込む。
+    /// @return 読み込んだ符号なし整数。
+    private: template<typename template_unsigned>
+    template_unsigned read_unsigned() PSYQ_NOEXCEPT
+    {
+        template_unsigned local_value(0);
+        for (unsigned local_shift(0); !this->failed_; local_shift += 7)
+        {
+            auto const local_byte(this->read_byte());
+            if (local_shift < sizeof(template_unsigned) * 8)
+            {
+                local_value |= static_cast<template_unsigned>(
+                    local_byte & 0x7f) << local_shift;
+            }
+            if ((local_byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        return local_value;
+    }
+
+    /// @brief zigzag 符号化して可変長で記録された符号あり整数を読み込む。
+    /// @return 読み込んだ符号あり整数。
+    private: template<typename template_signed>
+    template_signed read_signed() PSYQ_NOEXCEPT
+    {
+        typedef typename std::make_unsigned<template_signed>::type unsigned_type;
+        auto const local_value(this->template read_unsigned<unsigned_type>());
+        return static_cast<template_signed>(
+            (local_value & 1) != 0? ~(local_value >> 1): local_value >> 1);
+    }
+
+    //-------------------------------------------------------------------------
+    /// @brief 再現する記録。
+    private: typename this_type::recorder::log const* log_;
+    /// @brief 次に読み込む記録の位置。
+    private: std::size_t position_;
+    /// @brief 再現した時間フレームの数。
+    private: std::size_t frame_count_;
+    /// @brief 記録の解析に失敗したか。
+    private: bool failed_;
+
+}; // class psyq::if_then_engine::replayer
+
+#endif // !defined(PSYQ_IF_THEN_ENGINE_REPLAYER_HPP_)
+// vim: set expandtab:
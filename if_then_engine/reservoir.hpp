@@ -10,6 +10,7 @@
 #include "./status_property.hpp"
 #include "./status_chunk.hpp"
 #include "./status_operation.hpp"
+#include "./footprint.hpp"
 
 /// @cond
 namespace psyq
@@ -80,6 +81,8 @@ class psyq::if_then_engine::_private::reservoir
             typename this_type::status_value::assignment,
             typename this_type::status_value>
         status_assignment;
+    /// @brief メモリ使用量の計測値。
+    public: typedef psyq::if_then_engine::_private::footprint footprint;
 
     //-------------------------------------------------------------------------
     /// @brief 状態値プロパティの辞書。
@@ -175,11 +178,39 @@ class psyq::if_then_engine::_private::reservoir
     }
 
     /// @brief 状態貯蔵器を再構築する。
+    /// @details
+    /// 再構築した状態値ビット列チャンクは、元のチャンクと同じメモリ割当子を使う。
     public: void rebuild(
         /// [in] 状態値ビット列チャンク辞書のバケット数。
         std::size_t const in_chunk_count,
         /// [in] 状態値プロパティ辞書のバケット数。
         std::size_t const in_status_count)
+    {
+        this->rebuild(
+            in_chunk_count,
+            in_status_count,
+            [](
+                typename this_type::chunk_key const&,
+                typename this_type::allocator_type const& in_allocator)
+            ->typename this_type::allocator_type
+            {
+                return in_allocator;
+            });
+    }
+
+    /// @brief 状態貯蔵器を再構築する。
+    /// @details
+    /// 再構築した状態値ビット列チャンクは、 in_renew_allocator
+    /// がチャンクごとに1度だけ返すメモリ割当子を使う。
+    public: template<typename template_renew_allocator>
+    void rebuild(
+        /// [in] 状態値ビット列チャンク辞書のバケット数。
+        std::size_t const in_chunk_count,
+        /// [in] 状態値プロパティ辞書のバケット数。
+        std::size_t const in_status_count,
+        /// [in] チャンクの識別値と元のチャンクのメモリ割当子を受け取り、
+        /// 再構築したチャンクが使うメモリ割当子を返す関数オブジェクト。
+        template_renew_allocator const& in_renew_allocator)
     {
         // 新たな辞書を用意する。
         typename this_type::chunk_map local_chunks(
@@ -195,7 +226,11 @@ class psyq::if_then_engine::_private::reservoir
 
         // 現在の辞書を新たな辞書にコピーして整理する。
         this_type::copy_bit_fields(
-            local_properties, local_chunks, this->properties_, this->chunks_);
+            local_properties,
+            local_chunks,
+            this->properties_,
+            this->chunks_,
+            in_renew_allocator);
         for (auto i(local_chunks.begin()); i != local_chunks.end();)
         {
             auto& local_chunk(i->second);
@@ -213,6 +248,40 @@ class psyq::if_then_engine::_private::reservoir
         this->properties_ = std::move(local_properties);
         this->chunks_ = std::move(local_chunks);
     }
+
+    /// @brief 状態値の登録に備えて、状態値プロパティ辞書の容量を予約する。
+    /// @details
+    /// 状態値をまとめて登録する前に呼び出しておくと、
+    /// 登録の途中で辞書が何度も再ハッシュされるのを防げる。
+    public: void reserve_statuses(
+        /// [in] これから登録する状態値の数。
+        std::size_t const in_status_count)
+    {
+        auto const local_property_count(
+            this->properties_.size() + in_status_count);
+        if (this->properties_.bucket_count()
+            * this->properties_.max_load_factor() < local_property_count)
+        {
+            this->properties_.reserve(local_property_count);
+        }
+    }
+
+    /// @brief 状態貯蔵器のメモリ使用量を計測する。
+    public: void measure_footprint(
+        /// [in,out] 状態値ビット列チャンク辞書の計測値を加算する。
+        typename this_type::footprint& io_chunk_footprint,
+        /// [in,out] 状態値プロパティ辞書の計測値を加算する。
+        typename this_type::footprint& io_status_footprint)
+    const
+    {
+        io_chunk_footprint.count_map(this->chunks_);
+        for (auto const& local_chunk: this->chunks_)
+        {
+            io_chunk_footprint.add_vector(local_chunk.second.bit_blocks_);
+            io_chunk_footprint.add_vector(local_chunk.second.empty_fields_);
+        }
+        io_status_footprint.count_map(this->properties_);
+    }
     /// @}
     //-------------------------------------------------------------------------
     /// @name 状態値の登録
@@ -698,6 +767,37 @@ class psyq::if_then_engine::_private::reservoir
         local_chunk.second.empty_fields_.reserve(in_reserve_empty_fields);
     }
 
+    /// @brief 状態値ビット列チャンクを取得する。
+    /// @return
+    /// in_chunk_key に対応する状態値ビット列チャンク。
+    /// 該当するチャンクがない場合は nullptr を返す。
+    public: typename this_type::status_chunk const* find_chunk(
+        /// [in] 取得する状態値ビット列チャンクに対応する識別値。
+        typename this_type::chunk_key const& in_chunk_key)
+    const
+    {
+        auto const local_find(this->chunks_.find(in_chunk_key));
+        return local_find != this->chunks_.end()?
+            &local_find->second: nullptr;
+    }
+
+    /// @brief 状態値ビット列チャンクを用意する。
+    /// @details
+    /// in_chunk_key に対応するチャンクがまだない場合は、
+    /// in_allocator を使う空のチャンクを追加する。
+    /// @retval true  チャンクを追加した。
+    /// @retval false チャンクがすでにあったので、何もしなかった。
+    public: bool equip_chunk(
+        /// [in] 用意する状態値ビット列チャンクに対応する識別値。
+        typename this_type::chunk_key const& in_chunk_key,
+        /// [in] 追加するチャンクが使うメモリ割当子。
+        typename this_type::allocator_type const& in_allocator)
+    {
+        return this->chunks_.emplace(
+            in_chunk_key,
+            typename this_type::chunk_map::mapped_type(in_allocator)).second;
+    }
+
     /// @brief 状態値ビット列チャンクを削除する。
     /// @retval true  成功。 in_chunk_key に対応するチャンクを削除した。
     /// @retval false 失敗。該当するチャンクがない。
@@ -933,7 +1033,8 @@ class psyq::if_then_engine::_private::reservoir
 
     //-------------------------------------------------------------------------
     /// @brief 状態値をコピーして整理する。
-    private: static void copy_bit_fields(
+    private: template<typename template_renew_allocator>
+    static void copy_bit_fields(
         /// [in,out] コピー先となる状態値プロパティ辞書。
         typename this_type::property_map& io_properties,
         /// [in,out] コピー先となる状態値ビット列チャンク辞書。
@@ -941,7 +1042,9 @@ class psyq::if_then_engine::_private::reservoir
         /// [in] コピー元となる状態値プロパティ辞書。
         typename this_type::property_map const& in_properties,
         /// [in] コピー元となる状態値ビット列チャンク辞書。
-        typename this_type::chunk_map const& in_chunks)
+        typename this_type::chunk_map const& in_chunks,
+        /// [in] コピー先のチャンクが使うメモリ割当子を返す関数オブジェクト。
+        template_renew_allocator const& in_renew_allocator)
     {
         // 状態値プロパティのポインタのコンテナを構築する。
         typedef
@@ -976,12 +1079,17 @@ class psyq::if_then_engine::_private::reservoir
         for (auto& local_property: local_properties)
         {
             this_type::copy_bit_field(
-                io_properties, io_chunks, *local_property.second, in_chunks);
+                io_properties,
+                io_chunks,
+                *local_property.second,
+                in_chunks,
+                in_renew_allocator);
         }
     }
 
     /// @brief 状態値をコピーする。
-    private: static void copy_bit_field(
+    private: template<typename template_renew_allocator>
+    static void copy_bit_field(
         ///[in,out] コピー先となる状態値プロパティ辞書。
         typename this_type::property_map& io_properties,
         /// [in,out] コピー先となる状態値ビット列チャンク辞書。
@@ -989,7 +1097,9 @@ class psyq::if_then_engine::_private::reservoir
         /// [in] コピー元となる状態値プロパティ。
         typename this_type::property_map::value_type const& in_property,
         /// [in] コピー元となる状態値ビット列チャンク辞書。
-        typename this_type::chunk_map const& in_chunks)
+        typename this_type::chunk_map const& in_chunks,
+        /// [in] コピー先のチャンクが使うメモリ割当子を返す関数オブジェクト。
+        template_renew_allocator const& in_renew_allocator)
     {
         // コピー元となる状態値ビット列チャンクを取得する。
         auto const local_source_chunk_iterator(
@@ -1002,19 +1112,25 @@ class psyq::if_then_engine::_private::reservoir
         auto const& local_source_chunk(local_source_chunk_iterator->second);
 
         // コピー先となる状態値を用意する。
-        auto const local_emplace(
-            io_chunks.emplace(
+        // コピー先のチャンクが使うメモリ割当子は、チャンクごとに1度だけ取得する。
+        auto local_target_chunk_iterator(
+            io_chunks.find(in_property.second.get_chunk_key()));
+        if (local_target_chunk_iterator == io_chunks.end())
+        {
+            local_target_chunk_iterator = io_chunks.emplace(
                 in_property.second.get_chunk_key(),
                 typename this_type::chunk_map::mapped_type(
-                    io_chunks.get_allocator())));
-        auto& local_target_chunk(*local_emplace.first);
-        if (local_emplace.second)
-        {
-            local_target_chunk.second.bit_blocks_.reserve(
+                    in_renew_allocator(
+                        in_property.second.get_chunk_key(),
+                        typename this_type::allocator_type(
+                            local_source_chunk.bit_blocks_.get_allocator()))))
+                .first;
+            local_target_chunk_iterator->second.bit_blocks_.reserve(
                 local_source_chunk.bit_blocks_.size());
-            local_target_chunk.second.empty_fields_.reserve(
+            local_target_chunk_iterator->second.empty_fields_.reserve(
                 local_source_chunk.empty_fields_.size());
         }
+        auto& local_target_chunk(*local_target_chunk_iterator);
         auto const local_format(in_property.second.get_format());
         auto const local_target_property(
             this_type::allocate_bit_field(
@@ -77,6 +77,16 @@ class psyq::if_then_engine::_private::status_monitor
             this->expression_keys_, in_expression_monitors);
     }
 
+    /// @brief 条件式識別値コンテナのメモリ使用量を計測する。
+    public: template<typename template_footprint>
+    void measure_footprint(
+        /// [in,out] メモリ使用量を加算する _private::footprint 。
+        template_footprint& io_footprint)
+    const
+    {
+        io_footprint.add_vector(this->expression_keys_);
+    }
+
     //-------------------------------------------------------------------------
     /// @brief 条件式を状態監視器へ登録する。
     /// @details
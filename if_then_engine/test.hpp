@@ -6,6 +6,8 @@
 #define PSYQ_IF_THEN_ENGINE_TEST_HPP_
 
 #include "./driver.hpp"
+#include "./replayer.hpp"
+#include "./key_interner.hpp"
 #include "../string/storage.hpp"
 #include "../static_deque.hpp"
 
@@ -827,6 +829,27 @@ namespace psyq_test
                     driver::reservoir::status_value::comparison_GREATER_EQUAL,
                     1.25));
         local_driver.progress();
+
+        // メモリ使用量を計測する。
+        auto const local_footprint(local_driver.measure_footprint());
+        PSYQ_ASSERT(0 < local_footprint.get_bytes());
+        PSYQ_ASSERT(local_footprint.statuses_.element_count_ == 5);
+        PSYQ_ASSERT(local_footprint.expressions_.element_count_ == 11);
+        PSYQ_ASSERT(local_footprint.handler_chunks_.element_count_ == 1);
+        PSYQ_ASSERT(5 <= local_footprint.recommend_status_count());
+
+        // 推奨するバケット数で再構築すると、負荷率が1以下になる。
+        local_driver.rebuild(
+            local_footprint.recommend_chunk_count(),
+            local_footprint.recommend_status_count(),
+            local_footprint.recommend_expression_count(),
+            local_footprint.recommend_cache_capacity());
+        auto const local_rebuilt_footprint(local_driver.measure_footprint());
+        PSYQ_ASSERT(local_rebuilt_footprint.statuses_.element_count_ == 5);
+        PSYQ_ASSERT(local_rebuilt_footprint.statuses_.get_load_factor() <= 1);
+        PSYQ_ASSERT(local_rebuilt_footprint.expressions_.get_load_factor() <= 1);
+        PSYQ_ASSERT(
+            local_rebuilt_footprint.status_chunks_.get_load_factor() <= 1);
         local_driver.rebuild(1024, 1024, 1024);
 
         local_driver.accumulator_.accumulate(
@@ -866,6 +889,214 @@ namespace psyq_test
 
         local_string_factory->shrink_to_fit();
         local_driver.erase_chunk(local_chunk_key);
+
+        // チャンク専用のメモリ領域を使う駆動器を構築する。
+        typedef
+            psyq::if_then_engine::driver<
+                std::uint64_t,
+                float,
+                std::int32_t,
+                PSYQ_STRING_FLYWEIGHT_HASHER_DEFAULT,
+                psyq::if_then_engine::arena_allocator<void*>>
+            arena_driver;
+        arena_driver local_arena_driver(16, 16, 16);
+        local_arena_driver.reserve_chunk(local_chunk_key, 2, 1, 0);
+        PSYQ_ASSERT(
+            local_arena_driver.register_status(
+                local_chunk_key,
+                local_arena_driver.hash_function_("status_bool"),
+                true));
+        PSYQ_ASSERT(
+            local_arena_driver.register_status(
+                local_chunk_key,
+                local_arena_driver.hash_function_("status_unsigned"),
+                10u,
+                7));
+        PSYQ_ASSERT(
+            local_arena_driver.evaluator_.register_expression(
+                local_arena_driver.get_reservoir(),
+                local_arena_driver.hash_function_("expression_0"),
+                local_arena_driver.hash_function_("status_bool"),
+                true));
+        auto const local_arena_chunk(
+            local_arena_driver.get_reservoir().find_chunk(local_chunk_key));
+        PSYQ_ASSERT(local_arena_chunk != nullptr);
+        std::weak_ptr<arena_driver::allocator_type::arena> const local_arena(
+            arena_driver::allocator_type(
+                local_arena_chunk->bit_blocks_.get_allocator()).get_arena());
+        PSYQ_ASSERT(!local_arena.expired());
+        PSYQ_ASSERT(0 < local_arena.lock()->get_allocated_bytes());
+        local_arena_driver.progress();
+
+        // 再構築すると、チャンクは新たなメモリ領域に移り、元のメモリ領域は解放される。
+        auto const local_get_arena(
+            [&local_arena_driver, local_chunk_key]()
+            ->std::shared_ptr<arena_driver::allocator_type::arena>
+            {
+                auto const local_chunk(
+                    local_arena_driver.get_reservoir().find_chunk(
+                        local_chunk_key));
+                PSYQ_ASSERT(local_chunk != nullptr);
+                return arena_driver::allocator_type(
+                    local_chunk->bit_blocks_.get_allocator()).get_arena();
+            });
+        local_arena_driver.rebuild(16, 16, 16);
+        PSYQ_ASSERT(local_arena.expired());
+        std::weak_ptr<arena_driver::allocator_type::arena> local_rebuilt_arena(
+            local_get_arena());
+        PSYQ_ASSERT(!local_rebuilt_arena.expired());
+        auto const local_rebuilt_bytes(
+            local_rebuilt_arena.lock()->get_allocated_bytes());
+        PSYQ_ASSERT(0 < local_rebuilt_bytes);
+
+        // 何度再構築しても、メモリ領域の使用量は増えない。
+        for (unsigned i(0); i < 8; ++i)
+        {
+            local_arena_driver.rebuild(16, 16, 16);
+            PSYQ_ASSERT(local_rebuilt_arena.expired());
+            local_rebuilt_arena = local_get_arena();
+            PSYQ_ASSERT(
+                local_rebuilt_arena.lock()->get_allocated_bytes()
+                <= local_rebuilt_bytes);
+        }
+        auto const local_rebuilt_unsigned(
+            local_arena_driver.get_reservoir().find_status(
+                local_arena_driver.hash_function_("status_unsigned")));
+        PSYQ_ASSERT(
+            local_rebuilt_unsigned.get_unsigned() != nullptr
+            && *local_rebuilt_unsigned.get_unsigned() == 10u);
+        PSYQ_ASSERT(
+            0 <= local_arena_driver.evaluator_.evaluate_expression(
+                local_arena_driver.hash_function_("expression_0"),
+                local_arena_driver.get_reservoir()));
+        local_arena_driver.erase_chunk(local_chunk_key);
+        PSYQ_ASSERT(local_rebuilt_arena.expired());
+
+        // 駆動器への入力を記録し、別の駆動器で再現する。
+        driver::dispatcher::handler::condition const local_any_condition(
+            driver::dispatcher::handler::make_condition(
+                driver::dispatcher::handler::unit_condition_ANY,
+                driver::dispatcher::handler::unit_condition_ANY));
+        auto const local_setup_driver(
+            [&](driver& io_driver)
+            {
+                io_driver.register_status(
+                    local_chunk_key,
+                    io_driver.hash_function_("status_unsigned"),
+                    10u,
+                    8);
+                io_driver.register_status(
+                    local_chunk_key,
+                    io_driver.hash_function_("status_float"),
+                    1.5f);
+                io_driver.evaluator_.register_expression(
+                    io_driver.get_reservoir(),
+                    io_driver.hash_function_("expression_0"),
+                    driver::reservoir::status_comparison(
+                        io_driver.hash_function_("status_unsigned"),
+                        driver::reservoir::status_value::comparison_GREATER,
+                        driver::reservoir::status_value(20u)));
+            });
+        typedef std::vector<driver::evaluator::expression_key> call_log;
+        auto const local_make_logger(
+            [](call_log& io_calls) -> driver::dispatcher::handler::function_shared_ptr
+            {
+                return std::make_shared<driver::dispatcher::handler::function>(
+                    [&io_calls](
+                        driver::evaluator::expression_key const& in_key,
+                        driver::dispatcher::handler::evaluation const,
+                        driver::dispatcher::handler::evaluation const)
+                    {
+                        io_calls.push_back(in_key);
+                    });
+            });
+        call_log local_record_calls;
+        driver local_record_driver(16, 16, 16);
+        local_setup_driver(local_record_driver);
+        psyq::if_then_engine::recorder<driver> local_recorder(256);
+        PSYQ_ASSERT(
+            local_recorder.register_handler(
+                local_record_driver,
+                local_chunk_key,
+                local_record_driver.hash_function_("expression_0"),
+                local_any_condition,
+                local_make_logger(local_record_calls)));
+        local_recorder.progress(local_record_driver);
+        local_record_driver.accumulator_.accumulate(
+            local_record_driver.hash_function_("status_unsigned"),
+            driver::reservoir::status_value::assignment_ADD,
+            15u,
+            driver::accumulator::delay_YIELD);
+        local_record_driver.accumulator_.accumulate(
+            local_record_driver.hash_function_("status_float"),
+            -0.25f,
+            driver::accumulator::delay_BLOCK);
+        local_recorder.progress(local_record_driver);
+        local_record_driver.accumulator_.accumulate(
+            local_record_driver.hash_function_("status_unsigned"),
+            driver::reservoir::status_value::assignment_SUB,
+            -10,
+            driver::accumulator::delay_FOLLOW);
+        local_recorder.progress(local_record_driver);
+        local_recorder.progress(local_record_driver);
+        PSYQ_ASSERT(local_recorder.get_frame_count() == 4);
+        PSYQ_ASSERT(!local_record_calls.empty());
+
+        call_log local_replay_calls;
+        driver local_replay_driver(16, 16, 16);
+        local_setup_driver(local_replay_driver);
+        psyq::if_then_engine::replayer<driver> local_replayer(
+            local_recorder.get_log());
+        PSYQ_ASSERT(
+            local_replayer.replay(
+                local_replay_driver,
+                [&](
+                    driver::evaluator::expression_key const&,
+                    driver::dispatcher::handler::condition const,
+                    driver::dispatcher::handler::priority const)
+                {
+                    return local_make_logger(local_replay_calls);
+                })
+            == local_recorder.get_frame_count());
+        PSYQ_ASSERT(!local_replayer.is_failed());
+        PSYQ_ASSERT(local_replay_calls == local_record_calls);
+        PSYQ_ASSERT(
+            0 < local_replay_driver.get_reservoir().find_status(
+                local_replay_driver.hash_function_("status_float")).compare(
+                    driver::reservoir::status_value::comparison_EQUAL,
+                    -0.25f));
+
+        // 識別値を密な識別番号に変換する駆動器を構築する。
+        typedef
+            psyq::if_then_engine::driver<
+                std::uint64_t,
+                float,
+                std::int32_t,
+                psyq::if_then_engine::key_interner<>>
+            interned_driver;
+        interned_driver local_interned_driver(16, 16, 16);
+        auto const local_interned_chunk(
+            local_interned_driver.hash_function_("chunk_0"));
+        auto const local_interned_status(
+            local_interned_driver.hash_function_("status_bool"));
+        PSYQ_ASSERT(local_interned_driver.hash_function_("") == 0);
+        PSYQ_ASSERT(local_interned_chunk == 1);
+        PSYQ_ASSERT(local_interned_status == 2);
+        PSYQ_ASSERT(
+            local_interned_driver.hash_function_("chunk_0")
+            == local_interned_chunk);
+        PSYQ_ASSERT(local_interned_driver.hash_function_.get_id_count() == 3);
+        PSYQ_ASSERT(
+            local_interned_driver.hash_function_.find_string(
+                local_interned_status) == "status_bool");
+        PSYQ_ASSERT(
+            local_interned_driver.register_status(
+                local_interned_chunk, local_interned_status, true));
+        PSYQ_ASSERT(
+            0 < local_interned_driver.get_reservoir().find_status(
+                local_interned_status).compare(
+                    interned_driver::reservoir::status_value::comparison_EQUAL,
+                    true));
     }
 }
 
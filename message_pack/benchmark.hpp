@@ -0,0 +1,498 @@
+﻿/** @file
+    @author Hillco Psychi (https://twitter.com/psychi)
+    @brief psyq::message_pack::serializer と
+           psyq::message_pack::deserializer の速度を計測する。
+ */
+#ifndef PSYQ_MESSAGE_PACK_BENCHMARK_HPP_
+#define PSYQ_MESSAGE_PACK_BENCHMARK_HPP_
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+//#include "psyq/message_pack/serializer.hpp"
+//#include "psyq/message_pack/deserializer.hpp"
+//#include "psyq/message_pack/memory_istream.hpp"
+//#include "psyq/message_pack/memory_ostream.hpp"
+//#include "psyq/message_pack/scanner.hpp"
+//#include "psyq/message_pack/map_index.hpp"
+//#include "psyq/message_pack/struct_traits.hpp"
+
+namespace psyq
+{
+    namespace test
+    {
+        /** @brief 計測に使うMessagePackを直列化する。
+            @return 直列化したMessagePackのバイト列。
+         */
+        inline std::string make_message_pack_benchmark_data()
+        {
+            std::vector<int> local_integers;
+            std::map<std::string, double> local_map;
+            for (int i(0); i < 64; ++i)
+            {
+                local_integers.push_back(i * 1009 - 20000);
+                local_map[std::to_string(i)] = i * 0.5;
+            }
+            psyq::message_pack::serializer<std::stringstream, 16>
+                local_serializer(
+                    std::stringstream(std::ios_base::in | std::ios_base::out));
+            local_serializer.make_serial_array(5);
+            local_serializer << local_integers;
+            local_serializer << local_map;
+            local_serializer << std::string(200, 'x');
+            local_serializer << std::make_tuple(1, 2.0f, 3.0, true);
+            local_serializer.write_container_binary(std::string(1000, 'y'));
+            return local_serializer.get_stream().str();
+        }
+
+        /// @cond
+        template<typename template_stream>
+        template_stream make_message_pack_benchmark_stream(
+            std::string const& in_data);
+
+        template<>
+        inline std::istringstream make_message_pack_benchmark_stream(
+            std::string const& in_data)
+        {
+            return std::istringstream(in_data);
+        }
+
+        template<>
+        inline psyq::message_pack::memory_istream
+        make_message_pack_benchmark_stream(std::string const& in_data)
+        {
+            return psyq::message_pack::memory_istream(
+                in_data.data(), in_data.size());
+        }
+        /// @endcond
+
+        /** @brief 直列化復元を繰り返し、1回あたりの時間を計測する。
+            @param[in] in_data       直列化復元するMessagePackのバイト列。
+            @param[in] in_iterations 直列化復元を繰り返す回数。
+            @param[in] in_allocate_raw
+                RAWバイト列の直列化復元で、メモリ割当てをするかどうか。
+            @tparam template_stream  直列化復元に使う入力ストリーム。
+            @return 直列化復元1回あたりの時間。ナノ秒単位。
+         */
+        template<typename template_stream>
+        double measure_message_pack_deserializer(
+            std::string const& in_data,
+            std::size_t const in_iterations,
+            bool const in_allocate_raw = true)
+        {
+            typedef psyq::message_pack::deserializer<template_stream>
+                benchmark_deserializer;
+            std::size_t local_checksum(0);
+            auto const local_begin(std::chrono::steady_clock::now());
+            for (std::size_t i(0); i < in_iterations; ++i)
+            {
+                benchmark_deserializer local_deserializer(
+                    psyq::test::make_message_pack_benchmark_stream<template_stream>(
+                        in_data),
+                    typename benchmark_deserializer::pool());
+                local_deserializer.set_allocate_raw(in_allocate_raw);
+                typename benchmark_deserializer::root_object local_root_object;
+                local_deserializer >> local_root_object;
+                local_checksum += local_root_object.get_array()->size();
+            }
+            auto const local_end(std::chrono::steady_clock::now());
+            PSYQ_ASSERT(local_checksum == 5 * in_iterations);
+            return std::chrono::duration<double, std::nano>(
+                local_end - local_begin).count() / in_iterations;
+        }
+
+        /** @brief オブジェクトを構築せずに走査を繰り返し、1回あたりの時間を計測する。
+            @param[in] in_data       走査するMessagePackのバイト列。
+            @param[in] in_iterations 走査を繰り返す回数。
+            @return 走査1回あたりの時間。ナノ秒単位。
+         */
+        inline double measure_message_pack_scanner(
+            std::string const& in_data,
+            std::size_t const in_iterations)
+        {
+            std::size_t local_checksum(0);
+            psyq::message_pack::scan_visitor local_visitor;
+            auto const local_begin(std::chrono::steady_clock::now());
+            for (std::size_t i(0); i < in_iterations; ++i)
+            {
+                psyq::message_pack::scanner<psyq::message_pack::memory_istream>
+                    local_scanner(
+                        psyq::message_pack::memory_istream(
+                            in_data.data(), in_data.size()));
+                local_checksum += 0 < local_scanner.scan(local_visitor);
+            }
+            auto const local_end(std::chrono::steady_clock::now());
+            PSYQ_ASSERT(local_checksum == in_iterations);
+            return std::chrono::duration<double, std::nano>(
+                local_end - local_begin).count() / in_iterations;
+        }
+
+        /** @brief std::istringstream と memory_istream
+                   で直列化復元する時間を比較する。
+
+            memory_istream では、RAWバイト列をコピーせずに参照する場合と、
+            psyq::message_pack::scanner でオブジェクトを構築せずに走査する場合も計測する。
+
+            @param[in] in_iterations 直列化復元を繰り返す回数。
+            @param[in] in_verbose    計測結果を出力するかどうか。
+         */
+        inline void message_pack_deserializer_benchmark(
+            std::size_t const in_iterations = 10000,
+            bool const in_verbose = true)
+        {
+            auto const local_data(
+                psyq::test::make_message_pack_benchmark_data());
+            auto const local_stream_time(
+                psyq::test::measure_message_pack_deserializer<std::istringstream>(
+                    local_data, in_iterations));
+            auto const local_memory_time(
+                psyq::test::measure_message_pack_deserializer<
+                    psyq::message_pack::memory_istream>(
+                        local_data, in_iterations));
+            auto const local_borrow_time(
+                psyq::test::measure_message_pack_deserializer<
+                    psyq::message_pack::memory_istream>(
+                        local_data, in_iterations, false));
+            auto const local_scan_time(
+                psyq::test::measure_message_pack_scanner(local_data, in_iterations));
+            if (in_verbose)
+            {
+                printf(
+                    "message_pack::deserializer %u bytes: "
+                    "istringstream %9.0fns memory_istream %9.0fns (x%.2f) "
+                    "borrowed %9.0fns (x%.2f) scanner %9.0fns (x%.2f)\n",
+                    static_cast<unsigned>(local_data.size()),
+                    local_stream_time,
+                    local_memory_time,
+                    local_stream_time / local_memory_time,
+                    local_borrow_time,
+                    local_stream_time / local_borrow_time,
+                    local_scan_time,
+                    local_stream_time / local_scan_time);
+            }
+        }
+
+        /** @brief フレーム毎に多数のMessagePackを直列化復元する時間を計測する。
+
+            直列化復元したMessagePackオブジェクトは、フレームの終わりまで保持する。
+
+            @param[in] in_data            直列化復元するMessagePackのバイト列。
+            @param[in] in_frames          計測するフレームの数。
+            @param[in] in_frame_documents 1フレームで直列化復元するMessagePackの数。
+            @param[in] in_make_pool       直列化復元毎にメモリ割当子を用意する関数。
+            @param[in] in_end_frame       フレームの終わりに呼び出す関数。
+            @tparam template_pool         直列化復元に使うメモリ割当子。
+            @return MessagePack1つあたりの直列化復元の時間。ナノ秒単位。
+         */
+        template<
+            typename template_pool,
+            typename template_make_pool,
+            typename template_end_frame>
+        double measure_message_pack_frame(
+            std::string const& in_data,
+            std::size_t const in_frames,
+            std::size_t const in_frame_documents,
+            template_make_pool const& in_make_pool,
+            template_end_frame const& in_end_frame)
+        {
+            typedef psyq::message_pack::deserializer<
+                psyq::message_pack::memory_istream, template_pool>
+                    frame_deserializer;
+            std::vector<typename frame_deserializer::root_object>
+                local_root_objects(in_frame_documents);
+            std::size_t local_checksum(0);
+            auto const local_begin(std::chrono::steady_clock::now());
+            for (std::size_t i(0); i < in_frames; ++i)
+            {
+                for (auto& local_root_object: local_root_objects)
+                {
+                    frame_deserializer local_deserializer(
+                        psyq::message_pack::memory_istream(
+                            in_data.data(), in_data.size()),
+                        in_make_pool());
+                    local_deserializer >> local_root_object;
+                    local_checksum += local_root_object.get_array()->size();
+                }
+                for (auto& local_root_object: local_root_objects)
+                {
+                    local_root_object.reset();
+                }
+                in_end_frame();
+            }
+            auto const local_end(std::chrono::steady_clock::now());
+            PSYQ_ASSERT(local_checksum == 5 * in_frames * in_frame_documents);
+            return std::chrono::duration<double, std::nano>(
+                local_end - local_begin).count() / (in_frames * in_frame_documents);
+        }
+
+        /** @brief フレーム毎に多数のMessagePackを直列化復元する時間を、
+                   直列化復元毎にメモリプールを構築する場合と、
+                   1つのメモリプールをフレーム毎に再利用する場合で比較する。
+            @param[in] in_frames          計測するフレームの数。
+            @param[in] in_frame_documents 1フレームで直列化復元するMessagePackの数。
+            @param[in] in_verbose         計測結果を出力するかどうか。
+         */
+        inline void message_pack_frame_pool_benchmark(
+            std::size_t const in_frames = 100,
+            std::size_t const in_frame_documents = 100,
+            bool const in_verbose = true)
+        {
+            auto const local_data(
+                psyq::test::make_message_pack_benchmark_data());
+            auto const local_owner_time(
+                psyq::test::measure_message_pack_frame<psyq::message_pack::pool<>>(
+                    local_data,
+                    in_frames,
+                    in_frame_documents,
+                    []{return psyq::message_pack::pool<>();},
+                    []{}));
+            psyq::message_pack::pool<> local_frame_pool;
+            auto const local_frame_time(
+                psyq::test::measure_message_pack_frame<
+                    psyq::message_pack::pool_reference<>>(
+                        local_data,
+                        in_frames,
+                        in_frame_documents,
+                        [&local_frame_pool]
+                        {
+                            return psyq::message_pack::pool_reference<>(
+                                local_frame_pool);
+                        },
+                        [&local_frame_pool]{local_frame_pool.reset();}));
+            if (in_verbose)
+            {
+                printf(
+                    "message_pack::pool %u documents/frame: "
+                    "pool per document %9.0fns frame pool %9.0fns (x%.2f) "
+                    "%u chunks\n",
+                    static_cast<unsigned>(in_frame_documents),
+                    local_owner_time,
+                    local_frame_time,
+                    local_owner_time / local_frame_time,
+                    static_cast<unsigned>(
+                        local_frame_pool.get_statistics().chunk_count));
+            }
+        }
+
+        /** @brief 計測用の記録を直列化し続け、1記録あたりの時間を計測する。
+            @param[in,out] io_ostream    直列化した記録を書き込む出力ストリーム。
+            @param[in]     in_iterations 直列化する記録の数。
+            @return 記録1つあたりの直列化の時間。ナノ秒単位。
+         */
+        template<typename template_stream>
+        double measure_message_pack_serializer(
+            template_stream io_ostream,
+            std::size_t const in_iterations)
+        {
+            psyq::message_pack::serializer<template_stream>
+                local_serializer(std::move(io_ostream));
+            auto const local_begin(std::chrono::steady_clock::now());
+            for (std::size_t i(0); i < in_iterations; ++i)
+            {
+                local_serializer.make_serial_array(6);
+                local_serializer << static_cast<std::uint64_t>(i);
+                local_serializer << static_cast<std::int32_t>(i * 7 - 1000);
+                local_serializer << static_cast<std::uint16_t>(i);
+                local_serializer << i * 0.25;
+                local_serializer << 1.5f;
+                local_serializer << (i % 2 == 0);
+            }
+            auto const local_end(std::chrono::steady_clock::now());
+            PSYQ_ASSERT(!local_serializer.get_stream().fail());
+            return std::chrono::duration<double, std::nano>(
+                local_end - local_begin).count() / in_iterations;
+        }
+
+        /** @brief std::ostringstream と memory_ostream
+                   で直列化する時間を比較する。
+            @param[in] in_iterations 直列化する記録の数。
+            @param[in] in_verbose    計測結果を出力するかどうか。
+         */
+        inline void message_pack_serializer_benchmark(
+            std::size_t const in_iterations = 100000,
+            bool const in_verbose = true)
+        {
+            auto const local_stream_time(
+                psyq::test::measure_message_pack_serializer(
+                    std::ostringstream(), in_iterations));
+            auto const local_memory_time(
+                psyq::test::measure_message_pack_serializer(
+                    psyq::message_pack::memory_ostream<>(), in_iterations));
+            if (in_verbose)
+            {
+                printf(
+                    "message_pack::serializer %u records: "
+                    "ostringstream %6.1fns memory_ostream %6.1fns (x%.2f)\n",
+                    static_cast<unsigned>(in_iterations),
+                    local_stream_time,
+                    local_memory_time,
+                    local_stream_time / local_memory_time);
+            }
+        }
+
+        /** @brief 連想配列をキーで検索する時間を、
+                   ソート済み連想配列の二分探索とハッシュ表の索引で比較する。
+            @param[in] in_size       連想配列の要素数。
+            @param[in] in_iterations 全要素の検索を繰り返す回数。
+            @param[in] in_verbose    計測結果を出力するかどうか。
+         */
+        inline void message_pack_map_index_benchmark(
+            std::size_t const in_size = 4096,
+            std::size_t const in_iterations = 100,
+            bool const in_verbose = true)
+        {
+            std::vector<std::string> local_keys;
+            std::map<std::string, std::size_t> local_source_map;
+            for (std::size_t i(0); i < in_size; ++i)
+            {
+                local_keys.push_back("key" + std::to_string(i * 7919));
+                local_source_map[local_keys.back()] = i;
+            }
+            psyq::message_pack::serializer<psyq::message_pack::memory_ostream<>>
+                local_serializer(psyq::message_pack::memory_ostream<>(0x10000));
+            local_serializer << local_source_map;
+            typedef psyq::message_pack::deserializer<psyq::message_pack::memory_istream>
+                benchmark_deserializer;
+            benchmark_deserializer local_deserializer(
+                psyq::message_pack::memory_istream(
+                    local_serializer.get_stream().data(),
+                    local_serializer.get_stream().size()),
+                benchmark_deserializer::pool());
+            benchmark_deserializer::root_object local_root_object;
+            local_deserializer >> local_root_object;
+            auto const local_map(local_root_object.get_map());
+            PSYQ_ASSERT(local_map != nullptr);
+
+            std::size_t local_checksum(0);
+            auto const local_sorted_begin(std::chrono::steady_clock::now());
+            for (std::size_t i(0); i < in_iterations; ++i)
+            {
+                for (auto const& local_key: local_keys)
+                {
+                    local_checksum += local_map->find(
+                        psyq::message_pack::object::make_string(local_key))
+                            != local_map->end();
+                }
+            }
+            auto const local_sorted_end(std::chrono::steady_clock::now());
+            psyq::message_pack::map_index<benchmark_deserializer::pool>
+                local_index(*local_map, local_root_object.get_pool());
+            for (std::size_t i(0); i < in_iterations; ++i)
+            {
+                for (auto const& local_key: local_keys)
+                {
+                    local_checksum += local_index.find(
+                        psyq::message_pack::object::make_string(local_key))
+                            != local_map->end();
+                }
+            }
+            auto const local_index_end(std::chrono::steady_clock::now());
+            PSYQ_ASSERT(local_checksum == 2 * in_size * in_iterations);
+            if (in_verbose)
+            {
+                auto const local_count(
+                    static_cast<double>(in_size * in_iterations));
+                auto const local_sorted_time(
+                    std::chrono::duration<double, std::nano>(
+                        local_sorted_end - local_sorted_begin).count()
+                    / local_count);
+                auto const local_index_time(
+                    std::chrono::duration<double, std::nano>(
+                        local_index_end - local_sorted_end).count()
+                    / local_count);
+                printf(
+                    "message_pack::map_index %u elements: "
+                    "sorted find %6.1fns map_index %6.1fns (x%.2f)\n",
+                    static_cast<unsigned>(in_size),
+                    local_sorted_time,
+                    local_index_time,
+                    local_sorted_time / local_index_time);
+            }
+        }
+
+        /** @brief 構造体を直列化復元する時間を、
+                   MessagePackオブジェクトを構築する場合と、
+                   psyq::message_pack::read_struct() で直接直列化復元する場合で比較する。
+
+            psyq::test::message_pack_shape を使うので、
+            psyq/message_pack/test.hpp を先にincludeしておくこと。
+
+            @param[in] in_iterations 直列化復元を繰り返す回数。
+            @param[in] in_verbose    計測結果を出力するかどうか。
+         */
+        inline void message_pack_struct_benchmark(
+            std::size_t const in_iterations = 10000,
+            bool const in_verbose = true)
+        {
+            psyq::test::message_pack_shape local_shape;
+            local_shape.id = 1;
+            local_shape.layer = 2;
+            local_shape.scale = 0.5f;
+            local_shape.ratio = 0.25;
+            local_shape.visible = true;
+            local_shape.name = "benchmark";
+            for (std::int32_t i(0); i < 64; ++i)
+            {
+                psyq::test::message_pack_point const local_point = {i * 7, -i};
+                local_shape.points.push_back(local_point);
+            }
+            local_shape.color.fill(0x80);
+            local_shape.origin = local_shape.points.back();
+            psyq::message_pack::serializer<psyq::message_pack::memory_ostream<>>
+                local_serializer(psyq::message_pack::memory_ostream<>(0x1000));
+            psyq::message_pack::write_struct(local_serializer, local_shape);
+            auto const& local_stream(local_serializer.get_stream());
+
+            std::size_t local_checksum(0);
+            typedef psyq::message_pack::deserializer<psyq::message_pack::memory_istream>
+                benchmark_deserializer;
+            auto const local_object_begin(std::chrono::steady_clock::now());
+            for (std::size_t i(0); i < in_iterations; ++i)
+            {
+                benchmark_deserializer local_deserializer(
+                    psyq::message_pack::memory_istream(
+                        local_stream.data(), local_stream.size()),
+                    benchmark_deserializer::pool());
+                benchmark_deserializer::root_object local_root_object;
+                local_deserializer >> local_root_object;
+                local_checksum += local_root_object.get_array()->size();
+            }
+            auto const local_object_end(std::chrono::steady_clock::now());
+            psyq::test::message_pack_shape local_read_shape;
+            for (std::size_t i(0); i < in_iterations; ++i)
+            {
+                psyq::message_pack::scanner<psyq::message_pack::memory_istream>
+                    local_scanner(
+                        psyq::message_pack::memory_istream(
+                            local_stream.data(), local_stream.size()));
+                psyq::message_pack::read_struct(local_scanner, local_read_shape);
+                local_checksum += local_read_shape.points.size();
+            }
+            auto const local_struct_end(std::chrono::steady_clock::now());
+            PSYQ_ASSERT(local_checksum == (9 + 64) * in_iterations);
+            if (in_verbose)
+            {
+                auto const local_object_time(
+                    std::chrono::duration<double, std::nano>(
+                        local_object_end - local_object_begin).count()
+                    / in_iterations);
+                auto const local_struct_time(
+                    std::chrono::duration<double, std::nano>(
+                        local_struct_end - local_object_end).count()
+                    / in_iterations);
+                printf(
+                    "message_pack::read_struct %u bytes: "
+                    "object tree %9.0fns read_struct %9.0fns (x%.2f)\n",
+                    static_cast<unsigned>(local_stream.size()),
+                    local_object_time,
+                    local_struct_time,
+                    local_object_time / local_struct_time);
+            }
+        }
+    } // namespace test
+} // namespace psyq
+
+#endif // !defined(PSYQ_MESSAGE_PACK_BENCHMARK_HPP_)
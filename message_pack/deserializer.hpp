@@ -23,6 +23,7 @@ namespace psyq
             typename = psyq::message_pack::pool<>,
             std::size_t = PSYQ_MESSAGE_PACK_DESERIALIZER_STACK_CAPACITY_DEFAULT>
                 class deserializer;
+        class memory_istream;
         /// @endcond
 
         /// この名前空間をユーザーが直接アクセスするのは禁止。
@@ -54,13 +55,396 @@ namespace psyq
                     in_read_size / sizeof(char_type));
                 if (io_istream.fail())
                 {
-                    PSYQ_ASSERT(false);
                     io_istream.seekg(local_pre_position);
                     return 0;
                 }
                 return static_cast<std::size_t>(io_istream.tellg() - local_pre_position)
                     * sizeof(char_type);
             }
+
+            /** @brief メモリ領域からRAWバイト列を読み込む。
+
+                psyq::message_pack::memory_istream で、
+                ストリームを介さずにポインタで直接読み込む高速版。
+                定義は memory_istream.hpp にある。
+             */
+            inline std::size_t read_bytes(
+                void* const out_bytes,
+                psyq::message_pack::memory_istream& io_istream,
+                std::size_t const in_read_size);
+
+            /** @brief ストリームのバッファにあるRAWバイト列を、コピーせずに参照する。
+
+                汎用のストリームはバッファを直接参照できないので、常に失敗する。
+
+                @param[in,out] io_istream   読み込むストリーム。
+                @param[in]     in_read_size 読み込むバイト数。
+                @retval !=nullptr ストリームのバッファにあるRAWバイト列の先頭位置。
+                @retval ==nullptr 参照できなかった。
+             */
+            template<typename template_stream>
+            void const* borrow_bytes(template_stream&, std::size_t const)
+            {
+                return nullptr;
+            }
+
+            /** @brief メモリ領域にあるRAWバイト列を、コピーせずに参照する。
+
+                定義は memory_istream.hpp にある。
+             */
+            inline void const* borrow_bytes(
+                psyq::message_pack::memory_istream& io_istream,
+                std::size_t const in_read_size);
+
+            /** @brief ストリームからすぐに読み込めるバイト数を取得する。
+
+                汎用のストリームでは分からないので、最大値を返す。
+
+                @param[in] in_istream 読み込むストリーム。
+                @return すぐに読み込めるバイト数。
+             */
+            template<typename template_stream>
+            std::size_t get_readable_size(template_stream const& in_istream)
+            {
+                static_cast<void>(in_istream);
+                return (std::numeric_limits<std::size_t>::max)();
+            }
+
+            /** @brief メモリ領域からすぐに読み込めるバイト数を取得する。
+
+                定義は memory_istream.hpp にある。
+             */
+            inline std::size_t get_readable_size(
+                psyq::message_pack::memory_istream const& in_istream);
+
+            //---------------------------------------------------------------------
+            /// MessagePack値のヘッダが表す値の種類。
+            enum header_kind
+            {
+                header_kind_NIL,              ///< 空値。
+                header_kind_BOOLEAN,          ///< 真偽値。
+                header_kind_UNSIGNED_INTEGER, ///< 0以上の整数。
+                header_kind_SIGNED_INTEGER,   ///< 符号つき整数。
+                header_kind_FLOATING_POINT,   ///< 浮動小数点数。
+                header_kind_STRING,           ///< 文字列。
+                header_kind_BINARY,           ///< バイナリ。
+                header_kind_EXTENDED,         ///< 拡張バイナリ。
+                header_kind_ARRAY,            ///< 配列。
+                header_kind_MAP,              ///< 連想配列。
+                header_kind_INVALID,          ///< 未使用の形式。
+            };
+
+            /** @brief MessagePack値のヘッダを解読した結果。
+
+                psyq::message_pack::deserializer は read_header() で、
+                psyq::message_pack::scanner は decode_header() と
+                read_header_field() でヘッダを読み込んでから値を復元する。
+                ただし scanner は、走査を速くするため、
+                固定長の形式と数値は先頭バイトで直接分岐する。
+             */
+            struct header
+            {
+                /// 値の種類。
+                psyq::message_pack::_private::header_kind kind;
+                /** @brief 先頭バイトに続く、 header::field のバイト数。
+
+                    0なら、 header::field は先頭バイトに含まれている。
+                 */
+                std::size_t field_size;
+                /** @brief 値か、RAWバイト列のバイト長か、コンテナの要素数。
+
+                    - 真偽値と整数と浮動小数点数では、値のビット列。
+                      0未満の固定値整数は、符号拡張してある。
+                    - RAWバイト列では、バイト長。
+                      拡張バイナリは、型を表す1バイトを含まない。
+                    - コンテナでは、要素数。
+                 */
+                std::uint64_t field;
+            };
+
+            /** @brief MessagePack値の先頭バイトを解読する。
+                @param[in] in_format MessagePack値の先頭バイト。
+                @return
+                    MessagePack値のヘッダ。先頭バイトに続く header::field
+                    は読み込んでいない。
+                    in_format が未使用の形式なら、種類は header_kind_INVALID 。
+             */
+            inline psyq::message_pack::_private::header decode_header(
+                unsigned const in_format)
+            PSYQ_NOEXCEPT
+            {
+                if (in_format <= psyq::message_pack::_private::format_FIX_INTEGER_MAX)
+                {
+                    // [0x00, 0x7f]: positive fixnum
+                    psyq::message_pack::_private::header const local_header = {
+                        psyq::message_pack::_private::header_kind_UNSIGNED_INTEGER,
+                        0,
+                        in_format};
+                    return local_header;
+                }
+                else if (in_format <= psyq::message_pack::_private::format_FIX_MAP_MAX)
+                {
+                    // [0x80, 0x8f]: fix map
+                    psyq::message_pack::_private::header const local_header = {
+                        psyq::message_pack::_private::header_kind_MAP,
+                        0,
+                        in_format & 0x0f};
+                    return local_header;
+                }
+                else if (in_format <= psyq::message_pack::_private::format_FIX_ARRAY_MAX)
+                {
+                    // [0x90, 0x9f]: fix array
+                    psyq::message_pack::_private::header const local_header = {
+                        psyq::message_pack::_private::header_kind_ARRAY,
+                        0,
+                        in_format & 0x0f};
+                    return local_header;
+                }
+                else if (in_format <= psyq::message_pack::_private::format_FIX_STRING_MAX)
+                {
+                    // [0xa0, 0xbf]: fix str
+                    psyq::message_pack::_private::header const local_header = {
+                        psyq::message_pack::_private::header_kind_STRING,
+                        0,
+                        in_format & 0x1f};
+                    return local_header;
+                }
+                else if (psyq::message_pack::_private::format_MAP_32 < in_format)
+                {
+                    // [0xe0, 0xff]: negative fixnum
+                    psyq::message_pack::_private::header const local_header = {
+                        psyq::message_pack::_private::header_kind_SIGNED_INTEGER,
+                        0,
+                        static_cast<std::uint64_t>(
+                            static_cast<std::int64_t>(
+                                static_cast<std::int8_t>(in_format)))};
+                    return local_header;
+                }
+
+                // [0xc0, 0xdf]: 先頭バイトに続く値を持つ形式は、表から引く。
+                static psyq::message_pack::_private::header const local_headers[] =
+                {
+                    {psyq::message_pack::_private::header_kind_NIL,              0,  0}, // 0xc0: nil
+                    {psyq::message_pack::_private::header_kind_INVALID,          0,  0}, // 0xc1: (never used)
+                    {psyq::message_pack::_private::header_kind_BOOLEAN,          0,  0}, // 0xc2: false
+                    {psyq::message_pack::_private::header_kind_BOOLEAN,          0,  1}, // 0xc3: true
+                    {psyq::message_pack::_private::header_kind_BINARY,           1,  0}, // 0xc4: bin 8
+                    {psyq::message_pack::_private::header_kind_BINARY,           2,  0}, // 0xc5: bin 16
+                    {psyq::message_pack::_private::header_kind_BINARY,           4,  0}, // 0xc6: bin 32
+                    {psyq::message_pack::_private::header_kind_EXTENDED,         1,  0}, // 0xc7: ext 8
+                    {psyq::message_pack::_private::header_kind_EXTENDED,         2,  0}, // 0xc8: ext 16
+                    {psyq::message_pack::_private::header_kind_EXTENDED,         4,  0}, // 0xc9: ext 32
+                    {psyq::message_pack::_private::header_kind_FLOATING_POINT,   4,  0}, // 0xca: float 32
+                    {psyq::message_pack::_private::header_kind_FLOATING_POINT,   8,  0}, // 0xcb: float 64
+                    {psyq::message_pack::_private::header_kind_UNSIGNED_INTEGER, 1,  0}, // 0xcc: uint 8
+                    {psyq::message_pack::_private::header_kind_UNSIGNED_INTEGER, 2,  0}, // 0xcd: uint 16
+                    {psyq::message_pack::_private::header_kind_UNSIGNED_INTEGER, 4,  0}, // 0xce: uint 32
+                    {psyq::message_pack::_private::header_kind_UNSIGNED_INTEGER, 8,  0}, // 0xcf: uint 64
+                    {psyq::message_pack::_private::header_kind_SIGNED_INTEGER,   1,  0}, // 0xd0: int 8
+                    {psyq::message_pack::_private::header_kind_SIGNED_INTEGER,   2,  0}, // 0xd1: int 16
+                    {psyq::message_pack::_private::header_kind_SIGNED_INTEGER,   4,  0}, // 0xd2: int 32
+                    {psyq::message_pack::_private::header_kind_SIGNED_INTEGER,   8,  0}, // 0xd3: int 64
+                    {psyq::message_pack::_private::header_kind_EXTENDED,         0,  1}, // 0xd4: fixext 1
+                    {psyq::message_pack::_private::header_kind_EXTENDED,         0,  2}, // 0xd5: fixext 2
+                    {psyq::message_pack::_private::header_kind_EXTENDED,         0,  4}, // 0xd6: fixext 4
+                    {psyq::message_pack::_private::header_kind_EXTENDED,         0,  8}, // 0xd7: fixext 8
+                    {psyq::message_pack::_private::header_kind_EXTENDED,         0, 16}, // 0xd8: fixext 16
+                    {psyq::message_pack::_private::header_kind_STRING,           1,  0}, // 0xd9: str 8
+                    {psyq::message_pack::_private::header_kind_STRING,           2,  0}, // 0xda: str 16
+                    {psyq::message_pack::_private::header_kind_STRING,           4,  0}, // 0xdb: str 32
+                    {psyq::message_pack::_private::header_kind_ARRAY,            2,  0}, // 0xdc: array 16
+                    {psyq::message_pack::_private::header_kind_ARRAY,            4,  0}, // 0xdd: array 32
+                    {psyq::message_pack::_private::header_kind_MAP,              2,  0}, // 0xde: map 16
+                    {psyq::message_pack::_private::header_kind_MAP,              4,  0}, // 0xdf: map 32
+                };
+                static_assert(
+                    sizeof(local_headers) / sizeof(local_headers[0])
+                    == psyq::message_pack::_private::format_MAP_32
+                        - psyq::message_pack::_private::format_NIL + 1,
+                    "local_headers does not cover [0xc0, 0xdf].");
+                return local_headers[in_format - psyq::message_pack::_private::format_NIL];
+            }
+
+            /** @brief ストリームを読み込み、big-endianで値を復元する。
+                @tparam template_value 復元する値の型。
+                @param[out]    out_value  復元した値を格納する。
+                @param[in,out] io_istream 読み込むストリーム。
+                @retval true  成功。
+                @retval false 失敗。ストリームの末尾に達した。
+             */
+            template<typename template_value, typename template_stream>
+            inline bool read_big_endian(
+                template_value& out_value,
+                template_stream& io_istream)
+            {
+                typedef psyq::message_pack::endianness_converter<template_value>
+                    endianness_converter;
+                typename endianness_converter::bytes local_bytes;
+                auto const local_read_size(
+                    psyq::message_pack::_private::read_bytes(
+                        &local_bytes, io_istream, sizeof(local_bytes)));
+                if (local_read_size != sizeof(local_bytes))
+                {
+                    return false;
+                }
+                out_value = endianness_converter::unpack_bytes(
+                    local_bytes, psyq::message_pack::big_endian);
+                return true;
+            }
+
+            /** @brief ストリームを読み込み、big-endianで符号なし整数を復元する。
+                @tparam template_value 復元する整数の型。
+                @param[out]    out_value  復元した整数を格納する。
+                @param[in,out] io_istream 読み込むストリーム。
+                @retval true  成功。
+                @retval false 失敗。ストリームの末尾に達した。
+             */
+            template<typename template_value, typename template_stream>
+            inline bool read_big_endian_field(
+                std::uint64_t& out_value,
+                template_stream& io_istream)
+            {
+                template_value local_value;
+                if (!psyq::message_pack::_private::read_big_endian(
+                        local_value, io_istream))
+                {
+                    return false;
+                }
+                out_value = local_value;
+                return true;
+            }
+
+            /** @brief ストリームから、MessagePack値の先頭バイトに続く値を読み込む。
+
+                decode_header() で解読したヘッダに、値かRAWバイト列のバイト長か
+                コンテナの要素数を読み込む。
+
+                @param[in,out] io_header  decode_header() で解読したヘッダ。
+                @param[in,out] io_istream 読み込むストリーム。
+                @retval true  成功。
+                @retval false 失敗。ストリームの末尾に達した。
+             */
+            template<typename template_stream>
+            inline bool read_header_field(
+                psyq::message_pack::_private::header& io_header,
+                template_stream& io_istream)
+            {
+                if (io_header.field_size <= 0)
+                {
+                    return true;
+                }
+                switch (io_header.field_size)
+                {
+                case sizeof(std::uint8_t):
+                    return psyq::message_pack::_private::read_big_endian_field<std::uint8_t>(
+                        io_header.field, io_istream);
+                case sizeof(std::uint16_t):
+                    return psyq::message_pack::_private::read_big_endian_field<std::uint16_t>(
+                        io_header.field, io_istream);
+                case sizeof(std::uint32_t):
+                    return psyq::message_pack::_private::read_big_endian_field<std::uint32_t>(
+                        io_header.field, io_istream);
+                default:
+                    return psyq::message_pack::_private::read_big_endian_field<std::uint64_t>(
+                        io_header.field, io_istream);
+                }
+            }
+
+            /** @brief ストリームからMessagePack値のヘッダを読み込む。
+
+                先頭バイトと、それに続く値かRAWバイト列のバイト長か
+                コンテナの要素数までを読み込む。
+
+                @param[out]    out_header 読み込んだヘッダを格納する。
+                @param[in,out] io_istream 読み込むストリーム。
+                @retval true  成功。
+                @retval false 失敗。ストリームの末尾に達した。
+             */
+            template<typename template_stream>
+            inline bool read_header(
+                psyq::message_pack::_private::header& out_header,
+                template_stream& io_istream)
+            {
+                auto const local_format(io_istream.get());
+                if (io_istream.fail())
+                {
+                    return false;
+                }
+                out_header = psyq::message_pack::_private::decode_header(
+                    static_cast<unsigned>(local_format) & 0xff);
+                return psyq::message_pack::_private::read_header_field(
+                    out_header, io_istream);
+            }
+
+            /** @brief ヘッダに続くRAWバイト列のバイト数を取得する。
+                @param[in] in_header read_header() で読み込んだヘッダ。
+                @return
+                    ヘッダに続くRAWバイト列のバイト数。
+                    拡張バイナリは、型を表す1バイトを含む。
+                    RAWバイト列以外では0。
+             */
+            inline std::size_t get_payload_size(
+                psyq::message_pack::_private::header const& in_header)
+            PSYQ_NOEXCEPT
+            {
+                switch (in_header.kind)
+                {
+                case psyq::message_pack::_private::header_kind_STRING:
+                case psyq::message_pack::_private::header_kind_BINARY:
+                    return static_cast<std::size_t>(in_header.field);
+                case psyq::message_pack::_private::header_kind_EXTENDED:
+                    return static_cast<std::size_t>(in_header.field) + 1;
+                default:
+                    return 0;
+                }
+            }
+
+            /** @brief ヘッダから符号つき整数を取り出す。
+                @param[in] in_header
+                    read_header() で読み込んだ、符号つき整数のヘッダ。
+                @return ヘッダが持つ符号つき整数。
+             */
+            inline std::int64_t get_signed_integer(
+                psyq::message_pack::_private::header const& in_header)
+            PSYQ_NOEXCEPT
+            {
+                auto local_value(in_header.field);
+                if (0 < in_header.field_size
+                    && in_header.field_size < sizeof(std::uint64_t))
+                {
+                    // 読み込んだバイト数に合わせて、符号拡張する。
+                    auto const local_sign_bit(
+                        std::uint64_t(1) << (in_header.field_size * 8 - 1));
+                    local_value = (local_value ^ local_sign_bit) - local_sign_bit;
+                }
+                return static_cast<std::int64_t>(local_value);
+            }
+
+            /** @brief ヘッダから浮動小数点数を取り出す。
+                @tparam template_value 取り出す浮動小数点数の型。
+                @param[in] in_header
+                    read_header() で読み込んだ、浮動小数点数のヘッダ。
+                @return ヘッダが持つ浮動小数点数。
+             */
+            template<typename template_value>
+            template_value get_floating_point(
+                psyq::message_pack::_private::header const& in_header)
+            PSYQ_NOEXCEPT
+            {
+                typedef typename std::conditional<
+                    sizeof(template_value) == sizeof(std::uint32_t),
+                    std::uint32_t,
+                    std::uint64_t>
+                        ::type bits;
+                static_assert(
+                    sizeof(template_value) == sizeof(bits),
+                    "sizeof(template_value) is neither 4 nor 8.");
+                PSYQ_ASSERT(in_header.field_size == sizeof(bits));
+                auto const local_bits(static_cast<bits>(in_header.field));
+                template_value local_value;
+                std::memcpy(&local_value, &local_bits, sizeof(local_value));
+                return local_value;
+            }
         } // namespace _private
     } // namespace message_pack
 } // namespace psyq
@@ -124,10 +508,10 @@ class psyq::message_pack::deserializer
     public: enum value_kind
     {
         value_kind_ROOT,          ///< 最上位のMessagePackオブジェクト。
-        value_kind_RAW_BYTES,     ///< RAWバイト列。
         value_kind_ARRAY_ELEMENT, ///< 配列の要素。
         value_kind_MAP_KEY,       ///< 連想配列の要素のキー。
         value_kind_MAP_VALUE,     ///< 連想配列の要素のマップ値。
+        value_kind_RAW_BYTES,     ///< 読み込み途中のRAWバイト列。
     };
 
     /// 直列化復元途中のコンテナのスタック。
@@ -161,8 +545,10 @@ class psyq::message_pack::deserializer
         stream_(std::move(in_istream)),
         pool_(std::move(in_pool)),
         stack_size_(0),
+        partial_header_size_(0),
         allocate_raw_(true),
-        sort_map_(true)
+        sort_map_(true),
+        incremental_(false)
     {}
 
     /** @brief ムーブ構築子。
@@ -171,12 +557,16 @@ class psyq::message_pack::deserializer
     public: deserializer(this_type&& io_source):
         stream_(std::move(io_source.stream_)),
         pool_(std::move(io_source.pool_)),
-        stack_(std::move(io_source.stack_)),
+        container_stack_(std::move(io_source.container_stack_)),
         stack_size_(std::move(io_source.stack_size_)),
+        partial_header_(std::move(io_source.partial_header_)),
+        partial_header_size_(std::move(io_source.partial_header_size_)),
         allocate_raw_(std::move(io_source.allocate_raw_)),
-        sort_map_(std::move(io_source.sort_map_))
+        sort_map_(std::move(io_source.sort_map_)),
+        incremental_(false)
     {
         io_source.stack_size_ = 0;
+        io_source.partial_header_size_ = 0;
     }
 
     /** @brief ムーブ代入演算子。
@@ -188,9 +578,12 @@ class psyq::message_pack::deserializer
         this->pool_ = std::move(io_source.pool_);
         this->container_stack_ = std::move(io_source.container_stack_);
         this->stack_size_ = std::move(io_source.stack_size_);
+        this->partial_header_ = std::move(io_source.partial_header_);
+        this->partial_header_size_ = std::move(io_source.partial_header_size_);
         this->allocate_raw_ = std::move(io_source.allocate_raw_);
         this->sort_map_ = std::move(io_source.sort_map_);
         io_source.stack_size_ = 0;
+        io_source.partial_header_size_ = 0;
         return *this;
     }
     //@}
@@ -214,6 +607,21 @@ class psyq::message_pack::deserializer
         this->stream_.swap(in_istream);
         this->pool_ = std::move(in_pool);
         this->stack_size_ = 0;
+        this->partial_header_size_ = 0;
+        return in_istream;
+    }
+
+    /** @brief 直列化復元の途中状態を保ったまま、入力ストリームを差し替える。
+
+        this_type::read_partial_object() で、
+        次に読み込むメモリ領域の断片を設定するときに使う。
+
+        @param[in] in_istream 新たに設定する入力ストリーム。
+        @return これまで使っていた入力ストリーム。
+     */
+    public: typename this_type::stream resume(typename this_type::stream in_istream)
+    {
+        this->stream_.swap(in_istream);
         return in_istream;
     }
 
@@ -249,6 +657,32 @@ class psyq::message_pack::deserializer
         this->sort_map_ = in_sort_map;
     }
 
+    /** @brief RAWバイト列の直列化復元で、メモリ割当てをするかを取得する。
+        @return メモリ割当てをするかどうか。
+        @sa this_type::set_allocate_raw()
+     */
+    public: bool get_allocate_raw() const PSYQ_NOEXCEPT
+    {
+        return this->allocate_raw_;
+    }
+
+    /** @brief RAWバイト列の直列化復元で、メモリ割当てをするかを設定する。
+
+        falseを設定すると、文字列とバイナリと拡張バイナリは
+        メモリ割当て子にコピーせず、入力ストリームのバッファを直接参照する。
+        この場合、直列化復元したオブジェクトを使い終わるまで、
+        入力ストリームが読み込むメモリ領域を変更・解放しないこと。
+
+        バッファを直接参照できるのは psyq::message_pack::memory_istream だけで、
+        それ以外のストリームでは、設定に関わらずメモリ割当てをしてコピーする。
+
+        @param[in] in_allocate_raw メモリ割当てをするかどうか。
+     */
+    public: void set_allocate_raw(bool const in_allocate_raw) PSYQ_NOEXCEPT
+    {
+        this->allocate_raw_ = in_allocate_raw;
+    }
+
     /** @brief 次に直列化復元するMessagePack値の種別を取得する。
         @return 次に直列化復元するMessagePack値の種別。
         @sa this_type::read_object()
@@ -257,7 +691,7 @@ class psyq::message_pack::deserializer
     {
         return 0 < this->get_rest_container_count()?
             this->container_stack_.at(this->get_rest_container_count() - 1).kind:
-            typename this_type::value_kind_ROOT;
+            this_type::value_kind_ROOT;
     }
 
     /** @brief 直前に直列化復元を開始したMessagePackコンテナの残り要素数を取得する。
@@ -373,172 +807,351 @@ class psyq::message_pack::deserializer
             }
         }
     }
+
+    /** @brief メモリ領域の断片を読み込み、MessagePackオブジェクトの直列化復元を続行する。
+
+        this_type::read_object() と違って、読み込み途中の値があっても巻き戻さず、
+        読み込み途中の状態をコンテナスタックに保存しておく。
+        this_type::resume() で次の断片を設定して続行すると、
+        保存しておいた状態の続きから読み込むので、
+        断片がどこで区切られていても、同じバイトを2度読み込むことはない。
+
+        this_type::set_allocate_raw() でfalseを設定した場合、
+        断片内に収まったRAWバイト列は断片を直接参照するので、
+        直列化復元したオブジェクトを使い終わるまで、断片を解放しないこと。
+
+        断片の境界で途切れたRAWバイト列は、
+        this_type::value_kind_RAW_BYTES としてコンテナスタックを1段使う。
+        このため this_type::read_object() よりも入れ子が1段浅い時点で、
+        this_type::stack_capacity を超えて失敗することがある。
+
+        使用例
+        @code
+        // ソケットから受信した断片を、順に直列化復元する。
+        typedef psyq::message_pack::deserializer<psyq::message_pack::memory_istream>
+            memory_deserializer;
+        void receive_message_pack(
+            memory_deserializer& io_deserializer,
+            char const* const in_data,
+            std::size_t const in_size)
+        {
+            io_deserializer.resume(
+                psyq::message_pack::memory_istream(in_data, in_size));
+            memory_deserializer::root_object local_root_object;
+            while (0 < io_deserializer.read_partial_object(local_root_object))
+            {
+                // 直列化復元したオブジェクトを使う。
+            }
+        }
+        @endcode
+
+        @param[out] out_object
+            - 直列化復元が完了したMessagePackオブジェクトを格納する。
+            - 直列化復元が完了しなかった場合は、何もしない。
+        @return
+            - 正なら、MessagePackオブジェクトの直列化復元を完了。
+              断片の残りに、次のMessagePackオブジェクトがあるかもしれない。
+            - 0 なら、断片をすべて読み込んだ。
+              this_type::resume() で次の断片を設定して、続行できる。
+            - 負なら、直列化復元に失敗。
+        @note psyq::message_pack::memory_istream を使う場合のみ使える。
+     */
+    public: int read_partial_object(typename this_type::root_object& out_object)
+    {
+        static_assert(
+            std::is_same<
+                typename this_type::stream, psyq::message_pack::memory_istream>
+                    ::value,
+            "this_type::stream is not psyq::message_pack::memory_istream.");
+        this->incremental_ = true;
+        auto const local_result(this->read_partial_value());
+        this->incremental_ = false;
+        switch (local_result)
+        {
+        case this_type::read_result_FINISH:
+            out_object = typename this_type::root_object(
+                this->container_stack_.front().object,
+                std::move(this->pool_));
+            return 1;
+
+        case this_type::read_result_CONTINUE:
+            return 0;
+
+        default:
+            return -1;
+        }
+    }
     //@}
     //-------------------------------------------------------------------------
-    /** @brief ストリームを読み込み、MessagePack値を復元する。
+    /** @brief メモリ領域の断片を、読み込み途中の状態から読み込む。
      */
-    private: typename this_type::read_result read_value()
+    private: typename this_type::read_result read_partial_value()
     {
-        // ストリームからMessagePack直列化形式を読み込む。
-        if (!this->stream_.good())
+        for (;;)
         {
-            return this_type::read_result_ABORT;
+            typename this_type::read_result local_result;
+            auto const local_rest_size(this->stream_.get_rest_size());
+            if (this->get_next_value_kind() == this_type::value_kind_RAW_BYTES)
+            {
+                // 読み込み途中のRAWバイト列の続きを読み込む。
+                local_result = this->fill_partial_raw();
+            }
+            else if (0 < this->partial_header_size_)
+            {
+                // 読み込み途中のヘッダの続きを読み込む。
+                local_result = this->read_partial_header();
+            }
+            else if (local_rest_size <= 0)
+            {
+                return this_type::read_result_CONTINUE;
+            }
+            else if (
+                local_rest_size < this_type::get_header_size(
+                    static_cast<std::uint8_t>(*this->stream_.get_current())))
+            {
+                // ヘッダが断片の末尾で途切れているので、保存しておく。
+                this->partial_header_size_ = psyq::message_pack::_private::read_bytes(
+                    this->partial_header_.data(), this->stream_, local_rest_size);
+                return this_type::read_result_CONTINUE;
+            }
+            else
+            {
+                local_result = this->read_value();
+            }
+
+            switch (local_result)
+            {
+            case this_type::read_result_FINISH:
+                return local_result;
+
+            case this_type::read_result_CONTINUE:
+                if (this->stream_.get_rest_size() <= 0)
+                {
+                    return local_result;
+                }
+                break;
+
+            default:
+                PSYQ_ASSERT(false);
+                return this_type::read_result_FAILED;
+            }
         }
-        auto const local_header(static_cast<unsigned>(this->stream_.get()));
+    }
 
-        // MessagePackの直列化形式によって、復元処理を分岐する。
-        if (local_header <= psyq::message_pack::_private::format_FIX_INTEGER_MAX)
+    /** @brief 読み込み途中のヘッダの続きを読み込み、MessagePack値を復元する。
+     */
+    private: typename this_type::read_result read_partial_header()
+    {
+        auto const local_header_size(
+            this_type::get_header_size(
+                static_cast<std::uint8_t>(this->partial_header_.front())));
+        auto const local_read_size(
+            (std::min)(
+                local_header_size - this->partial_header_size_,
+                this->stream_.get_rest_size()));
+        this->partial_header_size_ += psyq::message_pack::_private::read_bytes(
+            this->partial_header_.data() + this->partial_header_size_,
+            this->stream_,
+            local_read_size);
+        if (this->partial_header_size_ < local_header_size)
         {
-            // [0x00, 0x7f]: positive fixnum
-            return this->add_container_element(psyq::message_pack::object(local_header));
+            return this_type::read_result_CONTINUE;
         }
-        else if (local_header <= psyq::message_pack::_private::format_FIX_MAP_MAX)
+
+        // 揃ったヘッダだけを読み込むストリームに差し替えて、復元する。
+        typename this_type::stream local_stream(
+            this->partial_header_.data(), this->partial_header_size_);
+        this->partial_header_size_ = 0;
+        this->stream_.swap(local_stream);
+        auto const local_result(this->read_value());
+        this->stream_.swap(local_stream);
+        return local_result;
+    }
+
+    /** @brief 読み込み途中のRAWバイト列の続きを読み込む。
+     */
+    private: typename this_type::read_result fill_partial_raw()
+    {
+        auto& local_stack_top(
+            this->container_stack_[this->get_rest_container_count() - 1]);
+        std::size_t local_raw_size;
+        auto const local_raw_bytes(
+            this_type::get_raw_bytes(local_stack_top.object, local_raw_size));
+        auto const local_read_size(
+            (std::min)(local_stack_top.rest_count, this->stream_.get_rest_size()));
+        local_stack_top.rest_count -= psyq::message_pack::_private::read_bytes(
+            local_raw_bytes + local_raw_size - local_stack_top.rest_count,
+            this->stream_,
+            local_read_size);
+        if (0 < local_stack_top.rest_count)
         {
-            // [0x80, 0x8f]: fix map
-            return this->reserve_container<psyq::message_pack::object::unordered_map>(local_header & 0x0f);
+            return this_type::read_result_CONTINUE;
         }
-        else if (local_header <= psyq::message_pack::_private::format_FIX_ARRAY_MAX)
+
+        // RAWバイト列が揃ったので、スタックから取り出す。
+        auto const local_raw(local_stack_top.object);
+        --this->stack_size_;
+        return this->add_container_element(local_raw);
+    }
+
+    /** @brief 読み込み途中のRAWバイト列を、スタックに積む。
+        @tparam template_raw MessagePackRAWバイト列の型。
+        @param[in] in_size RAWバイト列のバイト数。
+     */
+    private: template<typename template_raw>
+    typename this_type::read_result reserve_partial_raw(std::size_t const in_size)
+    {
+        if (this->container_stack_.size() <= this->get_rest_container_count())
         {
-            // [0x90, 0x9f]: fix array
-            return this->reserve_container<psyq::message_pack::object::array>(local_header & 0x0f);
+            PSYQ_ASSERT(false);
+            return this_type::read_result_FAILED;
         }
-        else if (local_header <= psyq::message_pack::_private::format_FIX_STRING_MAX)
+        auto const local_bytes(this->pool_.allocate(in_size, 1));
+        if (local_bytes == nullptr)
         {
-            // [0xa0, 0xbf]: fix str
-            return this->read_raw<psyq::message_pack::object::string>(local_header & 0x1f);
+            PSYQ_ASSERT(false);
+            return this_type::read_result_FAILED;
         }
-        else if (local_header <= psyq::message_pack::_private::foramt_NEGATIVE_INTEGER_64)
+        auto const local_read_size(
+            psyq::message_pack::_private::read_bytes(
+                local_bytes,
+                this->stream_,
+                psyq::message_pack::_private::get_readable_size(this->stream_)));
+
+        // RAWバイト列をスタックに積む。
+        template_raw local_raw;
+        local_raw.reset(
+            static_cast<typename template_raw::pointer>(local_bytes), in_size);
+        auto& local_stack_top(
+            this->container_stack_[this->get_rest_container_count()]);
+        local_stack_top.object = psyq::message_pack::object(local_raw);
+        local_stack_top.kind = this_type::value_kind_RAW_BYTES;
+        local_stack_top.rest_count = in_size - local_read_size;
+        ++this->stack_size_;
+        return this_type::read_result_CONTINUE;
+    }
+
+    /** @brief MessagePackオブジェクトが持つRAWバイト列を取得する。
+        @param[in]  in_object 文字列／バイナリ／拡張バイナリのオブジェクト。
+        @param[out] out_size  RAWバイト列のバイト数を格納する。
+        @return RAWバイト列の先頭位置。
+     */
+    private: static char* get_raw_bytes(
+        psyq::message_pack::object const& in_object,
+        std::size_t& out_size)
+    {
+        void const* local_bytes(nullptr);
+        out_size = 0;
+        auto const local_string(in_object.get_string());
+        auto const local_binary(in_object.get_binary());
+        auto const local_extended(in_object.get_extended());
+        if (local_string != nullptr)
         {
-            // 0xc0: nil
-            // 0xc1: never used
-            // 0xc2: false
-            // 0xc3: true
-            // 0xc4: bin 8
-            // 0xc5: bin 16
-            // 0xc6: bin 32
-            // 0xc7: ext 8
-            // 0xc8: ext 16
-            // 0xc9: ext 32
-            // 0xca: float 32
-            // 0xcb: float 64
-            // 0xcc: unsigned int 8
-            // 0xcd: unsigned int 16
-            // 0xce: unsigned int 32
-            // 0xcf: unsigned int 64
-            // 0xd0: signed int 8
-            // 0xd1: signed int 16
-            // 0xd2: signed int 32
-            // 0xd3: signed int 64
-            return this->read_value(local_header);
+            local_bytes = local_string->data();
+            out_size = local_string->size();
         }
-        else if (local_header <= psyq::message_pack::_private::format_FIX_EXTENDED_16)
+        else if (local_binary != nullptr)
         {
-            // 0xd4: fix ext 1
-            // 0xd5: fix ext 2
-            // 0xd6: fix ext 4
-            // 0xd7: fix ext 8
-            // 0xd8: fix ext 16
-            return this->read_raw<psyq::message_pack::object::extended>(
-                1 << (local_header - psyq::message_pack::_private::format_FIX_EXTENDED_1));
+            local_bytes = local_binary->data();
+            out_size = local_binary->size();
         }
-        else if (local_header <= psyq::message_pack::_private::format_MAP_32)
+        else if (local_extended != nullptr)
         {
-            // 0xd9: str 8
-            // 0xda: str 16
-            // 0xdb: str 32
-            // 0xdc: array 16
-            // 0xdd: array 32
-            // 0xde: map 16
-            // 0xdf: map 32
-            return this->read_value(local_header);
+            typedef psyq::message_pack::object::extended::base_type raw_bytes;
+            local_bytes = static_cast<raw_bytes const*>(local_extended)->data();
+            out_size = static_cast<raw_bytes const*>(local_extended)->size();
         }
         else
         {
-            // [0xe0, 0xff]: negative fixnum
-            PSYQ_ASSERT(local_header <= 0xff);
-            return this->add_container_element(
-                psyq::message_pack::object(
-                    static_cast<std::int8_t>(local_header)));
+            PSYQ_ASSERT(false);
         }
+        // 自分で割り当てたメモリなので、書き換えても問題ない。
+        return static_cast<char*>(const_cast<void*>(local_bytes));
     }
+
+    /** @brief MessagePack値のヘッダのバイト数を取得する。
+
+        RAWバイト列とコンテナはバイト長や要素数まで、
+        それ以外の値は値そのものまでを、ヘッダとみなす。
+
+        @param[in] in_header MessagePack値の先頭バイト。
+        @return MessagePack値のヘッダのバイト数。
+     */
+    private: static std::size_t get_header_size(std::uint8_t const in_header)
+    PSYQ_NOEXCEPT
+    {
+        return 1 + psyq::message_pack::_private::decode_header(in_header).field_size;
+    }
+
+    //-------------------------------------------------------------------------
     /** @brief ストリームを読み込み、MessagePack値を復元する。
-        @param[in] in_header 復元するMessagePack値のヘッダ。
      */
-    private: typename this_type::read_result read_value(unsigned const in_header)
+    private: typename this_type::read_result read_value()
     {
-        switch (in_header)
+        // ストリームからMessagePack値のヘッダを読み込む。
+        psyq::message_pack::_private::header local_header;
+        if (!this->stream_.good()
+            || !psyq::message_pack::_private::read_header(
+                local_header, this->stream_))
+        {
+            return this_type::read_result_ABORT;
+        }
+
+        // MessagePack値の種類によって、復元処理を分岐する。
+        switch (local_header.kind)
         {
         // 空値
-        case psyq::message_pack::_private::format_NIL:
+        case psyq::message_pack::_private::header_kind_NIL:
             return this->add_container_element(psyq::message_pack::object());
 
         // 真偽値
-        case psyq::message_pack::_private::format_FALSE:
-            return this->add_container_element(psyq::message_pack::object(false));
-        case psyq::message_pack::_private::format_TRUE:
-            return this->add_container_element(psyq::message_pack::object(true));
+        case psyq::message_pack::_private::header_kind_BOOLEAN:
+            return this->add_container_element(
+                psyq::message_pack::object(local_header.field != 0));
 
         // 0以上の整数
-        case psyq::message_pack::_private::format_UNSIGNED_INTEGER_8:
-            return this->read_big_endian<std::uint8_t >();
-        case psyq::message_pack::_private::format_UNSIGNED_INTEGER_16:
-            return this->read_big_endian<std::uint16_t>();
-        case psyq::message_pack::_private::format_UNSIGNED_INTEGER_32:
-            return this->read_big_endian<std::uint32_t>();
-        case psyq::message_pack::_private::format_UNSIGNED_INTEGER_64:
-            return this->read_big_endian<std::uint64_t>();
-
-        // 0未満の整数
-        case psyq::message_pack::_private::foramt_NEGATIVE_INTEGER_8:
-            return this->read_big_endian<std::int8_t >();
-        case psyq::message_pack::_private::foramt_NEGATIVE_INTEGER_16:
-            return this->read_big_endian<std::int16_t>();
-        case psyq::message_pack::_private::foramt_NEGATIVE_INTEGER_32:
-            return this->read_big_endian<std::int32_t>();
-        case psyq::message_pack::_private::foramt_NEGATIVE_INTEGER_64:
-            return this->read_big_endian<std::int64_t>();
+        case psyq::message_pack::_private::header_kind_UNSIGNED_INTEGER:
+            return this->add_container_element(
+                psyq::message_pack::object(local_header.field));
+
+        // 符号つき整数
+        case psyq::message_pack::_private::header_kind_SIGNED_INTEGER:
+            return this->add_container_element(
+                psyq::message_pack::object(
+                    psyq::message_pack::_private::get_signed_integer(local_header)));
 
         // 浮動小数点数
-        case psyq::message_pack::_private::format_FLOATING_POINT_32:
-            return this->read_big_endian<psyq::message_pack::object::floating_point_32>();
-        case psyq::message_pack::_private::format_FLOATING_POINT_64:
-            return this->read_big_endian<psyq::message_pack::object::floating_point_64>();
-
-        // 文字列
-        case psyq::message_pack::_private::format_STRING_8:
-            return this->read_raw<psyq::message_pack::object::string, std::uint8_t >();
-        case psyq::message_pack::_private::format_STRING_16:
-            return this->read_raw<psyq::message_pack::object::string, std::uint16_t>();
-        case psyq::message_pack::_private::format_STRING_32:
-            return this->read_raw<psyq::message_pack::object::string, std::uint32_t>();
-
-        // バイナリ
-        case psyq::message_pack::_private::format_BINARY_8:
-            return this->read_raw<psyq::message_pack::object::binary, std::uint8_t >();
-        case psyq::message_pack::_private::format_BINARY_16:
-            return this->read_raw<psyq::message_pack::object::binary, std::uint16_t>();
-        case psyq::message_pack::_private::format_BINARY_32:
-            return this->read_raw<psyq::message_pack::object::binary, std::uint32_t>();
-
-        // 拡張バイナリ
-        case psyq::message_pack::_private::format_EXTENDED_8:
-            return this->read_raw<psyq::message_pack::object::extended, std::uint8_t >();
-        case psyq::message_pack::_private::format_EXTENDED_16:
-            return this->read_raw<psyq::message_pack::object::extended, std::uint16_t>();
-        case psyq::message_pack::_private::format_EXTENDED_32:
-            return this->read_raw<psyq::message_pack::object::extended, std::uint32_t>();
-
-        // 配列
-        case psyq::message_pack::_private::format_ARRAY_16:
-            return this->reserve_container<psyq::message_pack::object::array, std::uint16_t>();
-        case psyq::message_pack::_private::format_ARRAY_32:
-            return this->reserve_container<psyq::message_pack::object::array, std::uint32_t>();
-
-        // 連想配列
-        case psyq::message_pack::_private::format_MAP_16:
-            return this->reserve_container<psyq::message_pack::object::unordered_map, std::uint16_t>();
-        case psyq::message_pack::_private::format_MAP_32:
-            return this->reserve_container<psyq::message_pack::object::unordered_map, std::uint32_t>();
+        case psyq::message_pack::_private::header_kind_FLOATING_POINT:
+            return this->add_container_element(
+                local_header.field_size
+                == sizeof(psyq::message_pack::object::floating_point_32)?
+                    psyq::message_pack::object(
+                        psyq::message_pack::_private::get_floating_point<
+                            psyq::message_pack::object::floating_point_32>(
+                                local_header)):
+                    psyq::message_pack::object(
+                        psyq::message_pack::_private::get_floating_point<
+                            psyq::message_pack::object::floating_point_64>(
+                                local_header)));
+
+        // RAWバイト列
+        case psyq::message_pack::_private::header_kind_STRING:
+            return this->read_raw<psyq::message_pack::object::string>(
+                psyq::message_pack::_private::get_payload_size(local_header));
+        case psyq::message_pack::_private::header_kind_BINARY:
+            return this->read_raw<psyq::message_pack::object::binary>(
+                psyq::message_pack::_private::get_payload_size(local_header));
+        case psyq::message_pack::_private::header_kind_EXTENDED:
+            return this->read_raw<psyq::message_pack::object::extended>(
+                psyq::message_pack::_private::get_payload_size(local_header));
+
+        // コンテナ
+        case psyq::message_pack::_private::header_kind_ARRAY:
+            return this->reserve_container<psyq::message_pack::object::array>(
+                static_cast<std::size_t>(local_header.field));
+        case psyq::message_pack::_private::header_kind_MAP:
+            return this->reserve_container<psyq::message_pack::object::unordered_map>(
+                static_cast<std::size_t>(local_header.field));
 
         default:
             PSYQ_ASSERT(false);
@@ -547,65 +1160,20 @@ class psyq::message_pack::deserializer
     }
 
     //-------------------------------------------------------------------------
-    /** @brief ストリームを読み込み、big-endianで値を復元する。
-        @tparam template_value 復元する値の型。
-     */
-    private: template<typename template_value>
-    typename this_type::read_result read_big_endian()
-    {
-        template_value local_value;
-        return this_type::read_big_endian(local_value, this->stream_)?
-            this->add_container_element(psyq::message_pack::object(local_value)):
-            this_type::read_result_ABORT;
-    }
-    /** @brief ストリームを読み込み、big-endianで値を復元する。
-        @tparam template_value 復元する値の型。
-        @param[out] out_value     復元した値を格納する。
-        @param[in,out] io_istream 読み込むストリーム。
-     */
-    private: template<typename template_value>
-    static bool read_big_endian(
-        template_value& out_value,
-        typename this_type::stream& io_istream)
-    {
-        typedef psyq::message_pack::endianness_converter<template_value>
-            endianness_converter;
-        typename endianness_converter::bytes local_bytes;
-        auto const local_read_size(
-            psyq::message_pack::_private::read_bytes(
-                &local_bytes, io_istream, sizeof(local_bytes)));
-        if (local_read_size != sizeof(local_bytes))
-        {
-            return false;
-        }
-        out_value = endianness_converter::unpack_bytes(
-            local_bytes, psyq::message_pack::big_endian);
-        return true;
-    }
-
-    //-------------------------------------------------------------------------
-    /** @brief ストリームを読み込み、MessagePackRAWバイト列を復元する。
-        @tparam template_length MessagePackRAWバイト列のバイト長の型。
-        @tparam template_raw    MessagePackRAWバイト列の型。
-     */
-    private: template<typename template_raw, typename template_length>
-    typename this_type::read_result read_raw()
-    {
-        template_length local_size;
-        return this_type::read_big_endian(local_size, this->stream_)?
-            this->read_raw<template_raw>(local_size):
-            this_type::read_result_ABORT;
-    }
     /** @brief ストリームを読み込み、MessagePackRAWバイト列を復元する。
         @tparam template_raw MessagePackRAWバイト列の型。
-        @param[in] in_size RAWバイト列のバイト数。
+        @param[in] in_size
+            RAWバイト列のバイト数。拡張バイナリは、型を表す1バイトを含む。
      */
     private: template<typename template_raw>
-    typename this_type::read_result read_raw(std::size_t in_size)
+    typename this_type::read_result read_raw(std::size_t const in_size)
     {
-        if (std::is_same<template_raw, psyq::message_pack::object::extended>::value)
+        if (this->incremental_
+            && psyq::message_pack::_private::get_readable_size(this->stream_)
+                < in_size)
         {
-            ++in_size;
+            // RAWバイト列が断片の末尾で途切れているので、続きを後で読み込む。
+            return this->reserve_partial_raw<template_raw>(in_size);
         }
         auto const local_bytes(
             static_cast<typename template_raw::pointer>(
@@ -625,7 +1193,7 @@ class psyq::message_pack::deserializer
         @param[in]     in_size     RAWバイト列のバイト数。
         @param[in]     in_allocate メモリ割当てをするかどうか。
      */
-    private: static void* read_raw(
+    private: static void const* read_raw(
         typename this_type::stream& io_istream,
         typename this_type::pool& io_pool,
         std::size_t const in_size,
@@ -639,51 +1207,38 @@ class psyq::message_pack::deserializer
         {
             return nullptr;
         }
-        else if (in_allocate)
+        if (!in_allocate)
         {
+            // ストリームのバッファを直接参照する。
             auto const local_bytes(
-                io_pool.allocate(local_allocate_size, sizeof(char_type)));
-            if (local_bytes == nullptr)
+                psyq::message_pack::_private::borrow_bytes(
+                    io_istream, local_allocate_size));
+            if (local_bytes != nullptr || io_istream.fail())
             {
-                PSYQ_ASSERT(false);
-                return nullptr;
+                return local_bytes;
             }
-            auto const local_read_size(
-                psyq::message_pack::_private::read_bytes(
-                    local_bytes, io_istream, local_allocate_size));
-            if (local_read_size != local_allocate_size)
-            {
-                PSYQ_ASSERT(io_istream.eof());
-                //io_pool.deallocate(local_bytes, local_allocate_size);
-                return nullptr;
-            }
-            return local_bytes;
         }
-        else
+        // バッファを参照できないので、メモリ割当てをして、RAWバイト列をコピーする。
+        auto const local_bytes(
+            io_pool.allocate(local_allocate_size, sizeof(char_type)));
+        if (local_bytes == nullptr)
         {
-            /** @todo 2014.05.15 未実装。
-                メモリ割当てを行わず、
-                ストリームのバッファを参照するような処理を実装すること。
-             */
             PSYQ_ASSERT(false);
             return nullptr;
         }
+        auto const local_read_size(
+            psyq::message_pack::_private::read_bytes(
+                local_bytes, io_istream, local_allocate_size));
+        if (local_read_size != local_allocate_size)
+        {
+            PSYQ_ASSERT(io_istream.eof());
+            //io_pool.deallocate(local_bytes, local_allocate_size);
+            return nullptr;
+        }
+        return local_bytes;
     }
 
     //-------------------------------------------------------------------------
-    /** @brief MessagePackコンテナを予約し、スタックに積む。
-        @tparam template_container コンテナの型。
-        @tparam template_length    コンテナ容量の型。
-     */
-    private: template<typename template_container, typename template_length>
-    typename this_type::read_result reserve_container()
-    {
-        // コンテナ容量をストリームから読み込み、コンテナを予約する。
-        template_length local_length;
-        return this_type::read_big_endian(local_length, this->stream_)?
-            this->reserve_container<template_container>(local_length):
-            this_type::read_result_ABORT;
-    }
     /** @brief MessagePackコンテナを予約し、スタックに積む。
         @param[in] in_capacity 予約するコンテナの容量。
      */
@@ -877,10 +1432,16 @@ class psyq::message_pack::deserializer
         container_stack_;
     /// 直列化復元している途中のコンテナのスタック階層数。
     private: std::size_t stack_size_;
+    /// 断片の末尾で途切れた、MessagePack値のヘッダ。
+    private: std::array<char, 9> partial_header_;
+    /// this_type::partial_header_ に保存したバイト数。
+    private: std::size_t partial_header_size_;
     /// RAWバイト列の構築で、メモリ割当てをするかどうか。
     private: bool allocate_raw_;
     /// 連想配列の構築で、要素をソートするかどうか。
     private: bool sort_map_;
+    /// this_type::read_partial_object() で読み込んでいる途中かどうか。
+    private: bool incremental_;
 
 }; // class psyq::message_pack::deserializer
 
@@ -226,6 +226,21 @@ struct psyq::message_pack::endianness_converter
         return true;
     }
 
+    /** @brief 値からRAWバイト列へ直列化し、メモリ領域へ書き込む。
+        @param[out] out_bytes     RAWバイト列を書き込むメモリ領域の先頭位置。
+        @param[in]  in_value      直列化する値。
+        @param[in]  in_endianness 値を直列化する際のエンディアン性。
+     */
+    public: static void store_bytes(
+        void* const out_bytes,
+        template_value const in_value,
+        psyq::message_pack::endianness const in_endianness)
+    PSYQ_NOEXCEPT
+    {
+        auto const local_bytes(this_type::pack_bytes(in_value, in_endianness));
+        std::memcpy(out_bytes, &local_bytes, sizeof(template_value));
+    }
+
     //---------------------------------------------------------------------
     /** @brief 値をRAWバイト列に変換する。
         @param[in] in_value      変換する値。
@@ -0,0 +1,275 @@
+﻿/** @file
+    @author Hillco Psychi (https://twitter.com/psychi)
+    @brief @copybrief psyq::message_pack::map_index
+ */
+#ifndef PSYQ_MESSAGE_PACK_MAP_INDEX_HPP_
+#define PSYQ_MESSAGE_PACK_MAP_INDEX_HPP_
+
+#include <cstring>
+//#include "psyq/hash/fnv.hpp"
+//#include "psyq/message_pack/object.hpp"
+
+namespace psyq
+{
+    namespace message_pack
+    {
+        /// @cond
+        template<
+            typename,
+            typename = psyq::hash::_private::array_fnv1a_32>
+                class map_index;
+        /// @endcond
+    } // namespace message_pack
+} // namespace psyq
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/** @brief MessagePack連想配列を、キーのハッシュ値で検索する索引。
+
+    psyq::message_pack::object::map::find() は、事前に
+    psyq::message_pack::object::sort_map() でソートしておく必要があり、
+    検索は二分探索になる。
+    map_index は、最初の検索時に要素番号のハッシュ表をメモリ割当子に構築し、
+    以後はソートせずに平均O(1)で検索する。
+    同じ連想配列をキーで何度も検索する場合に使う。
+
+    ハッシュ表は開番地法で、要素番号に1を足した値を格納する。
+    浮動小数点数やコンテナのキーは等値比較に許容誤差や要素の比較があるので、
+    型だけからハッシュ値を決める。
+
+    使用例
+    @code
+    // 直列化復元した連想配列を、ソートせずにキーで何度も検索する。
+    void find_values(
+        psyq::message_pack::deserializer<std::istringstream>::root_object& io_root)
+    {
+        auto const local_map(io_root.get_unordered_map());
+        if (local_map != nullptr)
+        {
+            psyq::message_pack::map_index<psyq::message_pack::pool<>>
+                local_index(*local_map, io_root.get_pool());
+            auto const local_found(
+                local_index.find(psyq::message_pack::object::make_string("id")));
+            if (local_found != local_map->end())
+            {
+                // local_found->second が "id" の値。
+            }
+        }
+    }
+    @endcode
+
+    @tparam template_pool   @copydoc psyq::message_pack::map_index::pool
+    @tparam template_hasher @copydoc psyq::message_pack::map_index::hasher
+ */
+template<typename template_pool, typename template_hasher>
+class psyq::message_pack::map_index
+{
+    /// thisが指す値の型。
+    private: typedef map_index this_type;
+
+    //-------------------------------------------------------------------------
+    /// ハッシュ表を構築する、 psyq::message_pack::pool 互換のメモリ割当子。
+    public: typedef template_pool pool;
+    /** @brief RAWバイト列のハッシュ値を算出する、
+               psyq::hash::_private::array_fnv1a_32 互換の関数オブジェクト。
+     */
+    public: typedef template_hasher hasher;
+    /// 索引をつける連想配列。ソート済みの連想配列も使える。
+    public: typedef psyq::message_pack::object::unordered_map map;
+
+    //-------------------------------------------------------------------------
+    /// @name 構築
+    //@{
+    /** @brief 連想配列の索引を構築する。
+
+        ハッシュ表は最初の検索時に構築するので、ここではメモリ割当てをしない。
+
+        @param[in]     in_map    索引をつける連想配列。
+        @param[in,out] io_pool   ハッシュ表の構築に使うメモリ割当子。
+                                 索引を使い終わるまで破棄しないこと。
+        @param[in]     in_hasher ハッシュ関数オブジェクトの初期値。
+     */
+    public: map_index(
+        typename this_type::map const& in_map,
+        typename this_type::pool& io_pool,
+        typename this_type::hasher in_hasher =
+            typename this_type::hasher(typename template_hasher::hasher()))
+    :
+        map_(in_map),
+        pool_(&io_pool),
+        hasher_(std::move(in_hasher)),
+        slots_(nullptr),
+        slot_mask_(0)
+    {}
+    //@}
+    //-------------------------------------------------------------------------
+    /// @name 検索
+    //@{
+    /** @brief 索引をつけた連想配列を取得する。
+        @return 索引をつけた連想配列。
+     */
+    public: typename this_type::map const& get_map() const PSYQ_NOEXCEPT
+    {
+        return this->map_;
+    }
+
+    /** @brief ハッシュ表を構築済みか判定する。
+        @retval true  構築済み。
+        @retval false 未構築。
+     */
+    public: bool is_built() const PSYQ_NOEXCEPT
+    {
+        return this->slots_ != nullptr;
+    }
+
+    /** @brief std::unordered_multimap::find() 相当の関数。
+
+        ハッシュ表が未構築なら構築する。
+        ハッシュ表の構築に失敗した場合は、線形探索する。
+
+        @param[in] in_key 検索するキー。
+        @return
+            キーが等値な要素のうち、最も先頭にある要素を指す反復子。
+            見つからなかったら this_type::get_map().end()。
+     */
+    public: typename this_type::map::const_iterator find(
+        typename this_type::map::value_type::first_type const& in_key)
+    {
+        auto const local_begin(this->map_.begin());
+        auto const local_end(this->map_.end());
+        if (!this->build())
+        {
+            return std::find_if(
+                local_begin,
+                local_end,
+                [&in_key](typename this_type::map::value_type const& in_element)
+                {
+                    return in_element.first == in_key;
+                });
+        }
+        for (
+            auto i(this->make_hash(in_key) & this->slot_mask_);
+            this->slots_[i] != 0;
+            i = (i + 1) & this->slot_mask_)
+        {
+            auto const local_element(local_begin + this->slots_[i] - 1);
+            if (local_element->first == in_key)
+            {
+                return local_element;
+            }
+        }
+        return local_end;
+    }
+
+    /** @brief ハッシュ表を構築する。
+
+        構築済みなら何もしない。
+
+        @retval true  構築済み。
+        @retval false メモリ割当てに失敗した。
+     */
+    public: bool build()
+    {
+        if (this->is_built())
+        {
+            return true;
+        }
+
+        // 要素数の2倍以上の、2のべき乗をハッシュ表の大きさにする。
+        std::size_t local_slot_count(2);
+        while (local_slot_count < this->map_.size() * 2)
+        {
+            local_slot_count <<= 1;
+        }
+        auto const local_slots(
+            static_cast<std::uint32_t*>(
+                this->pool_->allocate(
+                    local_slot_count * sizeof(std::uint32_t),
+                    sizeof(std::uint32_t))));
+        if (local_slots == nullptr)
+        {
+            PSYQ_ASSERT(false);
+            return false;
+        }
+        std::memset(local_slots, 0, local_slot_count * sizeof(std::uint32_t));
+
+        // 先頭の要素から順に登録するので、等値なキーは先頭の要素が先に見つかる。
+        auto const local_slot_mask(local_slot_count - 1);
+        for (std::uint32_t i(0); i < this->map_.size(); ++i)
+        {
+            auto j(this->make_hash(this->map_[i].first) & local_slot_mask);
+            while (local_slots[j] != 0)
+            {
+                j = (j + 1) & local_slot_mask;
+            }
+            local_slots[j] = i + 1;
+        }
+        this->slots_ = local_slots;
+        this->slot_mask_ = local_slot_mask;
+        return true;
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /** @brief MessagePackオブジェクトのハッシュ値を算出する。
+
+        等値なMessagePackオブジェクトは、同じハッシュ値になる。
+
+        @param[in] in_key ハッシュ値を算出するMessagePackオブジェクト。
+        @return ハッシュ値。
+     */
+    private: std::size_t make_hash(psyq::message_pack::object const& in_key) const
+    {
+        typedef psyq::message_pack::object::type type;
+        auto local_type(in_key.get_type());
+        std::size_t local_hash(0);
+        switch (local_type)
+        {
+        case type::BOOLEAN:
+            local_hash = *in_key.get_boolean();
+            break;
+        case type::UNSIGNED_INTEGER:
+            local_hash = this->hasher_(in_key.get_unsigned_integer(), 1);
+            break;
+        case type::NEGATIVE_INTEGER:
+            local_hash = this->hasher_(in_key.get_negative_integer(), 1);
+            break;
+        case type::STRING:
+            local_hash = this->hasher_(
+                in_key.get_string()->data(), in_key.get_string()->size());
+            break;
+        case type::BINARY:
+            local_hash = this->hasher_(
+                in_key.get_binary()->data(), in_key.get_binary()->size());
+            break;
+        case type::EXTENDED:
+        {
+            typedef psyq::message_pack::object::extended::base_type raw_bytes;
+            auto const& local_extended(
+                static_cast<raw_bytes const&>(*in_key.get_extended()));
+            local_hash = this->hasher_(
+                local_extended.data(), local_extended.size());
+            break;
+        }
+        case type::MAP:
+            local_type = type::UNORDERED_MAP;
+            break;
+        default:
+            break;
+        }
+        return local_hash ^ (static_cast<std::size_t>(local_type) * 0x9e3779b9u);
+    }
+
+    //-------------------------------------------------------------------------
+    /// 索引をつけた連想配列。
+    private: typename this_type::map map_;
+    /// ハッシュ表の構築に使うメモリ割当子。
+    private: typename this_type::pool* pool_;
+    /// @copydoc hasher
+    private: typename this_type::hasher hasher_;
+    /// 連想配列の要素番号に1を足した値を格納するハッシュ表。
+    private: std::uint32_t* slots_;
+    /// ハッシュ表の大きさから1を引いた値。
+    private: std::size_t slot_mask_;
+
+}; // class psyq::message_pack::map_index
+
+#endif // !defined(PSYQ_MESSAGE_PACK_MAP_INDEX_HPP_)
@@ -0,0 +1,303 @@
+﻿/** @file
+    @author Hillco Psychi (https://twitter.com/psychi)
+    @brief @copybrief psyq::message_pack::memory_istream
+ */
+#ifndef PSYQ_MESSAGE_PACK_MEMORY_ISTREAM_HPP_
+#define PSYQ_MESSAGE_PACK_MEMORY_ISTREAM_HPP_
+
+#include <cstring>
+#include <ios>
+#include <string>
+
+namespace psyq
+{
+    namespace message_pack
+    {
+        /// @cond
+        class memory_istream;
+        /// @endcond
+
+        /// この名前空間をユーザーが直接アクセスするのは禁止。
+        namespace _private
+        {
+            inline std::size_t read_bytes(
+                void* const,
+                psyq::message_pack::memory_istream&,
+                std::size_t const);
+            inline void const* borrow_bytes(
+                psyq::message_pack::memory_istream&, std::size_t const);
+            inline std::size_t get_readable_size(
+                psyq::message_pack::memory_istream const&);
+        } // namespace _private
+    } // namespace message_pack
+} // namespace psyq
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/** @brief 連続したメモリ領域を読み込む、 std::basic_istream 互換の入力ストリーム。
+
+    psyq::message_pack::deserializer が使う関数だけを実装している。
+    メモリ領域をポインタで直接走査するので、 std::istringstream
+    を使うよりも高速に直列化復元できる。
+    読み込むメモリ領域は、 memory_istream を破棄するまで変更しないこと。
+
+    使用例
+    @code
+    // メモリ領域を直列化復元する関数。
+    psyq::message_pack::deserializer<psyq::message_pack::memory_istream>::root_object
+    read_message_pack(char const* const in_data, std::size_t const in_size)
+    {
+        typedef psyq::message_pack::deserializer<psyq::message_pack::memory_istream>
+            memory_deserializer;
+        memory_deserializer local_deserializer(
+            psyq::message_pack::memory_istream(in_data, in_size),
+            memory_deserializer::pool());
+        memory_deserializer::root_object local_root_object;
+        local_deserializer >> local_root_object;
+        return local_root_object;
+    }
+    @endcode
+ */
+class psyq::message_pack::memory_istream
+{
+    /// thisが指す値の型。
+    private: typedef memory_istream this_type;
+
+    friend std::size_t psyq::message_pack::_private::read_bytes(
+        void* const, this_type&, std::size_t const);
+    friend void const* psyq::message_pack::_private::borrow_bytes(
+        this_type&, std::size_t const);
+
+    //-------------------------------------------------------------------------
+    /// 読み込む文字の型。
+    public: typedef char char_type;
+    /// std::char_traits 互換の文字特性。
+    public: typedef std::char_traits<char> traits_type;
+    /// 読み込む文字を表す整数の型。
+    public: typedef traits_type::int_type int_type;
+    /// ストリームの読み込み位置の型。
+    public: typedef std::streamoff pos_type;
+    /// ストリームの読み込み位置の差の型。
+    public: typedef std::streamoff off_type;
+
+    //-------------------------------------------------------------------------
+    /// @name 構築
+    //@{
+    /// 空のストリームを構築する。
+    public: memory_istream() PSYQ_NOEXCEPT:
+        begin_(nullptr),
+        end_(nullptr),
+        current_(nullptr),
+        state_(std::ios_base::goodbit)
+    {}
+
+    /** @brief メモリ領域を読み込むストリームを構築する。
+        @param[in] in_data 読み込むメモリ領域の先頭位置。
+        @param[in] in_size 読み込むメモリ領域のバイト数。
+     */
+    public: memory_istream(void const* const in_data, std::size_t const in_size)
+    PSYQ_NOEXCEPT:
+        begin_(static_cast<char_type const*>(in_data)),
+        end_(static_cast<char_type const*>(in_data) + in_size),
+        current_(static_cast<char_type const*>(in_data)),
+        state_(std::ios_base::goodbit)
+    {}
+
+    /** @brief 値を交換する。
+        @param[in,out] io_target 交換するインスタンス。
+     */
+    public: void swap(this_type& io_target) PSYQ_NOEXCEPT
+    {
+        std::swap(this->begin_, io_target.begin_);
+        std::swap(this->end_, io_target.end_);
+        std::swap(this->current_, io_target.current_);
+        std::swap(this->state_, io_target.state_);
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /// @name 状態
+    //@{
+    /// @copydoc std::basic_ios::good
+    public: bool good() const PSYQ_NOEXCEPT
+    {
+        return this->state_ == std::ios_base::goodbit;
+    }
+
+    /// @copydoc std::basic_ios::eof
+    public: bool eof() const PSYQ_NOEXCEPT
+    {
+        return (this->state_ & std::ios_base::eofbit) != 0;
+    }
+
+    /// @copydoc std::basic_ios::fail
+    public: bool fail() const PSYQ_NOEXCEPT
+    {
+        return (this->state_
+            & (std::ios_base::failbit | std::ios_base::badbit)) != 0;
+    }
+
+    /// @copydoc std::basic_ios::rdstate
+    public: std::ios_base::iostate rdstate() const PSYQ_NOEXCEPT
+    {
+        return this->state_;
+    }
+
+    /// @copydoc std::basic_ios::clear
+    public: void clear(
+        std::ios_base::iostate const in_state = std::ios_base::goodbit)
+    PSYQ_NOEXCEPT
+    {
+        this->state_ = in_state;
+    }
+
+    /** @brief 読み込んでいないバイト数を取得する。
+        @return 読み込んでいないバイト数。
+     */
+    public: std::size_t get_rest_size() const PSYQ_NOEXCEPT
+    {
+        return this->end_ - this->current_;
+    }
+
+    /** @brief 読み込み位置を取得する。
+        @return 読み込み位置のポインタ。
+     */
+    public: char_type const* get_current() const PSYQ_NOEXCEPT
+    {
+        return this->current_;
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /// @name 読み込み
+    //@{
+    /// @copydoc std::basic_istream::get
+    public: int_type get() PSYQ_NOEXCEPT
+    {
+        if (this->current_ < this->end_)
+        {
+            auto const local_char(*this->current_);
+            ++this->current_;
+            return traits_type::to_int_type(local_char);
+        }
+        this->state_ |= std::ios_base::eofbit | std::ios_base::failbit;
+        return traits_type::eof();
+    }
+
+    /// @copydoc std::basic_istream::read
+    public: this_type& read(char_type* const out_data, std::streamsize const in_size)
+    PSYQ_NOEXCEPT
+    {
+        auto const local_size(
+            psyq::message_pack::_private::read_bytes(
+                out_data, *this, static_cast<std::size_t>(in_size)));
+        static_cast<void>(local_size);
+        return *this;
+    }
+
+    /// @copydoc std::basic_istream::tellg
+    public: pos_type tellg() const PSYQ_NOEXCEPT
+    {
+        return this->fail()? -1: this->current_ - this->begin_;
+    }
+
+    /// @copydoc std::basic_istream::seekg
+    public: this_type& seekg(pos_type const in_position) PSYQ_NOEXCEPT
+    {
+        this->state_ &= ~std::ios_base::eofbit;
+        if (!this->fail())
+        {
+            if (0 <= in_position && in_position <= this->end_ - this->begin_)
+            {
+                this->current_ = this->begin_ + in_position;
+            }
+            else
+            {
+                this->state_ |= std::ios_base::failbit;
+            }
+        }
+        return *this;
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /// 読み込むメモリ領域の先頭位置。
+    private: char_type const* begin_;
+    /// 読み込むメモリ領域の末尾位置。
+    private: char_type const* end_;
+    /// 次に読み込む位置。
+    private: char_type const* current_;
+    /// ストリームの状態。
+    private: std::ios_base::iostate state_;
+
+}; // class psyq::message_pack::memory_istream
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/** @brief メモリ領域からRAWバイト列を読み込む。
+
+    std::basic_istream 版と同じ結果になるよう、
+    読み込めるバイト数が足りない場合は末尾まで読み進めて失敗状態にする。
+
+    @param[out]    out_bytes    読み込んだRAWバイト列を格納する。
+    @param[in,out] io_istream   読み込むストリーム。
+    @param[in]     in_read_size 読み込むバイト数。
+    @return 読み込んだバイト数。
+ */
+inline std::size_t psyq::message_pack::_private::read_bytes(
+    void* const out_bytes,
+    psyq::message_pack::memory_istream& io_istream,
+    std::size_t const in_read_size)
+{
+    if (io_istream.fail())
+    {
+        return 0;
+    }
+    auto const local_rest_size(io_istream.get_rest_size());
+    if (local_rest_size < in_read_size)
+    {
+        std::memcpy(out_bytes, io_istream.current_, local_rest_size);
+        io_istream.current_ = io_istream.end_;
+        io_istream.state_ |= std::ios_base::eofbit | std::ios_base::failbit;
+        return 0;
+    }
+    std::memcpy(out_bytes, io_istream.current_, in_read_size);
+    io_istream.current_ += in_read_size;
+    return in_read_size;
+}
+
+/** @brief メモリ領域にあるRAWバイト列を、コピーせずに参照する。
+
+    psyq::message_pack::deserializer::set_allocate_raw() でfalseを設定すると、
+    RAWバイト列の直列化復元でこの関数が使われる。
+
+    @param[in,out] io_istream   読み込むストリーム。
+    @param[in]     in_read_size 読み込むバイト数。
+    @retval !=nullptr メモリ領域にあるRAWバイト列の先頭位置。
+    @retval ==nullptr 読み込めるバイト数が足りなかった。
+ */
+inline void const* psyq::message_pack::_private::borrow_bytes(
+    psyq::message_pack::memory_istream& io_istream,
+    std::size_t const in_read_size)
+{
+    if (io_istream.fail())
+    {
+        return nullptr;
+    }
+    if (io_istream.get_rest_size() < in_read_size)
+    {
+        io_istream.current_ = io_istream.end_;
+        io_istream.state_ |= std::ios_base::eofbit | std::ios_base::failbit;
+        return nullptr;
+    }
+    auto const local_bytes(io_istream.current_);
+    io_istream.current_ += in_read_size;
+    return local_bytes;
+}
+
+/** @brief メモリ領域からすぐに読み込めるバイト数を取得する。
+    @param[in] in_istream 読み込むストリーム。
+    @return すぐに読み込めるバイト数。
+ */
+inline std::size_t psyq::message_pack::_private::get_readable_size(
+    psyq::message_pack::memory_istream const& in_istream)
+{
+    return in_istream.fail()? 0: in_istream.get_rest_size();
+}
+
+#endif // !defined(PSYQ_MESSAGE_PACK_MEMORY_ISTREAM_HPP_)
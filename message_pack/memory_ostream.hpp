@@ -0,0 +1,436 @@
+﻿/** @file
+    @author Hillco Psychi (https://twitter.com/psychi)
+    @brief @copybrief psyq::message_pack::memory_ostream
+ */
+#ifndef PSYQ_MESSAGE_PACK_MEMORY_OSTREAM_HPP_
+#define PSYQ_MESSAGE_PACK_MEMORY_OSTREAM_HPP_
+
+#include <cstring>
+#include <ios>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace psyq
+{
+    namespace message_pack
+    {
+        /// @cond
+        template<typename = std::allocator<char>> class memory_ostream;
+        /// @endcond
+    } // namespace message_pack
+} // namespace psyq
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/** @brief 連続したメモリ領域へ書き込む、 std::basic_ostream 互換の出力ストリーム。
+
+    psyq::message_pack::serializer が使う関数だけを実装している。
+    メモリ領域へポインタで直接書き込むので、 std::ostringstream
+    を使うよりも高速に直列化できる。
+
+    書き込み先のメモリ領域は、以下のどちらかを構築時に選ぶ。
+    - メモリ割当子で確保し、書き込むにしたがって拡張するメモリ領域。
+    - 呼び出し元が用意した、容量が固定のメモリ領域。
+      容量が足りなくなると、書き込みに失敗する。
+
+    書き込んだバイト列は this_type::flush_to() で、
+    まとめて別の出力ストリームへ書き出せる。
+    ファイル記述子へ書き出すなら、 this_type::data() と this_type::size()
+    を使って、まとめて書き出すこと。
+
+    使用例
+    @code
+    // MessagePackを直列化して、ファイルへまとめて書き出す。
+    void write_message_pack(std::ofstream& io_file)
+    {
+        psyq::message_pack::serializer<psyq::message_pack::memory_ostream<>>
+            local_serializer(psyq::message_pack::memory_ostream<>(4096));
+        local_serializer << std::make_tuple(1, 2.0f, std::string("3"));
+        local_serializer.get_stream().flush_to(io_file);
+    }
+    @endcode
+
+    @tparam template_allocator @copydoc psyq::message_pack::memory_ostream::allocator_type
+ */
+template<typename template_allocator>
+class psyq::message_pack::memory_ostream
+{
+    /// thisが指す値の型。
+    private: typedef memory_ostream this_type;
+
+    //-------------------------------------------------------------------------
+    /// 書き込む文字の型。
+    public: typedef char char_type;
+    /// std::char_traits 互換の文字特性。
+    public: typedef std::char_traits<char> traits_type;
+    /// 書き込む文字を表す整数の型。
+    public: typedef traits_type::int_type int_type;
+    /// ストリームの書き込み位置の型。
+    public: typedef std::streamoff pos_type;
+    /// ストリームの書き込み位置の差の型。
+    public: typedef std::streamoff off_type;
+    /// 拡張するメモリ領域の確保に使う、 std::allocator 互換のメモリ割当子。
+    public: typedef template_allocator allocator_type;
+    static_assert(
+        std::is_same<typename allocator_type::value_type, char_type>::value,
+        "allocator_type::value_type is not char_type.");
+
+    //-------------------------------------------------------------------------
+    /// @name 構築
+    //@{
+    /** @brief 拡張するメモリ領域へ書き込むストリームを構築する。
+        @param[in] in_reserve_size 最初に確保するメモリ領域のバイト数。
+        @param[in] in_allocator    メモリ割当子の初期値。
+     */
+    public: explicit memory_ostream(
+        std::size_t const in_reserve_size = 0,
+        allocator_type const& in_allocator = allocator_type())
+    :
+        allocator_(in_allocator),
+        begin_(
+            0 < in_reserve_size?
+                allocator_.allocate(in_reserve_size): nullptr),
+        end_(begin_ + in_reserve_size),
+        current_(begin_),
+        state_(std::ios_base::goodbit),
+        extendable_(true)
+    {}
+
+    /** @brief 容量が固定のメモリ領域へ書き込むストリームを構築する。
+
+        書き込み先のメモリ領域は、ストリームを破棄するまで解放しないこと。
+
+        @param[in] in_data     書き込むメモリ領域の先頭位置。
+        @param[in] in_capacity 書き込むメモリ領域のバイト数。
+     */
+    public: memory_ostream(void* const in_data, std::size_t const in_capacity)
+    :
+        allocator_(allocator_type()),
+        begin_(static_cast<char_type*>(in_data)),
+        end_(static_cast<char_type*>(in_data) + in_capacity),
+        current_(static_cast<char_type*>(in_data)),
+        state_(std::ios_base::goodbit),
+        extendable_(false)
+    {
+        PSYQ_ASSERT(in_data != nullptr || in_capacity == 0);
+    }
+
+    /** @brief ムーブ構築子。
+        @param[in,out] io_source ムーブ元インスタンス。
+     */
+    public: memory_ostream(this_type&& io_source):
+        allocator_(std::move(io_source.allocator_)),
+        begin_(io_source.begin_),
+        end_(io_source.end_),
+        current_(io_source.current_),
+        state_(io_source.state_),
+        extendable_(io_source.extendable_)
+    {
+        io_source.begin_ = nullptr;
+        io_source.end_ = nullptr;
+        io_source.current_ = nullptr;
+    }
+
+    /// @brief 拡張できるメモリ領域を解放する。
+    public: ~memory_ostream()
+    {
+        this->deallocate_buffer();
+    }
+
+    /** @brief ムーブ代入演算子。
+        @param[in,out] io_source ムーブ元インスタンス。
+        @return *this
+     */
+    public: this_type& operator=(this_type&& io_source)
+    {
+        if (this != &io_source)
+        {
+            this_type(std::move(io_source)).swap(*this);
+        }
+        return *this;
+    }
+
+    /** @brief 値を交換する。
+        @param[in,out] io_target 交換するインスタンス。
+     */
+    public: void swap(this_type& io_target) PSYQ_NOEXCEPT
+    {
+        std::swap(this->allocator_, io_target.allocator_);
+        std::swap(this->begin_, io_target.begin_);
+        std::swap(this->end_, io_target.end_);
+        std::swap(this->current_, io_target.current_);
+        std::swap(this->state_, io_target.state_);
+        std::swap(this->extendable_, io_target.extendable_);
+    }
+    //@}
+    /// コピー構築子は使用禁止。
+    private: memory_ostream(this_type const&);// = delete;
+    /// コピー代入演算子は使用禁止。
+    private: this_type& operator=(this_type const&);// = delete;
+
+    //-------------------------------------------------------------------------
+    /// @name 状態
+    //@{
+    /// @copydoc std::basic_ios::good
+    public: bool good() const PSYQ_NOEXCEPT
+    {
+        return this->state_ == std::ios_base::goodbit;
+    }
+
+    /// @copydoc std::basic_ios::fail
+    public: bool fail() const PSYQ_NOEXCEPT
+    {
+        return (this->state_
+            & (std::ios_base::failbit | std::ios_base::badbit)) != 0;
+    }
+
+    /// @copydoc std::basic_ios::rdstate
+    public: std::ios_base::iostate rdstate() const PSYQ_NOEXCEPT
+    {
+        return this->state_;
+    }
+
+    /// @copydoc std::basic_ios::clear
+    public: void clear(
+        std::ios_base::iostate const in_state = std::ios_base::goodbit)
+    PSYQ_NOEXCEPT
+    {
+        this->state_ = in_state;
+    }
+
+    /** @brief 書き込んだバイト列の先頭位置を取得する。
+        @return 書き込んだバイト列の先頭位置。
+     */
+    public: char_type const* data() const PSYQ_NOEXCEPT
+    {
+        return this->begin_;
+    }
+
+    /** @brief 書き込んだバイト数を取得する。
+        @return 書き込んだバイト数。
+     */
+    public: std::size_t size() const PSYQ_NOEXCEPT
+    {
+        return this->current_ - this->begin_;
+    }
+
+    /** @brief 再確保せずに書き込めるバイト数の上限を取得する。
+        @return 再確保せずに書き込めるバイト数の上限。
+     */
+    public: std::size_t get_capacity() const PSYQ_NOEXCEPT
+    {
+        return this->end_ - this->begin_;
+    }
+
+    /** @brief 書き込むメモリ領域を拡張できるか判定する。
+        @retval true  拡張できる。
+        @retval false 呼び出し元が用意した、容量が固定のメモリ領域。
+     */
+    public: bool is_extendable() const PSYQ_NOEXCEPT
+    {
+        return this->extendable_;
+    }
+
+    /** @brief 書き込んだバイト列を文字列として取得する。
+        @return 書き込んだバイト列をコピーした文字列。
+     */
+    public: std::string str() const
+    {
+        return std::string(this->begin_, this->current_);
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /// @name 書き込み
+    //@{
+    /// @copydoc std::basic_ostream::put
+    public: this_type& put(char_type const in_char)
+    {
+        if (this->current_ < this->end_? !this->fail(): this->extend(1))
+        {
+            *this->current_ = in_char;
+            ++this->current_;
+        }
+        return *this;
+    }
+
+    /// @copydoc std::basic_ostream::write
+    public: this_type& write(
+        char_type const* const in_data,
+        std::streamsize const in_size)
+    {
+        auto const local_size(static_cast<std::size_t>(in_size));
+        if (local_size <= static_cast<std::size_t>(this->end_ - this->current_)?
+                !this->fail(): this->extend(local_size))
+        {
+            std::memcpy(this->current_, in_data, local_size);
+            this->current_ += local_size;
+        }
+        return *this;
+    }
+
+    /** @brief 書き込み位置を進め、書き込む領域を取得する。
+
+        呼び出し元は、戻り値が指す領域へ in_size バイトを直接書き込むこと。
+        psyq::message_pack::serializer が、数値をストリームへ書き込むときに使う。
+
+        @param[in] in_size 書き込むバイト数。
+        @return
+            書き込む領域の先頭位置。
+            書き込めなかった場合は nullptr を返し、ストリームを失敗状態にする。
+     */
+    public: char_type* advance(std::size_t const in_size)
+    {
+        if (in_size <= static_cast<std::size_t>(this->end_ - this->current_)?
+                this->fail(): !this->extend(in_size))
+        {
+            return nullptr;
+        }
+        auto const local_position(this->current_);
+        this->current_ += in_size;
+        return local_position;
+    }
+
+    /// @copydoc std::basic_ostream::tellp
+    public: pos_type tellp() const PSYQ_NOEXCEPT
+    {
+        return this->fail()? -1: this->current_ - this->begin_;
+    }
+
+    /** @brief 書き込み位置を変更する。
+
+        書き込み位置より後ろにあるバイト列は破棄される。
+
+        @param[in] in_position 新たな書き込み位置。
+        @return *this
+     */
+    public: this_type& seekp(pos_type const in_position) PSYQ_NOEXCEPT
+    {
+        if (!this->fail())
+        {
+            if (0 <= in_position && in_position <= this->current_ - this->begin_)
+            {
+                this->current_ = this->begin_ + in_position;
+            }
+            else
+            {
+                this->state_ |= std::ios_base::failbit;
+            }
+        }
+        return *this;
+    }
+
+    /// @copydoc std::basic_ostream::flush
+    public: this_type& flush() PSYQ_NOEXCEPT
+    {
+        return *this;
+    }
+
+    /** @brief 書き込んだバイト列を、別の出力ストリームへまとめて書き出す。
+
+        書き出しに成功すると、書き込んだバイト列を空にする。
+        メモリ領域は解放しないので、続けて書き込んでも再確保しない。
+
+        @param[in,out] io_ostream 書き出す std::basic_ostream 互換のストリーム。
+        @retval true  成功。
+        @retval false 失敗。
+     */
+    public: template<typename template_ostream>
+    bool flush_to(template_ostream& io_ostream)
+    {
+        if (this->fail())
+        {
+            return false;
+        }
+        if (this->begin_ < this->current_)
+        {
+            typedef typename template_ostream::char_type ostream_char_type;
+            static_assert(sizeof(ostream_char_type) == 1, "");
+            io_ostream.write(
+                reinterpret_cast<ostream_char_type const*>(this->begin_),
+                this->current_ - this->begin_);
+            if (io_ostream.fail())
+            {
+                return false;
+            }
+            this->current_ = this->begin_;
+        }
+        return true;
+    }
+
+    /** @brief 書き込んだバイト列を空にする。
+
+        メモリ領域は解放しない。
+     */
+    public: void rewind() PSYQ_NOEXCEPT
+    {
+        this->current_ = this->begin_;
+        this->state_ = std::ios_base::goodbit;
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /** @brief 書き込むメモリ領域を拡張する。
+        @param[in] in_write_size これから書き込むバイト数。
+        @retval true  成功。
+        @retval false 失敗。ストリームを失敗状態にした。
+     */
+    private: bool extend(std::size_t const in_write_size)
+    {
+        if (this->fail())
+        {
+            return false;
+        }
+        if (!this->extendable_)
+        {
+            this->state_ |= std::ios_base::badbit;
+            return false;
+        }
+        auto const local_size(this->size());
+        auto local_capacity(this->get_capacity() * 2);
+        if (local_capacity < local_size + in_write_size)
+        {
+            local_capacity = local_size + in_write_size;
+        }
+        if (local_capacity < 256)
+        {
+            local_capacity = 256;
+        }
+        // 書き込んだバイト列だけをコピーし、残りの領域は初期化しない。
+        auto const local_buffer(this->allocator_.allocate(local_capacity));
+        if (0 < local_size)
+        {
+            std::memcpy(local_buffer, this->begin_, local_size);
+        }
+        this->deallocate_buffer();
+        this->begin_ = local_buffer;
+        this->end_ = local_buffer + local_capacity;
+        this->current_ = local_buffer + local_size;
+        return true;
+    }
+
+    /// @brief 拡張できるメモリ領域を解放する。
+    private: void deallocate_buffer()
+    {
+        if (this->extendable_ && this->begin_ != nullptr)
+        {
+            this->allocator_.deallocate(
+                this->begin_, this->end_ - this->begin_);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /// 拡張できるメモリ領域の確保に使うメモリ割当子。
+    private: allocator_type allocator_;
+    /// 書き込むメモリ領域の先頭位置。
+    private: char_type* begin_;
+    /// 書き込むメモリ領域の末尾位置。
+    private: char_type* end_;
+    /// 次に書き込む位置。
+    private: char_type* current_;
+    /// ストリームの状態。
+    private: std::ios_base::iostate state_;
+    /// 書き込むメモリ領域を拡張できるかどうか。
+    private: bool extendable_;
+
+}; // class psyq::message_pack::memory_ostream
+
+#endif // !defined(PSYQ_MESSAGE_PACK_MEMORY_OSTREAM_HPP_)
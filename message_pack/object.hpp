@@ -638,6 +638,18 @@ class psyq::message_pack::object::root: public psyq::message_pack::object
     {
         return this->pool_;
     }
+
+    /** @brief 下位オブジェクトを保持するメモリ割当子を取得する。
+
+        psyq::message_pack::map_index のように、
+        下位オブジェクトと同じ寿命のメモリを割り当てるときに使う。
+
+        @return 下位オブジェクトを保持するメモリ割当子。
+     */
+    public: typename this_type::pool& get_pool()
+    {
+        return this->pool_;
+    }
     //@}
     //-------------------------------------------------------------------------
     private: typename this_type::pool pool_; ///< @copydoc pool
@@ -5,6 +5,7 @@
 #ifndef PSYQ_MESSAGE_PACK_POOL_HPP_
 #define PSYQ_MESSAGE_PACK_POOL_HPP_
 
+#include <array>
 //#include "psyq/message_pack/object.hpp"
 
 /// psyq::message_pack::pool のチャンク容量のデフォルト値。
@@ -23,6 +24,7 @@ namespace psyq
     {
         /// @cond
         template<typename = std::allocator<long long>> class pool;
+        template<typename = psyq::message_pack::pool<>> class pool_reference;
         /// @endcond
     } // namespace message_pack
 } // namespace psyq
@@ -47,13 +49,31 @@ class psyq::message_pack::pool
         std::size_t free_size;    ///< 未使用メモリのバイト数。
     };
 
+    /// @brief this_type::get_statistics() で取得する、メモリプールの使用状況。
+    public: struct statistics
+    {
+        std::size_t chunk_count;   ///< 確保したチャンクの数。
+        std::size_t capacity;      ///< 全チャンク容量のバイト数の合計。
+        std::size_t free_size;     ///< 全チャンクの未使用メモリのバイト数の合計。
+        std::size_t max_free_size; ///< チャンク1つあたりの未使用メモリの最大バイト数。
+    };
+
     private: enum: std::size_t
     {
         value_size = sizeof(typename this_type::allocator_type::value_type),
         header_size = sizeof(typename this_type::chunk_header),
         header_alignment = sizeof(void*),
+        /// 最初の分類の上限となる、2の冪のビット数。
+        bin_shift = 4,
+        /// 空き領域を分類する数。最後の分類には、上限がない。
+        bin_count = 20,
     };
 
+    /// 空き領域のバイト数で分類した、チャンクリストの配列。
+    private: typedef std::array<
+        typename this_type::chunk_header*, this_type::bin_count>
+            chunk_bin_array;
+
     //-------------------------------------------------------------------------
     /// @name 構築と破壊
     //@{
@@ -67,49 +87,51 @@ class psyq::message_pack::pool
         typename this_type::allocator_type in_allocator =
             this_type::allocator_type())
     PSYQ_NOEXCEPT:
-        chunk_list_(nullptr),
+        front_chunk_(nullptr),
+        full_chunk_list_(nullptr),
         default_capacity_(in_default_capacity),
         allocator_(std::move(in_allocator))
-    {}
+    {
+        this->chunk_bins_.fill(nullptr);
+    }
 
     /** @brief copy構築子。
         @param[in] in_source copy元。
      */
     public: pool(this_type const& in_source):
-        chunk_list_(nullptr),
+        front_chunk_(nullptr),
+        full_chunk_list_(nullptr),
         default_capacity_(in_source.get_default_capacity()),
         allocator_(in_source.get_allocator())
-    {}
+    {
+        this->chunk_bins_.fill(nullptr);
+    }
 
     /** @brief move構築子。
         @param[in,out] io_source move元。
      */
     public: pool(this_type&& io_source) PSYQ_NOEXCEPT:
-        chunk_list_(std::move(io_source.chunk_list_)),
+        front_chunk_(std::move(io_source.front_chunk_)),
+        chunk_bins_(std::move(io_source.chunk_bins_)),
+        full_chunk_list_(std::move(io_source.full_chunk_list_)),
         default_capacity_(std::move(io_source.default_capacity_)),
         allocator_(std::move(io_source.allocator_))
     {
-        io_source.chunk_list_ = nullptr;
+        io_source.front_chunk_ = nullptr;
+        io_source.chunk_bins_.fill(nullptr);
+        io_source.full_chunk_list_ = nullptr;
     }
 
     /** @brief this_type::allocate() で確保したメモリを、すべて解放する。
      */
     public: ~pool() PSYQ_NOEXCEPT
     {
-        auto local_chunk(this->chunk_list_);
-        while (local_chunk != nullptr)
+        this->deallocate_chunk_list(this->front_chunk_);
+        for (auto const local_chunk_list: this->chunk_bins_)
         {
-            auto const local_capacity(local_chunk->capacity);
-            auto const local_memory(
-                reinterpret_cast<typename this_type::allocator_type::pointer>(
-                    reinterpret_cast<std::int8_t*>(local_chunk)
-                        - local_capacity));
-            local_chunk = local_chunk->next_chunk;
-            this->allocator_.deallocate(
-                local_memory,
-                this_type::alignment_count<this_type::value_size>(
-                    local_capacity + sizeof(typename this_type::chunk_header)));
+            this->deallocate_chunk_list(local_chunk_list);
         }
+        this->deallocate_chunk_list(this->full_chunk_list_);
     }
 
     /** @brief copy代入演算子。
@@ -169,13 +191,33 @@ class psyq::message_pack::pool
     {
         return this->default_capacity_;
     }
+
+    /** @brief メモリプールの使用状況を取得する。
+
+        断片化して使えなくなった空き領域のバイト数は、
+        statistics::free_size - statistics::max_free_size で見積もれる。
+
+        @return メモリプールの使用状況。
+     */
+    public: typename this_type::statistics get_statistics()
+    const PSYQ_NOEXCEPT
+    {
+        typename this_type::statistics local_statistics = {};
+        this_type::add_statistics(local_statistics, this->front_chunk_);
+        for (auto const local_chunk_list: this->chunk_bins_)
+        {
+            this_type::add_statistics(local_statistics, local_chunk_list);
+        }
+        this_type::add_statistics(local_statistics, this->full_chunk_list_);
+        return local_statistics;
+    }
     //@}
     //-------------------------------------------------------------------------
     /// @name メモリ確保
     //@{
     /** @brief メモリを確保する。
 
-        確保したメモリは、 this_type::~pool() で解放される。
+        確保したメモリは、 this_type::~pool() か this_type::reset() で解放される。
 
         @param[in] in_size      確保するメモリのバイト数。
         @param[in] in_alignment 確保するメモリ先頭位置のメモリ境界単位。
@@ -191,25 +233,50 @@ class psyq::message_pack::pool
             return nullptr;
         }
 
-        // チャンクからメモリを分配する。
-        if (this->chunk_list_ != nullptr)
+        // 先頭のチャンクからメモリを分配する。
+        if (this->front_chunk_ != nullptr)
         {
             auto const local_memory(
                 this_type::partition_chunk(
-                    *this->chunk_list_, in_size, in_alignment));
+                    *this->front_chunk_, in_size, in_alignment));
             if (local_memory != nullptr)
             {
                 return local_memory;
             }
         }
 
-        // 新たにチャンクを確保する。
-        /** @todo 2014.05.09
-            今のところ、新たにチャンクを確保すると、
-            既存のチャンクの空き領域が使われなくなる。
-            チャンクを空き領域のサイズでソートし、
-            既存のチャンクから空き領域を検索するようにしたい。
+        // 先頭のチャンクに収まらなかったので、既存のチャンクから検索する。
+        /** @note
+            大きなメモリを確保するときのために大きな空き領域を残しておくよう、
+            収まる中で空き領域が小さい分類のチャンクから分配する。
          */
+        for (
+            auto i(this_type::find_bin(in_size));
+            i < this->chunk_bins_.size();
+            ++i)
+        {
+            for (
+                auto local_position(&this->chunk_bins_[i]);
+                *local_position != nullptr;
+                local_position = &(*local_position)->next_chunk)
+            {
+                auto const local_chunk(*local_position);
+                if (in_size <= local_chunk->free_size)
+                {
+                    auto const local_memory(
+                        this_type::partition_chunk(
+                            *local_chunk, in_size, in_alignment));
+                    if (local_memory != nullptr)
+                    {
+                        *local_position = local_chunk->next_chunk;
+                        this->set_front_chunk(local_chunk);
+                        return local_memory;
+                    }
+                }
+            }
+        }
+
+        // 新たにチャンクを確保する。
         auto const local_free_size(
             this_type::alignment_size<this_type::header_alignment>(
                 std::max(
@@ -231,8 +298,7 @@ class psyq::message_pack::pool
                 static_cast<std::int8_t*>(local_pool) + local_free_size));
         local_chunk->free_size = local_free_size;
         local_chunk->capacity = local_free_size;
-        local_chunk->next_chunk = this->chunk_list_;
-        this->chunk_list_ = local_chunk;
+        this->set_front_chunk(local_chunk);
         auto const local_memory(
             this_type::partition_chunk(*local_chunk, in_size, in_alignment));
         PSYQ_ASSERT(local_memory != nullptr);
@@ -240,6 +306,169 @@ class psyq::message_pack::pool
     }
     //@}
     //-------------------------------------------------------------------------
+    /// @name インスタンス変数の操作
+    //@{
+    /** @brief this_type::allocate() で確保したメモリを、すべて未使用に戻す。
+
+        確保したチャンクは解放せずに再利用するので、
+        以後の this_type::allocate() は、
+        既存のチャンクに収まる限りメモリ割当子を呼び出さない。
+
+        @warning
+            これまでに this_type::allocate() で確保したメモリは、すべて無効になる。
+            このメモリプールで直列化復元したMessagePackオブジェクトは、
+            this_type::reset() を呼び出す前に破棄しておくこと。
+     */
+    public: void reset() PSYQ_NOEXCEPT
+    {
+        // すべてのチャンクを1つのチャンクリストにまとめる。
+        auto local_chunk_list(this->full_chunk_list_);
+        this->full_chunk_list_ = nullptr;
+        for (auto& local_chunk_bin: this->chunk_bins_)
+        {
+            local_chunk_list = this_type::splice_chunk_list(
+                local_chunk_bin, local_chunk_list);
+            local_chunk_bin = nullptr;
+        }
+        local_chunk_list = this_type::splice_chunk_list(
+            this->front_chunk_, local_chunk_list);
+        this->front_chunk_ = nullptr;
+
+        // チャンクの空き領域を戻し、空き領域の大きさで分類し直す。
+        while (local_chunk_list != nullptr)
+        {
+            auto const local_chunk(local_chunk_list);
+            local_chunk_list = local_chunk->next_chunk;
+            local_chunk->free_size = local_chunk->capacity;
+            this->insert_chunk(*local_chunk);
+        }
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /** @brief メモリを分配するチャンクを、先頭のチャンクにする。
+
+        それまで先頭だったチャンクは、空き領域の大きさで分類する。
+
+        @param[in,out] io_chunk 先頭にするチャンク。
+     */
+    private: void set_front_chunk(
+        typename this_type::chunk_header* const io_chunk)
+    PSYQ_NOEXCEPT
+    {
+        if (this->front_chunk_ != nullptr)
+        {
+            this->insert_chunk(*this->front_chunk_);
+        }
+        io_chunk->next_chunk = nullptr;
+        this->front_chunk_ = io_chunk;
+    }
+
+    /** @brief チャンクを、空き領域の大きさで分類する。
+
+        わずかな空き領域も小さい分類に残し、小さなメモリの分配に使う。
+        空き領域がないチャンクは、 this_type::reset() するまで検索しない。
+
+        @param[in,out] io_chunk 分類するチャンク。
+     */
+    private: void insert_chunk(typename this_type::chunk_header& io_chunk)
+    PSYQ_NOEXCEPT
+    {
+        auto& local_chunk_list(
+            io_chunk.free_size <= 0?
+                this->full_chunk_list_:
+                this->chunk_bins_[this_type::find_bin(io_chunk.free_size)]);
+        io_chunk.next_chunk = local_chunk_list;
+        local_chunk_list = &io_chunk;
+    }
+
+    /** @brief 空き領域のバイト数から、分類の番号を決定する。
+        @param[in] in_size 空き領域のバイト数。
+        @return 分類の番号。
+     */
+    private: static std::size_t find_bin(std::size_t const in_size)
+    PSYQ_NOEXCEPT
+    {
+        std::size_t local_bin(0);
+        for (
+            auto local_size(in_size >> (this_type::bin_shift + 1));
+            local_size != 0 && local_bin + 1 < this_type::bin_count;
+            local_size >>= 1)
+        {
+            ++local_bin;
+        }
+        return local_bin;
+    }
+
+    /** @brief チャンクリストを連結する。
+        @param[in] in_front_list 前に置くチャンクリスト。
+        @param[in] in_back_list  後に置くチャンクリスト。
+        @return 連結したチャンクリストの先頭。
+     */
+    private: static typename this_type::chunk_header* splice_chunk_list(
+        typename this_type::chunk_header* const in_front_list,
+        typename this_type::chunk_header* const in_back_list)
+    PSYQ_NOEXCEPT
+    {
+        if (in_front_list == nullptr)
+        {
+            return in_back_list;
+        }
+        auto local_last(in_front_list);
+        while (local_last->next_chunk != nullptr)
+        {
+            local_last = local_last->next_chunk;
+        }
+        local_last->next_chunk = in_back_list;
+        return in_front_list;
+    }
+
+    /** @brief チャンクリストの使用状況を集計する。
+        @param[in,out] io_statistics 集計した使用状況を加算する。
+        @param[in]     in_list       集計するチャンクリスト。
+     */
+    private: static void add_statistics(
+        typename this_type::statistics& io_statistics,
+        typename this_type::chunk_header const* in_list)
+    PSYQ_NOEXCEPT
+    {
+        for (
+            auto local_chunk(in_list);
+            local_chunk != nullptr;
+            local_chunk = local_chunk->next_chunk)
+        {
+            ++io_statistics.chunk_count;
+            io_statistics.capacity += local_chunk->capacity;
+            io_statistics.free_size += local_chunk->free_size;
+            if (io_statistics.max_free_size < local_chunk->free_size)
+            {
+                io_statistics.max_free_size = local_chunk->free_size;
+            }
+        }
+    }
+
+    /** @brief チャンクリストのチャンクを、すべて解放する。
+        @param[in] in_list 解放するチャンクリスト。
+     */
+    private: void deallocate_chunk_list(
+        typename this_type::chunk_header* const in_list)
+    PSYQ_NOEXCEPT
+    {
+        auto local_chunk(in_list);
+        while (local_chunk != nullptr)
+        {
+            auto const local_capacity(local_chunk->capacity);
+            auto const local_memory(
+                reinterpret_cast<typename this_type::allocator_type::pointer>(
+                    reinterpret_cast<std::int8_t*>(local_chunk)
+                        - local_capacity));
+            local_chunk = local_chunk->next_chunk;
+            this->allocator_.deallocate(
+                local_memory,
+                this_type::alignment_count<this_type::value_size>(
+                    local_capacity + sizeof(typename this_type::chunk_header)));
+        }
+    }
+
     /** @brief チャンクからメモリを分配する。
         @param[in,out] io_chunk     メモリを分配するチャンク。
         @param[in]     in_size      分配するメモリのバイト数。
@@ -289,8 +518,12 @@ class psyq::message_pack::pool
     }
 
     //-------------------------------------------------------------------------
-    /// チャンクリストの先頭。
-    private: typename this_type::chunk_header* chunk_list_;
+    /// メモリを分配しているチャンク。
+    private: typename this_type::chunk_header* front_chunk_;
+    /// 空き領域のバイト数で分類した、チャンクリストの配列。
+    private: typename this_type::chunk_bin_array chunk_bins_;
+    /// 空き領域がなく、メモリの分配に使わないチャンクリストの先頭。
+    private: typename this_type::chunk_header* full_chunk_list_;
     /// チャンク容量のデフォルト値。
     private: std::size_t default_capacity_;
     /// @copydoc allocator_type
@@ -298,4 +531,137 @@ class psyq::message_pack::pool
 
 }; // class psyq::message_pack::pool
 
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/** @brief psyq::message_pack::pool を参照する、 pool 互換のメモリ割当子。
+
+    複数の直列化復元で1つのメモリプールを共有するのに使う。
+    参照するメモリプールのメモリは、 pool::reset() でまとめて再利用できるので、
+    フレーム毎に多数のMessagePackを直列化復元する場合でも、
+    定常状態ではメモリ割当子を呼び出さずに済む。
+
+    @code
+    psyq::message_pack::pool<> local_frame_pool;
+    typedef psyq::message_pack::deserializer<
+        psyq::message_pack::memory_istream,
+        psyq::message_pack::pool_reference<>>
+            frame_deserializer;
+    for (;;)
+    {
+        // フレーム内の直列化復元は、すべて local_frame_pool から割り当てる。
+        frame_deserializer local_deserializer(
+            psyq::message_pack::memory_istream(local_data, local_size),
+            frame_deserializer::pool(local_frame_pool));
+        frame_deserializer::root_object local_root_object;
+        local_deserializer >> local_root_object;
+        // ...
+        local_root_object.reset();
+        local_frame_pool.reset();
+    }
+    @endcode
+
+    @tparam template_pool @copydoc psyq::message_pack::pool_reference::pool
+ */
+template<typename template_pool>
+class psyq::message_pack::pool_reference
+{
+    private: typedef pool_reference<template_pool> this_type; ///< thisが指す値の型。
+
+    /// 参照する psyq::message_pack::pool 。
+    public: typedef template_pool pool;
+
+    /// @copydoc psyq::message_pack::pool::allocator_type
+    public: typedef typename this_type::pool::allocator_type allocator_type;
+
+    //-------------------------------------------------------------------------
+    /// @name 構築
+    //@{
+    /** @brief メモリプールを参照しないインスタンスを構築する。
+
+        this_type::allocate() は、常に失敗する。
+     */
+    public: pool_reference() PSYQ_NOEXCEPT: pool_(nullptr) {}
+
+    /** @brief メモリプールを参照するインスタンスを構築する。
+        @param[in,out] io_pool 参照するメモリプール。
+     */
+    public: explicit pool_reference(typename this_type::pool& io_pool)
+    PSYQ_NOEXCEPT:
+        pool_(&io_pool)
+    {}
+
+    /** @brief copy構築子。
+
+        move構築にも使う。 psyq::message_pack::deserializer は
+        move元を使い続けるので、move元も同じメモリプールを参照したままにしておく。
+
+        @param[in] in_source copy元。
+     */
+    public: pool_reference(this_type const& in_source) PSYQ_NOEXCEPT:
+        pool_(in_source.pool_)
+    {}
+
+    /** @brief 代入演算子。
+        @param[in] in_source 代入元。
+        @return *this
+     */
+    public: this_type& operator=(this_type const& in_source) PSYQ_NOEXCEPT
+    {
+        this->pool_ = in_source.pool_;
+        return *this;
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /// @name 比較
+    //@{
+    public: bool operator==(this_type const& in_source) const PSYQ_NOEXCEPT
+    {
+        return this->pool_ == in_source.pool_;
+    }
+    public: bool operator!=(this_type const& in_source) const PSYQ_NOEXCEPT
+    {
+        return this->pool_ != in_source.pool_;
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /// @name 状態の取得
+    //@{
+    /** @brief 参照しているメモリプールを取得する。
+        @retval !=nullptr 参照しているメモリプール。
+        @retval ==nullptr メモリプールを参照していない。
+     */
+    public: typename this_type::pool* get_pool() const PSYQ_NOEXCEPT
+    {
+        return this->pool_;
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /// @name メモリ確保
+    //@{
+    /** @brief 参照しているメモリプールから、メモリを確保する。
+
+        確保したメモリは、参照しているメモリプールの
+        pool::reset() か pool::~pool() で解放される。
+
+        @param[in] in_size      確保するメモリのバイト数。
+        @param[in] in_alignment 確保するメモリ先頭位置のメモリ境界単位。
+        @retval !=nullptr 確保したメモリの先頭位置。
+        @retval ==nullptr メモリの確保に失敗した。
+     */
+    public: void* allocate(
+        std::size_t const in_size,
+        std::size_t const in_alignment = sizeof(std::int64_t))
+    {
+        if (this->pool_ == nullptr)
+        {
+            PSYQ_ASSERT(false);
+            return nullptr;
+        }
+        return this->pool_->allocate(in_size, in_alignment);
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    private: typename this_type::pool* pool_; ///< 参照するメモリプール。
+
+}; // class psyq::message_pack::pool_reference
+
 #endif // !defined(PSYQ_MESSAGE_PACK_POOL_HPP_)
@@ -0,0 +1,842 @@
+﻿/** @file
+    @author Hillco Psychi (https://twitter.com/psychi)
+    @brief @copybrief psyq::message_pack::scanner
+ */
+#ifndef PSYQ_MESSAGE_PACK_SCANNER_HPP_
+#define PSYQ_MESSAGE_PACK_SCANNER_HPP_
+
+#include <array>
+#include <vector>
+//#include "psyq/message_pack/object.hpp"
+//#include "psyq/message_pack/deserializer.hpp"
+
+/// psyq::message_pack::scanner のスタック限界数のデフォルト値。
+#ifndef PSYQ_MESSAGE_PACK_SCANNER_STACK_CAPACITY_DEFAULT
+#define PSYQ_MESSAGE_PACK_SCANNER_STACK_CAPACITY_DEFAULT 32
+#endif // !defined(PSYQ_MESSAGE_PACK_SCANNER_STACK_CAPACITY_DEFAULT)
+
+namespace psyq
+{
+    namespace message_pack
+    {
+        /// @cond
+        template<
+            typename,
+            std::size_t = PSYQ_MESSAGE_PACK_SCANNER_STACK_CAPACITY_DEFAULT>
+                class scanner;
+        struct scan_visitor;
+        /// @endcond
+
+        /// コンテナの走査を開始するときに、visitorが返す動作。
+        enum scan_action
+        {
+            scan_action_ENTER, ///< コンテナの要素を走査する。
+            scan_action_SKIP,  ///< コンテナの要素を走査せずに読み飛ばす。
+            scan_action_STOP,  ///< 走査を中断する。
+        };
+    } // namespace message_pack
+} // namespace psyq
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/** @brief psyq::message_pack::scanner に渡すvisitorの基底型。
+
+    すべての関数が、何もせずに走査を続行する。
+    必要な関数だけを派生型で同じ名前で定義すれば、visitorとして使える。
+    仮想関数ではないので、派生型の関数はテンプレートで静的に呼び出される。
+
+    各関数の戻り値は以下の通り。
+    - on_*() と end_*() は、falseを返すと走査を中断する。
+    - begin_*() は、 psyq::message_pack::scan_action を返す。
+
+    連想配列の要素は、キーと値の順に交互に呼び出される。
+ */
+struct psyq::message_pack::scan_visitor
+{
+    /// 空値を走査した。
+    bool on_nil() PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /// 真偽値を走査した。
+    bool on_boolean(bool const) PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /// 0以上の整数を走査した。
+    bool on_unsigned_integer(
+        psyq::message_pack::object::unsigned_integer const)
+    PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /// 0未満の整数を走査した。
+    bool on_negative_integer(
+        psyq::message_pack::object::negative_integer const)
+    PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /// IEEE754単精度浮動小数点数を走査した。
+    bool on_floating_point_32(
+        psyq::message_pack::object::floating_point_32 const)
+    PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /// IEEE754倍精度浮動小数点数を走査した。
+    bool on_floating_point_64(
+        psyq::message_pack::object::floating_point_64 const)
+    PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /** @brief 文字列を走査した。
+
+        文字列が参照するメモリ領域は、この関数から戻ると無効になる。
+     */
+    bool on_string(psyq::message_pack::object::string const&) PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /// @copydoc on_string
+    bool on_binary(psyq::message_pack::object::binary const&) PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /// @copydoc on_string
+    bool on_extended(psyq::message_pack::object::extended const&) PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /// 要素数が引数の配列の走査を開始する。
+    psyq::message_pack::scan_action begin_array(std::size_t const)
+    PSYQ_NOEXCEPT
+    {
+        return psyq::message_pack::scan_action_ENTER;
+    }
+
+    /// 配列の走査を終了した。
+    bool end_array() PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+    /// 要素数が引数の連想配列の走査を開始する。
+    psyq::message_pack::scan_action begin_map(std::size_t const)
+    PSYQ_NOEXCEPT
+    {
+        return psyq::message_pack::scan_action_ENTER;
+    }
+
+    /// 連想配列の走査を終了した。
+    bool end_map() PSYQ_NOEXCEPT
+    {
+        return true;
+    }
+
+}; // struct psyq::message_pack::scan_visitor
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/** @brief std::basic_istream 互換の入力ストリームを読み込み、
+           MessagePack値ごとにvisitorの関数を呼び出すアダプタ。
+
+    psyq::message_pack::deserializer と違って、
+    MessagePackオブジェクトを構築せず、メモリ割当子も使わない。
+    visitorが psyq::message_pack::scan_action_SKIP を返したコンテナは、
+    ヘッダだけをたどって読み飛ばす。
+
+    psyq::message_pack::memory_istream を使うと、
+    RAWバイト列はメモリ領域を直接参照するので、メモリ割当てをしない。
+    それ以外のストリームでは、RAWバイト列を作業領域にコピーする。
+
+    使用例
+    @code
+    // MessagePackの最上位の連想配列から、"id"の値を探す。
+    struct find_id: public psyq::message_pack::scan_visitor
+    {
+        // 最上位の連想配列だけを走査し、入れ子のコンテナは読み飛ばす。
+        psyq::message_pack::scan_action begin_array(std::size_t const)
+        {
+            return psyq::message_pack::scan_action_SKIP;
+        }
+        psyq::message_pack::scan_action begin_map(std::size_t const)
+        {
+            return this->entered?
+                psyq::message_pack::scan_action_SKIP:
+                (this->entered = true, psyq::message_pack::scan_action_ENTER);
+        }
+        bool on_string(psyq::message_pack::object::string const& in_string)
+        {
+            this->found = std::string(in_string.begin(), in_string.end()) == "id";
+            return true;
+        }
+        bool on_unsigned_integer(std::uint64_t const in_integer)
+        {
+            if (this->found)
+            {
+                this->id = in_integer;
+                return false;
+            }
+            return true;
+        }
+        bool entered = false;
+        bool found = false;
+        std::uint64_t id = 0;
+    };
+    @endcode
+
+    @tparam template_stream         @copydoc psyq::message_pack::scanner::stream
+    @tparam template_stack_capacity @copydoc psyq::message_pack::scanner::stack_capacity
+ */
+template<typename template_stream, std::size_t template_stack_capacity>
+class psyq::message_pack::scanner
+{
+    /// thisが指す値の型。
+    private: typedef scanner this_type;
+
+    //-------------------------------------------------------------------------
+    /// 走査に使う、 std::basic_istream 互換の入力ストリーム。
+    public: typedef template_stream stream;
+    static_assert(
+        sizeof(typename this_type::stream::char_type) == 1,
+        "sizeof(this_type::stream::char_type) is not 1.");
+
+    /// 走査途中のコンテナのスタック限界数。
+    public: static std::size_t const stack_capacity = template_stack_capacity;
+
+    /// 走査途中のコンテナのスタック。
+    private: struct container_stack
+    {
+        std::size_t rest_count; ///< コンテナ要素の残数。連想配列ではキーと値の合計。
+        bool map;               ///< 連想配列かどうか。
+    };
+
+    private: enum scan_result
+    {
+        scan_result_FAILED, ///< 走査に失敗した。
+        scan_result_STOP,   ///< visitorが走査を中断した。
+        scan_result_VALUE,  ///< 値を1つ走査した。
+        scan_result_ENTER,  ///< コンテナをスタックに積んだ。
+    };
+
+    //-------------------------------------------------------------------------
+    /// @name 構築
+    //@{
+    /** @brief 入力ストリームを構築する。
+        @param[in] in_istream MessagePackを読み込むストリームの初期値。
+     */
+    public: explicit scanner(typename this_type::stream in_istream):
+        stream_(std::move(in_istream)),
+        stack_size_(0),
+        shallow_(false)
+    {}
+
+    /** @brief ムーブ構築子。
+        @param[in,out] io_source ムーブ元インスタンス。
+     */
+    public: scanner(this_type&& io_source):
+        stream_(std::move(io_source.stream_)),
+        raw_buffer_(std::move(io_source.raw_buffer_)),
+        stack_size_(0),
+        shallow_(false)
+    {}
+
+    /** @brief ムーブ代入演算子。
+        @param[in,out] io_source ムーブ元インスタンス。
+     */
+    public: this_type& operator=(this_type&& io_source)
+    {
+        this->stream_ = std::move(io_source.stream_);
+        this->raw_buffer_ = std::move(io_source.raw_buffer_);
+        this->stack_size_ = 0;
+        return *this;
+    }
+    //@}
+    /// コピー構築子は使用禁止。
+    private: scanner(this_type const&);// = delete;
+    /// コピー代入演算子は使用禁止。
+    private: this_type& operator=(this_type const&);// = delete;
+
+    //-------------------------------------------------------------------------
+    /// @name インスタンス変数の操作
+    //@{
+    /** @brief 入力ストリームを再構築する。
+        @param[in] in_istream 新たに設定する入力ストリーム。
+        @return これまで使っていた入力ストリーム。
+     */
+    public: typename this_type::stream reset(typename this_type::stream in_istream)
+    {
+        this->stream_.swap(in_istream);
+        return in_istream;
+    }
+
+    /** @brief 走査で読み込む入力ストリームを取得する。
+        @return 走査で読み込む入力ストリーム。
+     */
+    public: typename this_type::stream const& get_stream() const PSYQ_NOEXCEPT
+    {
+        return this->stream_;
+    }
+
+    /** @brief 走査で読み込む入力ストリームを取得する。
+
+        読み込み位置を調べるときなどに使う。
+        走査の途中で読み込み位置を変更しないこと。
+
+        @return 走査で読み込む入力ストリーム。
+     */
+    public: typename this_type::stream& get_stream() PSYQ_NOEXCEPT
+    {
+        return this->stream_;
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /// @name 走査
+    //@{
+    /** @brief ストリームを読み込み、MessagePackオブジェクトを1つ走査する。
+        @param[in,out] io_visitor
+            値ごとに呼び出すvisitor。
+            psyq::message_pack::scan_visitor と同じ関数を持つこと。
+        @return
+            - 正なら、MessagePackオブジェクトの走査を完了。
+            - 0 なら、visitorが走査を中断した。
+            - 負なら、走査に失敗。
+     */
+    public: template<typename template_visitor>
+    int scan(template_visitor& io_visitor)
+    {
+        this->stack_size_ = 0;
+        for (;;)
+        {
+            switch (this->scan_value(io_visitor))
+            {
+            case this_type::scan_result_VALUE:
+                break;
+            case this_type::scan_result_ENTER:
+                continue;
+            case this_type::scan_result_STOP:
+                return 0;
+            default:
+                return -1;
+            }
+
+            // 走査を終えたコンテナをスタックから取り出す。
+            for (;;)
+            {
+                if (this->stack_size_ <= 0)
+                {
+                    return 1;
+                }
+                auto& local_stack_top(this->container_stack_[this->stack_size_ - 1]);
+                --local_stack_top.rest_count;
+                if (0 < local_stack_top.rest_count)
+                {
+                    break;
+                }
+                --this->stack_size_;
+                if (!(local_stack_top.map?
+                        io_visitor.end_map(): io_visitor.end_array()))
+                {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    /** @brief ストリームを読み込み、MessagePackオブジェクトを1つ読み飛ばす。
+
+        ヘッダだけをたどるので、値の復元はしない。
+
+        @retval true  成功。
+        @retval false 失敗。
+     */
+    public: bool skip()
+    {
+        return this->skip_values(1);
+    }
+
+    /** @brief ストリームを読み込み、MessagePack値を1つだけ走査する。
+
+        this_type::scan() と違って、コンテナの要素は走査しない。
+        visitorの begin_*() が psyq::message_pack::scan_action_ENTER を返すと、
+        コンテナのヘッダだけを読み込んで終了するので、
+        続くコンテナの要素は呼び出し側で走査すること。
+        コンテナの end_*() は呼び出さない。
+
+        @param[in,out] io_visitor
+            値を走査したときに呼び出すvisitor。
+            psyq::message_pack::scan_visitor と同じ関数を持つこと。
+        @return
+            - 正なら、MessagePack値の走査を完了。
+            - 0 なら、visitorが走査を中断した。
+            - 負なら、走査に失敗。
+     */
+    public: template<typename template_visitor>
+    int scan_header(template_visitor& io_visitor)
+    {
+        this->shallow_ = true;
+        auto const local_result(this->scan_value(io_visitor));
+        this->shallow_ = false;
+        switch (local_result)
+        {
+        case this_type::scan_result_VALUE:
+        case this_type::scan_result_ENTER:
+            return 1;
+        case this_type::scan_result_STOP:
+            return 0;
+        default:
+            return -1;
+        }
+    }
+    //@}
+    //-------------------------------------------------------------------------
+    /** @brief ストリームを読み込み、MessagePack値を1つ走査する。
+        @param[in,out] io_visitor 値ごとに呼び出すvisitor。
+     */
+    private: template<typename template_visitor>
+    typename this_type::scan_result scan_value(template_visitor& io_visitor)
+    {
+        auto const local_format(
+            this->stream_.good()?
+                this->stream_.get(): this_type::stream::traits_type::eof());
+        if (this->stream_.fail())
+        {
+            // ストリームの末尾に達していた。
+            return this_type::scan_result_FAILED;
+        }
+
+        // 固定長の形式と数値は先頭バイトで直接分岐し、ヘッダの解読を省く。
+        auto const local_byte(static_cast<unsigned>(local_format) & 0xff);
+        if (local_byte <= psyq::message_pack::_private::format_FIX_INTEGER_MAX)
+        {
+            // [0x00, 0x7f]: positive fixnum
+            return this_type::make_scan_result(
+                io_visitor.on_unsigned_integer(local_byte));
+        }
+        else if (local_byte <= psyq::message_pack::_private::format_FIX_MAP_MAX)
+        {
+            // [0x80, 0x8f]: fix map
+            return this->scan_container<true>(io_visitor, local_byte & 0x0f);
+        }
+        else if (local_byte <= psyq::message_pack::_private::format_FIX_ARRAY_MAX)
+        {
+            // [0x90, 0x9f]: fix array
+            return this->scan_container<false>(io_visitor, local_byte & 0x0f);
+        }
+        else if (local_byte <= psyq::message_pack::_private::format_FIX_STRING_MAX)
+        {
+            // [0xa0, 0xbf]: fix str
+            return this->scan_raw<psyq::message_pack::object::string>(
+                io_visitor, local_byte & 0x1f);
+        }
+        else if (psyq::message_pack::_private::format_MAP_32 < local_byte)
+        {
+            // [0xe0, 0xff]: negative fixnum
+            return this_type::make_scan_result(
+                io_visitor.on_negative_integer(
+                    static_cast<std::int8_t>(local_byte)));
+        }
+        switch (local_byte)
+        {
+        case psyq::message_pack::_private::format_UNSIGNED_INTEGER_8:
+            return this->scan_integer<std::uint8_t>(io_visitor);
+        case psyq::message_pack::_private::format_UNSIGNED_INTEGER_16:
+            return this->scan_integer<std::uint16_t>(io_visitor);
+        case psyq::message_pack::_private::format_UNSIGNED_INTEGER_32:
+            return this->scan_integer<std::uint32_t>(io_visitor);
+        case psyq::message_pack::_private::format_UNSIGNED_INTEGER_64:
+            return this->scan_integer<std::uint64_t>(io_visitor);
+        case psyq::message_pack::_private::foramt_NEGATIVE_INTEGER_8:
+            return this->scan_integer<std::int8_t>(io_visitor);
+        case psyq::message_pack::_private::foramt_NEGATIVE_INTEGER_16:
+            return this->scan_integer<std::int16_t>(io_visitor);
+        case psyq::message_pack::_private::foramt_NEGATIVE_INTEGER_32:
+            return this->scan_integer<std::int32_t>(io_visitor);
+        case psyq::message_pack::_private::foramt_NEGATIVE_INTEGER_64:
+            return this->scan_integer<std::int64_t>(io_visitor);
+        case psyq::message_pack::_private::format_FLOATING_POINT_32:
+            return this->scan_floating_point<
+                psyq::message_pack::object::floating_point_32>(io_visitor);
+        case psyq::message_pack::_private::format_FLOATING_POINT_64:
+            return this->scan_floating_point<
+                psyq::message_pack::object::floating_point_64>(io_visitor);
+        default:
+            break;
+        }
+
+        // 数値以外は、ヘッダを解読してから走査する。
+        auto local_header(
+            psyq::message_pack::_private::decode_header(local_byte));
+        if (!psyq::message_pack::_private::read_header_field(
+                local_header, this->stream_))
+        {
+            // ストリームの末尾に達していた。
+            return this_type::scan_result_FAILED;
+        }
+        switch (local_header.kind)
+        {
+        // 空値
+        case psyq::message_pack::_private::header_kind_NIL:
+            return this_type::make_scan_result(io_visitor.on_nil());
+
+        // 真偽値
+        case psyq::message_pack::_private::header_kind_BOOLEAN:
+            return this_type::make_scan_result(
+                io_visitor.on_boolean(local_header.field != 0));
+
+        // RAWバイト列
+        case psyq::message_pack::_private::header_kind_STRING:
+            return this->scan_raw<psyq::message_pack::object::string>(
+                io_visitor, psyq::message_pack::_private::get_payload_size(local_header));
+        case psyq::message_pack::_private::header_kind_BINARY:
+            return this->scan_raw<psyq::message_pack::object::binary>(
+                io_visitor, psyq::message_pack::_private::get_payload_size(local_header));
+        case psyq::message_pack::_private::header_kind_EXTENDED:
+            return this->scan_raw<psyq::message_pack::object::extended>(
+                io_visitor, psyq::message_pack::_private::get_payload_size(local_header));
+
+        // コンテナ
+        case psyq::message_pack::_private::header_kind_ARRAY:
+            return this->scan_container<false>(
+                io_visitor, static_cast<std::size_t>(local_header.field));
+        case psyq::message_pack::_private::header_kind_MAP:
+            return this->scan_container<true>(
+                io_visitor, static_cast<std::size_t>(local_header.field));
+
+        // 未使用の形式は、不正なMessagePackとして走査に失敗する。
+        default:
+            return this_type::scan_result_FAILED;
+        }
+    }
+
+    /** @brief visitorの戻り値を、走査の結果に変換する。
+        @param[in] in_continue visitorの戻り値。
+     */
+    private: static typename this_type::scan_result make_scan_result(
+        bool const in_continue)
+    PSYQ_NOEXCEPT
+    {
+        return in_continue?
+            this_type::scan_result_VALUE: this_type::scan_result_STOP;
+    }
+
+    //-------------------------------------------------------------------------
+    /** @brief ストリームを読み込み、整数を走査する。
+
+        psyq::message_pack::object と同じく、0以上なら無符号整数として扱う。
+
+        @tparam template_value 読み込む整数の型。
+        @param[in,out] io_visitor 値ごとに呼び出すvisitor。
+     */
+    private: template<typename template_value, typename template_visitor>
+    typename this_type::scan_result scan_integer(template_visitor& io_visitor)
+    {
+        template_value local_value;
+        if (!psyq::message_pack::_private::read_big_endian(
+                local_value, this->stream_))
+        {
+            return this_type::scan_result_FAILED;
+        }
+        return this_type::make_scan_result(
+            local_value < 0?
+                io_visitor.on_negative_integer(local_value):
+                io_visitor.on_unsigned_integer(local_value));
+    }
+
+    /** @brief ストリームを読み込み、浮動小数点数を走査する。
+        @tparam template_value 読み込む浮動小数点数の型。
+        @param[in,out] io_visitor 値ごとに呼び出すvisitor。
+     */
+    private: template<typename template_value, typename template_visitor>
+    typename this_type::scan_result scan_floating_point(
+        template_visitor& io_visitor)
+    {
+        template_value local_value;
+        if (!psyq::message_pack::_private::read_big_endian(
+                local_value, this->stream_))
+        {
+            return this_type::scan_result_FAILED;
+        }
+        return this_type::make_scan_result(
+            this_type::visit_floating_point(io_visitor, local_value));
+    }
+
+    /// @cond
+    private: template<typename template_visitor>
+    static bool visit_floating_point(
+        template_visitor& io_visitor,
+        psyq::message_pack::object::floating_point_32 const in_value)
+    {
+        return io_visitor.on_floating_point_32(in_value);
+    }
+
+    private: template<typename template_visitor>
+    static bool visit_floating_point(
+        template_visitor& io_visitor,
+        psyq::message_pack::object::floating_point_64 const in_value)
+    {
+        return io_visitor.on_floating_point_64(in_value);
+    }
+    /// @endcond
+
+    //-------------------------------------------------------------------------
+    /** @brief ストリームを読み込み、RAWバイト列を走査する。
+        @tparam template_raw RAWバイト列の型。
+        @param[in,out] io_visitor 値ごとに呼び出すvisitor。
+        @param[in]     in_size
+            RAWバイト列のバイト数。拡張バイナリは、型を表す1バイトを含む。
+     */
+    private: template<typename template_raw, typename template_visitor>
+    typename this_type::scan_result scan_raw(
+        template_visitor& io_visitor,
+        std::size_t const in_size)
+    {
+        auto const local_bytes(this->read_raw(in_size));
+        if (local_bytes == nullptr && 0 < in_size)
+        {
+            return this_type::scan_result_FAILED;
+        }
+        template_raw local_raw;
+        local_raw.reset(
+            static_cast<typename template_raw::pointer>(local_bytes), in_size);
+        return this_type::make_scan_result(this_type::visit_raw(io_visitor, local_raw));
+    }
+
+    /// @cond
+    private: template<typename template_visitor>
+    static bool visit_raw(
+        template_visitor& io_visitor,
+        psyq::message_pack::object::string const& in_raw)
+    {
+        return io_visitor.on_string(in_raw);
+    }
+
+    private: template<typename template_visitor>
+    static bool visit_raw(
+        template_visitor& io_visitor,
+        psyq::message_pack::object::binary const& in_raw)
+    {
+        return io_visitor.on_binary(in_raw);
+    }
+
+    private: template<typename template_visitor>
+    static bool visit_raw(
+        template_visitor& io_visitor,
+        psyq::message_pack::object::extended const& in_raw)
+    {
+        return io_visitor.on_extended(in_raw);
+    }
+    /// @endcond
+
+    /** @brief ストリームからRAWバイト列を読み込む。
+
+        メモリ領域を直接参照できないストリームでは、作業領域にコピーする。
+        作業領域は、実際に読み込めた分だけ拡張する。
+
+        @param[in] in_size RAWバイト列のバイト数。
+        @retval !=nullptr 読み込んだRAWバイト列の先頭位置。
+        @retval ==nullptr 失敗。
+     */
+    private: void const* read_raw(std::size_t const in_size)
+    {
+        if (in_size <= 0
+            || psyq::message_pack::_private::get_readable_size(this->stream_)
+                < in_size)
+        {
+            return nullptr;
+        }
+        auto const local_bytes(
+            psyq::message_pack::_private::borrow_bytes(this->stream_, in_size));
+        if (local_bytes != nullptr || this->stream_.fail())
+        {
+            return local_bytes;
+        }
+
+        // 不正なバイト長で巨大な作業領域を確保しないよう、少しずつ読み込む。
+        std::size_t local_read_size(0);
+        while (local_read_size < in_size)
+        {
+            auto const local_block_size(
+                (std::min)(
+                    in_size - local_read_size,
+                    (std::max)(local_read_size, std::size_t(0x1000))));
+            if (this->raw_buffer_.size() < local_read_size + local_block_size)
+            {
+                this->raw_buffer_.resize(local_read_size + local_block_size);
+            }
+            if (!this->read_stream(
+                    &this->raw_buffer_[local_read_size], local_block_size))
+            {
+                return nullptr;
+            }
+            local_read_size += local_block_size;
+        }
+        return this->raw_buffer_.data();
+    }
+
+    /** @brief メモリ領域を直接参照できないストリームから、バイト列を読み込む。
+        @param[out] out_bytes 読み込んだバイト列を格納する。
+        @param[in]  in_size   読み込むバイト数。
+        @retval true  成功。
+        @retval false 失敗。ストリームの末尾に達した。
+     */
+    private: bool read_stream(char* const out_bytes, std::size_t const in_size)
+    {
+        typedef typename this_type::stream::char_type char_type;
+        static_assert(sizeof(char_type) == 1, "");
+        this->stream_.read(
+            reinterpret_cast<char_type*>(out_bytes),
+            static_cast<std::streamsize>(in_size));
+        return !this->stream_.fail();
+    }
+
+    //-------------------------------------------------------------------------
+    /** @brief コンテナの走査を開始する。
+        @tparam template_map 連想配列かどうか。
+        @param[in,out] io_visitor 値ごとに呼び出すvisitor。
+        @param[in]     in_length  コンテナの要素数。
+     */
+    private: template<bool template_map, typename template_visitor>
+    typename this_type::scan_result scan_container(
+        template_visitor& io_visitor,
+        std::size_t const in_length)
+    {
+        auto const local_action(
+            template_map?
+                io_visitor.begin_map(in_length):
+                io_visitor.begin_array(in_length));
+        auto const local_count(template_map? in_length * 2: in_length);
+        switch (local_action)
+        {
+        case psyq::message_pack::scan_action_ENTER:
+            if (this->shallow_)
+            {
+                // コンテナの要素は、呼び出し側で走査する。
+                return this_type::scan_result_ENTER;
+            }
+            if (local_count <= 0)
+            {
+                return this_type::make_scan_result(
+                    template_map? io_visitor.end_map(): io_visitor.end_array());
+            }
+            if (this_type::stack_capacity <= this->stack_size_)
+            {
+                // コンテナの入れ子が、スタックの限界を超えた。
+                return this_type::scan_result_FAILED;
+            }
+            this->container_stack_[this->stack_size_].rest_count = local_count;
+            this->container_stack_[this->stack_size_].map = template_map;
+            ++this->stack_size_;
+            return this_type::scan_result_ENTER;
+
+        case psyq::message_pack::scan_action_SKIP:
+            return this->skip_values(local_count)?
+                this_type::scan_result_VALUE: this_type::scan_result_FAILED;
+
+        default:
+            return this_type::scan_result_STOP;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    /** @brief ストリームを読み込み、MessagePack値をヘッダだけたどって読み飛ばす。
+        @param[in] in_count 読み飛ばす値の数。
+        @retval true  成功。
+        @retval false 失敗。
+     */
+    private: bool skip_values(std::size_t const in_count)
+    {
+        for (auto local_rest_count(in_count); 0 < local_rest_count; --local_rest_count)
+        {
+            psyq::message_pack::_private::header local_header;
+            if (!this->stream_.good()
+                || !psyq::message_pack::_private::read_header(
+                    local_header, this->stream_))
+            {
+                // ストリームの末尾に達していた。
+                return false;
+            }
+            switch (local_header.kind)
+            {
+            case psyq::message_pack::_private::header_kind_ARRAY:
+                local_rest_count += static_cast<std::size_t>(local_header.field);
+                break;
+            case psyq::message_pack::_private::header_kind_MAP:
+                local_rest_count += static_cast<std::size_t>(local_header.field) * 2;
+                break;
+            case psyq::message_pack::_private::header_kind_INVALID:
+                // 未使用の形式は、不正なMessagePackとして読み飛ばしに失敗する。
+                return false;
+            default:
+                break;
+            }
+            if (!this->skip_bytes(
+                    psyq::message_pack::_private::get_payload_size(local_header)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** @brief ストリームを読み飛ばす。
+        @param[in] in_size 読み飛ばすバイト数。
+        @retval true  成功。
+        @retval false 失敗。
+     */
+    private: bool skip_bytes(std::size_t in_size)
+    {
+        if (in_size <= 0)
+        {
+            return true;
+        }
+        if (psyq::message_pack::_private::get_readable_size(this->stream_)
+                < in_size)
+        {
+            return false;
+        }
+        if (psyq::message_pack::_private::borrow_bytes(this->stream_, in_size)
+                != nullptr)
+        {
+            return true;
+        }
+
+        // メモリ領域を直接参照できないストリームは、固定長の領域へ読み捨てる。
+        std::array<char, 0x400> local_block;
+        while (0 < in_size && !this->stream_.fail())
+        {
+            auto const local_size((std::min)(in_size, local_block.size()));
+            if (!this->read_stream(local_block.data(), local_size))
+            {
+                return false;
+            }
+            in_size -= local_size;
+        }
+        return in_size <= 0;
+    }
+
+    //-------------------------------------------------------------------------
+    /// @copydoc stream
+    private: typename this_type::stream stream_;
+    /// メモリ領域を直接参照できないストリームで、RAWバイト列をコピーする作業領域。
+    private: std::vector<char> raw_buffer_;
+    /// @copydoc container_stack
+    private: std::array<typename this_type::container_stack, template_stack_capacity>
+        container_stack_;
+    /// 走査途中のコンテナのスタック階層数。
+    private: std::size_t stack_size_;
+    /// コンテナの要素を走査しないかどうか。
+    private: bool shallow_;
+
+}; // class psyq::message_pack::scanner
+
+#endif // !defined(PSYQ_MESSAGE_PACK_SCANNER_HPP_)
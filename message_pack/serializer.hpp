@@ -33,6 +33,7 @@ namespace psyq
             typename,
             std::size_t = PSYQ_MESSAGE_PACK_SERIALIZER_STACK_CAPACITY_DEFAULT>
                 class serializer;
+        template<typename> class memory_ostream;
         /// @endcond
 
         /// この名前空間をユーザーが直接アクセスするのは禁止。
@@ -249,6 +250,19 @@ class psyq::message_pack::serializer
     {
         return this->stream_;
     }
+
+    /** @brief 出力ストリームを取得する。
+
+        直列化したバイト列を、途中で別の出力先へ書き出すときに使う。
+        書き込み済みのバイト列以外を変更しないこと。
+
+        @return 出力ストリーム。
+        @sa psyq::message_pack::memory_ostream::flush_to()
+     */
+    public: typename this_type::stream& get_stream() PSYQ_NOEXCEPT
+    {
+        return this->stream_;
+    }
     //@}
     //-------------------------------------------------------------------------
     /// @name 状態の取得
@@ -265,7 +279,7 @@ class psyq::message_pack::serializer
     {
         return 0 < this->get_rest_container_count()?
             this->container_stack_.at(this->get_rest_container_count() - 1).kind:
-            typename this_type::value_kind_ROOT;
+            this_type::value_kind_ROOT;
     }
 
     /** @brief 直前に直列化を開始したMessagePackコンテナの残り要素数を取得する。
@@ -477,9 +491,44 @@ class psyq::message_pack::serializer
      */
     private: template<typename template_value>
     bool write_big_endian(template_value const in_value)
+    {
+        return this_type::write_stream_big_endian(this->stream_, in_value);
+    }
+
+    /** @brief 数値を直列化し、出力ストリームへ書き込む。
+        @param[in,out] io_ostream 書き込む出力ストリーム。
+        @param[in]     in_value   直列化する数値。
+        @retval true  成功。
+        @retval false 失敗。
+     */
+    private: template<typename template_ostream, typename template_value>
+    static bool write_stream_big_endian(
+        template_ostream& io_ostream,
+        template_value const in_value)
     {
         return psyq::message_pack::endianness_converter<template_value>
-            ::write_value(this->stream_, in_value, psyq::message_pack::big_endian);
+            ::write_value(io_ostream, in_value, psyq::message_pack::big_endian);
+    }
+
+    /** @brief 数値を直列化し、連続したメモリ領域へ直接書き込む。
+        @param[in,out] io_ostream 書き込む出力ストリーム。
+        @param[in]     in_value   直列化する数値。
+        @retval true  成功。
+        @retval false 失敗。
+     */
+    private: template<typename template_allocator, typename template_value>
+    static bool write_stream_big_endian(
+        psyq::message_pack::memory_ostream<template_allocator>& io_ostream,
+        template_value const in_value)
+    {
+        auto const local_bytes(io_ostream.advance(sizeof(template_value)));
+        if (local_bytes == nullptr)
+        {
+            return false;
+        }
+        psyq::message_pack::endianness_converter<template_value>::store_bytes(
+            local_bytes, in_value, psyq::message_pack::big_endian);
+        return true;
     }
 
     //-------------------------------------------------------------------------
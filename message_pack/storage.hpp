@@ -94,7 +94,7 @@ union psyq::message_pack::_private::storage
     /// @name MessagePackオブジェクト値の構築
     //@{
     /// 空のMessagePackオブジェクト値を構築する。
-    public: PSYQ_CONSTEXPR storage() PSYQ_NOEXCEPT {}
+    public: PSYQ_CONSTEXPR storage() PSYQ_NOEXCEPT: unsigned_integer_(0) {}
 
     /** @brief MessagePackオブジェクトに真偽値を格納する。
         @param[in] in_boolean MessagePackオブジェクトに格納する真偽値。
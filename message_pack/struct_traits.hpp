@@ -0,0 +1,668 @@
+﻿/** @file
+    @author Hillco Psychi (https://twitter.com/psychi)
+    @brief @copybrief psyq::message_pack::struct_traits
+ */
+#ifndef PSYQ_MESSAGE_PACK_STRUCT_TRAITS_HPP_
+#define PSYQ_MESSAGE_PACK_STRUCT_TRAITS_HPP_
+
+#include <array>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+//#include "psyq/message_pack/serializer.hpp"
+//#include "psyq/message_pack/scanner.hpp"
+
+namespace psyq
+{
+    namespace message_pack
+    {
+        /// @cond
+        template<typename> struct struct_traits;
+        template<typename template_scanner, typename template_struct>
+        bool read_struct(template_scanner&, template_struct&);
+        /// @endcond
+    } // namespace message_pack
+} // namespace psyq
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/** @brief 構造体のメンバ変数をMessagePackに直列化する順序を記述する。
+
+    グローバル名前空間で、以下のように記述する。
+    構造体は、メンバ変数を記述した順に並べたMessagePack配列として直列化される。
+    @code
+    struct point
+    {
+        std::int32_t x;
+        std::int32_t y;
+        std::string name;
+    };
+    PSYQ_MESSAGE_PACK_STRUCT_BEGIN(point)
+        PSYQ_MESSAGE_PACK_STRUCT_FIELD(x)
+        PSYQ_MESSAGE_PACK_STRUCT_FIELD(y)
+        PSYQ_MESSAGE_PACK_STRUCT_FIELD(name)
+    PSYQ_MESSAGE_PACK_STRUCT_END()
+    @endcode
+
+    @param define_struct 記述する構造体の型。名前空間で修飾した名前も使える。
+ */
+#define PSYQ_MESSAGE_PACK_STRUCT_BEGIN(define_struct)\
+    template<> struct psyq::message_pack::struct_traits<define_struct>\
+    {\
+        static bool const is_defined = true;\
+        template<typename template_struct, typename template_function>\
+        static bool for_each_field(\
+            template_struct& io_struct,\
+            template_function& io_function)\
+        {\
+            return true
+
+/** @brief 直列化する構造体のメンバ変数を記述する。
+    @param define_field 直列化するメンバ変数の名前。
+    @sa PSYQ_MESSAGE_PACK_STRUCT_BEGIN
+ */
+#define PSYQ_MESSAGE_PACK_STRUCT_FIELD(define_field)\
+                && io_function(io_struct.define_field)
+
+/** @brief 直列化する構造体の記述を終了する。
+    @sa PSYQ_MESSAGE_PACK_STRUCT_BEGIN
+ */
+#define PSYQ_MESSAGE_PACK_STRUCT_END()\
+            ;\
+        }\
+    };
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+/** @brief 構造体をMessagePackに直列化する方法の特性。
+
+    PSYQ_MESSAGE_PACK_STRUCT_BEGIN で特殊化すると、
+    psyq::message_pack::write_struct() と psyq::message_pack::read_struct() で、
+    psyq::message_pack::object を経由せずに構造体を直接直列化／直列化復元できる。
+
+    @tparam template_struct 直列化する構造体の型。
+ */
+template<typename template_struct>
+struct psyq::message_pack::struct_traits
+{
+    /// 構造体の直列化する方法が記述されているかどうか。
+    static bool const is_defined = false;
+
+}; // struct psyq::message_pack::struct_traits
+
+//ZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZZ
+namespace psyq
+{
+    namespace message_pack
+    {
+        namespace _private
+        {
+            //-----------------------------------------------------------------
+            /// 構造体のメンバ変数の数を数える関数オブジェクト。
+            struct struct_field_counter
+            {
+                template<typename template_field>
+                bool operator()(template_field const&) PSYQ_NOEXCEPT
+                {
+                    ++this->count;
+                    return true;
+                }
+
+                std::size_t count; ///< メンバ変数の数。
+            };
+
+            /** @brief 構造体のメンバ変数を直列化する関数オブジェクト。
+                @tparam template_serializer @copydoc psyq::message_pack::serializer
+             */
+            template<typename template_serializer>
+            struct struct_field_writer
+            {
+                template<typename template_field>
+                bool operator()(template_field const& in_field)
+                {
+                    *this->serializer << in_field;
+                    return !this->serializer->get_stream().fail();
+                }
+
+                template_serializer* serializer; ///< 直列化に使うserializer。
+            };
+
+            //-----------------------------------------------------------------
+            /** @brief 構造体のメンバ変数の直列化復元に使うvisitorの基底型。
+
+                すべての関数が、型の不一致として走査を中断する。
+                psyq::message_pack::scanner::scan_header() に渡して使う。
+             */
+            struct struct_field_visitor
+            {
+                bool on_nil() PSYQ_NOEXCEPT {return false;}
+                bool on_boolean(bool const) PSYQ_NOEXCEPT {return false;}
+                bool on_unsigned_integer(
+                    psyq::message_pack::object::unsigned_integer const)
+                PSYQ_NOEXCEPT
+                {
+                    return false;
+                }
+                bool on_negative_integer(
+                    psyq::message_pack::object::negative_integer const)
+                PSYQ_NOEXCEPT
+                {
+                    return false;
+                }
+                bool on_floating_point_32(
+                    psyq::message_pack::object::floating_point_32 const)
+                PSYQ_NOEXCEPT
+                {
+                    return false;
+                }
+                bool on_floating_point_64(
+                    psyq::message_pack::object::floating_point_64 const)
+                PSYQ_NOEXCEPT
+                {
+                    return false;
+                }
+                bool on_string(psyq::message_pack::object::string const&)
+                PSYQ_NOEXCEPT
+                {
+                    return false;
+                }
+                bool on_binary(psyq::message_pack::object::binary const&)
+                PSYQ_NOEXCEPT
+                {
+                    return false;
+                }
+                bool on_extended(psyq::message_pack::object::extended const&)
+                PSYQ_NOEXCEPT
+                {
+                    return false;
+                }
+                psyq::message_pack::scan_action begin_array(std::size_t const)
+                PSYQ_NOEXCEPT
+                {
+                    return psyq::message_pack::scan_action_STOP;
+                }
+                bool end_array() PSYQ_NOEXCEPT {return false;}
+                psyq::message_pack::scan_action begin_map(std::size_t const)
+                PSYQ_NOEXCEPT
+                {
+                    return psyq::message_pack::scan_action_STOP;
+                }
+                bool end_map() PSYQ_NOEXCEPT {return false;}
+            };
+
+            /// 真偽値を直列化復元するvisitor。
+            struct struct_boolean_visitor: public struct_field_visitor
+            {
+                bool on_boolean(bool const in_boolean) PSYQ_NOEXCEPT
+                {
+                    *this->value = in_boolean;
+                    return true;
+                }
+
+                bool* value; ///< 直列化復元した値を格納する。
+            };
+
+            /** @brief 整数を直列化復元するvisitor。
+                @tparam template_value 直列化復元する整数の型。
+             */
+            template<typename template_value>
+            struct struct_integer_visitor: public struct_field_visitor
+            {
+                bool on_unsigned_integer(
+                    psyq::message_pack::object::unsigned_integer const in_integer)
+                PSYQ_NOEXCEPT
+                {
+                    if (static_cast<std::uint64_t>(
+                            (std::numeric_limits<template_value>::max)())
+                        < in_integer)
+                    {
+                        return false;
+                    }
+                    *this->value = static_cast<template_value>(in_integer);
+                    return true;
+                }
+
+                bool on_negative_integer(
+                    psyq::message_pack::object::negative_integer const in_integer)
+                PSYQ_NOEXCEPT
+                {
+                    if (!std::is_signed<template_value>::value
+                        || in_integer < static_cast<std::int64_t>(
+                            (std::numeric_limits<template_value>::min)()))
+                    {
+                        return false;
+                    }
+                    *this->value = static_cast<template_value>(in_integer);
+                    return true;
+                }
+
+                template_value* value; ///< 直列化復元した値を格納する。
+            };
+
+            /** @brief 浮動小数点数を直列化復元するvisitor。
+
+                整数も、浮動小数点数に変換して直列化復元する。
+
+                @tparam template_value 直列化復元する浮動小数点数の型。
+             */
+            template<typename template_value>
+            struct struct_floating_point_visitor: public struct_field_visitor
+            {
+                bool on_unsigned_integer(
+                    psyq::message_pack::object::unsigned_integer const in_integer)
+                PSYQ_NOEXCEPT
+                {
+                    *this->value = static_cast<template_value>(in_integer);
+                    return true;
+                }
+
+                bool on_negative_integer(
+                    psyq::message_pack::object::negative_integer const in_integer)
+                PSYQ_NOEXCEPT
+                {
+                    *this->value = static_cast<template_value>(in_integer);
+                    return true;
+                }
+
+                bool on_floating_point_32(
+                    psyq::message_pack::object::floating_point_32 const in_float)
+                PSYQ_NOEXCEPT
+                {
+                    *this->value = static_cast<template_value>(in_float);
+                    return true;
+                }
+
+                bool on_floating_point_64(
+                    psyq::message_pack::object::floating_point_64 const in_float)
+                PSYQ_NOEXCEPT
+                {
+                    *this->value = static_cast<template_value>(in_float);
+                    return true;
+                }
+
+                template_value* value; ///< 直列化復元した値を格納する。
+            };
+
+            /** @brief 文字列を直列化復元するvisitor。
+                @tparam template_string 直列化復元する std::basic_string の型。
+             */
+            template<typename template_string>
+            struct struct_string_visitor: public struct_field_visitor
+            {
+                bool on_string(psyq::message_pack::object::string const& in_string)
+                {
+                    this->value->assign(in_string.data(), in_string.size());
+                    return true;
+                }
+
+                template_string* value; ///< 直列化復元した値を格納する。
+            };
+
+            /// 配列の要素数を直列化復元するvisitor。
+            struct struct_array_visitor: public struct_field_visitor
+            {
+                psyq::message_pack::scan_action begin_array(
+                    std::size_t const in_length)
+                PSYQ_NOEXCEPT
+                {
+                    this->length = in_length;
+                    return psyq::message_pack::scan_action_ENTER;
+                }
+
+                std::size_t length; ///< 配列の要素数。
+            };
+
+            //-----------------------------------------------------------------
+            /** @brief 構造体のメンバ変数を、MessagePackから直列化復元する。
+
+                psyq::message_pack::struct_traits で記述した構造体の場合。
+
+                @tparam template_value 直列化復元するメンバ変数の型。
+             */
+            template<typename template_value, typename = void>
+            struct struct_field_reader
+            {
+                template<typename template_scanner>
+                static bool read(
+                    template_scanner& io_scanner,
+                    template_value& out_value)
+                {
+                    static_assert(
+                        psyq::message_pack::struct_traits<template_value>
+                            ::is_defined,
+                        "psyq::message_pack::struct_traits<template_value>"
+                        " is not defined.");
+                    return psyq::message_pack::read_struct(io_scanner, out_value);
+                }
+            };
+
+            /// 真偽値の場合。
+            template<> struct struct_field_reader<bool>
+            {
+                template<typename template_scanner>
+                static bool read(template_scanner& io_scanner, bool& out_value)
+                {
+                    psyq::message_pack::_private::struct_boolean_visitor
+                        local_visitor;
+                    local_visitor.value = &out_value;
+                    return 0 < io_scanner.scan_header(local_visitor);
+                }
+            };
+
+            /// 整数の場合。
+            template<typename template_value>
+            struct struct_field_reader<
+                template_value,
+                typename std::enable_if<
+                    std::is_integral<template_value>::value>::type>
+            {
+                template<typename template_scanner>
+                static bool read(
+                    template_scanner& io_scanner,
+                    template_value& out_value)
+                {
+                    psyq::message_pack::_private
+                        ::struct_integer_visitor<template_value>
+                            local_visitor;
+                    local_visitor.value = &out_value;
+                    return 0 < io_scanner.scan_header(local_visitor);
+                }
+            };
+
+            /// 浮動小数点数の場合。
+            template<typename template_value>
+            struct struct_field_reader<
+                template_value,
+                typename std::enable_if<
+                    std::is_floating_point<template_value>::value>::type>
+            {
+                template<typename template_scanner>
+                static bool read(
+                    template_scanner& io_scanner,
+                    template_value& out_value)
+                {
+                    psyq::message_pack::_private
+                        ::struct_floating_point_visitor<template_value>
+                            local_visitor;
+                    local_visitor.value = &out_value;
+                    return 0 < io_scanner.scan_header(local_visitor);
+                }
+            };
+
+            /// std::basic_string の場合。
+            template<typename template_traits, typename template_allocator>
+            struct struct_field_reader<
+                std::basic_string<char, template_traits, template_allocator>>
+            {
+                typedef std::basic_string<
+                    char, template_traits, template_allocator>
+                        string_type;
+
+                template<typename template_scanner>
+                static bool read(
+                    template_scanner& io_scanner,
+                    string_type& out_value)
+                {
+                    psyq::message_pack::_private
+                        ::struct_string_visitor<string_type>
+                            local_visitor;
+                    local_visitor.value = &out_value;
+                    return 0 < io_scanner.scan_header(local_visitor);
+                }
+            };
+
+            /// std::vector の場合。
+            template<typename template_element, typename template_allocator>
+            struct struct_field_reader<
+                std::vector<template_element, template_allocator>>
+            {
+                template<typename template_scanner>
+                static bool read(
+                    template_scanner& io_scanner,
+                    std::vector<template_element, template_allocator>& out_value)
+                {
+                    psyq::message_pack::_private::struct_array_visitor
+                        local_visitor;
+                    if (io_scanner.scan_header(local_visitor) <= 0)
+                    {
+                        return false;
+                    }
+
+                    /* 要素数はストリームから読み込んだもので信頼できないので、
+                       読み込めるバイト数を超えて予約しない。
+                       要素は1バイト以上あるので、要素数はバイト数を超えない。 */
+                    out_value.clear();
+                    auto const local_readable_size(
+                        psyq::message_pack::_private::get_readable_size(
+                            io_scanner.get_stream()));
+                    if (local_readable_size
+                        < (std::numeric_limits<std::size_t>::max)())
+                    {
+                        out_value.reserve(
+                            (std::min)(local_visitor.length, local_readable_size));
+                    }
+                    for (auto i(local_visitor.length); 0 < i; --i)
+                    {
+                        out_value.emplace_back();
+                        if (!psyq::message_pack::_private
+                                ::struct_field_reader<template_element>
+                                    ::read(io_scanner, out_value.back()))
+                        {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+            };
+
+            /// std::array の場合。要素数が一致しなければならない。
+            template<typename template_element, std::size_t template_size>
+            struct struct_field_reader<
+                std::array<template_element, template_size>>
+            {
+                template<typename template_scanner>
+                static bool read(
+                    template_scanner& io_scanner,
+                    std::array<template_element, template_size>& out_value)
+                {
+                    psyq::message_pack::_private::struct_array_visitor
+                        local_visitor;
+                    if (io_scanner.scan_header(local_visitor) <= 0
+                        || local_visitor.length != template_size)
+                    {
+                        return false;
+                    }
+                    for (auto& local_element: out_value)
+                    {
+                        if (!psyq::message_pack::_private
+                                ::struct_field_reader<template_element>
+                                    ::read(io_scanner, local_element))
+                        {
+                            return false;
+                        }
+                    }
+                    return true;
+                }
+            };
+
+            /** @brief 構造体のメンバ変数を直列化復元する関数オブジェクト。
+                @tparam template_scanner @copydoc psyq::message_pack::scanner
+             */
+            template<typename template_scanner>
+            struct struct_field_reader_function
+            {
+                template<typename template_field>
+                bool operator()(template_field& out_field)
+                {
+                    if (this->rest_count <= 0)
+                    {
+                        // MessagePack配列の要素が足りないので、変更しない。
+                        return true;
+                    }
+                    --this->rest_count;
+                    return psyq::message_pack::_private
+                        ::struct_field_reader<template_field>
+                            ::read(*this->scanner, out_field);
+                }
+
+                template_scanner* scanner; ///< 直列化復元に使うscanner。
+                std::size_t rest_count;    ///< MessagePack配列の要素の残り数。
+            };
+        } // namespace _private
+
+        //---------------------------------------------------------------------
+        /** @brief 構造体をMessagePack配列として直列化し、ストリームへ出力する。
+
+            psyq::message_pack::struct_traits で記述したメンバ変数を、
+            記述した順に配列の要素として直列化する。
+
+            @param[in,out] io_serializer 直列化に使うserializer。
+            @param[in]     in_struct     直列化する構造体。
+            @retval true  成功。
+            @retval false 失敗。
+         */
+        template<typename template_serializer, typename template_struct>
+        bool write_struct(
+            template_serializer& io_serializer,
+            template_struct const& in_struct)
+        {
+            typedef psyq::message_pack::struct_traits<template_struct> traits;
+            static_assert(
+                traits::is_defined,
+                "psyq::message_pack::struct_traits<template_struct>"
+                " is not defined.");
+            psyq::message_pack::_private::struct_field_counter local_counter;
+            local_counter.count = 0;
+            traits::for_each_field(in_struct, local_counter);
+            if (!io_serializer.make_serial_array(local_counter.count))
+            {
+                return false;
+            }
+            psyq::message_pack::_private
+                ::struct_field_writer<template_serializer>
+                    local_writer;
+            local_writer.serializer = &io_serializer;
+            return traits::for_each_field(in_struct, local_writer);
+        }
+
+        /** @brief MessagePack配列を、構造体に直接直列化復元する。
+
+            psyq::message_pack::object を構築せず、メモリ割当子も使わない。
+            - MessagePack配列の要素が足りない場合は、残りのメンバ変数を変更しない。
+            - MessagePack配列の要素が余った場合は、読み飛ばす。
+
+            @param[in,out] io_scanner 直列化復元に使うscanner。
+            @param[out]    out_struct 直列化復元した値を格納する構造体。
+            @retval true  成功。
+            @retval false 失敗。 out_struct の一部が変更されている場合がある。
+         */
+        template<typename template_scanner, typename template_struct>
+        bool read_struct(
+            template_scanner& io_scanner,
+            template_struct& out_struct)
+        {
+            typedef psyq::message_pack::struct_traits<template_struct> traits;
+            static_assert(
+                traits::is_defined,
+                "psyq::message_pack::struct_traits<template_struct>"
+                " is not defined.");
+            psyq::message_pack::_private::struct_array_visitor local_visitor;
+            if (io_scanner.scan_header(local_visitor) <= 0)
+            {
+                return false;
+            }
+            psyq::message_pack::_private
+                ::struct_field_reader_function<template_scanner>
+                    local_reader;
+            local_reader.scanner = &io_scanner;
+            local_reader.rest_count = local_visitor.length;
+            if (!traits::for_each_field(out_struct, local_reader))
+            {
+                return false;
+            }
+            for (; 0 < local_reader.rest_count; --local_reader.rest_count)
+            {
+                if (!io_scanner.skip())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /** @brief MessagePack配列を、 std::vector に直接直列化復元する。
+
+            要素が構造体の std::vector も、
+            psyq::message_pack::object を構築せずに直列化復元できる。
+
+            @param[in,out] io_scanner 直列化復元に使うscanner。
+            @param[out]    out_value  直列化復元した要素を格納するコンテナ。
+            @retval true  成功。
+            @retval false 失敗。 out_value の一部が変更されている場合がある。
+         */
+        template<
+            typename template_scanner,
+            typename template_element,
+            typename template_allocator>
+        bool read_struct(
+            template_scanner& io_scanner,
+            std::vector<template_element, template_allocator>& out_value)
+        {
+            return psyq::message_pack::_private
+                ::struct_field_reader<
+                    std::vector<template_element, template_allocator>>
+                        ::read(io_scanner, out_value);
+        }
+
+        /** @brief MessagePack配列を、 std::array に直接直列化復元する。
+
+            MessagePack配列の要素数が、 std::array の要素数と一致しなければならない。
+
+            @param[in,out] io_scanner 直列化復元に使うscanner。
+            @param[out]    out_value  直列化復元した要素を格納するコンテナ。
+            @retval true  成功。
+            @retval false 失敗。 out_value の一部が変更されている場合がある。
+         */
+        template<
+            typename template_scanner,
+            typename template_element,
+            std::size_t template_size>
+        bool read_struct(
+            template_scanner& io_scanner,
+            std::array<template_element, template_size>& out_value)
+        {
+            return psyq::message_pack::_private
+                ::struct_field_reader<
+                    std::array<template_element, template_size>>
+                        ::read(io_scanner, out_value);
+        }
+
+        /** @brief 構造体をMessagePack配列として直列化し、ストリームへ出力する。
+
+            構造体のメンバ変数や標準コンテナの要素に構造体があっても、
+            psyq::message_pack::serializer の出力演算子で直列化できるようにする。
+
+            @param[in,out] io_serializer 直列化に使うserializer。
+            @param[in]     in_struct     直列化する構造体。
+            @return io_serializer
+            @sa psyq::message_pack::write_struct()
+         */
+        template<
+            typename template_stream,
+            std::size_t template_stack_capacity,
+            typename template_struct>
+        typename std::enable_if<
+            psyq::message_pack::struct_traits<template_struct>::is_defined,
+            psyq::message_pack::serializer<
+                template_stream, template_stack_capacity>&>::type
+        operator<<(
+            psyq::message_pack::serializer<
+                template_stream, template_stack_capacity>& io_serializer,
+            template_struct const& in_struct)
+        {
+            psyq::message_pack::write_struct(io_serializer, in_struct);
+            return io_serializer;
+        }
+    } // namespace message_pack
+} // namespace psyq
+
+#endif // !defined(PSYQ_MESSAGE_PACK_STRUCT_TRAITS_HPP_)
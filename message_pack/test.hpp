@@ -13,6 +13,65 @@
 //#include "psyq/message_pack/serializer.hpp"
 //#include "psyq/message_pack/root_object.hpp"
 //#include "psyq/message_pack/deserialize.hpp"
+//#include "psyq/message_pack/struct_traits.hpp"
+
+namespace psyq
+{
+    namespace test
+    {
+        /// psyq::message_pack::struct_traits の試験に使う構造体。
+        struct message_pack_point
+        {
+            std::int32_t x;
+            std::int32_t y;
+        };
+
+        /// psyq::message_pack::struct_traits の試験に使う構造体。
+        struct message_pack_shape
+        {
+            std::uint32_t id;
+            std::int8_t layer;
+            float scale;
+            double ratio;
+            bool visible;
+            std::string name;
+            std::vector<psyq::test::message_pack_point> points;
+            std::array<std::uint16_t, 3> color;
+            psyq::test::message_pack_point origin;
+        };
+
+        /// psyq::message_pack::struct_traits の試験に使う構造体。
+        struct message_pack_polyline
+        {
+            std::int32_t x;
+            std::int32_t y;
+            std::vector<psyq::test::message_pack_point> points;
+        };
+    } // namespace test
+} // namespace psyq
+
+PSYQ_MESSAGE_PACK_STRUCT_BEGIN(psyq::test::message_pack_point)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(x)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(y)
+PSYQ_MESSAGE_PACK_STRUCT_END()
+
+PSYQ_MESSAGE_PACK_STRUCT_BEGIN(psyq::test::message_pack_shape)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(id)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(layer)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(scale)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(ratio)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(visible)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(name)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(points)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(color)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(origin)
+PSYQ_MESSAGE_PACK_STRUCT_END()
+
+PSYQ_MESSAGE_PACK_STRUCT_BEGIN(psyq::test::message_pack_polyline)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(x)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(y)
+    PSYQ_MESSAGE_PACK_STRUCT_FIELD(points)
+PSYQ_MESSAGE_PACK_STRUCT_END()
 
 namespace psyq
 {
@@ -355,6 +414,568 @@ namespace psyq
 
             local_serializer << local_root_object;
             PSYQ_ASSERT(local_serializer.get_stream().str() == local_serialize_string);
+
+            // メモリ領域から直接直列化復元しても、同じ結果になる。
+            typedef psyq::message_pack::deserializer
+                <psyq::message_pack::memory_istream, psyq::message_pack::pool<>, 8>
+                    memory_deserializer;
+            memory_deserializer local_memory_deserializer(
+                psyq::message_pack::memory_istream(
+                    local_serialize_string.data(), local_serialize_string.size()),
+                memory_deserializer::pool());
+            memory_deserializer::root_object local_memory_root_object;
+            local_memory_deserializer >> local_memory_root_object;
+            PSYQ_ASSERT(local_memory_deserializer.get_stream().get_rest_size() == 0);
+            local_serializer.reset(std::stringstream());
+            local_serializer << local_memory_root_object;
+            PSYQ_ASSERT(local_serializer.get_stream().str() == local_serialize_string);
+
+            // メモリ割当てをせずに、RAWバイト列がメモリ領域を直接参照する。
+            local_memory_deserializer.reset(
+                psyq::message_pack::memory_istream(
+                    local_serialize_string.data(), local_serialize_string.size()),
+                memory_deserializer::pool());
+            local_memory_deserializer.set_allocate_raw(false);
+            PSYQ_ASSERT(!local_memory_deserializer.get_allocate_raw());
+            memory_deserializer::root_object local_borrow_root_object;
+            local_memory_deserializer >> local_borrow_root_object;
+            PSYQ_ASSERT(local_memory_deserializer.get_stream().get_rest_size() == 0);
+            auto const local_serialize_begin(local_serialize_string.data());
+            auto const local_serialize_end(
+                local_serialize_begin + local_serialize_string.size());
+            std::size_t local_borrow_count(0);
+            for (auto& local_object: *local_borrow_root_object.get_array())
+            {
+                void const* local_raw_data(nullptr);
+                if (local_object.get_string() != nullptr)
+                {
+                    local_raw_data = local_object.get_string()->data();
+                }
+                else if (local_object.get_binary() != nullptr)
+                {
+                    local_raw_data = local_object.get_binary()->data();
+                }
+                else if (local_object.get_extended() != nullptr)
+                {
+                    local_raw_data = local_object.get_extended()->data();
+                }
+                if (local_raw_data != nullptr)
+                {
+                    auto const local_raw_bytes(
+                        static_cast<char const*>(local_raw_data));
+                    PSYQ_ASSERT(local_serialize_begin <= local_raw_bytes);
+                    PSYQ_ASSERT(local_raw_bytes < local_serialize_end);
+                    ++local_borrow_count;
+                }
+            }
+            PSYQ_ASSERT(0 < local_borrow_count);
+            local_serializer.reset(std::stringstream());
+            local_serializer << local_borrow_root_object;
+            PSYQ_ASSERT(local_serializer.get_stream().str() == local_serialize_string);
+
+            // 断片に分けて直列化復元しても、同じ結果になる。
+            std::size_t const local_chunk_sizes[] = {1, 7, 0x1000};
+            for (auto const local_chunk_size: local_chunk_sizes)
+            {
+                memory_deserializer local_partial_deserializer(
+                    psyq::message_pack::memory_istream(nullptr, 0),
+                    memory_deserializer::pool());
+                memory_deserializer::root_object local_partial_root_object;
+                int local_partial_result(0);
+                for (std::size_t i(0); i < local_serialize_string.size();)
+                {
+                    auto const local_size(
+                        (std::min)(local_chunk_size, local_serialize_string.size() - i));
+                    local_partial_deserializer.resume(
+                        psyq::message_pack::memory_istream(
+                            local_serialize_string.data() + i, local_size));
+                    i += local_size;
+                    local_partial_result = local_partial_deserializer.read_partial_object(
+                        local_partial_root_object);
+                    PSYQ_ASSERT(
+                        0 <= local_partial_result
+                        && (local_partial_result == 0)
+                            == (i < local_serialize_string.size()));
+                }
+                PSYQ_ASSERT(0 < local_partial_result);
+                PSYQ_ASSERT(local_partial_deserializer.get_rest_container_count() == 0);
+                local_serializer.reset(std::stringstream());
+                local_serializer << local_partial_root_object;
+                PSYQ_ASSERT(
+                    local_serializer.get_stream().str() == local_serialize_string);
+            }
+
+            // オブジェクトを構築せずに走査し、大きな配列は読み飛ばす。
+            struct count_visitor: public psyq::message_pack::scan_visitor
+            {
+                bool on_nil()
+                {
+                    ++this->nil_count;
+                    return true;
+                }
+                bool on_unsigned_integer(std::uint64_t const)
+                {
+                    ++this->unsigned_count;
+                    return true;
+                }
+                bool on_negative_integer(std::int64_t const)
+                {
+                    ++this->negative_count;
+                    return true;
+                }
+                bool on_string(psyq::message_pack::object::string const& in_string)
+                {
+                    ++this->string_count;
+                    return this->string_limit == 0
+                        || this->string_count < this->string_limit
+                        || in_string.empty();
+                }
+                psyq::message_pack::scan_action begin_array(std::size_t const in_size)
+                {
+                    if (0x100 < in_size)
+                    {
+                        ++this->skip_count;
+                        return psyq::message_pack::scan_action_SKIP;
+                    }
+                    return psyq::message_pack::scan_action_ENTER;
+                }
+                psyq::message_pack::scan_action begin_map(std::size_t const in_size)
+                {
+                    return this->begin_array(in_size);
+                }
+                bool end_array()
+                {
+                    ++this->end_array_count;
+                    return true;
+                }
+                std::size_t string_limit = 0;
+                std::size_t nil_count = 0;
+                std::size_t unsigned_count = 0;
+                std::size_t negative_count = 0;
+                std::size_t string_count = 0;
+                std::size_t skip_count = 0;
+                std::size_t end_array_count = 0;
+            };
+            psyq::message_pack::scanner<psyq::message_pack::memory_istream>
+                local_scanner(
+                    psyq::message_pack::memory_istream(
+                        local_serialize_string.data(), local_serialize_string.size()));
+            count_visitor local_count_visitor;
+            PSYQ_ASSERT(0 < local_scanner.scan(local_count_visitor));
+            PSYQ_ASSERT(local_scanner.get_stream().get_rest_size() == 0);
+            PSYQ_ASSERT(local_count_visitor.nil_count == 1);
+            PSYQ_ASSERT(local_count_visitor.unsigned_count == 6);
+            PSYQ_ASSERT(local_count_visitor.negative_count == 5);
+            PSYQ_ASSERT(local_count_visitor.string_count == 4);
+            PSYQ_ASSERT(local_count_visitor.skip_count == 2);
+            PSYQ_ASSERT(local_count_visitor.end_array_count == 2);
+
+            // 汎用のストリームでも同じ結果になり、visitorが走査を中断できる。
+            psyq::message_pack::scanner<std::istringstream>
+                local_stream_scanner((std::istringstream(local_serialize_string)));
+            count_visitor local_stop_visitor;
+            local_stop_visitor.string_limit = 2;
+            PSYQ_ASSERT(local_stream_scanner.scan(local_stop_visitor) == 0);
+            PSYQ_ASSERT(local_stop_visitor.string_count == 2);
+            PSYQ_ASSERT(local_stop_visitor.end_array_count == 1);
+            local_stream_scanner.reset(std::istringstream(local_serialize_string));
+            PSYQ_ASSERT(local_stream_scanner.skip());
+            PSYQ_ASSERT(
+                local_stream_scanner.get_stream().tellg()
+                == static_cast<std::streamoff>(local_serialize_string.size()));
+
+            // 途中で途切れたMessagePackは、走査も読み飛ばしも失敗する。
+            {
+                char const local_truncated[] = {'\x93', '\x01', '\x02'};
+                count_visitor local_truncated_visitor;
+                psyq::message_pack::scanner<psyq::message_pack::memory_istream>
+                    local_truncated_scanner(
+                        psyq::message_pack::memory_istream(
+                            local_truncated, sizeof(local_truncated)));
+                PSYQ_ASSERT(
+                    local_truncated_scanner.scan(local_truncated_visitor) < 0);
+                PSYQ_ASSERT(local_truncated_visitor.unsigned_count == 2);
+                PSYQ_ASSERT(local_truncated_visitor.negative_count == 0);
+                local_truncated_scanner.reset(
+                    psyq::message_pack::memory_istream(
+                        local_truncated, sizeof(local_truncated)));
+                PSYQ_ASSERT(!local_truncated_scanner.skip());
+
+                std::string const local_truncated_string(
+                    local_truncated, sizeof(local_truncated));
+                psyq::message_pack::scanner<std::istringstream>
+                    local_truncated_stream_scanner(
+                        (std::istringstream(local_truncated_string)));
+                count_visitor local_truncated_stream_visitor;
+                PSYQ_ASSERT(
+                    local_truncated_stream_scanner.scan(
+                        local_truncated_stream_visitor) < 0);
+                PSYQ_ASSERT(local_truncated_stream_visitor.negative_count == 0);
+                local_truncated_stream_scanner.reset(
+                    std::istringstream(local_truncated_string));
+                PSYQ_ASSERT(!local_truncated_stream_scanner.skip());
+            }
+
+            // 不正なMessagePackは、表明せずに走査も読み飛ばしも失敗する。
+            {
+                // 未使用の形式と、途中で途切れた数値。
+                char const local_never_used[] = {'\x92', '\x01', '\xc1'};
+                char const local_short_integer[] = {'\x91', '\xd1', '\x01'};
+                count_visitor local_malformed_visitor;
+                psyq::message_pack::scanner<psyq::message_pack::memory_istream>
+                    local_malformed_scanner(
+                        psyq::message_pack::memory_istream(
+                            local_never_used, sizeof(local_never_used)));
+                PSYQ_ASSERT(
+                    local_malformed_scanner.scan(local_malformed_visitor) < 0);
+                local_malformed_scanner.reset(
+                    psyq::message_pack::memory_istream(
+                        local_never_used, sizeof(local_never_used)));
+                PSYQ_ASSERT(!local_malformed_scanner.skip());
+                local_malformed_scanner.reset(
+                    psyq::message_pack::memory_istream(
+                        local_short_integer, sizeof(local_short_integer)));
+                PSYQ_ASSERT(
+                    local_malformed_scanner.scan(local_malformed_visitor) < 0);
+                PSYQ_ASSERT(local_malformed_visitor.negative_count == 0);
+
+                // スタックの限界を超えて入れ子になったコンテナ。
+                char const local_nested[] =
+                    {'\x91', '\x91', '\x91', '\x91', '\x91', '\x01'};
+                psyq::message_pack::scanner<psyq::message_pack::memory_istream, 4>
+                    local_nested_scanner(
+                        psyq::message_pack::memory_istream(
+                            local_nested, sizeof(local_nested)));
+                PSYQ_ASSERT(
+                    local_nested_scanner.scan(local_malformed_visitor) < 0);
+                local_nested_scanner.reset(
+                    psyq::message_pack::memory_istream(
+                        local_nested, sizeof(local_nested)));
+                PSYQ_ASSERT(local_nested_scanner.skip());
+
+                // 実際より長いバイト長のRAWバイト列は、作業領域を確保しきらずに失敗する。
+                std::string const local_long_string("\xdb\x7f\xff\xff\xffxyz", 8);
+                psyq::message_pack::scanner<std::istringstream>
+                    local_long_scanner((std::istringstream(local_long_string)));
+                PSYQ_ASSERT(local_long_scanner.scan(local_malformed_visitor) < 0);
+                local_long_scanner.reset(std::istringstream(local_long_string));
+                PSYQ_ASSERT(!local_long_scanner.skip());
+
+                // 汎用のストリームでも、大きなRAWバイト列を読み飛ばせる。
+                std::string local_binary("\xc6\x00\x01\x00\x00", 5);
+                local_binary.append(0x10000, 'b');
+                local_binary.push_back('\x07');
+                local_long_scanner.reset(std::istringstream(local_binary));
+                PSYQ_ASSERT(local_long_scanner.skip());
+                PSYQ_ASSERT(local_long_scanner.get_stream().get() == 7);
+            }
+
+            // ソートしていない連想配列を、ハッシュ表の索引で検索する。
+            {
+                std::map<std::string, int> local_source_map;
+                for (int i(0); i < 100; ++i)
+                {
+                    local_source_map[std::to_string(i * 7)] = i;
+                }
+                psyq::message_pack::serializer<psyq::message_pack::memory_ostream<>>
+                    local_map_serializer(psyq::message_pack::memory_ostream<>(0x100));
+                local_map_serializer << local_source_map;
+                memory_deserializer local_map_deserializer(
+                    psyq::message_pack::memory_istream(
+                        local_map_serializer.get_stream().data(),
+                        local_map_serializer.get_stream().size()),
+                    memory_deserializer::pool());
+                local_map_deserializer.set_sort_map(false);
+                memory_deserializer::root_object local_map_root;
+                local_map_deserializer >> local_map_root;
+                auto const local_map(local_map_root.get_unordered_map());
+                PSYQ_ASSERT(local_map != nullptr);
+                psyq::message_pack::map_index<memory_deserializer::pool>
+                    local_index(*local_map, local_map_root.get_pool());
+                PSYQ_ASSERT(!local_index.is_built());
+                for (auto const& local_source: local_source_map)
+                {
+                    auto const local_found(
+                        local_index.find(
+                            psyq::message_pack::object::make_string(
+                                local_source.first)));
+                    PSYQ_ASSERT(local_found != local_map->end());
+                    PSYQ_ASSERT(
+                        local_found->second
+                        == psyq::message_pack::object(local_source.second));
+                }
+                PSYQ_ASSERT(local_index.is_built());
+                PSYQ_ASSERT(
+                    local_index.find(psyq::message_pack::object::make_string("1"))
+                    == local_map->end());
+                PSYQ_ASSERT(
+                    local_index.find(psyq::message_pack::object(7)) == local_map->end());
+            }
+
+            // 拡張するメモリ領域へ直列化しても、同じ結果になる。
+            psyq::message_pack::serializer<psyq::message_pack::memory_ostream<>, 16>
+                local_memory_serializer(psyq::message_pack::memory_ostream<>(0x100));
+            local_memory_serializer << local_borrow_root_object;
+            PSYQ_ASSERT(
+                local_memory_serializer.get_stream().str() == local_serialize_string);
+            std::stringstream local_flush_stream;
+            PSYQ_ASSERT(
+                local_memory_serializer.get_stream().flush_to(local_flush_stream));
+            PSYQ_ASSERT(local_memory_serializer.get_stream().size() == 0);
+            PSYQ_ASSERT(local_flush_stream.str() == local_serialize_string);
+
+            // 容量が固定のメモリ領域へ直列化しても、同じ結果になる。
+            std::vector<char> local_span(local_serialize_string.size());
+            local_memory_serializer.reset(
+                psyq::message_pack::memory_ostream<>(
+                    local_span.data(), local_span.size()));
+            PSYQ_ASSERT(!local_memory_serializer.get_stream().is_extendable());
+            local_memory_serializer << local_borrow_root_object;
+            PSYQ_ASSERT(local_memory_serializer.get_stream().good());
+            PSYQ_ASSERT(
+                std::string(local_span.begin(), local_span.end())
+                == local_serialize_string);
+
+            // 空のメモリ領域から拡張しながら直列化しても、書き込んだバイト列を保つ。
+            local_memory_serializer.reset(psyq::message_pack::memory_ostream<>());
+            PSYQ_ASSERT(local_memory_serializer.get_stream().get_capacity() == 0);
+            std::string local_repeat_string;
+            for (unsigned i(0); i < 16; ++i)
+            {
+                local_memory_serializer << local_borrow_root_object;
+                local_repeat_string += local_serialize_string;
+            }
+            PSYQ_ASSERT(local_memory_serializer.get_stream().good());
+            PSYQ_ASSERT(
+                local_memory_serializer.get_stream().str() == local_repeat_string);
+
+            // 新たなチャンクを確保したあとも、既存のチャンクの空き領域を使う。
+            {
+                psyq::message_pack::pool<> local_pool(256);
+                PSYQ_ASSERT(local_pool.get_statistics().chunk_count == 0);
+                PSYQ_ASSERT(local_pool.allocate(200) != nullptr);
+                PSYQ_ASSERT(local_pool.allocate(100) != nullptr);
+                PSYQ_ASSERT(local_pool.allocate(140) != nullptr);
+                PSYQ_ASSERT(local_pool.get_statistics().chunk_count == 3);
+                PSYQ_ASSERT(local_pool.allocate(120) != nullptr);
+                auto const local_statistics(local_pool.get_statistics());
+                PSYQ_ASSERT(local_statistics.chunk_count == 3);
+                PSYQ_ASSERT(
+                    200 + 100 + 140 + 120
+                    <= local_statistics.capacity - local_statistics.free_size);
+                PSYQ_ASSERT(
+                    local_statistics.max_free_size <= local_statistics.free_size);
+                PSYQ_ASSERT(local_statistics.max_free_size < 120);
+            }
+
+            // フレーム毎にメモリプールを再利用すると、チャンクが増えない。
+            {
+                typedef psyq::message_pack::deserializer<
+                    psyq::message_pack::memory_istream,
+                    psyq::message_pack::pool_reference<>,
+                    8>
+                        frame_deserializer;
+                psyq::message_pack::pool<> local_frame_pool;
+                psyq::message_pack::pool<>::statistics local_first_statistics = {};
+                for (int i(0); i < 4; ++i)
+                {
+                    for (int j(0); j < 3; ++j)
+                    {
+                        frame_deserializer local_frame_deserializer(
+                            psyq::message_pack::memory_istream(
+                                local_serialize_string.data(),
+                                local_serialize_string.size()),
+                            frame_deserializer::pool(local_frame_pool));
+                        frame_deserializer::root_object local_frame_root_object;
+                        local_frame_deserializer >> local_frame_root_object;
+                        local_serializer.reset(std::stringstream());
+                        local_serializer << local_frame_root_object;
+                        PSYQ_ASSERT(
+                            local_serializer.get_stream().str()
+                            == local_serialize_string);
+                    }
+                    auto const local_frame_statistics(
+                        local_frame_pool.get_statistics());
+                    PSYQ_ASSERT(0 < local_frame_statistics.chunk_count);
+                    if (i == 0)
+                    {
+                        local_first_statistics = local_frame_statistics;
+                    }
+                    PSYQ_ASSERT(
+                        local_frame_statistics.chunk_count
+                        == local_first_statistics.chunk_count);
+                    PSYQ_ASSERT(
+                        local_frame_statistics.capacity
+                        == local_first_statistics.capacity);
+                    local_frame_pool.reset();
+                    PSYQ_ASSERT(
+                        local_frame_pool.get_statistics().free_size
+                        == local_first_statistics.capacity);
+                }
+            }
+
+            // 構造体を直接直列化し、直接直列化復元する。
+            {
+                psyq::test::message_pack_shape local_shape;
+                local_shape.id = 0x12345;
+                local_shape.layer = -3;
+                local_shape.scale = 1.5f;
+                local_shape.ratio = -0.25;
+                local_shape.visible = true;
+                local_shape.name = local_string_0x10;
+                for (std::int32_t i(0); i < 20; ++i)
+                {
+                    psyq::test::message_pack_point const local_point = {i, -i * 1000};
+                    local_shape.points.push_back(local_point);
+                }
+                local_shape.color[0] = 0;
+                local_shape.color[1] = 0x80;
+                local_shape.color[2] = 0xffff;
+                local_shape.origin.x = 7;
+                local_shape.origin.y = -70000;
+                psyq::message_pack::serializer<psyq::message_pack::memory_ostream<>>
+                    local_struct_serializer(psyq::message_pack::memory_ostream<>(0x100));
+                PSYQ_ASSERT(
+                    psyq::message_pack::write_struct(
+                        local_struct_serializer, local_shape));
+                std::vector<psyq::test::message_pack_shape> local_shapes(2, local_shape);
+                local_struct_serializer << local_shapes;
+                auto const& local_struct_stream(local_struct_serializer.get_stream());
+
+                // 手書きの直列化と同じ結果になる。
+                psyq::message_pack::serializer<psyq::message_pack::memory_ostream<>>
+                    local_manual_serializer(psyq::message_pack::memory_ostream<>(0x100));
+                local_manual_serializer.make_serial_array(9);
+                local_manual_serializer << local_shape.id << local_shape.layer;
+                local_manual_serializer << local_shape.scale << local_shape.ratio;
+                local_manual_serializer << local_shape.visible << local_shape.name;
+                local_manual_serializer.make_serial_array(local_shape.points.size());
+                for (auto const& local_point: local_shape.points)
+                {
+                    local_manual_serializer.make_serial_array(2);
+                    local_manual_serializer << local_point.x << local_point.y;
+                }
+                local_manual_serializer << local_shape.color;
+                local_manual_serializer.make_serial_array(2);
+                local_manual_serializer << local_shape.origin.x << local_shape.origin.y;
+                auto const local_manual_string(
+                    local_manual_serializer.get_stream().str());
+                PSYQ_ASSERT(
+                    local_struct_stream.str().compare(
+                        0, local_manual_string.size(), local_manual_string) == 0);
+
+                // 直列化復元した構造体が、元の構造体と一致する。
+                typedef psyq::message_pack::scanner<psyq::message_pack::memory_istream>
+                    struct_scanner;
+                struct_scanner local_struct_scanner(
+                    psyq::message_pack::memory_istream(
+                        local_struct_stream.data(), local_struct_stream.size()));
+                psyq::test::message_pack_shape local_read_shape;
+                PSYQ_ASSERT(
+                    psyq::message_pack::read_struct(
+                        local_struct_scanner, local_read_shape));
+                PSYQ_ASSERT(local_read_shape.id == local_shape.id);
+                PSYQ_ASSERT(local_read_shape.layer == local_shape.layer);
+                PSYQ_ASSERT(local_read_shape.scale == local_shape.scale);
+                PSYQ_ASSERT(local_read_shape.ratio == local_shape.ratio);
+                PSYQ_ASSERT(local_read_shape.visible == local_shape.visible);
+                PSYQ_ASSERT(local_read_shape.name == local_shape.name);
+                PSYQ_ASSERT(local_read_shape.points.size() == local_shape.points.size());
+                for (std::size_t i(0); i < local_shape.points.size(); ++i)
+                {
+                    PSYQ_ASSERT(local_read_shape.points[i].x == local_shape.points[i].x);
+                    PSYQ_ASSERT(local_read_shape.points[i].y == local_shape.points[i].y);
+                }
+                PSYQ_ASSERT(local_read_shape.color == local_shape.color);
+                PSYQ_ASSERT(local_read_shape.origin.x == local_shape.origin.x);
+                PSYQ_ASSERT(local_read_shape.origin.y == local_shape.origin.y);
+
+                // 構造体のコンテナも直列化復元できる。
+                std::vector<psyq::test::message_pack_shape> local_read_shapes;
+                PSYQ_ASSERT(
+                    psyq::message_pack::read_struct(
+                        local_struct_scanner, local_read_shapes));
+                PSYQ_ASSERT(local_read_shapes.size() == 2);
+                PSYQ_ASSERT(local_read_shapes[1].name == local_shape.name);
+                PSYQ_ASSERT(local_struct_scanner.get_stream().get_rest_size() == 0);
+
+                // 余った要素は読み飛ばし、足りない要素は変更しない。
+                local_manual_serializer.reset(psyq::message_pack::memory_ostream<>(0x100));
+                local_manual_serializer.make_serial_array(3);
+                local_manual_serializer << 1 << 2 << "extra";
+                local_manual_serializer.make_serial_array(1);
+                local_manual_serializer << 3;
+                auto const& local_short_stream(local_manual_serializer.get_stream());
+                local_struct_scanner.reset(
+                    psyq::message_pack::memory_istream(
+                        local_short_stream.data(), local_short_stream.size()));
+                psyq::test::message_pack_point local_point = {0, 0};
+                PSYQ_ASSERT(
+                    psyq::message_pack::read_struct(local_struct_scanner, local_point));
+                PSYQ_ASSERT(local_point.x == 1 && local_point.y == 2);
+                PSYQ_ASSERT(
+                    psyq::message_pack::read_struct(local_struct_scanner, local_point));
+                PSYQ_ASSERT(local_point.x == 3 && local_point.y == 2);
+
+                // 型が一致しない値や、範囲外の整数は直列化復元できない。
+                local_manual_serializer.reset(psyq::message_pack::memory_ostream<>(0x100));
+                local_manual_serializer.make_serial_array(2);
+                local_manual_serializer << "x" << 0;
+                local_manual_serializer.make_serial_array(2);
+                local_manual_serializer << 0x100000000ull << 0;
+                local_manual_serializer.make_serial_array(2);
+                local_manual_serializer << 1.5 << 0;
+                for (int i(0); i < 3; ++i)
+                {
+                    local_struct_scanner.reset(
+                        psyq::message_pack::memory_istream(
+                            local_short_stream.data(), local_short_stream.size()));
+                    for (int j(0); j < i; ++j)
+                    {
+                        PSYQ_ASSERT(local_struct_scanner.skip());
+                    }
+                    PSYQ_ASSERT(
+                        !psyq::message_pack::read_struct(
+                            local_struct_scanner, local_point));
+                }
+
+                // 途中で終わるMessagePackは、直列化復元できない。
+                static char const local_truncated_point[] = {
+                    static_cast<char>(0x92), 0x01};
+                local_struct_scanner.reset(
+                    psyq::message_pack::memory_istream(
+                        local_truncated_point, sizeof(local_truncated_point)));
+                PSYQ_ASSERT(
+                    !psyq::message_pack::read_struct(
+                        local_struct_scanner, local_point));
+
+                // 信頼できない要素数で、巨大なメモリを確保しない。
+                static char const local_truncated_polyline[] = {
+                    static_cast<char>(0x93), 0x01, 0x02,
+                    static_cast<char>(0xdd), 0x10, 0x00, 0x00, 0x00};
+                local_struct_scanner.reset(
+                    psyq::message_pack::memory_istream(
+                        local_truncated_polyline, sizeof(local_truncated_polyline)));
+                psyq::test::message_pack_polyline local_polyline;
+                PSYQ_ASSERT(
+                    !psyq::message_pack::read_struct(
+                        local_struct_scanner, local_polyline));
+                PSYQ_ASSERT(
+                    local_polyline.points.capacity()
+                    <= sizeof(local_truncated_polyline));
+                psyq::message_pack::scanner<std::istringstream>
+                    local_truncated_scanner(
+                        (std::istringstream(
+                            std::string(
+                                local_truncated_polyline,
+                                sizeof(local_truncated_polyline)))));
+                PSYQ_ASSERT(
+                    !psyq::message_pack::read_struct(
+                        local_truncated_scanner, local_polyline));
+                PSYQ_ASSERT(
+                    local_polyline.points.capacity()
+                    <= sizeof(local_truncated_polyline));
+            }
         }
     } // namespace test
 } // namespace psyq